@@ -29,18 +29,18 @@ endif ()
 
 if(${LINUX_DISTRO} MATCHES "openSUSE")
   # OpenSuse (Leap, Tumbleweed)
-  set(CPACK_RPM_PACKAGE_REQUIRES "libgtkmm-4_0-0, cabextract, unzip, p7zip, wget, zenity, tar, xz")
+  set(CPACK_RPM_PACKAGE_REQUIRES "libgtkmm-4_0-0, liblzma5, libz1, libopenssl3, cabextract, unzip, p7zip, wget, zenity")
 else()
   # Fedora/CentOS/Redhat/etc.
-  set(CPACK_RPM_PACKAGE_REQUIRES "gtkmm4.0, cabextract, unzip, p7zip, wget, zenity, tar, xz")
+  set(CPACK_RPM_PACKAGE_REQUIRES "gtkmm4.0, xz-libs, zlib, openssl-libs, cabextract, unzip, p7zip, wget, zenity")
 endif()
 # Optional RPM packages
 set(CPACK_RPM_PACKAGE_SUGGESTS "vulkan, vulkan-loader")
 
 # Debian trixie, forky, sid, Ubuntu Noble Numbat, Linux Mint 22 (libgtkmm-4.0-0)
 # If needed we can add multiple minor versions eg. via libgtkmm-4.0-0 | libgtkmm-4.0-1
-# Note: xz-utils is needed to extract the Wine runner tar.xz archives (tar itself is an Essential package)
-set(CPACK_DEBIAN_PACKAGE_DEPENDS "libgtkmm-4.0-0, cabextract, unzip, p7zip, wget, zenity, xz-utils")
+# Note: liblzma5 & zlib1g are needed to extract the Wine runner archives (tar.xz & tar.gz), libssl3 to verify them
+set(CPACK_DEBIAN_PACKAGE_DEPENDS "libgtkmm-4.0-0, liblzma5, zlib1g, libssl3t64 | libssl3, cabextract, unzip, p7zip, wget, zenity")
 # Optional deb packages
 set(CPACK_DEBIAN_PACKAGE_SUGGESTS "libvulkan1, libvulkan1:i386, mesa-vulkan-drivers, mesa-vulkan-drivers:i386")
 
@@ -35,6 +35,7 @@ class AddAppWindow;
 class RemoveAppWindow;
 class CreateShortcutWindow;
 class WineRunnerWindow;
+class JobsWindow;
 class SignalController;
 
 /**
@@ -66,6 +67,7 @@ private:
   RemoveAppWindow* remove_app_window_;
   CreateShortcutWindow* create_shortcut_window_;
   WineRunnerWindow* wine_runner_window_;
+  JobsWindow* jobs_window_;
   std::shared_ptr<BottleManager> manager_;
   std::shared_ptr<SignalController> signal_controller_;
 
@@ -0,0 +1,127 @@
+/**
+ * Copyright (c) 2026 WineGUI
+ *
+ * \file    archive_extractor.h
+ * \brief   Extract tar.xz / tar.gz archives in-process, while the archive is streamed
+ * \author  Melroy van den Berg <webmaster1989@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <ctime>
+#include <lzma.h>
+#include <string>
+#include <vector>
+#include <zlib.h>
+
+/**
+ * \class ArchiveExtractor
+ * \brief Extracts a (compressed) tar archive into a directory, the archive data is passed in chunks as it arrives.
+ *
+ * Regular files, directories, symbolic links and hard links are extracted (GNU, ustar & pax tar formats). Like GNU tar,
+ * members are never extracted outside the destination directory: absolute paths and ".." are refused, and no member is
+ * written via a symbolic link of the archive. The owner of the files is not restored.
+ * xz archives with multiple blocks (eg. compressed with xz -T0) are decoded by multiple threads.
+ */
+class ArchiveExtractor
+{
+public:
+  /**
+   * \enum Compression
+   * \brief Compression of the tar archive
+   */
+  enum class Compression
+  {
+    None, /*!< Plain tar archive */
+    Gzip, /*!< tar.gz */
+    Xz    /*!< tar.xz */
+  };
+
+  ArchiveExtractor(const std::string& destination_dir, Compression compression, unsigned int thread_count = 0);
+  ~ArchiveExtractor();
+  ArchiveExtractor(const ArchiveExtractor&) = delete;
+  ArchiveExtractor& operator=(const ArchiveExtractor&) = delete;
+
+  static Compression get_compression(const std::string& archive_name);
+  static unsigned int get_default_thread_count();
+
+  void write(const char* data, std::size_t size);
+  void finish();
+  std::uint64_t get_extracted_bytes() const;
+  std::uint64_t get_extracted_entries() const;
+
+private:
+  /**
+   * \enum State
+   * \brief Part of the tar archive that is expected next
+   */
+  enum class State
+  {
+    Header,  /*!< 512 byte header block of the next member */
+    Data,    /*!< Data of the current member */
+    Padding, /*!< Zeros up to the next 512 byte block */
+    End      /*!< End of the archive (zero block), the remaining data is ignored */
+  };
+
+  /**
+   * \struct Member
+   * \brief Archive member that is extracted
+   */
+  struct Member
+  {
+    char type = '0';          /*!< tar type flag */
+    std::string path;         /*!< Path within the archive */
+    std::string link_path;    /*!< Target of a symbolic or hard link */
+    unsigned int mode = 0644; /*!< Permissions */
+    struct timespec mtime{};  /*!< Modification time */
+    std::uint64_t size = 0;   /*!< Size of the data */
+    int fd = -1;              /*!< Open regular file, -1 when the data is not written to a file */
+    std::string metadata;     /*!< Data of a GNU long name/link or pax header member */
+  };
+
+  Compression compression_;
+  lzma_stream xz_stream_;           /*!< xz decoder (Compression::Xz) */
+  z_stream gzip_stream_;            /*!< gzip decoder (Compression::Gzip) */
+  bool is_decoder_finished_;        /*!< End of the compressed stream reached */
+  std::vector<char> output_buffer_; /*!< Decompressed data */
+  int destination_fd_;              /*!< Destination directory */
+  std::string parent_dir_path_;     /*!< Path of the cached parent directory of the last member */
+  int parent_dir_fd_;               /*!< Cached parent directory of the last member, -1 if none */
+  State state_;                     /*!< Part of the archive that is expected next */
+  std::array<char, 512> header_;    /*!< Header block being collected */
+  std::size_t header_size_;         /*!< Bytes collected in header_ */
+  std::uint64_t remaining_;         /*!< Remaining bytes of the data or padding */
+  Member member_;                   /*!< Current member */
+  std::string long_path_;           /*!< Path for the next member (GNU long name or pax path) */
+  std::string long_link_path_;      /*!< Link path for the next member (GNU long link or pax linkpath) */
+  std::uint64_t pax_size_;          /*!< Size for the next member (pax size), 0 if none */
+  std::uint64_t extracted_bytes_;   /*!< Size of the extracted files */
+  std::uint64_t extracted_entries_; /*!< Number of extracted members */
+
+  void decompress(const char* data, std::size_t size, bool is_finishing);
+  void process(const char* data, std::size_t size);
+  void process_header();
+  void process_data(const char* data, std::size_t size);
+  void finish_member();
+  void parse_pax_header(const std::string& records);
+  void create_member();
+  int open_parent_dir(const std::string& path, std::string& name);
+  int open_dir(const std::string& dir_path, bool is_create) const;
+  void close_parent_dir();
+  static std::string sanitize_path(const std::string& path);
+};
@@ -21,6 +21,7 @@
 #pragma once
 
 #include "busy_dialog.h"
+#include <cstdint>
 #include <gtkmm.h>
 
 using std::string;
@@ -49,6 +50,7 @@ class BottleCloneWindow : public Gtk::Window
 public:
   // Signals
   sigc::signal<void(CloneBottleStruct&)> clone_bottle; /*!< clone button clicked signal */
+  sigc::signal<void()> cancel_clone;                   /*!< cancel button of the busy dialog clicked signal */
 
   explicit BottleCloneWindow(Gtk::Window& parent);
   virtual ~BottleCloneWindow();
@@ -59,6 +61,8 @@ public:
 
   // Signal handlers
   virtual Glib::ustring on_bottle_cloned();
+  virtual void on_bottle_clone_cancelled();
+  void on_clone_progress(std::uint64_t bytes_done, std::uint64_t bytes_total);
 
 protected:
   // Child widgets
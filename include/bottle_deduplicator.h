@@ -0,0 +1,105 @@
+/**
+ * Copyright (c) 2026 WineGUI
+ *
+ * \file    bottle_deduplicator.h
+ * \brief   Share identical files between Wine bottles
+ * \author  Melroy van den Berg <webmaster1989@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <sys/stat.h>
+#include <vector>
+
+/**
+ * \class BottleDeduplicator
+ * \brief Finds identical files in the bottles (like the DLLs & fonts of the same Wine runner and winetricks packages),
+ * and lets them share their data on disk.
+ *
+ * Identical files are deduplicated with the FIDEDUPERANGE ioctl (btrfs, XFS, ..), the kernel compares the data itself
+ * and the files stay separate files (copy-on-write). On other file systems, only read-only files can be replaced by a
+ * hard link (optional), since a program that writes to a hard linked file would change the file in every bottle.
+ * The file hashes are stored in an index keyed by inode & modification time, so the next run only hashes changed files.
+ */
+class BottleDeduplicator
+{
+public:
+  /**
+   * \struct Options
+   * \brief Deduplication options
+   */
+  struct Options
+  {
+    bool is_dry_run = true;                   /*!< Only report the duplicates, don't change any file */
+    bool allow_hard_links = false;            /*!< Replace read-only duplicates by hard links, when the data can't be shared */
+    std::uint64_t min_file_size = 16 * 1024; /*!< Smaller files are skipped */
+  };
+
+  /**
+   * \struct Report
+   * \brief Deduplication result
+   */
+  struct Report
+  {
+    std::uint64_t scanned_files = 0;        /*!< Files that are large enough to be deduplicated */
+    std::uint64_t hashed_files = 0;         /*!< Files that are hashed (not found in the index) */
+    std::uint64_t duplicate_files = 0;      /*!< Files that have an identical file in the same or another bottle (and don't share its data yet) */
+    std::uint64_t duplicate_bytes = 0;      /*!< Size of the duplicate files (not counting the first file) */
+    std::uint64_t deduplicated_files = 0;   /*!< Duplicate files that now share their data */
+    std::uint64_t deduplicated_bytes = 0;   /*!< Size of the deduplicated files */
+    std::uint64_t already_shared_files = 0; /*!< Identical files that already shared their data (eg. by an earlier run) */
+    std::uint64_t already_shared_bytes = 0; /*!< Size of the files that already shared their data */
+  };
+
+  explicit BottleDeduplicator(std::string index_file_path);
+  BottleDeduplicator(const BottleDeduplicator&) = delete;
+  BottleDeduplicator& operator=(const BottleDeduplicator&) = delete;
+
+  static BottleDeduplicator& get_instance();
+  static bool share_file_data(const std::string& source_path, const std::string& destination_path, std::uint64_t size);
+  static bool is_sharing_file_data(const std::string& source_path, const std::string& destination_path);
+
+  Report deduplicate(const std::vector<std::string>& prefix_paths, const Options& options, const std::atomic<bool>& cancel);
+
+private:
+  /**
+   * \struct IndexEntry
+   * \brief Hash of a single file
+   */
+  struct IndexEntry
+  {
+    dev_t device;          /*!< Device of the file */
+    ino_t inode;           /*!< Inode of the file */
+    struct timespec mtime; /*!< Modification time of the file */
+    off_t size;            /*!< File size */
+    std::string hash;      /*!< Hash of the file content */
+  };
+
+  std::mutex mutex_; /*!< Only one deduplication at the same time */
+  std::string index_file_path_;
+
+  static std::string hash_file(const std::string& file_path);
+  static bool replace_by_hard_link(const std::string& source_path,
+                                   const struct stat& source_stat,
+                                   const std::string& destination_path,
+                                   const struct stat& destination_stat);
+  std::map<std::string, IndexEntry> load_index() const;
+  void save_index(const std::map<std::string, IndexEntry>& index) const;
+};
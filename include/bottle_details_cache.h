@@ -0,0 +1,73 @@
+/**
+ * Copyright (c) 2026 WineGUI
+ *
+ * \file    bottle_details_cache.h
+ * \brief   Persisted snapshot of the bottle details
+ * \author  Melroy van den Berg <webmaster1989@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include "bottle_details_struct.h"
+#include <map>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+/**
+ * \class BottleDetailsCache
+ * \brief Snapshot of the details of all bottles, persisted in a single file.
+ *
+ * At start-up the bottles are shown straight from the snapshot, instead of parsing the registry files (and running Wine)
+ * of every bottle. A snapshot entry is only valid as long as the modification times of the files the details are read
+ * from (user.reg, system.reg, .update-timestamp & winegui.ini) are unchanged, otherwise the bottle is read again.
+ * Only bottles that were read without errors are stored.
+ */
+class BottleDetailsCache
+{
+public:
+  explicit BottleDetailsCache(std::string cache_file_path);
+  BottleDetailsCache(const BottleDetailsCache&) = delete;
+  BottleDetailsCache& operator=(const BottleDetailsCache&) = delete;
+
+  static BottleDetailsCache& get_instance();
+  static std::vector<std::string> get_file_stamps(const std::string& prefix_path);
+  static bool is_source_file(const std::string& file_name);
+
+  std::optional<BottleDetailsData> get(const std::string& prefix_path, const std::vector<std::string>& file_stamps);
+  void put(const BottleDetailsData& details, const std::vector<std::string>& file_stamps);
+  void retain(const std::vector<std::string>& prefix_paths);
+  void save();
+
+private:
+  /**
+   * \struct Entry
+   * \brief Snapshot of a single bottle
+   */
+  struct Entry
+  {
+    std::vector<std::string> file_stamps; /*!< Modification times of the files the details are read from */
+    BottleDetailsData details;            /*!< Bottle details */
+  };
+
+  std::mutex mutex_;
+  std::string cache_file_path_;
+  std::map<std::string, Entry> entries_; /*!< Bottle prefix path to entry */
+  bool is_loaded_ = false;
+  bool is_changed_ = false;
+
+  void load();
+};
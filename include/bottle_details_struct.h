@@ -0,0 +1,52 @@
+/**
+ * Copyright (c) 2026 WineGUI
+ *
+ * \file    bottle_details_struct.h
+ * \brief   Plain bottle details data struct (gathered off the GUI thread)
+ * \author  Melroy van den Berg <webmaster1989@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include "app_list_struct.h"
+#include "bottle_config_file.h"
+#include "bottle_types.h"
+#include "wine_defaults.h"
+#include <map>
+#include <string>
+#include <vector>
+
+/**
+ * \struct BottleDetailsData
+ * \brief All the details of a single Wine bottle, as read from disk.
+ * In contrast to BottleItem (a GTK widget) this struct can be safely filled from a worker thread.
+ */
+struct BottleDetailsData
+{
+  std::string prefix_path;
+  std::string folder_name;
+  BottleConfigData config;
+  std::map<int, ApplicationData> app_list;
+  bool status = false;
+  BottleTypes::Windows windows = WineDefaults::WindowsOs;
+  BottleTypes::Bit bit = BottleTypes::Bit::win32;
+  std::string wine_version = "?";
+  std::string c_drive_location = "- Unknown -";
+  std::string last_time_wine_updated = "- Unknown -";
+  BottleTypes::AudioDriver audio_driver = BottleTypes::AudioDriver::pulseaudio;
+  std::string virtual_desktop;
+  std::vector<std::string> error_messages; /*!< Errors during reading the details, to be shown to the user (GUI thread) */
+  bool is_snapshot = false;                /*!< Details are taken from the snapshot, see BottleDetailsCache (not persisted) */
+};
@@ -27,6 +27,7 @@
 #include <gtkmm/image.h>
 #include <gtkmm/label.h>
 #include <gtkmm/listboxrow.h>
+#include <gtkmm/spinner.h>
 #include <map>
 #include <string>
 #include <vector>
@@ -72,8 +73,11 @@ public:
     swap(a.debug_log_level_, b.debug_log_level_);
     swap(a.env_vars_, b.env_vars_);
     swap(a.app_list_, b.app_list_);
+    swap(a.is_loading_, b.is_loading_);
   }
 
+  BottleItem(const Glib::ustring& folder_name, const Glib::ustring& wine_location);
+
   BottleItem(Glib::ustring& name,
              Glib::ustring& folder_name,
              Glib::ustring& wine_bin_path,
@@ -302,6 +306,18 @@ public:
   {
     return app_list_;
   };
+  /// set is loading (placeholder, details are not yet read from disk)
+  void is_loading(bool is_loading)
+  {
+    is_loading_ = is_loading;
+  };
+  /// get is loading (placeholder, details are not yet read from disk)
+  bool is_loading() const
+  {
+    return is_loading_;
+  };
+
+  void update_ui();
 
 protected:
   // Widgets
@@ -310,6 +326,7 @@ protected:
   Gtk::Label name_label;   /*!< Name of the Wine Bottle */
   Gtk::Image status_icon;  /*!< Status icon of the Wine Bottle */
   Gtk::Label status_label; /*!< Status of the Wine Bottle */
+  Gtk::Spinner spinner;    /*!< Shown instead of the status icon, while the details are loading */
 
 private:
   Glib::ustring name_;
@@ -331,6 +348,7 @@ private:
   int debug_log_level_;
   std::vector<std::pair<std::string, std::string>> env_vars_;
   std::map<int, ApplicationData> app_list_;
+  bool is_loading_ = false;
 
   void CreateUI();
   static std::string str_tolower(std::string s);
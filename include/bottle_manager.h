@@ -20,14 +20,26 @@
  */
 #pragma once
 
+#include <atomic>
+#include <cstdint>
+#include <functional>
 #include <gtkmm.h>
 #include <list>
+#include <map>
+#include <memory>
 #include <mutex>
+#include <set>
 #include <string>
+#include <string_view>
 #include <thread>
+#include <utility>
 
+#include "bottle_deduplicator.h"
+#include "bottle_details_struct.h"
 #include "bottle_types.h"
 #include "general_config_struct.h"
+#include "job_scheduler.h"
+#include "log_writer.h"
 
 using std::string;
 
@@ -47,6 +59,7 @@ public:
   sigc::signal<void()> reset_active_bottle;             /*!< Send signal: Clear the current active bottle */
   sigc::signal<void()> bottle_removed;                  /*!< Send signal: When the bottle is confirmed to be removed */
   Glib::Dispatcher finished_package_install_dispatcher; /*!< Signal that Wine package install is completed */
+  Glib::Dispatcher jobs_changed_dispatcher;             /*!< Signal that a job is queued, started, finished or cancelled */
 
   explicit BottleManager(MainWindow& main_window);
   virtual ~BottleManager();
@@ -60,7 +73,8 @@ public:
                   const Glib::ustring& virtual_desktop_resolution,
                   bool disable_gecko_mono,
                   BottleTypes::AudioDriver audio,
-                  const Glib::ustring& wine_bin_path = "");
+                  const Glib::ustring& wine_bin_path = "",
+                  bool install_gaming_packages = false);
   void update_bottle(SignalController* caller,
                      const Glib::ustring& name,
                      const Glib::ustring& folder_name,
@@ -80,10 +94,15 @@ public:
                     const Glib::ustring& folder_name,
                     const Glib::ustring& description,
                     const Glib::ustring& wine_bin_path);
+  void cancel_clone();
+  std::pair<std::uint64_t, std::uint64_t> get_clone_progress() const;
   void delete_bottle(Gtk::Window* parent);
+  void deduplicate_bottles(Gtk::Window* parent);
   void set_active_bottle(BottleItem* bottle);
   const Glib::ustring& get_error_message() const;
   std::vector<string> get_bottle_wine_bin_paths() const;
+  std::vector<JobScheduler::JobInfo> get_jobs() const;
+  void cancel_job(std::size_t job_id);
 
   // Signal handlers
   void run_executable(string program, bool is_msi_file);
@@ -106,15 +125,27 @@ public:
 private:
   // Synchronizes access to data members using mutexes
   mutable std::mutex error_message_mutex_;
-  mutable std::mutex output_loging_mutex_;
   mutable std::mutex error_message_winetricks_mutex_;
   mutable std::mutex error_message_gpu_test_mutex_;
+  mutable std::mutex loaded_bottles_details_mutex_;
+  mutable std::mutex deduplication_mutex_;
+  mutable std::mutex pending_winetricks_verbs_mutex_;
   std::unique_ptr<std::thread> thread_install_update_winetricks_; /*!< Thread for installing/updating winetricks binary */
+  std::unique_ptr<std::thread> thread_refresh_bottles_;           /*!< Thread for reading the bottle details from disk */
+  std::atomic<bool> is_refresh_bottles_cancelled_;                /*!< Stop the refresh thread (a newer refresh is requested) */
+  std::atomic<bool> is_clone_cancelled_{false};                   /*!< Stop the running bottle clone */
+  std::atomic<std::uint64_t> clone_bytes_done_{0};                /*!< Clone progress: bytes done */
+  std::atomic<std::uint64_t> clone_bytes_total_{0};               /*!< Clone progress: bytes total */
+  std::atomic<bool> is_deduplication_cancelled_{false};           /*!< Stop the running deduplication (on exit) */
   Glib::Dispatcher update_bottles_dispatcher_;                    /*!< Dispatcher if the bottle list needs to be updated, from thread */
-  Glib::Dispatcher write_log_dispatcher_;                         /*!< Dispatcher if we can write the output logging to disk */
   Glib::Dispatcher error_message_winetricks_dispatcher_; /*!< Dispatcher when there is an error message during winetricks install/update thread */
   Glib::Dispatcher winetricks_finished_dispatcher_;      /*!< Dispatcher when the Winetricks install is completed */
   Glib::Dispatcher error_message_gpu_test_dispatcher_;   /*!< Dispatcher when the DXVK GPU test exited with a failure */
+  Glib::Dispatcher bottle_details_loaded_dispatcher_;    /*!< Dispatcher when the details of one or more bottles are read from disk */
+  Glib::Dispatcher refresh_bottles_finished_dispatcher_; /*!< Dispatcher when the refresh bottles thread is finished */
+  Glib::Dispatcher deduplication_finished_dispatcher_;   /*!< Dispatcher when the deduplication job is finished */
+  std::map<string, std::vector<string>> pending_winetricks_verbs_; /*!< Verbs for the queued install job of the bottle (by prefix path) */
+  std::shared_ptr<LogWriter> log_writer_; /*!< Writes the output of the programs to the log files (thread), shared with the launched programs */
 
   MainWindow& main_window_;
   string bottle_location_;
@@ -125,19 +156,49 @@ private:
   bool is_logging_stderr_;
   int previous_active_bottle_index_;
   std::size_t previous_bottles_list_size_;
+  bool is_refresh_pending_;                  /*!< Refresh again once the running refresh thread is stopped */
+  Glib::ustring pending_select_bottle_name_; /*!< Bottle name to select after the pending refresh */
+  Glib::ustring select_bottle_name_;         /*!< Bottle name to select once its details are loaded (empty if none) */
+  std::vector<std::pair<std::size_t, BottleDetailsData>> loaded_bottles_details_; /*!< Details read by the refresh thread (by bottles_ index) */
+  Glib::RefPtr<Gio::FileMonitor> bottle_location_monitor_;                       /*!< Watches the bottle location for added/removed bottles */
+  string bottle_location_monitored_;                                             /*!< Bottle location that is watched */
+  std::map<string, Glib::RefPtr<Gio::FileMonitor>> bottle_monitors_;             /*!< Watches the files of each bottle (by prefix path) */
+  sigc::connection bottle_changes_timeout_;                                      /*!< Debounce timer of the watched bottle changes */
+  std::set<string> changed_bottle_prefixes_;                                     /*!< Bottles with changed files, since the last update */
+  bool is_bottle_list_changed_;                                                  /*!< Bottles are added/removed, since the last update */
 
   //// error_message is used by both the GUI thread and NewBottle thread (used a 'temp' location)
   Glib::ustring error_message_;
   Glib::ustring error_message_winetricks_;
   Glib::ustring error_message_gpu_test_;
-  std::string logging_bottle_prefix_;
-  std::string output_logging_;
+
+  //// Deduplication result, written by the deduplication job (protected by deduplication_mutex_)
+  Gtk::Window* deduplication_parent_;               /*!< Parent window of the deduplication dialogs */
+  std::vector<string> deduplication_prefix_paths_;  /*!< Bottles that are deduplicated */
+  bool is_deduplication_dry_run_;                   /*!< The finished job only searched for duplicates */
+  bool is_deduplication_hard_links_;                /*!< The finished job replaced read-only duplicates by hard links */
+  BottleDeduplicator::Report deduplication_report_; /*!< Result of the finished job */
+  Glib::ustring error_message_deduplication_;       /*!< Error of the finished job (empty if none) */
+  bool is_deduplication_job_cancelled_;             /*!< The job is cancelled before it started (there is no result) */
+
+  JobScheduler job_scheduler_; /*!< Runs the programs & installs of the bottles (declared last: its jobs are finished first) */
 
   // Signal handlers
-  virtual void write_log_to_file();
   virtual void on_error_winetricks();
   virtual void on_error_gpu_test();
+  virtual void on_deduplication_finished();
   virtual void cleanup_install_update_winetricks_thread();
+  virtual void on_bottle_details_loaded();
+  virtual void on_refresh_bottles_finished();
+  virtual void cleanup_refresh_bottles_thread();
+  virtual void on_bottle_location_changed(const Glib::RefPtr<Gio::File>& file,
+                                          const Glib::RefPtr<Gio::File>& other_file,
+                                          Gio::FileMonitor::Event event);
+  virtual void on_bottle_files_changed(const string& prefix_path,
+                                       const Glib::RefPtr<Gio::File>& file,
+                                       const Glib::RefPtr<Gio::File>& other_file,
+                                       Gio::FileMonitor::Event event);
+  virtual bool on_bottle_changes_timeout();
 
   static bool add_gallium_nine_shortcut(const string& wine_prefix);
   void install_or_update_winetricks_thread(bool install);
@@ -145,7 +206,17 @@ private:
   bool is_bottle_not_null();
   std::vector<std::pair<string, string>> get_winetricks_env_vars();
   string get_deinstall_mono_command();
-  string get_wine_version(const string& prefix_path, const string& wine_bin_path = "", bool use_wine64 = false);
   std::vector<string> get_bottle_paths();
   std::list<BottleItem> create_wine_bottles(const std::vector<string>& bottle_dirs);
+  void set_bottle_details(BottleItem& bottle, const BottleDetailsData& details);
+  void read_bottles_details(const std::vector<string>& bottle_dirs, const std::vector<std::size_t>& bottle_indexes);
+  void watch_bottles(const std::vector<string>& bottle_dirs);
+  void schedule_bottle_changes();
+  std::function<void(std::string_view output)> create_output_sink(const string& prefix_path, bool is_debug_logging);
+  void queue_winetricks_verbs(const std::vector<string>& verbs);
+  static string get_winetricks_install_command(const std::vector<string>& verbs);
+  void run_deduplication(bool is_dry_run, bool allow_hard_links = false);
+  static void get_bottles_details(const std::vector<string>& bottle_dirs,
+                                  const std::function<bool(std::size_t index, BottleDetailsData details)>& on_bottle_details);
+  static BottleDetailsData get_bottle_details(const string& prefix_path);
 };
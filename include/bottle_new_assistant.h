@@ -36,7 +36,8 @@ struct NewBottleStruct
   Glib::ustring virtual_desktop_resolution;
   bool disable_gecko_mono = false;
   BottleTypes::AudioDriver audio = BottleTypes::AudioDriver::pulseaudio;
-  Glib::ustring wine_bin_path; /*!< Wine binary directory of the selected Wine runner (empty string = system Wine) */
+  Glib::ustring wine_bin_path;          /*!< Wine binary directory of the selected Wine runner (empty string = system Wine) */
+  bool install_gaming_packages = false; /*!< Install the common gaming packages (Visual C++, D3DX9, DXVK & fonts) */
 };
 
 /**
@@ -82,6 +83,7 @@ public:
   Gtk::ComboBoxText audio_driver_combobox;
   Gtk::CheckButton virtual_desktop_check;
   Gtk::CheckButton disable_gecko_mono_check;
+  Gtk::CheckButton gaming_packages_check;
   Gtk::Entry name_entry;
   Gtk::Entry virtual_desktop_resolution_entry;
   Gtk::Button manage_runners_button;
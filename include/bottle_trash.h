@@ -0,0 +1,66 @@
+/**
+ * Copyright (c) 2026 WineGUI
+ *
+ * \file    bottle_trash.h
+ * \brief   Removes deleted Wine bottles in the background
+ * \author  Melroy van den Berg <webmaster1989@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+
+/**
+ * \class BottleTrash
+ * \brief Deleting a bottle only renames it into a hidden trash folder (instant), a low-priority thread removes the files.
+ *
+ * The trash folder is created next to the bottle (in the bottle location), so the rename never crosses a file system.
+ * Bottles that are still in the trash when WineGUI stops are removed on the next start-up (see sweep()).
+ */
+class BottleTrash
+{
+public:
+  static constexpr const char* TrashDirName = ".winegui-trash"; /*!< Hidden trash folder, skipped in the bottle list */
+
+  explicit BottleTrash(unsigned int thread_count);
+  ~BottleTrash();
+  BottleTrash(const BottleTrash&) = delete;
+  BottleTrash& operator=(const BottleTrash&) = delete;
+
+  static BottleTrash& get_instance();
+  static std::string move_to_trash(const std::string& prefix_path);
+  static bool remove_tree(const std::string& path, unsigned int thread_count, const std::atomic<bool>& cancel);
+
+  void remove(const std::string& prefix_path);
+  void sweep(const std::string& location);
+  void wait_until_idle();
+
+private:
+  std::mutex mutex_;
+  std::condition_variable condition_;
+  std::condition_variable idle_condition_;
+  std::deque<std::string> paths_; /*!< Trashed folders waiting to be removed */
+  bool is_removing_ = false;      /*!< The thread is removing a folder */
+  std::atomic<bool> is_stopping_; /*!< Stop the thread, the remaining folders are removed on the next start-up */
+  unsigned int thread_count_;     /*!< Number of threads that remove a single folder */
+  std::thread thread_;
+
+  void run();
+};
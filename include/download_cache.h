@@ -0,0 +1,55 @@
+/**
+ * Copyright (c) 2026 WineGUI
+ *
+ * \file    download_cache.h
+ * \brief   Content-addressed cache of downloaded archives
+ * \author  Melroy van den Berg <webmaster1989@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <string>
+
+/**
+ * \class DownloadCache
+ * \brief Directory of downloaded archives, every archive is stored under its (verified) checksum.
+ *
+ * An index file (index.ini) maps the archive file names to their checksum, so an archive is found again without
+ * any network access (eg. to reinstall a removed Wine runner). The least recently used archives are removed once the
+ * cache grows beyond its maximum size. The unfinished downloads (.part files) are kept in the same directory.
+ */
+class DownloadCache
+{
+public:
+  DownloadCache(std::string cache_dir, std::uint64_t max_size);
+
+  static bool is_digest(const std::string& digest);
+
+  std::string get_part_path(const std::string& file_name) const;
+  std::optional<std::string> find_digest(const std::string& file_name) const;
+  std::optional<std::string> get_file_path(const std::string& digest) const;
+  void store(const std::string& file_name, const std::string& digest, const std::string& source_path);
+  void remove(const std::string& digest);
+  std::uint64_t get_size() const;
+
+private:
+  std::string cache_dir_;
+  std::string index_path_;
+  std::uint64_t max_size_; /*!< Maximum total size of the archives in bytes */
+
+  void evict(const std::string& keep_digest);
+};
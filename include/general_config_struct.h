@@ -32,4 +32,5 @@ struct GeneralConfigData
   bool display_default_wine_machine = false;
   bool enable_logging_stderr = false;
   bool check_for_updates_startup = false;
+  int max_runner_downloads = 3;
 };
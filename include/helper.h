@@ -20,11 +20,16 @@
  */
 #pragma once
 
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
 #include <glibmm/dispatcher.h>
 #include <map>
 #include <memory>
 #include <mutex>
 #include <string>
+#include <string_view>
 #include <utility>
 #include <vector>
 
@@ -36,6 +41,9 @@ using std::pair;
 using std::string;
 using std::vector;
 
+// Forward declaration
+class RegistryFile;
+
 /**
  * \class Helper
  * \brief Provide some helper methods for Bottle Manager and CLI
@@ -57,7 +65,8 @@ public:
                             const vector<pair<string, string>>& env_vars = {},
                             bool give_error = true,
                             bool stderr_output = true,
-                            int* exit_code = nullptr);
+                            int* exit_code = nullptr,
+                            const std::function<void(std::string_view output)>& on_output = nullptr);
   static string run_program_under_wine(bool wine_64_bit,
                                        const string& prefix_path,
                                        int debug_log_level,
@@ -67,10 +76,12 @@ public:
                                        bool give_error = true,
                                        bool stderr_output = true,
                                        const string& wine_bin_path = "",
-                                       int* exit_code = nullptr);
-  static void write_to_log_file(const string& logging_bottle_prefix, const string& logging);
+                                       int* exit_code = nullptr,
+                                       const std::function<void(std::string_view output)>& on_output = nullptr);
   static string get_log_file_path(const string& logging_bottle_prefix);
-  static void wait_until_wineserver_is_terminated(const string& prefix_path, const string& wine_bin_path = "");
+  static bool wait_until_wineserver_is_terminated(const string& prefix_path,
+                                                  const string& wine_bin_path = "",
+                                                  std::chrono::seconds timeout = std::chrono::seconds(60));
   static int determine_wine_executable();
   static string get_wine_executable_location(bool prefer_wine64 = false, const string& wine_bin_path = "");
   static string get_wineserver_executable_location(const string& wine_bin_path = "");
@@ -81,7 +92,10 @@ public:
       bool wine_64_bit, const string& prefix_path, BottleTypes::Bit bit, const bool disable_gecko_mono = false, const string& wine_bin_path = "");
   static void remove_wine_bottle(const string& prefix_path);
   static void rename_wine_bottle_folder(const string& current_prefix_path, const string& new_prefix_path);
-  static void copy_wine_bottle_folder(const string& source_prefix_path, const string& destination_prefix_path);
+  static bool copy_wine_bottle_folder(const string& source_prefix_path,
+                                      const string& destination_prefix_path,
+                                      const std::function<void(std::uint64_t, std::uint64_t)>& progress_cb = nullptr,
+                                      const std::atomic<bool>* cancel = nullptr);
   static string get_folder_name(const string& prefix_path);
   static BottleTypes::Bit get_windows_bitness(const string& prefix_path);
   static BottleTypes::AudioDriver get_audio_driver(const string& prefix_path);
@@ -129,7 +143,6 @@ public:
                                   const string& bottle_name = "",
                                   bool make_executable = false);
   static string to_filename_part(const string& input);
-  static void invalidate_reg_cache();
   static void invalidate_reg_cache(const string& prefix_path);
 
 private:
@@ -138,9 +151,7 @@ private:
   Helper(const Helper&) = delete;
   Helper& operator=(const Helper&) = delete;
 
-  static std::pair<int, string> exec(const string& command);
-  static string exec_error_message(const string& command);
-  static int close_exec_stream(std::FILE* file);
+  static string exec_wine_version(const string& wine_executable, const string& prefix_path, const string& wine_bin_path);
   static void write_file(const string& filename, const string& contents);
   static string read_file(const string& filename);
   static BottleTypes::Windows get_windows_version(const string& prefix_path);
@@ -163,7 +174,7 @@ private:
   static string get_reg_meta_data(const string& filename, const string& meta_value_name);
   static string get_bottle_dir_from_prefix(const string& prefix_path);
   static vector<string> read_file_lines(const string& file_path);
-  static std::shared_ptr<const vector<string>> get_reg_file_lines(const string& file_path);
+  static std::shared_ptr<const RegistryFile> get_reg_file(const string& file_path);
   static vector<string> split(const string& s, const char delimiter);
   static string unescape_reg_key_data(const string& src);
   static string string2hex(const string& str, bool capital = false);
@@ -0,0 +1,139 @@
+/**
+ * Copyright (c) 2026 WineGUI
+ *
+ * \file    job_scheduler.h
+ * \brief   Runs the bottle jobs (programs, installs, ...) on a bounded pool of worker threads
+ * \author  Melroy van den Berg <webmaster1989@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * \class JobScheduler
+ * \brief Runs jobs on a fixed number of worker threads.
+ *
+ * Jobs of different bottles run in parallel (up to the number of workers), while the jobs of the same bottle are
+ * serialized depending on their lock: a job that modifies the bottle (eg. winetricks or wineboot) runs alone, programs
+ * can run next to each other. Jobs of the same bottle are started in the order they are submitted.
+ *
+ * Long-lived jobs (eg. a game that runs for hours) are launched on their own thread instead, so they never occupy a
+ * worker nor block the other jobs of their bottle.
+ */
+class JobScheduler
+{
+public:
+  /**
+   * \enum Lock
+   * \brief How a job is serialized with the other jobs of the same bottle
+   */
+  enum class Lock
+  {
+    None,     /*!< Runs regardless of the other jobs of the bottle (eg. killing the processes of the bottle) */
+    Shared,   /*!< Runs next to the other shared jobs of the bottle (eg. running a program) */
+    Exclusive /*!< Runs alone, once the earlier jobs of the bottle are finished (eg. winetricks or wineboot) */
+  };
+
+  /**
+   * \enum State
+   * \brief State of a job
+   */
+  enum class State
+  {
+    Queued, /*!< Waiting for a worker (or for the other jobs of the bottle) */
+    Running /*!< Running on a worker thread (or on its own thread, when launched) */
+  };
+
+  /**
+   * \struct JobInfo
+   * \brief Job as shown to the user
+   */
+  struct JobInfo
+  {
+    std::size_t id;            /*!< Unique job ID */
+    std::string name;          /*!< Description of the job */
+    std::string bottle_prefix; /*!< Bottle the job runs in */
+    Lock lock;                 /*!< Serialization with the other jobs of the bottle */
+    State state;               /*!< Current state */
+  };
+
+  JobScheduler(std::size_t worker_count, std::function<void()> on_jobs_changed);
+  ~JobScheduler();
+  JobScheduler(const JobScheduler&) = delete;
+  JobScheduler& operator=(const JobScheduler&) = delete;
+
+  std::size_t submit(const std::string& name,
+                     const std::string& bottle_prefix,
+                     Lock lock,
+                     std::function<void()> job,
+                     std::function<void()> on_cancelled = nullptr);
+  std::size_t launch(const std::string& name,
+                     const std::string& bottle_prefix,
+                     std::function<void()> job,
+                     std::function<void()> on_finished = nullptr);
+  bool cancel(std::size_t id);
+  std::size_t cancel_bottle_jobs(const std::string& bottle_prefix);
+  bool has_running_jobs(const std::string& bottle_prefix) const;
+  std::vector<JobInfo> get_jobs() const;
+  void wait_until_idle();
+
+private:
+  /**
+   * \struct Job
+   * \brief Queued job
+   */
+  struct Job
+  {
+    JobInfo info;                       /*!< Job details */
+    std::function<void()> execute;      /*!< Work to do */
+    std::function<void()> on_cancelled; /*!< Called when the job is removed from the queue, may be empty */
+  };
+
+  /**
+   * \struct LaunchedJobs
+   * \brief Jobs running on their own (detached) thread, shared with those threads so it outlives the scheduler
+   */
+  struct LaunchedJobs
+  {
+    std::mutex mutex;
+    std::list<JobInfo> jobs;                /*!< Running launched jobs */
+    bool is_stopped = false;                /*!< The scheduler is destroyed, don't call back anymore */
+    std::function<void()> on_jobs_changed; /*!< Copy of the jobs changed callback of the scheduler */
+  };
+
+  mutable std::mutex mutex_;
+  std::condition_variable job_condition_;  /*!< Signalled when a job can be started */
+  std::condition_variable idle_condition_; /*!< Signalled when a job is finished */
+  std::list<Job> queue_;                   /*!< Queued jobs, in submit order */
+  std::list<JobInfo> running_;             /*!< Running jobs */
+  std::size_t next_id_;
+  bool is_stopping_;
+  std::function<void()> on_jobs_changed_; /*!< Called (from any thread) when jobs are added, started or finished */
+  std::vector<std::thread> workers_;
+  std::shared_ptr<LaunchedJobs> launched_;
+
+  void run_worker();
+  std::list<Job>::iterator find_runnable_job();
+  bool is_runnable(const JobInfo& job) const;
+};
@@ -0,0 +1,57 @@
+/**
+ * Copyright (c) 2026 WineGUI
+ *
+ * \file    jobs_window.h
+ * \brief   Running & queued jobs of the machines Window
+ * \author  Melroy van den Berg <webmaster1989@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include "job_scheduler.h"
+#include <cstddef>
+#include <gtkmm.h>
+#include <vector>
+
+/**
+ * \class JobsWindow
+ * \brief GTK Window class that lists the running & queued jobs (installs, updates, programs, ..) of the machines
+ */
+class JobsWindow : public Gtk::Window
+{
+public:
+  // Signals
+  sigc::signal<void(std::size_t)> cancel_job; /*!< Cancel button of a queued job clicked signal (with the job ID) */
+
+  explicit JobsWindow(Gtk::Window& parent);
+  virtual ~JobsWindow();
+
+  void show();
+  void set_jobs(const std::vector<JobScheduler::JobInfo>& jobs);
+
+protected:
+  // Child widgets
+  Gtk::Box vbox;                   /*!< Main vertical box */
+  Gtk::Box hbox_buttons;           /*!< Box for buttons */
+  Gtk::Label header_jobs_label;    /*!< Header jobs label */
+  Gtk::Label empty_label;          /*!< Empty state label */
+  Gtk::ScrolledWindow jobs_scroll; /*!< Scrolled window around the jobs list */
+  Gtk::ListBox jobs_listbox;       /*!< One row per job */
+  Gtk::Button close_button;        /*!< Close button */
+
+private:
+  // Signal handlers
+  void on_close_button_clicked();
+};
@@ -0,0 +1,89 @@
+/**
+ * Copyright (c) 2026 WineGUI
+ *
+ * \file    log_writer.h
+ * \brief   Writes the output of running programs to the bottle log files (thread)
+ * \author  Melroy van den Berg <webmaster1989@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+class OutputRingBuffer;
+
+/**
+ * \class LogWriter
+ * \brief Dedicated thread that writes the output of running programs to the log file (winegui.log) of their bottle.
+ *
+ * Every program has its own output buffer, so programs that run at the same time (or exit at the same time) never
+ * overwrite each other's output. The log file of a bottle is kept open as long as one of its programs is running and is
+ * rotated (winegui.log -> winegui.log.1 -> winegui.log.2, ...) once it grows beyond the maximum size.
+ */
+class LogWriter
+{
+public:
+  LogWriter(std::size_t max_file_size, int max_rotated_files);
+  ~LogWriter();
+  LogWriter(const LogWriter&) = delete;
+  LogWriter& operator=(const LogWriter&) = delete;
+
+  void add_output(const std::string& bottle_prefix, const std::shared_ptr<OutputRingBuffer>& output);
+  void notify();
+
+private:
+  /**
+   * \struct Source
+   * \brief Output of a single program
+   */
+  struct Source
+  {
+    std::string bottle_prefix;                /*!< Bottle of the program */
+    std::shared_ptr<OutputRingBuffer> output; /*!< Output that is not yet written to disk */
+    char last_char;                           /*!< Last character written to disk */
+  };
+  /**
+   * \struct LogFile
+   * \brief Opened log file of a bottle (only used by the writer thread)
+   */
+  struct LogFile
+  {
+    int fd;           /*!< File descriptor, -1 if the file could not be opened */
+    std::size_t size; /*!< Current file size */
+  };
+
+  std::mutex mutex_;
+  std::condition_variable condition_;
+  std::list<Source> sources_;            /*!< Output of the running programs */
+  bool is_notified_;                     /*!< New output is available */
+  bool is_stopping_;                     /*!< Write the remaining output and stop the thread */
+  std::map<std::string, LogFile> files_; /*!< Opened log files (by bottle prefix) */
+  std::size_t max_file_size_;
+  int max_rotated_files_;
+  std::thread thread_;
+
+  void run();
+  void write_output(Source& source, bool is_finished);
+  LogFile& open_log_file(const std::string& bottle_prefix);
+  void rotate_log_file(const std::string& bottle_prefix, LogFile& log_file);
+  void close_log_file(const std::string& bottle_prefix);
+};
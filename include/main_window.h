@@ -75,6 +75,7 @@ public:
   virtual ~MainWindow();
 
   void set_wine_bottles(std::list<BottleItem>& bottles);
+  void update_wine_bottle(BottleItem& bottle);
   void select_row_bottle(BottleItem& bottle);
   void refresh_wine_runner_assistant();
   void reset_detailed_info();
@@ -85,6 +86,7 @@ public:
   void show_error_message(const Glib::ustring& message, bool markup = false);
   DialogWindow* show_question_dialog(Gtk::Window* parent, const Glib::ustring& message, bool markup = false);
   void show_busy_install_dialog(Gtk::Window& parent, const Glib::ustring& message);
+  void show_busy_dialog(Gtk::Window& parent, const Glib::ustring& heading, const Glib::ustring& message);
   void hide_busy_dialog();
 
   // Signal handlers
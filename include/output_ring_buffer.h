@@ -0,0 +1,53 @@
+/**
+ * Copyright (c) 2026 WineGUI
+ *
+ * \file    output_ring_buffer.h
+ * \brief   Fixed-size buffer for streaming program output
+ * \author  Melroy van den Berg <webmaster1989@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <cstddef>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * \class OutputRingBuffer
+ * \brief Thread-safe ring buffer between a program that produces output (writer) and the log (reader).
+ *
+ * The memory usage is fixed, no matter how long the program runs or how much output it produces. When the reader
+ * can not keep up, the oldest output is overwritten; the number of dropped bytes is reported by the next read().
+ */
+class OutputRingBuffer
+{
+public:
+  explicit OutputRingBuffer(std::size_t capacity);
+
+  bool write(std::string_view data);
+  std::size_t read(std::string& output);
+  void close();
+  bool is_closed() const;
+
+private:
+  mutable std::mutex mutex_;
+  std::vector<char> buffer_;
+  std::size_t start_ = 0;   /*!< Position of the oldest byte */
+  std::size_t size_ = 0;    /*!< Number of bytes in the buffer */
+  std::size_t dropped_ = 0; /*!< Bytes overwritten since the last read */
+  bool is_closed_ = false;  /*!< Writer is finished */
+};
@@ -47,10 +47,12 @@ protected:
   Gtk::Label logging_stderr_header;                /*!< Logging stderr header */
   Gtk::Label default_wine_machine_header;          /*!< Default Wine machine header */
   Gtk::Label check_for_updates_header;             /*!< Check for updates header */
+  Gtk::Label runner_downloads_header;              /*!< Parallel Wine runner downloads header */
   Gtk::Entry default_folder_entry;                 /*!< Default Wine storage location input field */
   Gtk::Switch display_default_wine_machine_switch; /*!< Display default Wine machine switch */
   Gtk::Switch enable_logging_stderr_switch;        /*!< Debug logging switch */
   Gtk::Switch check_for_updates_switch;            /*!< Check for updates during startup switch */
+  Gtk::SpinButton runner_downloads_spin_button;    /*!< Maximum number of parallel Wine runner downloads */
   Gtk::Button select_folder_button;                /*!< Select folder button */
   Gtk::Button save_button;                         /*!< Save button */
   Gtk::Button cancel_button;                       /*!< Cancel button */
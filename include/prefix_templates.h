@@ -0,0 +1,65 @@
+/**
+ * Copyright (c) 2026 WineGUI
+ *
+ * \file    prefix_templates.h
+ * \brief   Pre-provisioned Wine prefixes, used to create new bottles fast
+ * \author  Melroy van den Berg <webmaster1989@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include "bottle_types.h"
+#include <chrono>
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+
+/**
+ * \class PrefixTemplates
+ * \brief Template prefixes, a new bottle is a copy of a template instead of a full 'wineboot' run.
+ *
+ * A template is built (once) by the first bottle that is created with the same Wine runner (binary & version), bitness
+ * and Gecko/Mono setting. Templates of a previous version of the same Wine runner are removed once a new template is built
+ * (when they are not being copied).
+ */
+class PrefixTemplates
+{
+public:
+  explicit PrefixTemplates(std::string templates_dir);
+  PrefixTemplates(const PrefixTemplates&) = delete;
+  PrefixTemplates& operator=(const PrefixTemplates&) = delete;
+
+  static PrefixTemplates& get_instance();
+  static std::string get_template_name(const std::string& wine_executable,
+                                       const std::string& wine_version,
+                                       BottleTypes::Bit bit,
+                                       bool disable_gecko_mono);
+  static void fix_user_paths(const std::string& template_path, const std::string& prefix_path);
+  static void regenerate_machine_ids(const std::string& prefix_path);
+
+  void create_bottle(const std::string& prefix_path, BottleTypes::Bit bit, bool disable_gecko_mono, const std::string& wine_bin_path);
+
+private:
+  std::mutex mutex_; /*!< Protects the template bookkeeping below (not held while building or copying a template) */
+  std::condition_variable template_built_; /*!< Signalled when a template is no longer being built */
+  std::string templates_dir_;
+  std::map<std::string, int> templates_in_use_; /*!< Templates that are being built or copied (by name), these are never removed */
+  std::set<std::string> templates_building_;    /*!< Templates that are being built (by name) */
+
+  void remove_outdated_templates(const std::string& template_name);
+  bool build_template(const std::string& template_name, BottleTypes::Bit bit, bool disable_gecko_mono, const std::string& wine_bin_path);
+};
@@ -0,0 +1,63 @@
+/**
+ * Copyright (c) 2026 WineGUI
+ *
+ * \file    process_launcher.h
+ * \brief   Launch processes without a shell (posix_spawn)
+ * \author  Melroy van den Berg <webmaster1989@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <functional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+/**
+ * \class ProcessLauncher
+ * \brief Run a process with an explicit argument list & environment, and capture its output.
+ *
+ * The process is started with posix_spawn (vfork + exec), so there is no intermediate /bin/sh process and
+ * no quoting of the environment variables or arguments. Only commands that really need a shell (eg. pipes,
+ * redirects or multiple commands) are still executed by /bin/sh, see run_command().
+ */
+class ProcessLauncher
+{
+public:
+  static std::pair<int, std::string> run(const std::vector<std::string>& argv,
+                                         const std::vector<std::pair<std::string, std::string>>& env_vars = {},
+                                         const std::string& working_directory = "",
+                                         bool stderr_output = false);
+  static int run(const std::vector<std::string>& argv,
+                 const std::vector<std::pair<std::string, std::string>>& env_vars,
+                 const std::string& working_directory,
+                 bool stderr_output,
+                 const std::function<void(std::string_view output)>& on_output);
+  static std::pair<int, std::string> run_command(const std::string& command,
+                                                 const std::vector<std::pair<std::string, std::string>>& env_vars = {},
+                                                 const std::string& working_directory = "",
+                                                 bool stderr_output = false);
+  static int run_command(const std::string& command,
+                         const std::vector<std::pair<std::string, std::string>>& env_vars,
+                         const std::string& working_directory,
+                         bool stderr_output,
+                         const std::function<void(std::string_view output)>& on_output);
+  static std::vector<std::string> parse_command(const std::string& command, std::vector<std::pair<std::string, std::string>>& env_vars);
+  static int decode_exit_status(int wait_status);
+
+private:
+  static bool needs_shell(const std::string& command);
+};
@@ -0,0 +1,77 @@
+/**
+ * Copyright (c) 2026 WineGUI
+ *
+ * \file    registry_file.h
+ * \brief   Parsed & indexed in-memory model of a Wine registry file
+ * \author  Melroy van den Berg <webmaster1989@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <sys/stat.h>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * \class RegistryFile
+ * \brief Wine registry file (user.reg, system.reg), parsed once into an index.
+ *
+ * The file is split into key sections up-front; each key maps (by its escaped path) to a contiguous
+ * block of value entries, so a lookup no longer scans the whole file. The file contents are read into a
+ * single owned buffer; all string views point directly into it, so keep the (shared) object alive while using them.
+ * Key names are kept in the escaped form as written by Wine (eg. Software\\\\Wine\\\\Drivers).
+ */
+class RegistryFile
+{
+public:
+  /**
+   * \struct Key
+   * \brief Single registry key section
+   */
+  struct Key
+  {
+    std::string_view name;   /*!< Escaped key path, without the surrounding brackets */
+    std::size_t first_entry; /*!< Index of the first value entry of this key */
+    std::size_t entry_count; /*!< Number of value entries of this key */
+  };
+
+  explicit RegistryFile(std::string contents);
+  RegistryFile(const RegistryFile&) = delete;
+  RegistryFile& operator=(const RegistryFile&) = delete;
+
+  static std::shared_ptr<const RegistryFile> read(const std::string& file_path, struct stat* file_stat = nullptr);
+
+  const Key* find_key(std::string_view key_name) const;
+  std::span<const std::string_view> get_entries(const Key& key) const;
+  std::optional<std::string_view> find_value(const Key& key, std::string_view value_name) const;
+  std::optional<std::string_view> get_meta_data(std::string_view meta_name) const;
+  const std::vector<Key>& get_keys() const;
+
+private:
+  std::string buffer_;                                               /*!< Owned file contents */
+  std::string_view contents_;                                        /*!< Raw file contents, all views below point into it */
+  std::vector<std::string_view> entries_;                            /*!< Value entries of all keys, grouped per key */
+  std::vector<Key> keys_;                                            /*!< Keys in file order */
+  std::unordered_map<std::string_view, std::size_t> key_index_;      /*!< Key name to index in keys_ */
+  std::unordered_map<std::string_view, std::string_view> meta_data_; /*!< File header meta data (eg. #arch=win64) */
+
+  void parse();
+};
@@ -0,0 +1,69 @@
+/**
+ * Copyright (c) 2026 WineGUI
+ *
+ * \file    release_list_cache.h
+ * \brief   Persisted release lists of the Wine runner sources
+ * \author  Melroy van den Berg <webmaster1989@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include "wine_runner_types.h"
+#include <map>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+/**
+ * \class ReleaseListCache
+ * \brief The parsed release list of every runner source, persisted in a single file.
+ *
+ * The release list is shown straight from the file (also when offline), while it is revalidated in the background.
+ * The ETag & Last-Modified validators of the GitHub API response are stored as well, so the revalidation is a
+ * conditional request: an unchanged list is not transferred again (and does not count against the rate limit).
+ */
+class ReleaseListCache
+{
+public:
+  /**
+   * \struct Entry
+   * \brief Release list of a single source
+   */
+  struct Entry
+  {
+    std::vector<WineRunner::Release> releases; /*!< Parsed releases, newest first */
+    std::string etag;                          /*!< ETag header of the response (empty if none) */
+    std::string last_modified;                 /*!< Last-Modified header of the response (empty if none) */
+  };
+
+  explicit ReleaseListCache(std::string cache_file_path);
+  ReleaseListCache(const ReleaseListCache&) = delete;
+  ReleaseListCache& operator=(const ReleaseListCache&) = delete;
+
+  static ReleaseListCache& get_instance();
+
+  std::optional<Entry> get(WineRunner::SourceId source_id);
+  void put(WineRunner::SourceId source_id, const Entry& entry);
+
+private:
+  std::mutex mutex_;
+  std::string cache_file_path_;
+  std::map<WineRunner::SourceId, Entry> entries_;
+  bool is_loaded_ = false;
+
+  void load();
+  void save();
+};
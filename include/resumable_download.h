@@ -0,0 +1,94 @@
+/**
+ * Copyright (c) 2026 WineGUI
+ *
+ * \file    resumable_download.h
+ * \brief   Download a file over HTTP(S) into a .part file that survives a cancel or a broken connection
+ * \author  Melroy van den Berg <webmaster1989@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <sys/types.h>
+#include <vector>
+
+/**
+ * \class ResumableDownload
+ * \brief Downloads a file into a .part file, optionally in multiple parallel segments (HTTP range requests).
+ *
+ * The progress of every segment is stored next to the .part file (<part file>.ini), so a cancelled or failed download
+ * continues where it stopped, both within the same run (a broken connection is retried) and in a later run. The data is
+ * also passed in order to a callback while it arrives (already downloaded data is passed first), so the file can be
+ * processed during the download. Every segment is downloaded by its own wget subprocess (no shell involved).
+ */
+class ResumableDownload
+{
+public:
+  ResumableDownload(std::string url, std::string part_path, std::uint64_t size, unsigned int segment_count = 1);
+  ~ResumableDownload();
+  ResumableDownload(const ResumableDownload&) = delete;
+  ResumableDownload& operator=(const ResumableDownload&) = delete;
+
+  static void discard(const std::string& part_path);
+
+  bool run(const std::function<void(const char*, std::size_t)>& data_cb,
+           const std::function<void(std::uint64_t, std::uint64_t)>& progress_cb,
+           const std::atomic<bool>& cancel);
+  std::uint64_t get_resumed_bytes() const;
+  unsigned int get_segment_count() const;
+
+private:
+  /**
+   * \struct Segment
+   * \brief Byte range of the file that is downloaded by a single wget process
+   */
+  struct Segment
+  {
+    std::uint64_t start = 0;                          /*!< Offset of the first byte */
+    std::uint64_t length = 0;                         /*!< Number of bytes, 0 when the size is unknown (until the end of the file) */
+    std::uint64_t done = 0;                           /*!< Number of bytes in the .part file */
+    pid_t pid = 0;                                    /*!< Running wget process, 0 if none */
+    int output_fd = -1;                               /*!< Standard output of the wget process, -1 if none */
+    int process_fd = -1;                              /*!< Process file descriptor (pidfd) of the wget process, -1 if none */
+    std::uint64_t done_at_start = 0;                  /*!< Value of done when the wget process was started */
+    unsigned int failures = 0;                        /*!< Successive attempts that failed without any progress */
+    std::chrono::steady_clock::time_point retry_time; /*!< Earliest time of the next attempt */
+    bool is_finished = false;                         /*!< All bytes of the segment are downloaded */
+  };
+
+  std::string url_;
+  std::string part_path_;
+  std::string state_path_;
+  std::uint64_t size_;            /*!< File size, 0 when unknown */
+  std::vector<Segment> segments_;
+  int part_fd_;                   /*!< Open .part file */
+  std::uint64_t resumed_bytes_;   /*!< Bytes already downloaded by a previous run */
+  std::uint64_t delivered_bytes_; /*!< Bytes passed to the data callback (in order) */
+  std::vector<char> buffer_;
+
+  void load_state();
+  void save_state() const;
+  void start_segment(Segment& segment);
+  int stop_segment(Segment& segment, bool is_kill);
+  void stop_all_segments();
+  void read_segment(Segment& segment, const std::function<void(const char*, std::size_t)>& data_cb);
+  void deliver(const std::function<void(const char*, std::size_t)>& data_cb);
+  std::uint64_t get_downloaded_bytes() const;
+};
@@ -36,6 +36,7 @@ class AddAppWindow;
 class RemoveAppWindow;
 class CreateShortcutWindow;
 class WineRunnerWindow;
+class JobsWindow;
 struct NewBottleStruct;
 struct UpdateBottleStruct;
 struct CloneBottleStruct;
@@ -59,7 +60,8 @@ public:
                    AddAppWindow& add_app_window,
                    RemoveAppWindow& remove_app_window,
                    CreateShortcutWindow& create_shortcut_window,
-                   WineRunnerWindow& wine_runner_window);
+                   WineRunnerWindow& wine_runner_window,
+                   JobsWindow& jobs_window);
   virtual ~SignalController();
   void dispatch_signals();
 
@@ -70,6 +72,8 @@ public:
   void signal_bottle_created();
   void signal_bottle_updated();
   void signal_bottle_cloned();
+  void signal_bottle_clone_cancelled();
+  void signal_clone_progress();
   void signal_error_message_during_create();
   void signal_error_message_during_update();
   void signal_error_message_during_clone();
@@ -86,6 +90,8 @@ private:
   virtual void on_new_bottle_created();
   virtual void on_bottle_updated();
   virtual void on_bottle_cloned();
+  virtual void on_bottle_clone_cancelled();
+  virtual void on_clone_progress();
   virtual void on_error_message_created();
   virtual void on_error_message_updated();
   virtual void on_error_message_cloned();
@@ -101,11 +107,14 @@ private:
   RemoveAppWindow& remove_app_window_;
   CreateShortcutWindow& create_shortcut_window_;
   WineRunnerWindow& wine_runner_window_;
+  JobsWindow& jobs_window_;
 
   // Dispatchers for handling signals from the thread towards a GUI thread
   Glib::Dispatcher bottle_created_dispatcher_;
   Glib::Dispatcher bottle_updated_dispatcher_;
   Glib::Dispatcher bottle_cloned_dispatcher_;
+  Glib::Dispatcher bottle_clone_cancelled_dispatcher_;
+  Glib::Dispatcher clone_progress_dispatcher_;
   Glib::Dispatcher error_message_created_dispatcher_;
   Glib::Dispatcher error_message_updated_dispatcher_;
   Glib::Dispatcher error_message_cloned_dispatcher_;
@@ -0,0 +1,81 @@
+/**
+ * Copyright (c) 2026 WineGUI
+ *
+ * \file    stream_hasher.h
+ * \brief   SHA-256/512 digest of a data stream, computed on a separate thread
+ * \author  Melroy van den Berg <webmaster1989@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <openssl/evp.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * \class StreamHasher
+ * \brief Computes the SHA-256 or SHA-512 digest of data that is passed in order (eg. a download), while the caller
+ * continues with the same data (eg. extracting it).
+ *
+ * The data is collected in large aligned blocks, which are hashed by a worker thread. So hashing overlaps with the work
+ * of the caller, instead of adding to it. The hashing itself is done by OpenSSL (libcrypto), which picks the fastest
+ * implementation for the CPU at runtime (eg. the SHA extensions of x86 & ARM CPUs).
+ */
+class StreamHasher
+{
+public:
+  /**
+   * \enum Algorithm
+   * \brief Hash algorithm
+   */
+  enum class Algorithm
+  {
+    Sha256, /*!< SHA-256, 64 hex digits */
+    Sha512, /*!< SHA-512, 128 hex digits */
+  };
+
+  explicit StreamHasher(Algorithm algorithm);
+  ~StreamHasher();
+  StreamHasher(const StreamHasher&) = delete;
+  StreamHasher& operator=(const StreamHasher&) = delete;
+
+  void update(const char* data, std::size_t size);
+  std::string finish();
+
+private:
+  /// Block of data, aligned to a memory page
+  using Block = std::unique_ptr<char, void (*)(void*)>;
+
+  EVP_MD_CTX* context_;                                   /*!< Digest state */
+  Block current_block_;                                   /*!< Block that is filled by update() */
+  std::size_t current_size_;                              /*!< Number of bytes in the current block */
+  std::mutex mutex_;                                      /*!< Protects the members below */
+  std::condition_variable cv_;                            /*!< Signals a full block, a free block or the end of the data */
+  std::deque<std::pair<Block, std::size_t>> full_blocks_; /*!< Blocks waiting to be hashed, with their size */
+  std::vector<Block> free_blocks_;                        /*!< Hashed blocks, ready to be filled again */
+  bool is_finished_;                                      /*!< No more data follows */
+  std::string error_message_;                             /*!< Set when hashing failed */
+  std::thread thread_;
+
+  static Block allocate_block();
+  void submit_block();
+  void hash_blocks();
+};
@@ -2,7 +2,7 @@
  * Copyright (c) 2026 WineGUI
  *
  * \file    wine_runner_install_task.h
- * \brief   Asynchronous facade around WineRunnerManager (worker thread + Glib::Dispatcher signals)
+ * \brief   Asynchronous facade around WineRunnerManager (worker threads + Glib::Dispatcher signals)
  * \author  Melroy van den Berg <webmaster1989@gmail.com>
  *
  * This program is free software: you can redistribute it and/or modify
@@ -21,63 +21,116 @@
 #pragma once
 
 #include <atomic>
+#include <chrono>
+#include <cstddef>
 #include <cstdint>
+#include <functional>
 #include <glibmm/dispatcher.h>
 #include <glibmm/ustring.h>
+#include <map>
 #include <memory>
 #include <mutex>
+#include <string>
 #include <thread>
-#include <utility>
 #include <vector>
 
+#include "job_scheduler.h"
 #include "wine_runner_types.h"
 
 /**
  * \class WineRunnerInstallTask
- * \brief Runs the blocking WineRunnerManager operations in a worker thread.
+ * \brief Runs the blocking WineRunnerManager operations in worker threads.
  * All dispatchers fire on the GUI thread (construct this class on the GUI thread!).
- * Only one operation runs at a time (see is_busy()). After a dispatcher fired,
- * read the outcome via the thread-safe getters.
+ * Installs & removals are queued as jobs, up to the given number of jobs run at the same time (the downloads run in
+ * parallel, the extraction is serialized per disk by WineRunnerManager). Only one release list fetch runs at a time
+ * (see is_fetching()). After a dispatcher fired, read the outcome via the thread-safe getters.
  */
 class WineRunnerInstallTask
 {
 public:
+  /**
+   * \enum JobType
+   * \brief Kind of runner operation
+   */
+  enum class JobType
+  {
+    Install, /*!< Download & install a release */
+    Remove,  /*!< Remove an installed runner */
+  };
+
+  /**
+   * \struct Job
+   * \brief State of a queued, running or finished runner operation
+   */
+  struct Job
+  {
+    std::size_t id = 0;                                                    /*!< Unique job ID */
+    JobType type = JobType::Install;                                       /*!< Kind of operation */
+    std::string name;                                                      /*!< Runner directory name (eg. "wine-11.13-staging-amd64") */
+    Glib::ustring display_name;                                            /*!< Runner display name */
+    std::string asset_name;                                                /*!< Archive file name (installs only) */
+    WineRunner::InstallPhase phase = WineRunner::InstallPhase::Idle;       /*!< Current phase (Queued until the job is started) */
+    std::uint64_t bytes_done = 0;                                          /*!< Progress: bytes done */
+    std::uint64_t bytes_total = 0;                                         /*!< Progress: bytes total (0 = unknown) */
+    bool is_finished = false;                                              /*!< True when the job is finished */
+    WineRunner::InstallStatus status = WineRunner::InstallStatus::Success; /*!< Final status (once finished) */
+    Glib::ustring error_message;                                           /*!< Error message (once finished, empty = no error) */
+  };
+
   // Dispatchers (fired on the GUI thread)
   Glib::Dispatcher releases_fetched; /*!< Release list fetch finished successfully -> get_fetched_releases() */
   Glib::Dispatcher fetch_failed;     /*!< Release list fetch failed -> get_error_message() */
-  Glib::Dispatcher progress_changed; /*!< Install progress/phase changed -> get_progress() / get_phase() */
-  Glib::Dispatcher install_finished; /*!< Install finished -> get_install_status() + get_error_message() */
-  Glib::Dispatcher remove_finished;  /*!< Removal finished -> get_error_message() (empty string = success) */
+  Glib::Dispatcher progress_changed; /*!< Job added/started or its progress/phase changed (rate-limited) -> get_jobs() */
+  Glib::Dispatcher job_finished;     /*!< One or more jobs finished -> take_finished_jobs() */
 
-  WineRunnerInstallTask();
+  explicit WineRunnerInstallTask(std::size_t max_running_jobs);
   virtual ~WineRunnerInstallTask();
 
-  bool is_busy() const;
+  bool is_fetching() const;
   void fetch_releases_async(WineRunner::SourceId source_id);
-  void install_async(const WineRunner::Release& release);
-  void remove_async(const WineRunner::InstalledRunner& runner);
-  void cancel();
+  std::size_t install_async(const WineRunner::Release& release);
+  std::size_t remove_async(const WineRunner::InstalledRunner& runner);
+  void cancel(std::size_t job_id);
+  bool has_pending_job(const std::string& name) const;
 
   // Thread-safe result accessors
   std::vector<WineRunner::Release> get_fetched_releases() const;
   WineRunner::SourceId get_fetched_source_id() const;
-  std::pair<std::uint64_t, std::uint64_t> get_progress() const;
-  WineRunner::InstallPhase get_phase() const;
-  WineRunner::InstallStatus get_install_status() const;
   Glib::ustring get_error_message() const;
+  std::vector<Job> get_jobs() const;
+  std::vector<Job> take_finished_jobs();
 
 private:
+  /**
+   * \struct JobState
+   * \brief Job with the state that is shared with its worker thread
+   */
+  struct JobState
+  {
+    Job job;                                                                       /*!< Job details (guarded by jobs_mutex_) */
+    std::size_t scheduler_id = 0;                                                  /*!< Job ID of the scheduler (to cancel a queued job) */
+    std::atomic<bool> cancel_requested{false};                                     /*!< Cancellation flag, polled by the operation */
+    std::atomic<std::uint64_t> bytes_done{0};                                      /*!< Progress: bytes done */
+    std::atomic<std::uint64_t> bytes_total{0};                                     /*!< Progress: bytes total (0 = unknown) */
+    std::atomic<WineRunner::InstallPhase> phase{WineRunner::InstallPhase::Queued}; /*!< Current phase */
+    std::chrono::steady_clock::time_point last_progress_time;                      /*!< Last progress notification (worker thread) */
+  };
+
+  std::size_t submit(std::unique_ptr<JobState> state, const std::function<bool(JobState&)>& operation);
+  void run_job(JobState& state, const std::function<bool(JobState&)>& operation);
+  void finish_job(JobState& state, WineRunner::InstallStatus status, const Glib::ustring& error_message);
+  void notify_progress(JobState& state, bool is_forced);
   void cleanup_thread();
 
-  std::unique_ptr<std::thread> thread_;                                                          /*!< Worker thread for all operations */
-  std::atomic<bool> is_busy_{false};                                                             /*!< True while an operation is running */
-  std::atomic<bool> cancel_requested_{false};                                                    /*!< Cancellation flag, polled by the install */
-  std::atomic<std::uint64_t> bytes_done_{0};                                                     /*!< Download progress: bytes done */
-  std::atomic<std::uint64_t> bytes_total_{0};                                                    /*!< Download progress: bytes total (0 = unknown) */
-  std::atomic<WineRunner::InstallPhase> phase_{WineRunner::InstallPhase::Idle};                  /*!< Current install phase */
-  std::atomic<WineRunner::InstallStatus> status_{WineRunner::InstallStatus::Success};            /*!< Final install status */
+  std::unique_ptr<std::thread> thread_;                                                          /*!< Worker thread for the release list fetch */
+  std::atomic<bool> is_fetching_{false};                                                         /*!< True while a fetch is running */
+  std::atomic<bool> is_progress_pending_{false};                                                 /*!< A progress_changed notification is queued */
   std::atomic<WineRunner::SourceId> fetched_source_id_{WineRunner::SourceId::Kron4ekWineBuilds}; /*!< Source the fetched releases belong to */
   mutable std::mutex data_mutex_;                                                                /*!< Protects releases_ & error_message_ */
   std::vector<WineRunner::Release> releases_;                                                    /*!< Fetched releases (guarded by data_mutex_) */
-  Glib::ustring error_message_; /*!< Error message of the last operation (guarded by data_mutex_) */
+  Glib::ustring error_message_; /*!< Error message of the last fetch (guarded by data_mutex_) */
+  mutable std::mutex jobs_mutex_;                                                                /*!< Protects jobs_ & next_job_id_ */
+  std::map<std::size_t, std::unique_ptr<JobState>> jobs_;                                        /*!< Queued, running & finished jobs, by ID */
+  std::size_t next_job_id_ = 1;                                                                  /*!< ID of the next job */
+  JobScheduler scheduler_; /*!< Runs the jobs (declared last: its workers stop before the job states are destroyed) */
 };
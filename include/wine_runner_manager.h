@@ -23,6 +23,7 @@
 #include <atomic>
 #include <cstdint>
 #include <functional>
+#include <mutex>
 #include <optional>
 #include <string>
 #include <vector>
@@ -42,11 +43,12 @@ public:
   static const std::vector<WineRunner::Source>& get_sources();
   static const WineRunner::Source& get_source(WineRunner::SourceId source_id);
 
-  // -- Release listing (network; cached per session; throws std::runtime_error)
+  // -- Release listing (network, conditional requests; persisted on disk; throws std::runtime_error)
   static std::vector<WineRunner::Release> get_releases(WineRunner::SourceId source_id);
+  static std::optional<std::vector<WineRunner::Release>> get_cached_releases(WineRunner::SourceId source_id);
   static void invalidate_release_cache();
 
-  // -- Install (network + tar subprocess; throws std::runtime_error)
+  // -- Install (network + wget subprocesses or the download cache, in-process extraction; throws std::runtime_error)
   static bool download_and_install(const WineRunner::Release& release,
                                    const std::function<void(std::uint64_t, std::uint64_t)>& progress_cb,
                                    const std::function<void(WineRunner::InstallPhase)>& phase_cb,
@@ -71,19 +73,26 @@ public:
   static std::string derive_display_name(const std::string& runner_dir_name);
   static std::optional<std::string> find_wine_bin_dir(const std::string& runner_dir);
   static std::optional<std::string> parse_checksum_file(const std::string& file_content, const std::string& asset_name);
+  static int parse_server_response(const std::string& server_response, std::string& etag, std::string& last_modified);
 
 private:
   WineRunnerManager() = delete;
 
   static std::string fetch_url(const std::string& url);
-  static bool download_file(const std::string& url,
-                            const std::string& dest_path,
-                            std::uint64_t expected_size,
-                            const std::function<void(std::uint64_t, std::uint64_t)>& progress_cb,
-                            const std::atomic<bool>& cancel);
-  static void extract_archive(const std::string& archive_path, const std::string& staging_dir);
-  static std::string compute_checksum(const std::string& file_path, WineRunner::ChecksumType checksum_type);
-  static void verify_archive_checksum(const WineRunner::Release& release, const std::string& archive_path);
+  static std::optional<std::string> fetch_url_if_modified(const std::string& url, std::string& etag, std::string& last_modified);
+  static std::optional<std::string> download_and_extract(const WineRunner::Release& release,
+                                                         const std::string& archive_path,
+                                                         bool is_cached,
+                                                         const std::string& staging_dir,
+                                                         const std::function<void(std::uint64_t, std::uint64_t)>& progress_cb,
+                                                         const std::function<void(WineRunner::InstallPhase)>& phase_cb,
+                                                         const std::atomic<bool>& cancel);
+  static std::optional<std::string> fetch_expected_digest(const WineRunner::Release& release);
+  static std::string get_staging_prefix();
+  static std::timed_mutex& get_extraction_mutex(const std::string& path);
+  static bool lock_disk(std::unique_lock<std::timed_mutex>& disk_lock,
+                        const std::function<void(WineRunner::InstallPhase)>& phase_cb,
+                        const std::atomic<bool>& cancel);
   static void sweep_leftover_temp_dirs(const std::string& runners_dir);
   static bool is_safe_file_name(const std::string& name);
 };
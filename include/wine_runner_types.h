@@ -99,10 +99,12 @@ namespace WineRunner
    */
   enum class InstallPhase
   {
-    Idle,        /*!< No install running */
-    Downloading, /*!< Downloading the archive */
-    Verifying,   /*!< Verifying the archive checksum */
-    Extracting,  /*!< Extracting the archive */
+    Idle,           /*!< No install running */
+    Queued,         /*!< Waiting until fewer runner operations are running */
+    Downloading,    /*!< Downloading the archive */
+    Verifying,      /*!< Verifying the archive checksum */
+    WaitingForDisk, /*!< Waiting until another install finished extracting to the same disk */
+    Extracting,     /*!< Extracting the archive */
   };
 
   /**
@@ -20,13 +20,14 @@
  */
 #pragma once
 
+#include <cstddef>
 #include <functional>
 #include <gtkmm.h>
+#include <map>
 #include <memory>
 #include <string>
 #include <vector>
 
-#include "busy_dialog.h"
 #include "dialog_window.h"
 #include "wine_runner_install_task.h"
 #include "wine_runner_types.h"
@@ -61,6 +62,11 @@ protected:
   Gtk::ListBox installed_listbox;       /*!< List of installed runners */
   Gtk::Label installed_empty_label;     /*!< Empty state label */
 
+  // Running & queued installs/removals (below the pages)
+  Gtk::Box jobs_vbox;        /*!< Jobs vertical box (hidden without jobs) */
+  Gtk::Label jobs_label;     /*!< Jobs header */
+  Gtk::ListBox jobs_listbox; /*!< One row per job */
+
 private:
   /**
    * \struct SourcePage
@@ -85,15 +91,27 @@ private:
     bool fetch_pending = false;                                               /*!< True when a fetch is queued (another operation was running) */
   };
 
+  /**
+   * \struct JobRow
+   * \brief Widgets of a single install/removal job in the jobs list
+   */
+  struct JobRow
+  {
+    Gtk::ListBoxRow* row = nullptr;           /*!< Row in the jobs list */
+    Gtk::Label* status_label = nullptr;       /*!< Phase & progress text */
+    Gtk::ProgressBar* progress_bar = nullptr; /*!< Progress (pulsing when the progress is unknown) */
+    Gtk::Button* cancel_button = nullptr;     /*!< Cancel the job */
+    bool is_pulsing = false;                  /*!< True when the progress is unknown */
+  };
+
   Gtk::Window& default_parent_;                                              /*!< Main window (default transient parent) */
   std::vector<std::unique_ptr<SourcePage>> source_pages_;                    /*!< The downloadable-variant pages */
-  WineRunnerInstallTask task_;                                               /*!< Async worker for fetch/install/remove operations */
-  BusyDialog busy_dialog_;                                                   /*!< Busy dialog with progress bar during install/removal */
+  WineRunnerInstallTask task_;                                               /*!< Async workers for fetch/install/remove operations */
   DialogWindow error_dialog_;                                                /*!< Error dialog */
   DialogWindow info_dialog_;                                                 /*!< Info dialog */
   std::function<std::vector<std::string>()> bottle_wine_bin_paths_provider_; /*!< Provides the wine bin paths of all bottles (for in-use checks) */
-  WineRunner::InstallPhase last_phase_ = WineRunner::InstallPhase::Idle;     /*!< Last seen install phase (to limit label updates) */
-  Glib::ustring installing_display_name_;                                    /*!< Display name of the runner being installed */
+  std::map<std::size_t, JobRow> job_rows_;                                   /*!< Rows of the queued & running jobs, by job ID */
+  sigc::connection pulse_timer_;                                             /*!< Pulses the progress bars with an unknown progress */
 
   // Signal handlers
   void on_page_changed();
@@ -104,8 +122,9 @@ private:
   void on_releases_fetched();
   void on_fetch_failed();
   void on_progress_changed();
-  void on_install_finished();
-  void on_remove_finished();
+  void on_job_finished();
+  void on_cancel_job_clicked(std::size_t job_id);
+  bool on_pulse_timer();
 
   // Member functions
   void create_layout();
@@ -114,12 +133,14 @@ private:
   void refresh_installed_list();
   void refresh_version_comboboxes();
   void fill_version_combobox(SourcePage& page);
+  void fill_source_pages(WineRunner::SourceId source_id, const std::vector<WineRunner::Release>& releases);
   void start_fetch(SourcePage& page);
   void start_pending_fetch();
   void start_fetch_for_visible_page();
   SourcePage* get_visible_source_page();
   void set_page_fetching_state(SourcePage& page, bool fetching);
   void remove_runner_confirmed(const WineRunner::InstalledRunner& runner);
+  void update_job_row(JobRow& job_row, const WineRunnerInstallTask::Job& job);
   void show_error_message(const Glib::ustring& message);
   void show_info_message(const Glib::ustring& message);
   static Glib::ustring format_release_label(const WineRunner::Release& release);
@@ -0,0 +1,75 @@
+/**
+ * Copyright (c) 2026 WineGUI
+ *
+ * \file    wine_version_cache.h
+ * \brief   Cache of Wine versions, per Wine binary
+ * \author  Melroy van den Berg <webmaster1989@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <functional>
+#include <future>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <sys/stat.h>
+
+/**
+ * \class WineVersionCache
+ * \brief Wine version results, keyed by the resolved Wine binary path, its inode and its modification time.
+ *
+ * Most bottles share the same (system) Wine or the same Wine runner, so every distinct binary only needs to be
+ * probed (wine --version) once. A cached version is only used as long as the binary on disk is unchanged (same
+ * device, inode, modification time & size), eg. a Wine upgrade replaces the binary and triggers a new probe.
+ * Successful results are persisted to disk, failures are never cached. Concurrent requests for the same binary
+ * wait for the single probe that is in-flight, instead of starting their own probe.
+ */
+class WineVersionCache
+{
+public:
+  explicit WineVersionCache(std::string cache_file_path);
+  WineVersionCache(const WineVersionCache&) = delete;
+  WineVersionCache& operator=(const WineVersionCache&) = delete;
+
+  static WineVersionCache& get_instance();
+  static std::string resolve_executable(const std::string& executable);
+
+  std::string get_version(const std::string& executable, const std::function<std::string(const std::string& executable)>& probe);
+
+private:
+  /**
+   * \struct Entry
+   * \brief Single (resolved) Wine binary
+   */
+  struct Entry
+  {
+    dev_t device;                                           /*!< Device of the binary */
+    ino_t inode;                                            /*!< Inode of the binary */
+    struct timespec mtime;                                  /*!< Modification time of the binary */
+    off_t size;                                             /*!< File size of the binary */
+    std::shared_future<std::optional<std::string>> version; /*!< Wine version (std::nullopt when the probe failed) */
+  };
+
+  std::mutex mutex_;
+  std::string cache_file_path_;
+  std::map<std::string, Entry> entries_; /*!< Resolved binary path to entry */
+  bool is_loaded_ = false;
+
+  static bool is_same_binary(const Entry& entry, const struct stat& file_stat);
+  void load();
+  void save();
+};
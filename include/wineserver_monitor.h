@@ -0,0 +1,75 @@
+/**
+ * Copyright (c) 2026 WineGUI
+ *
+ * \file    wineserver_monitor.h
+ * \brief   Waits until the wineserver of a bottle is terminated (pidfd)
+ * \author  Melroy van den Berg <webmaster1989@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <chrono>
+#include <functional>
+#include <list>
+#include <mutex>
+#include <string>
+#include <sys/types.h>
+#include <thread>
+
+/**
+ * \class WineserverMonitor
+ * \brief Waits until the wineserver of a bottle is terminated, without starting any process.
+ *
+ * The wineserver of a bottle is found via the lock it holds on the 'lock' file in its server directory
+ * (/tmp/.wine-<uid>/server-<device>-<inode>/). The process is watched via a pidfd, all waits share a single epoll thread.
+ */
+class WineserverMonitor
+{
+public:
+  WineserverMonitor();
+  ~WineserverMonitor();
+  WineserverMonitor(const WineserverMonitor&) = delete;
+  WineserverMonitor& operator=(const WineserverMonitor&) = delete;
+
+  static WineserverMonitor& get_instance();
+  static std::string get_server_directory(const std::string& prefix_path);
+  static pid_t find_wineserver_pid(const std::string& prefix_path);
+
+  bool wait(const std::string& prefix_path, std::chrono::milliseconds timeout);
+  void wait_async(const std::string& prefix_path, std::chrono::milliseconds timeout, std::function<void(bool is_terminated)> on_finished);
+
+private:
+  /**
+   * \struct Waiter
+   * \brief Pending wait for a wineserver
+   */
+  struct Waiter
+  {
+    int pidfd;                                           /*!< Process file descriptor of the wineserver */
+    std::chrono::steady_clock::time_point deadline;      /*!< Give up after this time */
+    std::function<void(bool is_terminated)> on_finished; /*!< Called (from the monitor thread) when done */
+  };
+
+  std::mutex mutex_;
+  std::list<Waiter> new_waiters_; /*!< Waiters that are not yet added to the event loop */
+  bool is_stopping_;
+  bool is_stopped_; /*!< Event loop is no longer running (stopped or failed) */
+  int epoll_fd_;
+  int wakeup_fd_; /*!< Event file descriptor to wake up the event loop */
+  std::thread thread_;
+
+  void run();
+  void wake_up();
+};
@@ -1,4 +1,4 @@
 #!/usr/bin/env bash
 sudo apt update
 sudo apt upgrade
-sudo apt install build-essential cmake ninja-build g++ libgtkmm-4.0-dev nlohmann-json3-dev pkg-config doxygen graphviz rpm ccache
+sudo apt install build-essential cmake ninja-build g++ libgtkmm-4.0-dev liblzma-dev zlib1g-dev libssl-dev nlohmann-json3-dev pkg-config doxygen graphviz rpm ccache
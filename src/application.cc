@@ -7,6 +7,7 @@
 #include "bottle_edit_window.h"
 #include "bottle_manager.h"
 #include "create_shortcut_window.h"
+#include "jobs_window.h"
 #include "main_window.h"
 #include "preferences_window.h"
 #include "remove_app_window.h"
@@ -37,10 +38,12 @@ Application::Application() : Gtk::Application("org.melroy.winegui", Gio::Applica
     remove_app_window_ = Gtk::make_managed<RemoveAppWindow>(*main_window_);
     create_shortcut_window_ = Gtk::make_managed<CreateShortcutWindow>(*main_window_);
     wine_runner_window_ = Gtk::make_managed<WineRunnerWindow>(*main_window_);
+    jobs_window_ = Gtk::make_managed<JobsWindow>(*main_window_);
     manager_ = std::make_shared<BottleManager>(*main_window_);
     signal_controller_ =
         std::make_shared<SignalController>(main_window_, *manager_, *preferences_window_, *edit_window_, *clone_window_, *configure_env_var_window_,
-                                           *configure_window_, *add_app_window_, *remove_app_window_, *create_shortcut_window_, *wine_runner_window_);
+                                           *configure_window_, *add_app_window_, *remove_app_window_, *create_shortcut_window_, *wine_runner_window_,
+                                           *jobs_window_);
   }
   else
   {
@@ -61,8 +64,10 @@ void Application::on_startup()
   add_action("preferences", sigc::mem_fun(*preferences_window_, &PreferencesWindow::show));
   add_action("wine_runners", sigc::mem_fun(*wine_runner_window_, &WineRunnerWindow::show));
   add_action("quit", sigc::mem_fun(*this, &Application::on_action_quit));
+  add_action("show_jobs", sigc::mem_fun(*jobs_window_, &JobsWindow::show));
   add_action("refresh_view", sigc::bind(sigc::mem_fun(*manager_, &BottleManager::update_config_and_bottles), "", false));
   add_action("remove_bottle", sigc::bind(sigc::mem_fun(*manager_, &BottleManager::delete_bottle), main_window_));
+  add_action("deduplicate_bottles", sigc::bind(sigc::mem_fun(*manager_, &BottleManager::deduplicate_bottles), main_window_));
   add_action("open_c_drive", sigc::mem_fun(*manager_, &BottleManager::open_c_drive));
   add_action("open_log_file", sigc::mem_fun(*manager_, &BottleManager::open_log_file));
   add_action("edit_bottle", sigc::mem_fun(*edit_window_, &BottleEditWindow::show));
@@ -96,6 +101,7 @@ void Application::on_startup()
       item->set_icon(icon); // This is not working ;(
       section->append_item(item);
       section->append_item(Gio::MenuItem::create("Wine Runners...", "app.wine_runners"));
+      section->append_item(Gio::MenuItem::create("Deduplicate Machines...", "app.deduplicate_bottles"));
       file_menu->append_section(section);
     }
     {
@@ -108,6 +114,7 @@ void Application::on_startup()
   {
     auto view_menu = Gio::Menu::create();
     view_menu->append_item(Gio::MenuItem::create("Refresh", "app.refresh_view"));
+    view_menu->append_item(Gio::MenuItem::create("Jobs...", "app.show_jobs"));
     menubar->append_submenu("View", view_menu);
   }
   {
@@ -0,0 +1,622 @@
+/**
+ * Copyright (c) 2026 WineGUI
+ *
+ * \file    archive_extractor.cc
+ * \brief   Extract tar.xz / tar.gz archives in-process, while the archive is streamed
+ * \author  Melroy van den Berg <webmaster1989@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "archive_extractor.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <charconv>
+#include <cstring>
+#include <fcntl.h>
+#include <stdexcept>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+
+// Size of the decompressed data that is processed at once
+static constexpr std::size_t OutputBufferSize = 1024 * 1024;
+// A tar archive consists of 512 byte blocks
+static constexpr std::uint64_t BlockSize = 512;
+// Larger GNU long name & pax header members are refused (a path is at most a few KiB)
+static constexpr std::uint64_t MaxMetadataSize = 1024 * 1024;
+
+/**
+ * \brief Parse a numeric field of a tar header (octal, or base-256 for large values)
+ */
+static std::uint64_t parse_number(const char* field, std::size_t size)
+{
+  // GNU extension: the value is stored base-256 when the high bit of the first byte is set
+  if ((static_cast<unsigned char>(field[0]) & 0x80) != 0)
+  {
+    std::uint64_t value = static_cast<unsigned char>(field[0]) & 0x7f;
+    for (std::size_t i = 1; i < size; ++i)
+    {
+      value = (value << 8) | static_cast<unsigned char>(field[i]);
+    }
+    return value;
+  }
+  std::size_t i = 0;
+  while (i < size && field[i] == ' ')
+    ++i;
+  std::uint64_t value = 0;
+  for (; i < size && field[i] >= '0' && field[i] <= '7'; ++i)
+  {
+    value = (value << 3) | static_cast<std::uint64_t>(field[i] - '0');
+  }
+  return value;
+}
+
+/**
+ * \brief Parse a text field of a tar header (NUL-terminated, unless the field is full)
+ */
+static std::string parse_string(const char* field, std::size_t size)
+{
+  return std::string(field, strnlen(field, size));
+}
+
+/**
+ * \brief Write all data to a file descriptor
+ * \return False when the write failed (errno is set)
+ */
+static bool write_all(int fd, const char* data, std::size_t size)
+{
+  while (size > 0)
+  {
+    ssize_t count = ::write(fd, data, size);
+    if (count < 0)
+    {
+      if (errno == EINTR)
+        continue;
+      return false;
+    }
+    data += count;
+    size -= static_cast<std::size_t>(count);
+  }
+  return true;
+}
+
+/**
+ * \brief Constructor
+ * \param[in] destination_dir Existing directory to extract into
+ * \param[in] compression Compression of the archive
+ * \param[in] thread_count Maximum number of xz decoder threads (0 = get_default_thread_count())
+ * \throws std::runtime_error when the directory can't be opened or the decoder can't be initialized
+ */
+ArchiveExtractor::ArchiveExtractor(const std::string& destination_dir, Compression compression, unsigned int thread_count)
+    : compression_(compression),
+      xz_stream_(),
+      gzip_stream_(),
+      is_decoder_finished_(false),
+      output_buffer_(OutputBufferSize),
+      destination_fd_(-1),
+      parent_dir_fd_(-1),
+      state_(State::Header),
+      header_(),
+      header_size_(0),
+      remaining_(0),
+      pax_size_(0),
+      extracted_bytes_(0),
+      extracted_entries_(0)
+{
+  if (thread_count == 0)
+    thread_count = get_default_thread_count();
+  if (compression_ == Compression::Xz)
+  {
+#if LZMA_VERSION >= 50040002
+    // Decode the blocks in parallel (xz 5.4.0 or newer). An archive with a single block is decoded by one thread.
+    lzma_mt options{};
+    options.flags = LZMA_CONCATENATED;
+    options.threads = thread_count;
+    // Use less threads (instead of failing) when the blocks need more memory
+    options.memlimit_threading = std::max<std::uint64_t>(lzma_physmem() / 4, 64 * 1024 * 1024);
+    options.memlimit_stop = UINT64_MAX;
+    lzma_ret result = lzma_stream_decoder_mt(&xz_stream_, &options);
+#else
+    lzma_ret result = lzma_stream_decoder(&xz_stream_, UINT64_MAX, LZMA_CONCATENATED);
+#endif
+    if (result != LZMA_OK)
+      throw std::runtime_error("Could not initialize the xz decoder.");
+  }
+  else if (compression_ == Compression::Gzip)
+  {
+    // Window size 15, +32 to detect the gzip header
+    if (inflateInit2(&gzip_stream_, 15 + 32) != Z_OK)
+      throw std::runtime_error("Could not initialize the gzip decoder.");
+  }
+
+  destination_fd_ = open(destination_dir.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+  if (destination_fd_ < 0)
+  {
+    if (compression_ == Compression::Xz)
+      lzma_end(&xz_stream_);
+    else if (compression_ == Compression::Gzip)
+      inflateEnd(&gzip_stream_);
+    throw std::runtime_error("Could not open the directory to extract into: " + destination_dir);
+  }
+}
+
+/**
+ * \brief Destructor, an incomplete extraction leaves the already extracted files behind
+ */
+ArchiveExtractor::~ArchiveExtractor()
+{
+  if (member_.fd >= 0)
+    close(member_.fd);
+  close_parent_dir();
+  close(destination_fd_);
+  if (compression_ == Compression::Xz)
+    lzma_end(&xz_stream_);
+  else if (compression_ == Compression::Gzip)
+    inflateEnd(&gzip_stream_);
+}
+
+/**
+ * \brief Get the compression of an archive by its file name
+ * \param[in] archive_name Archive file name
+ * \return Compression
+ */
+ArchiveExtractor::Compression ArchiveExtractor::get_compression(const std::string& archive_name)
+{
+  if (archive_name.ends_with(".tar.xz") || archive_name.ends_with(".txz"))
+    return Compression::Xz;
+  if (archive_name.ends_with(".tar.gz") || archive_name.ends_with(".tgz"))
+    return Compression::Gzip;
+  return Compression::None;
+}
+
+/**
+ * \brief Default number of xz decoder threads
+ * \return Number of CPU threads, at most 8 (the extraction is limited by the disk beyond that)
+ */
+unsigned int ArchiveExtractor::get_default_thread_count()
+{
+  return std::clamp(std::thread::hardware_concurrency(), 1U, 8U);
+}
+
+/**
+ * \brief Extract the next part of the archive
+ * \param[in] data Next (compressed) archive data
+ * \param[in] size Size of the data
+ * \throws std::runtime_error when the archive is corrupted, contains an unsafe path or a file can't be written
+ */
+void ArchiveExtractor::write(const char* data, std::size_t size)
+{
+  if (compression_ == Compression::None)
+    process(data, size);
+  else
+    decompress(data, size, false);
+}
+
+/**
+ * \brief Finish the extraction, after all the archive data is written
+ * \throws std::runtime_error when the archive is incomplete
+ */
+void ArchiveExtractor::finish()
+{
+  if (compression_ != Compression::None)
+    decompress(nullptr, 0, true);
+  if (state_ == State::Data || state_ == State::Padding || header_size_ > 0)
+    throw std::runtime_error("Unexpected end of the archive, the download is incomplete.");
+  close_parent_dir();
+}
+
+/**
+ * \brief Get the size of the extracted files so far
+ * \return Size in bytes
+ */
+std::uint64_t ArchiveExtractor::get_extracted_bytes() const
+{
+  return extracted_bytes_;
+}
+
+/**
+ * \brief Get the number of extracted files, directories & links so far
+ * \return Number of members
+ */
+std::uint64_t ArchiveExtractor::get_extracted_entries() const
+{
+  return extracted_entries_;
+}
+
+/**
+ * \brief Decompress the data and extract the decompressed data
+ * \param[in] data Compressed data
+ * \param[in] size Size of the data
+ * \param[in] is_finishing No more data follows, flush the decoder
+ * \throws std::runtime_error when the data is corrupted or incomplete
+ */
+void ArchiveExtractor::decompress(const char* data, std::size_t size, bool is_finishing)
+{
+  if (compression_ == Compression::Xz)
+  {
+    xz_stream_.next_in = reinterpret_cast<const std::uint8_t*>(data);
+    xz_stream_.avail_in = size;
+    while (!is_decoder_finished_ && (xz_stream_.avail_in > 0 || is_finishing))
+    {
+      xz_stream_.next_out = reinterpret_cast<std::uint8_t*>(output_buffer_.data());
+      xz_stream_.avail_out = output_buffer_.size();
+      lzma_ret result = lzma_code(&xz_stream_, is_finishing ? LZMA_FINISH : LZMA_RUN);
+      process(output_buffer_.data(), output_buffer_.size() - xz_stream_.avail_out);
+      if (result == LZMA_STREAM_END)
+        is_decoder_finished_ = true;
+      else if (result == LZMA_BUF_ERROR && is_finishing)
+        throw std::runtime_error("Unexpected end of the archive, the download is incomplete.");
+      else if (result != LZMA_OK && result != LZMA_BUF_ERROR)
+        throw std::runtime_error("Could not decompress the archive, the xz data is corrupted (error " + std::to_string(result) + ").");
+    }
+  }
+  else
+  {
+    // A new gzip member can follow the end of the previous one (eg. archives created by pigz)
+    if (size > 0)
+      is_decoder_finished_ = false;
+    gzip_stream_.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data));
+    gzip_stream_.avail_in = static_cast<uInt>(size);
+    while (!is_decoder_finished_ && (gzip_stream_.avail_in > 0 || is_finishing))
+    {
+      gzip_stream_.next_out = reinterpret_cast<Bytef*>(output_buffer_.data());
+      gzip_stream_.avail_out = static_cast<uInt>(output_buffer_.size());
+      int result = inflate(&gzip_stream_, Z_NO_FLUSH);
+      process(output_buffer_.data(), output_buffer_.size() - gzip_stream_.avail_out);
+      if (result == Z_STREAM_END)
+      {
+        inflateReset(&gzip_stream_);
+        is_decoder_finished_ = (gzip_stream_.avail_in == 0);
+      }
+      else if (result == Z_BUF_ERROR && is_finishing)
+        throw std::runtime_error("Unexpected end of the archive, the download is incomplete.");
+      else if (result != Z_OK && result != Z_BUF_ERROR)
+        throw std::runtime_error("Could not decompress the archive, the gzip data is corrupted.");
+    }
+  }
+}
+
+/**
+ * \brief Extract the decompressed tar data
+ * \param[in] data tar data
+ * \param[in] size Size of the data
+ */
+void ArchiveExtractor::process(const char* data, std::size_t size)
+{
+  while (size > 0)
+  {
+    std::size_t count = 0;
+    switch (state_)
+    {
+    case State::Header:
+      count = std::min(size, header_.size() - header_size_);
+      std::memcpy(header_.data() + header_size_, data, count);
+      header_size_ += count;
+      if (header_size_ == header_.size())
+      {
+        header_size_ = 0;
+        process_header();
+      }
+      break;
+    case State::Data:
+      count = static_cast<std::size_t>(std::min<std::uint64_t>(size, remaining_));
+      process_data(data, count);
+      remaining_ -= count;
+      if (remaining_ == 0)
+        finish_member();
+      break;
+    case State::Padding:
+      count = static_cast<std::size_t>(std::min<std::uint64_t>(size, remaining_));
+      remaining_ -= count;
+      if (remaining_ == 0)
+        state_ = State::Header;
+      break;
+    case State::End:
+      return; // Ignore the remaining zero blocks
+    }
+    data += count;
+    size -= count;
+  }
+}
+
+/**
+ * \brief Start the member of the collected header block
+ * \throws std::runtime_error when the header is corrupted
+ */
+void ArchiveExtractor::process_header()
+{
+  if (std::all_of(header_.begin(), header_.end(), [](char byte) { return byte == 0; }))
+  {
+    state_ = State::End;
+    return;
+  }
+  // The checksum field itself counts as spaces
+  std::uint64_t checksum = 0;
+  for (std::size_t i = 0; i < header_.size(); ++i)
+  {
+    checksum += (i >= 148 && i < 156) ? ' ' : static_cast<unsigned char>(header_[i]);
+  }
+  if (checksum != parse_number(&header_[148], 8))
+    throw std::runtime_error("Could not extract the archive, the tar data is corrupted.");
+
+  member_ = Member();
+  member_.type = header_[156];
+  member_.mode = static_cast<unsigned int>(parse_number(&header_[100], 8)) & 07777;
+  member_.mtime.tv_sec = static_cast<std::time_t>(parse_number(&header_[136], 12));
+  member_.size = parse_number(&header_[124], 12);
+  std::string path = parse_string(&header_[0], 100);
+  // POSIX ustar format: long paths are split into a prefix & name (the GNU format uses this field for other data)
+  if (std::memcmp(&header_[257], "ustar\0", 6) == 0 && header_[345] != '\0')
+    path = parse_string(&header_[345], 155) + "/" + path;
+
+  if (member_.type == 'L' || member_.type == 'K' || member_.type == 'x')
+  {
+    if (member_.size > MaxMetadataSize)
+      throw std::runtime_error("Could not extract the archive, the tar data is corrupted.");
+  }
+  else if (member_.type != 'g') // Global pax headers are ignored
+  {
+    member_.path = long_path_.empty() ? path : long_path_;
+    member_.link_path = long_link_path_.empty() ? parse_string(&header_[157], 100) : long_link_path_;
+    if (pax_size_ > 0)
+      member_.size = pax_size_;
+    long_path_.clear();
+    long_link_path_.clear();
+    pax_size_ = 0;
+    create_member();
+  }
+
+  remaining_ = member_.size;
+  if (remaining_ > 0)
+    state_ = State::Data;
+  else
+    finish_member();
+}
+
+/**
+ * \brief Process the data of the current member
+ * \param[in] data Member data
+ * \param[in] size Size of the data
+ * \throws std::runtime_error when the file can't be written
+ */
+void ArchiveExtractor::process_data(const char* data, std::size_t size)
+{
+  if (member_.fd >= 0)
+  {
+    if (!write_all(member_.fd, data, size))
+      throw std::runtime_error("Could not write '" + member_.path + "': " + std::strerror(errno));
+    extracted_bytes_ += size;
+  }
+  else if (member_.type == 'L' || member_.type == 'K' || member_.type == 'x')
+  {
+    member_.metadata.append(data, size);
+  }
+}
+
+/**
+ * \brief Finish the current member, after all its data is processed
+ */
+void ArchiveExtractor::finish_member()
+{
+  if (member_.type == 'L')
+    long_path_ = member_.metadata.substr(0, member_.metadata.find('\0'));
+  else if (member_.type == 'K')
+    long_link_path_ = member_.metadata.substr(0, member_.metadata.find('\0'));
+  else if (member_.type == 'x')
+    parse_pax_header(member_.metadata);
+
+  if (member_.fd >= 0)
+  {
+    const struct timespec times[2] = {{0, UTIME_OMIT}, member_.mtime};
+    futimens(member_.fd, times);
+    close(member_.fd);
+    member_.fd = -1;
+  }
+  remaining_ = (BlockSize - member_.size % BlockSize) % BlockSize;
+  state_ = (remaining_ > 0) ? State::Padding : State::Header;
+}
+
+/**
+ * \brief Parse the records of a pax extended header ("<length> <key>=<value>\n"), which apply to the next member
+ * \param[in] records pax header data
+ * \throws std::runtime_error when the records are corrupted
+ */
+void ArchiveExtractor::parse_pax_header(const std::string& records)
+{
+  std::size_t position = 0;
+  while (position < records.size())
+  {
+    std::size_t length = 0;
+    const char* begin = records.data() + position;
+    const char* end = records.data() + records.size();
+    auto [separator, error] = std::from_chars(begin, end, length);
+    if (error != std::errc() || separator == end || *separator != ' ' || length == 0 || length > records.size() - position)
+      throw std::runtime_error("Could not extract the archive, the tar data is corrupted.");
+    // Record without the length & trailing newline
+    std::string record(separator + 1, begin + length - 1);
+    position += length;
+    std::size_t equal_sign = record.find('=');
+    if (equal_sign == std::string::npos)
+      continue;
+    std::string key = record.substr(0, equal_sign);
+    std::string value = record.substr(equal_sign + 1);
+    if (key == "path")
+      long_path_ = value;
+    else if (key == "linkpath")
+      long_link_path_ = value;
+    else if (key == "size")
+      std::from_chars(value.data(), value.data() + value.size(), pax_size_);
+  }
+}
+
+/**
+ * \brief Create the current member on disk (the data of a regular file follows)
+ * \throws std::runtime_error when the path is unsafe or the member can't be created
+ */
+void ArchiveExtractor::create_member()
+{
+  std::string path = sanitize_path(member_.path);
+  if (path.empty())
+    return; // The destination directory itself (eg. "./")
+  std::string name;
+  int dir_fd = open_parent_dir(path, name);
+  int result = 0;
+  switch (member_.type)
+  {
+  case '0':
+  case '\0':
+  case '7':
+  {
+    // An existing file is replaced instead of overwritten (like tar does), it could be a (hard or symbolic) link
+    int flags = O_WRONLY | O_CREAT | O_EXCL | O_NOFOLLOW | O_CLOEXEC;
+    member_.fd = openat(dir_fd, name.c_str(), flags, member_.mode & 0777);
+    if (member_.fd < 0 && errno == EEXIST && unlinkat(dir_fd, name.c_str(), 0) == 0)
+      member_.fd = openat(dir_fd, name.c_str(), flags, member_.mode & 0777);
+    result = member_.fd;
+    break;
+  }
+  case '5':
+  {
+    // Keep the directory writable, otherwise its files can't be extracted
+    result = mkdirat(dir_fd, name.c_str(), (member_.mode | 0700) & 0777);
+    struct stat status;
+    if (result != 0 && errno == EEXIST && fstatat(dir_fd, name.c_str(), &status, AT_SYMLINK_NOFOLLOW) == 0 && S_ISDIR(status.st_mode))
+      result = 0;
+    break;
+  }
+  case '2':
+    // The target is not checked: the symbolic links of the archive are never followed during the extraction
+    result = symlinkat(member_.link_path.c_str(), dir_fd, name.c_str());
+    if (result != 0 && errno == EEXIST && unlinkat(dir_fd, name.c_str(), 0) == 0)
+      result = symlinkat(member_.link_path.c_str(), dir_fd, name.c_str());
+    break;
+  case '1':
+  {
+    std::string target_path = sanitize_path(member_.link_path);
+    std::size_t slash = target_path.rfind('/');
+    std::string target_dir = (slash == std::string::npos) ? "" : target_path.substr(0, slash);
+    std::string target_name = target_path.substr(slash + 1);
+    int target_dir_fd = open_dir(target_dir, false);
+    result = linkat(target_dir_fd, target_name.c_str(), dir_fd, name.c_str(), 0);
+    if (result != 0 && errno == EEXIST && unlinkat(dir_fd, name.c_str(), 0) == 0)
+      result = linkat(target_dir_fd, target_name.c_str(), dir_fd, name.c_str(), 0);
+    int link_error = errno;
+    close(target_dir_fd);
+    errno = link_error;
+    break;
+  }
+  default:
+    // Devices & FIFOs are not needed for a Wine runner (tar can't create devices as a normal user either)
+    return;
+  }
+  if (result < 0)
+    throw std::runtime_error("Could not extract '" + member_.path + "': " + std::strerror(errno));
+  ++extracted_entries_;
+}
+
+/**
+ * \brief Open the parent directory of a member, the missing directories are created.
+ * The directory of the previous member is reused, since the members of a directory are mostly stored together.
+ * \param[in] path Sanitized path of the member
+ * \param[out] name File name of the member within the parent directory
+ * \throws std::runtime_error when a parent is not a directory (eg. a symbolic link)
+ * \return Parent directory (owned by the extractor)
+ */
+int ArchiveExtractor::open_parent_dir(const std::string& path, std::string& name)
+{
+  std::size_t slash = path.rfind('/');
+  std::string dir_path = (slash == std::string::npos) ? "" : path.substr(0, slash);
+  name = path.substr(slash + 1);
+  if (parent_dir_fd_ < 0 || dir_path != parent_dir_path_)
+  {
+    close_parent_dir();
+    parent_dir_fd_ = open_dir(dir_path, true);
+    parent_dir_path_ = dir_path;
+  }
+  return parent_dir_fd_;
+}
+
+/**
+ * \brief Open a directory within the destination directory, without following symbolic links
+ * \param[in] dir_path Sanitized directory path (empty for the destination directory)
+ * \param[in] is_create Create the missing directories
+ * \throws std::runtime_error when a directory is missing or not a directory (eg. a symbolic link)
+ * \return Directory, which needs to be closed by the caller
+ */
+int ArchiveExtractor::open_dir(const std::string& dir_path, bool is_create) const
+{
+  int dir_fd = openat(destination_fd_, ".", O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+  std::size_t start = 0;
+  while (dir_fd >= 0 && start < dir_path.size())
+  {
+    std::size_t end = dir_path.find('/', start);
+    if (end == std::string::npos)
+      end = dir_path.size();
+    std::string component = dir_path.substr(start, end - start);
+    start = end + 1;
+    if (is_create)
+      mkdirat(dir_fd, component.c_str(), 0755);
+    // O_NOFOLLOW: a symbolic link of the archive could point outside the destination directory
+    int child_fd = openat(dir_fd, component.c_str(), O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+    int open_error = errno;
+    close(dir_fd);
+    errno = open_error;
+    dir_fd = child_fd;
+  }
+  if (dir_fd < 0)
+    throw std::runtime_error("Could not extract into '" + dir_path + "': " + std::strerror(errno));
+  return dir_fd;
+}
+
+/**
+ * \brief Close the cached parent directory
+ */
+void ArchiveExtractor::close_parent_dir()
+{
+  if (parent_dir_fd_ >= 0)
+    close(parent_dir_fd_);
+  parent_dir_fd_ = -1;
+  parent_dir_path_.clear();
+}
+
+/**
+ * \brief Normalize the path of a member, and refuse paths outside the destination directory (like GNU tar)
+ * \param[in] path Path within the archive
+ * \throws std::runtime_error when the path is absolute or contains ".."
+ * \return Path without "." and empty components (empty for the destination directory itself)
+ */
+std::string ArchiveExtractor::sanitize_path(const std::string& path)
+{
+  if (path.starts_with('/'))
+    throw std::runtime_error("Refusing to extract '" + path + "': absolute path in the archive.");
+  std::string result;
+  std::size_t start = 0;
+  while (start <= path.size())
+  {
+    std::size_t end = path.find('/', start);
+    if (end == std::string::npos)
+      end = path.size();
+    std::string component = path.substr(start, end - start);
+    start = end + 1;
+    if (component.empty() || component == ".")
+      continue;
+    if (component == "..")
+      throw std::runtime_error("Refusing to extract '" + path + "': path outside of the destination directory.");
+    if (!result.empty())
+      result += '/';
+    result += component;
+  }
+  return result;
+}
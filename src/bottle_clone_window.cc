@@ -103,6 +103,7 @@ BottleCloneWindow::BottleCloneWindow(Gtk::Window& parent)
   // Signals
   cancel_button.signal_clicked().connect(sigc::mem_fun(*this, &BottleCloneWindow::on_cancel_button_clicked));
   clone_button.signal_clicked().connect(sigc::mem_fun(*this, &BottleCloneWindow::on_clone_button_clicked));
+  busy_dialog.cancel_requested.connect([this]() { cancel_clone.emit(); });
   // Hide window instead of destroy
   signal_close_request().connect(
       [this]() -> bool
@@ -170,11 +171,36 @@ void BottleCloneWindow::reset_active_bottle()
  */
 Glib::ustring BottleCloneWindow::on_bottle_cloned()
 {
+  busy_dialog.set_cancelable(false);
   busy_dialog.hide();
   set_visible(false); // Hide the clone Window
   return name_entry.get_text();
 }
 
+/**
+ * \brief Handler when the clone is cancelled by the user (the partial clone is already removed)
+ */
+void BottleCloneWindow::on_bottle_clone_cancelled()
+{
+  busy_dialog.set_cancelable(false);
+  busy_dialog.hide();
+  set_visible(false); // Hide the clone Window
+}
+
+/**
+ * \brief Handler when the clone progress changed, shows the progress in the busy dialog
+ * \param[in] bytes_done Bytes cloned so far
+ * \param[in] bytes_total Total bytes to clone
+ */
+void BottleCloneWindow::on_clone_progress(std::uint64_t bytes_done, std::uint64_t bytes_total)
+{
+  if (bytes_total > 0)
+  {
+    double fraction = static_cast<double>(bytes_done) / static_cast<double>(bytes_total);
+    busy_dialog.set_progress(fraction, Glib::format_size(bytes_done) + " of " + Glib::format_size(bytes_total));
+  }
+}
+
 /**
  * \brief Triggered when cancel button is clicked
  */
@@ -196,6 +222,7 @@ void BottleCloneWindow::on_clone_button_clicked()
   // Show busy dialog
   busy_dialog.set_message("Clone Windows Machine",
                           "Currently cloning the Windows Machine.\nThis can take a while, depending on the size of the machine.");
+  busy_dialog.set_cancelable(true);
   busy_dialog.present();
 
   // Set the new bottle configuration data for the clone
@@ -0,0 +1,485 @@
+/**
+ * Copyright (c) 2026 WineGUI
+ *
+ * \file    bottle_cloner.cc
+ * \brief   Copy-on-write aware cloning of Wine bottle folders
+ * \author  Melroy van den Berg <webmaster1989@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "bottle_cloner.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <fcntl.h>
+#include <filesystem>
+#include <iostream>
+#include <linux/fs.h>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <sys/ioctl.h>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+#include <utility>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+// Maximum bytes copied at once, so progress is reported and cancellation is checked during large files
+static constexpr std::size_t CopyChunkSize = 16 * 1024 * 1024;
+static constexpr std::size_t ReadWriteBufferSize = 1024 * 1024;
+
+/**
+ * \brief File descriptor that is closed when going out of scope
+ */
+struct ScopedFd
+{
+  int fd;
+  explicit ScopedFd(int file_descriptor) : fd(file_descriptor)
+  {
+  }
+  ~ScopedFd()
+  {
+    if (fd >= 0)
+      close(fd);
+  }
+  ScopedFd(const ScopedFd&) = delete;
+  ScopedFd& operator=(const ScopedFd&) = delete;
+};
+
+/**
+ * \brief Create an error (including errno) for a failed file operation
+ * \param[in] action What failed
+ * \param[in] path File path
+ * \return Runtime error
+ */
+static std::runtime_error file_error(const std::string& action, const std::string& path)
+{
+  return std::runtime_error(action + ": " + path + " (" + std::strerror(errno) + ")");
+}
+
+/**
+ * \brief Copies the files of a clone with multiple threads, while the folder walk still adds files.
+ * Every thread has its own queue; an idle thread steals the oldest files from the other queues (work-stealing).
+ */
+class CopyWorkers
+{
+public:
+  CopyWorkers(unsigned int thread_count,
+              std::uint64_t bytes_total,
+              const std::function<void(std::uint64_t, std::uint64_t)>& progress_cb,
+              const std::atomic<bool>& cancel);
+  ~CopyWorkers();
+  CopyWorkers(const CopyWorkers&) = delete;
+  CopyWorkers& operator=(const CopyWorkers&) = delete;
+
+  void add(fs::path source_path, fs::path destination_path);
+  void finish();
+  bool is_failed() const;
+
+private:
+  /**
+   * \struct FileCopy
+   * \brief Single file to copy
+   */
+  struct FileCopy
+  {
+    fs::path source_path;
+    fs::path destination_path;
+  };
+
+  /**
+   * \struct WorkQueue
+   * \brief Files waiting to be copied, by one thread (or stolen by another thread)
+   */
+  struct WorkQueue
+  {
+    std::mutex mutex;
+    std::deque<FileCopy> files;
+  };
+
+  std::vector<std::unique_ptr<WorkQueue>> queues_;
+  std::vector<std::thread> threads_;
+  std::size_t next_queue_ = 0; /*!< Queue that gets the next file (round-robin) */
+  std::mutex wait_mutex_;
+  std::condition_variable wait_condition_;
+  std::atomic<std::size_t> pending_files_{0}; /*!< Files in the queues */
+  bool is_walk_finished_ = false;             /*!< No files are added anymore (guarded by wait_mutex_) */
+  std::atomic<bool> is_failed_{false};        /*!< A copy failed, all threads stop */
+  std::exception_ptr error_;                  /*!< First copy error (guarded by wait_mutex_) */
+  const std::atomic<bool>& cancel_;
+  std::mutex progress_mutex_;
+  std::uint64_t bytes_done_ = 0; /*!< Guarded by progress_mutex_ */
+  std::uint64_t bytes_total_;
+  const std::function<void(std::uint64_t, std::uint64_t)>& progress_cb_;
+
+  void run(std::size_t index);
+  bool take(std::size_t index, FileCopy& file);
+  bool is_stopped() const;
+};
+
+/**
+ * \brief Start the copy threads
+ * \param[in] thread_count Number of copy threads
+ * \param[in] bytes_total Total bytes to copy (for the progress)
+ * \param[in] progress_cb Called with the bytes done & the bytes total, by one thread at a time (may be empty)
+ * \param[in] cancel Cancellation flag
+ */
+CopyWorkers::CopyWorkers(unsigned int thread_count,
+                         std::uint64_t bytes_total,
+                         const std::function<void(std::uint64_t, std::uint64_t)>& progress_cb,
+                         const std::atomic<bool>& cancel)
+    : cancel_(cancel), bytes_total_(bytes_total), progress_cb_(progress_cb)
+{
+  thread_count = std::max(thread_count, 1U);
+  for (unsigned int i = 0; i < thread_count; ++i)
+    queues_.push_back(std::make_unique<WorkQueue>());
+  for (std::size_t i = 0; i < thread_count; ++i)
+    threads_.emplace_back(&CopyWorkers::run, this, i);
+}
+
+/**
+ * \brief Stop & join the copy threads, the files that are not copied yet are skipped
+ */
+CopyWorkers::~CopyWorkers()
+{
+  if (!threads_.empty())
+  {
+    is_failed_.store(true);
+    try
+    {
+      finish();
+    }
+    catch (const std::exception&)
+    {
+      // Already reported by the first finish() call, or the clone is aborted anyway
+    }
+  }
+}
+
+/**
+ * \brief Add a file to copy
+ * \param[in] source_path Source file
+ * \param[in] destination_path Destination file
+ */
+void CopyWorkers::add(fs::path source_path, fs::path destination_path)
+{
+  WorkQueue& queue = *queues_[next_queue_];
+  next_queue_ = (next_queue_ + 1) % queues_.size();
+  {
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    queue.files.push_back({std::move(source_path), std::move(destination_path)});
+  }
+  {
+    std::lock_guard<std::mutex> lock(wait_mutex_);
+    pending_files_.fetch_add(1);
+  }
+  wait_condition_.notify_one();
+}
+
+/**
+ * \brief No more files are added, wait until all files are copied
+ * \throws runtime_error when a file could not be copied
+ */
+void CopyWorkers::finish()
+{
+  {
+    std::lock_guard<std::mutex> lock(wait_mutex_);
+    is_walk_finished_ = true;
+  }
+  wait_condition_.notify_all();
+  for (std::thread& thread : threads_)
+    thread.join();
+  threads_.clear();
+  if (error_)
+    std::rethrow_exception(error_);
+}
+
+/**
+ * \brief Check if a copy failed (stop adding files)
+ * \return true if a copy failed, otherwise false
+ */
+bool CopyWorkers::is_failed() const
+{
+  return is_failed_.load();
+}
+
+/**
+ * \brief Copy thread, copies files until the walk is finished and all queues are empty
+ * \param[in] index Index of the own queue
+ */
+void CopyWorkers::run(std::size_t index)
+{
+  FileCopy file;
+  while (!is_stopped())
+  {
+    if (take(index, file))
+    {
+      try
+      {
+        BottleCloner::copy_file(file.source_path.string(), file.destination_path.string(),
+                                [this](std::uint64_t bytes_copied)
+                                {
+                                  std::lock_guard<std::mutex> lock(progress_mutex_);
+                                  bytes_done_ += bytes_copied;
+                                  if (progress_cb_)
+                                    progress_cb_(bytes_done_, bytes_total_);
+                                },
+                                cancel_);
+      }
+      catch (const std::exception&)
+      {
+        {
+          std::lock_guard<std::mutex> lock(wait_mutex_);
+          if (!error_)
+            error_ = std::current_exception();
+          is_failed_.store(true);
+        }
+        wait_condition_.notify_all();
+      }
+      continue;
+    }
+    std::unique_lock<std::mutex> lock(wait_mutex_);
+    wait_condition_.wait(lock, [this] { return pending_files_.load() > 0 || is_walk_finished_ || is_stopped(); });
+    if (pending_files_.load() == 0 && is_walk_finished_)
+      return;
+  }
+}
+
+/**
+ * \brief Take the newest file from the own queue, or steal the oldest file from another queue
+ * \param[in] index Index of the own queue
+ * \param[out] file File to copy
+ * \return true if a file is taken, false if all queues are empty
+ */
+bool CopyWorkers::take(std::size_t index, FileCopy& file)
+{
+  for (std::size_t i = 0; i < queues_.size(); ++i)
+  {
+    WorkQueue& queue = *queues_[(index + i) % queues_.size()];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.files.empty())
+      continue;
+    if (i == 0)
+    {
+      file = std::move(queue.files.back());
+      queue.files.pop_back();
+    }
+    else
+    {
+      file = std::move(queue.files.front());
+      queue.files.pop_front();
+    }
+    pending_files_.fetch_sub(1);
+    return true;
+  }
+  return false;
+}
+
+/**
+ * \brief Check if the copy threads should stop
+ * \return true when cancelled or a copy failed
+ */
+bool CopyWorkers::is_stopped() const
+{
+  return cancel_.load() || is_failed_.load();
+}
+
+/**
+ * \brief Get the default number of copy threads, multiple copies in flight keep fast disks (NVMe) busy
+ * \return Number of threads
+ */
+unsigned int BottleCloner::get_default_thread_count()
+{
+  return std::clamp(std::thread::hardware_concurrency(), 4U, 16U);
+}
+
+/**
+ * \brief Clone a folder tree, the destination may not exist yet.
+ * The calling thread walks the source & creates the folders and symbolic links, the files are copied by the copy threads.
+ * \param[in] source_path Source folder
+ * \param[in] destination_path Destination folder, will be created
+ * \param[in] progress_cb Called with the bytes done & the bytes total, by one copy thread at a time (may be empty)
+ * \param[in] cancel Cancellation flag, polled between (and during) files
+ * \param[in] thread_count Number of copy threads (0 = get_default_thread_count())
+ * \throws runtime_error when the folder could not be cloned, the (partial) destination is removed
+ * \return true when cloned, false when cancelled (the partial destination is removed)
+ */
+bool BottleCloner::clone(const std::string& source_path,
+                         const std::string& destination_path,
+                         const std::function<void(std::uint64_t, std::uint64_t)>& progress_cb,
+                         const std::atomic<bool>& cancel,
+                         unsigned int thread_count)
+{
+  std::error_code error_code;
+  if (!fs::is_directory(fs::symlink_status(source_path, error_code)))
+    throw std::runtime_error("Source is not a directory: " + source_path);
+  if (fs::exists(fs::symlink_status(destination_path, error_code)))
+    throw std::runtime_error("Destination already exists: " + destination_path);
+
+  // First determine the total size, for the progress
+  std::uint64_t bytes_total = 0;
+  for (auto it = fs::recursive_directory_iterator(source_path, error_code); !error_code && it != fs::recursive_directory_iterator();
+       it.increment(error_code))
+  {
+    if (it->is_regular_file(error_code) && !it->is_symlink(error_code))
+      bytes_total += it->file_size(error_code);
+  }
+  if (error_code)
+    throw std::runtime_error("Could not read the source directory: " + source_path + " (" + error_code.message() + ")");
+
+  // Directories are created writable, the original permissions are set afterwards (deepest first)
+  std::vector<std::pair<fs::path, fs::perms>> directory_permissions;
+  try
+  {
+    fs::create_directory(destination_path);
+    directory_permissions.emplace_back(destination_path, fs::status(source_path).permissions());
+    fs::permissions(destination_path, fs::perms::owner_all, fs::perm_options::add);
+    CopyWorkers workers(thread_count > 0 ? thread_count : get_default_thread_count(), bytes_total, progress_cb, cancel);
+    for (auto it = fs::recursive_directory_iterator(source_path); it != fs::recursive_directory_iterator(); ++it)
+    {
+      if (cancel.load() || workers.is_failed())
+        break;
+      fs::path target = fs::path(destination_path) / it->path().lexically_relative(source_path);
+      fs::file_status status = it->symlink_status();
+      switch (status.type())
+      {
+      case fs::file_type::directory:
+        fs::create_directory(target);
+        directory_permissions.emplace_back(target, status.permissions());
+        fs::permissions(target, fs::perms::owner_all, fs::perm_options::add);
+        break;
+      case fs::file_type::symlink:
+        fs::copy_symlink(it->path(), target);
+        break;
+      case fs::file_type::regular:
+        workers.add(it->path(), std::move(target));
+        break;
+      default:
+        // Sockets, pipes & devices do not belong in a bottle
+        std::cout << "INFO: Skip special file during clone: " << it->path().string() << std::endl;
+        break;
+      }
+    }
+    workers.finish();
+    if (!cancel.load())
+    {
+      for (auto it = directory_permissions.rbegin(); it != directory_permissions.rend(); ++it)
+        fs::permissions(it->first, it->second);
+    }
+  }
+  catch (const std::exception& error)
+  {
+    fs::remove_all(destination_path, error_code);
+    std::cerr << "Error: Couldn't clone " << source_path << " to " << destination_path << ": " << error.what() << std::endl;
+    throw std::runtime_error(error.what());
+  }
+
+  if (cancel.load())
+  {
+    fs::remove_all(destination_path, error_code);
+    return false;
+  }
+  return true;
+}
+
+/**
+ * \brief Copy a single regular file (including its permissions), the data is reflinked when possible.
+ * When cancelled during the copy, the destination file is left incomplete.
+ * \param[in] source_path Source file
+ * \param[in] destination_path Destination file, may not exist yet
+ * \param[in] copied_cb Called with the number of bytes copied since the previous call (may be empty)
+ * \param[in] cancel Cancellation flag, polled between chunks
+ * \throws runtime_error when the file could not be copied
+ * \return The way the data is copied
+ */
+BottleCloner::CopyMethod BottleCloner::copy_file(const std::string& source_path,
+                                                 const std::string& destination_path,
+                                                 const std::function<void(std::uint64_t)>& copied_cb,
+                                                 const std::atomic<bool>& cancel)
+{
+  ScopedFd source(open(source_path.c_str(), O_RDONLY | O_CLOEXEC));
+  if (source.fd < 0)
+    throw file_error("Could not open file", source_path);
+  struct stat source_stat;
+  if (fstat(source.fd, &source_stat) != 0)
+    throw file_error("Could not read file", source_path);
+  ScopedFd destination(open(destination_path.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, source_stat.st_mode & 07777));
+  if (destination.fd < 0)
+    throw file_error("Could not create file", destination_path);
+  std::uint64_t size = static_cast<std::uint64_t>(source_stat.st_size);
+  auto report = [&copied_cb](std::uint64_t bytes_copied)
+  {
+    if (copied_cb && bytes_copied > 0)
+      copied_cb(bytes_copied);
+  };
+
+  // Share the data extents (copy-on-write), supported by btrfs, XFS & bcachefs within the same file system
+  if (ioctl(destination.fd, FICLONE, source.fd) == 0)
+  {
+    report(size);
+    return CopyMethod::Reflink;
+  }
+
+  // Copy in the kernel (which reflinks as well on some file systems, or does a server-side copy on NFS)
+  CopyMethod method = CopyMethod::CopyFileRange;
+  std::uint64_t bytes_copied = 0;
+  while (bytes_copied < size && !cancel.load())
+  {
+    ssize_t result = copy_file_range(source.fd, nullptr, destination.fd, nullptr, CopyChunkSize, 0);
+    if (result < 0 && bytes_copied == 0 && (errno == EXDEV || errno == ENOSYS || errno == EOPNOTSUPP || errno == EINVAL))
+    {
+      method = CopyMethod::ReadWrite;
+      break;
+    }
+    if (result < 0)
+      throw file_error("Could not copy file", source_path);
+    if (result == 0)
+      break; // File became smaller during the copy
+    bytes_copied += static_cast<std::uint64_t>(result);
+    report(static_cast<std::uint64_t>(result));
+  }
+
+  if (method == CopyMethod::ReadWrite)
+  {
+    std::vector<char> buffer(ReadWriteBufferSize);
+    while (!cancel.load())
+    {
+      ssize_t bytes_read = read(source.fd, buffer.data(), buffer.size());
+      if (bytes_read < 0 && errno == EINTR)
+        continue;
+      if (bytes_read < 0)
+        throw file_error("Could not read file", source_path);
+      if (bytes_read == 0)
+        break;
+      for (ssize_t offset = 0; offset < bytes_read;)
+      {
+        ssize_t bytes_written = write(destination.fd, buffer.data() + offset, static_cast<std::size_t>(bytes_read - offset));
+        if (bytes_written < 0 && errno == EINTR)
+          continue;
+        if (bytes_written < 0)
+          throw file_error("Could not write file", destination_path);
+        offset += bytes_written;
+      }
+      report(static_cast<std::uint64_t>(bytes_read));
+    }
+  }
+  return method;
+}
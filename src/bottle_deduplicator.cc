@@ -0,0 +1,446 @@
+/**
+ * Copyright (c) 2026 WineGUI
+ *
+ * \file    bottle_deduplicator.cc
+ * \brief   Share identical files between Wine bottles
+ * \author  Melroy van den Berg <webmaster1989@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "bottle_deduplicator.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <fcntl.h>
+#include <filesystem>
+#include <fstream>
+#include <giomm.h>
+#include <glibmm.h>
+#include <iostream>
+#include <linux/fiemap.h>
+#include <linux/fs.h>
+#include <set>
+#include <sys/ioctl.h>
+#include <unistd.h>
+#include <utility>
+
+namespace fs = std::filesystem;
+
+// Maximum bytes per FIDEDUPERANGE call (some file systems, like btrfs, limit a single call to 16 MiB)
+static constexpr std::uint64_t DedupeChunkSize = 16 * 1024 * 1024;
+
+/**
+ * \struct ScannedFile
+ * \brief File found in a bottle
+ */
+struct ScannedFile
+{
+  std::string path;      /*!< File path */
+  struct stat file_stat; /*!< Status during the scan */
+  std::string hash;      /*!< Content hash (empty until hashed) */
+};
+
+/**
+ * \brief Construct a deduplicator, the index file is read at the start of each deduplication
+ * \param[in] index_file_path File location of the persisted hash index
+ */
+BottleDeduplicator::BottleDeduplicator(std::string index_file_path) : index_file_path_(std::move(index_file_path))
+{
+}
+
+/**
+ * \brief Get the application wide instance, the index is persisted in the WineGUI cache directory
+ * \return BottleDeduplicator reference (singleton)
+ */
+BottleDeduplicator& BottleDeduplicator::get_instance()
+{
+  static BottleDeduplicator instance(
+      Glib::build_filename(Glib::build_path(G_DIR_SEPARATOR_S, std::vector<std::string>{Glib::get_user_cache_dir(), "winegui"}), "dedup_index.ini"));
+  return instance;
+}
+
+/**
+ * \brief Let the destination file share the data of the (identical) source file, via the FIDEDUPERANGE ioctl.
+ * The kernel compares the data first, files that are not identical are left untouched.
+ * \param[in] source_path Source file
+ * \param[in] destination_path Destination file
+ * \param[in] size File size of both files
+ * \return true if the data is shared, false if the data differs or the file system doesn't support it
+ */
+bool BottleDeduplicator::share_file_data(const std::string& source_path, const std::string& destination_path, std::uint64_t size)
+{
+  int source_fd = open(source_path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (source_fd < 0)
+    return false;
+  // A read-only file descriptor is sufficient for the owner of the file (since Linux 4.20)
+  int destination_fd = open(destination_path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (destination_fd < 0)
+  {
+    close(source_fd);
+    return false;
+  }
+
+  // Request with a single destination (the info array is a flexible array member)
+  std::vector<std::uint64_t> request_buffer((sizeof(file_dedupe_range) + sizeof(file_dedupe_range_info)) / sizeof(std::uint64_t) + 1);
+  auto* request = reinterpret_cast<file_dedupe_range*>(request_buffer.data());
+  bool is_shared = true;
+  for (std::uint64_t offset = 0; offset < size && is_shared;)
+  {
+    std::fill(request_buffer.begin(), request_buffer.end(), 0);
+    request->src_offset = offset;
+    request->src_length = std::min(DedupeChunkSize, size - offset);
+    request->dest_count = 1;
+    request->info[0].dest_fd = destination_fd;
+    request->info[0].dest_offset = offset;
+    if (ioctl(source_fd, FIDEDUPERANGE, request) != 0 || request->info[0].status != FILE_DEDUPE_RANGE_SAME || request->info[0].bytes_deduped == 0)
+      is_shared = false;
+    else
+      offset += request->info[0].bytes_deduped;
+  }
+  close(destination_fd);
+  close(source_fd);
+  return is_shared;
+}
+
+/**
+ * \brief Get the data extents of a file (FIEMAP), contiguous extents are merged
+ * \param[in] fd File descriptor
+ * \param[out] extents Logical & physical location of the data
+ * \return true if the extents are known, false if the file system doesn't support it (or the file has no data on disk)
+ */
+static bool get_file_extents(int fd, std::vector<fiemap_extent>& extents)
+{
+  // Count the extents first
+  fiemap count_request{};
+  count_request.fm_length = FIEMAP_MAX_OFFSET;
+  count_request.fm_flags = FIEMAP_FLAG_SYNC;
+  if (ioctl(fd, FS_IOC_FIEMAP, &count_request) != 0 || count_request.fm_mapped_extents == 0)
+    return false;
+
+  // Request with the extents (the extents array is a flexible array member)
+  std::size_t extent_count = count_request.fm_mapped_extents;
+  std::vector<std::uint64_t> request_buffer((sizeof(fiemap) + extent_count * sizeof(fiemap_extent)) / sizeof(std::uint64_t) + 1);
+  auto* request = reinterpret_cast<fiemap*>(request_buffer.data());
+  request->fm_length = FIEMAP_MAX_OFFSET;
+  request->fm_flags = FIEMAP_FLAG_SYNC;
+  request->fm_extent_count = static_cast<std::uint32_t>(extent_count);
+  if (ioctl(fd, FS_IOC_FIEMAP, request) != 0 || request->fm_mapped_extents == 0)
+    return false;
+  // The file could be extended in the meantime
+  const fiemap_extent* found_extents = request->fm_extents;
+  if ((found_extents[request->fm_mapped_extents - 1].fe_flags & FIEMAP_EXTENT_LAST) == 0)
+    return false;
+
+  extents.clear();
+  const std::uint32_t unknown_location = FIEMAP_EXTENT_UNKNOWN | FIEMAP_EXTENT_DELALLOC | FIEMAP_EXTENT_DATA_INLINE | FIEMAP_EXTENT_DATA_TAIL;
+  for (std::uint32_t i = 0; i < request->fm_mapped_extents; ++i)
+  {
+    const fiemap_extent& extent = found_extents[i];
+    if ((extent.fe_flags & unknown_location) != 0)
+      return false;
+    if (!extents.empty() && extents.back().fe_logical + extents.back().fe_length == extent.fe_logical &&
+        extents.back().fe_physical + extents.back().fe_length == extent.fe_physical &&
+        (extents.back().fe_flags & FIEMAP_EXTENT_SHARED) == (extent.fe_flags & FIEMAP_EXTENT_SHARED))
+    {
+      extents.back().fe_length += extent.fe_length;
+    }
+    else
+    {
+      extents.push_back(extent);
+    }
+  }
+  return true;
+}
+
+/**
+ * \brief Check if the destination file already shares all its data with the source file (eg. deduplicated by an earlier
+ * run or a reflink copy), by comparing their physical extents
+ * \param[in] source_path Source file
+ * \param[in] destination_path Destination file
+ * \return true if all the data is shared, false if not (or unknown)
+ */
+bool BottleDeduplicator::is_sharing_file_data(const std::string& source_path, const std::string& destination_path)
+{
+  std::vector<fiemap_extent> source_extents;
+  std::vector<fiemap_extent> destination_extents;
+  for (auto [path, extents] : {std::pair{&source_path, &source_extents}, std::pair{&destination_path, &destination_extents}})
+  {
+    int fd = open(path->c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+      return false;
+    bool has_extents = get_file_extents(fd, *extents);
+    close(fd);
+    if (!has_extents)
+      return false;
+  }
+  return std::equal(source_extents.begin(), source_extents.end(), destination_extents.begin(), destination_extents.end(),
+                    [](const fiemap_extent& source, const fiemap_extent& destination)
+                    {
+                      return (source.fe_flags & FIEMAP_EXTENT_SHARED) != 0 && (destination.fe_flags & FIEMAP_EXTENT_SHARED) != 0 &&
+                             source.fe_logical == destination.fe_logical && source.fe_physical == destination.fe_physical &&
+                             source.fe_length == destination.fe_length;
+                    });
+}
+
+/**
+ * \brief Find & deduplicate the identical files of the bottles
+ * \param[in] prefix_paths Bottle prefix paths
+ * \param[in] options Deduplication options (like the dry run)
+ * \param[in] cancel Cancellation flag
+ * \return Report with the (deduplicated) duplicates
+ */
+BottleDeduplicator::Report
+BottleDeduplicator::deduplicate(const std::vector<std::string>& prefix_paths, const Options& options, const std::atomic<bool>& cancel)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  Report report;
+
+  // Scan the bottles, files can only share data on the same device & with the same size
+  std::map<std::pair<dev_t, off_t>, std::vector<ScannedFile>> size_groups;
+  std::set<std::pair<dev_t, ino_t>> inodes; // Hard links are already shared
+  for (const std::string& prefix_path : prefix_paths)
+  {
+    std::error_code error_code;
+    for (auto it = fs::recursive_directory_iterator(prefix_path, fs::directory_options::skip_permission_denied, error_code);
+         !error_code && it != fs::recursive_directory_iterator() && !cancel.load(); it.increment(error_code))
+    {
+      struct stat file_stat;
+      if (lstat(it->path().c_str(), &file_stat) != 0 || !S_ISREG(file_stat.st_mode) ||
+          static_cast<std::uint64_t>(file_stat.st_size) < options.min_file_size)
+        continue;
+      if (!inodes.emplace(file_stat.st_dev, file_stat.st_ino).second)
+        continue;
+      ++report.scanned_files;
+      size_groups[{file_stat.st_dev, file_stat.st_size}].push_back({it->path().string(), file_stat, ""});
+    }
+  }
+
+  // Hash the files that have the same size as another file, unless the index has the hash of the unchanged file
+  std::map<std::string, IndexEntry> index = load_index();
+  std::map<std::string, IndexEntry> new_index;
+  std::map<std::pair<dev_t, std::string>, std::vector<ScannedFile*>> hash_groups;
+  for (auto& [key, files] : size_groups)
+  {
+    if (files.size() < 2)
+      continue;
+    for (ScannedFile& file : files)
+    {
+      if (cancel.load())
+        break;
+      const struct stat& file_stat = file.file_stat;
+      auto entry = index.find(file.path);
+      if (entry != index.end() && entry->second.device == file_stat.st_dev && entry->second.inode == file_stat.st_ino &&
+          entry->second.mtime.tv_sec == file_stat.st_mtim.tv_sec && entry->second.mtime.tv_nsec == file_stat.st_mtim.tv_nsec &&
+          entry->second.size == file_stat.st_size)
+      {
+        file.hash = entry->second.hash;
+      }
+      else
+      {
+        try
+        {
+          file.hash = hash_file(file.path);
+          ++report.hashed_files;
+        }
+        catch (const std::runtime_error& error)
+        {
+          std::cerr << "Error: " << error.what() << std::endl;
+          continue;
+        }
+      }
+      new_index[file.path] = {file_stat.st_dev, file_stat.st_ino, file_stat.st_mtim, file_stat.st_size, file.hash};
+      hash_groups[{file_stat.st_dev, file.hash}].push_back(&file);
+    }
+  }
+
+  // Let the duplicates share the data of the first file
+  for (auto& [key, files] : hash_groups)
+  {
+    for (std::size_t i = 1; i < files.size() && !cancel.load(); ++i)
+    {
+      const ScannedFile& source = *files[0];
+      const ScannedFile& duplicate = *files[i];
+      std::uint64_t size = static_cast<std::uint64_t>(duplicate.file_stat.st_size);
+      // Don't count the savings of an earlier run again
+      if (is_sharing_file_data(source.path, duplicate.path))
+      {
+        ++report.already_shared_files;
+        report.already_shared_bytes += size;
+        continue;
+      }
+      ++report.duplicate_files;
+      report.duplicate_bytes += size;
+      if (options.is_dry_run)
+        continue;
+      bool is_deduplicated = share_file_data(source.path, duplicate.path, size);
+      if (!is_deduplicated && options.allow_hard_links)
+      {
+        // Only when both files are read-only & have the same owner and permissions, the hard link shares the file status
+        const mode_t write_bits = S_IWUSR | S_IWGRP | S_IWOTH;
+        if ((source.file_stat.st_mode & write_bits) == 0 && source.file_stat.st_mode == duplicate.file_stat.st_mode &&
+            source.file_stat.st_uid == duplicate.file_stat.st_uid && source.file_stat.st_gid == duplicate.file_stat.st_gid &&
+            replace_by_hard_link(source.path, source.file_stat, duplicate.path, duplicate.file_stat))
+        {
+          is_deduplicated = true;
+          new_index[duplicate.path] = new_index[source.path];
+        }
+      }
+      if (is_deduplicated)
+      {
+        ++report.deduplicated_files;
+        report.deduplicated_bytes += size;
+      }
+    }
+  }
+
+  // Only the files that still exist are kept in the index (also when cancelled, the next run continues)
+  save_index(new_index);
+  return report;
+}
+
+/**
+ * \brief Hash the content of a file (SHA-256, streamed in 1 MiB chunks)
+ * \param[in] file_path File path
+ * \throws runtime_error when the file could not be read
+ * \return Lowercase hex digest
+ */
+std::string BottleDeduplicator::hash_file(const std::string& file_path)
+{
+  Glib::Checksum checksum(Glib::Checksum::Type::SHA256);
+  std::ifstream file(file_path, std::ios::binary);
+  if (!file.is_open())
+    throw std::runtime_error("Could not open the file for deduplication: " + file_path);
+  std::vector<char> buffer(1024 * 1024);
+  while (file.read(buffer.data(), static_cast<std::streamsize>(buffer.size())) || file.gcount() > 0)
+    checksum.update(reinterpret_cast<const guchar*>(buffer.data()), static_cast<gssize>(file.gcount()));
+  if (file.bad())
+    throw std::runtime_error("Could not read the file for deduplication: " + file_path);
+  return checksum.get_string();
+}
+
+/**
+ * \brief Check if a file is still the same file (and unchanged) as during the scan.
+ * The change time is not compared, since linking the file changes it as well.
+ * \param[in] file_stat Current status of the file
+ * \param[in] scanned_stat Status of the file during the scan
+ * \return true if unchanged, otherwise false
+ */
+static bool is_unchanged(const struct stat& file_stat, const struct stat& scanned_stat)
+{
+  return file_stat.st_dev == scanned_stat.st_dev && file_stat.st_ino == scanned_stat.st_ino && file_stat.st_size == scanned_stat.st_size &&
+         file_stat.st_mode == scanned_stat.st_mode && file_stat.st_mtim.tv_sec == scanned_stat.st_mtim.tv_sec &&
+         file_stat.st_mtim.tv_nsec == scanned_stat.st_mtim.tv_nsec;
+}
+
+/**
+ * \brief Atomically replace the destination file by a hard link to the source file.
+ * Both files are checked again right before the replacement, a file that is changed since the scan (eg. by an install
+ * in the bottle) is left untouched.
+ * \param[in] source_path Source file
+ * \param[in] source_stat Status of the source file during the scan
+ * \param[in] destination_path Destination file, identical to the source (during the scan)
+ * \param[in] destination_stat Status of the destination file during the scan
+ * \return true if replaced, otherwise false
+ */
+bool BottleDeduplicator::replace_by_hard_link(const std::string& source_path,
+                                              const struct stat& source_stat,
+                                              const std::string& destination_path,
+                                              const struct stat& destination_stat)
+{
+  std::string temp_path = destination_path + ".winegui-dedup";
+  if (link(source_path.c_str(), temp_path.c_str()) != 0)
+    return false;
+  // The new link refers to the source inode, which must be the scanned (hashed) one
+  struct stat linked_stat;
+  struct stat current_destination_stat;
+  if (lstat(temp_path.c_str(), &linked_stat) != 0 || !is_unchanged(linked_stat, source_stat) ||
+      lstat(destination_path.c_str(), &current_destination_stat) != 0 || !is_unchanged(current_destination_stat, destination_stat) ||
+      rename(temp_path.c_str(), destination_path.c_str()) != 0)
+  {
+    unlink(temp_path.c_str());
+    return false;
+  }
+  return true;
+}
+
+/**
+ * \brief Read the persisted hash index (if present)
+ * \return File path to index entry
+ */
+std::map<std::string, BottleDeduplicator::IndexEntry> BottleDeduplicator::load_index() const
+{
+  std::map<std::string, IndexEntry> index;
+  if (!Glib::file_test(index_file_path_, Glib::FileTest::IS_REGULAR))
+    return index;
+  try
+  {
+    auto keyfile = Glib::KeyFile::create();
+    keyfile->load_from_file(index_file_path_);
+    for (const Glib::ustring& group : keyfile->get_groups())
+    {
+      struct timespec mtime = {static_cast<time_t>(keyfile->get_int64(group, "ModifiedTime")),
+                               static_cast<long>(keyfile->get_int64(group, "ModifiedTimeNsec"))};
+      IndexEntry entry{static_cast<dev_t>(keyfile->get_uint64(group, "Device")),
+                       static_cast<ino_t>(keyfile->get_uint64(group, "Inode")),
+                       mtime,
+                       static_cast<off_t>(keyfile->get_int64(group, "Size")),
+                       keyfile->get_string(group, "Hash")};
+      index.emplace(keyfile->get_string(group, "Path"), std::move(entry));
+    }
+  }
+  catch (const Glib::Error& ex)
+  {
+    std::cerr << "Error: Exception while reading deduplication index file: " << ex.what() << std::endl;
+    // Start with an empty index, all files are hashed again
+    index.clear();
+  }
+  return index;
+}
+
+/**
+ * \brief Write the hash index file
+ * \param[in] index File path to index entry
+ */
+void BottleDeduplicator::save_index(const std::map<std::string, IndexEntry>& index) const
+{
+  try
+  {
+    auto keyfile = Glib::KeyFile::create();
+    int file_index = 0;
+    for (const auto& [path, entry] : index)
+    {
+      // A file path is not always a valid group name, so the path is stored as a value
+      Glib::ustring group = "File" + std::to_string(file_index++);
+      keyfile->set_string(group, "Path", path);
+      keyfile->set_uint64(group, "Device", static_cast<guint64>(entry.device));
+      keyfile->set_uint64(group, "Inode", static_cast<guint64>(entry.inode));
+      keyfile->set_int64(group, "ModifiedTime", static_cast<gint64>(entry.mtime.tv_sec));
+      keyfile->set_int64(group, "ModifiedTimeNsec", static_cast<gint64>(entry.mtime.tv_nsec));
+      keyfile->set_int64(group, "Size", static_cast<gint64>(entry.size));
+      keyfile->set_string(group, "Hash", entry.hash);
+    }
+    std::string cache_dir = Glib::path_get_dirname(index_file_path_);
+    if (!Glib::file_test(cache_dir, Glib::FileTest::IS_DIR))
+    {
+      Glib::RefPtr<Gio::File> directory = Gio::File::create_for_path(cache_dir);
+      if (directory)
+        directory->make_directory_with_parents();
+    }
+    keyfile->save_to_file(index_file_path_);
+  }
+  catch (const Glib::Error& ex)
+  {
+    std::cerr << "Error: Exception while writing deduplication index file: " << ex.what() << std::endl;
+  }
+}
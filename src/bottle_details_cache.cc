@@ -0,0 +1,256 @@
+/**
+ * Copyright (c) 2026 WineGUI
+ *
+ * \file    bottle_details_cache.cc
+ * \brief   Persisted snapshot of the bottle details
+ * \author  Melroy van den Berg <webmaster1989@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "bottle_details_cache.h"
+
+#include <algorithm>
+#include <giomm.h>
+#include <glibmm.h>
+#include <iostream>
+#include <set>
+#include <sys/stat.h>
+#include <utility>
+
+// Files (within the bottle prefix) the bottle details are read from
+static const std::vector<std::string> SourceFiles{"user.reg", "system.reg", ".update-timestamp", "winegui.ini"};
+
+/**
+ * \brief Construct a (empty) bottle details cache, the cache file is read on first use
+ * \param[in] cache_file_path File location of the persisted cache
+ */
+BottleDetailsCache::BottleDetailsCache(std::string cache_file_path) : cache_file_path_(std::move(cache_file_path))
+{
+}
+
+/**
+ * \brief Get the application wide instance, persisted in the WineGUI data directory
+ * \return BottleDetailsCache reference (singleton)
+ */
+BottleDetailsCache& BottleDetailsCache::get_instance()
+{
+  static BottleDetailsCache instance(
+      Glib::build_filename(Glib::build_path(G_DIR_SEPARATOR_S, std::vector<std::string>{Glib::get_user_data_dir(), "winegui"}), "bottles.ini"));
+  return instance;
+}
+
+/**
+ * \brief Get the modification times of the files the bottle details are read from.
+ * Take the stamps before reading the details, so a file that changes during the read invalidates the snapshot.
+ * \param[in] prefix_path Bottle prefix
+ * \return Modification time (seconds.nanoseconds) per file, empty string for a missing file
+ */
+std::vector<std::string> BottleDetailsCache::get_file_stamps(const std::string& prefix_path)
+{
+  std::vector<std::string> file_stamps;
+  file_stamps.reserve(SourceFiles.size());
+  for (const std::string& file_name : SourceFiles)
+  {
+    struct stat file_stat;
+    if (stat(Glib::build_filename(prefix_path, file_name).c_str(), &file_stat) == 0)
+      file_stamps.emplace_back(std::to_string(file_stat.st_mtim.tv_sec) + "." + std::to_string(file_stat.st_mtim.tv_nsec));
+    else
+      file_stamps.emplace_back("");
+  }
+  return file_stamps;
+}
+
+/**
+ * \brief Check if the bottle details are read from this file (within the bottle prefix)
+ * \param[in] file_name File name (without directory)
+ * \return true if a change of the file invalidates the snapshot of the bottle, otherwise false
+ */
+bool BottleDetailsCache::is_source_file(const std::string& file_name)
+{
+  return std::find(SourceFiles.begin(), SourceFiles.end(), file_name) != SourceFiles.end();
+}
+
+/**
+ * \brief Get the bottle details from the snapshot
+ * \param[in] prefix_path Bottle prefix
+ * \param[in] file_stamps Current modification times of the bottle files (see get_file_stamps)
+ * \return Bottle details, or std::nullopt when the bottle is not in the snapshot or its files are changed
+ */
+std::optional<BottleDetailsData> BottleDetailsCache::get(const std::string& prefix_path, const std::vector<std::string>& file_stamps)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!is_loaded_)
+    load();
+  auto it = entries_.find(prefix_path);
+  if (it == entries_.end() || it->second.file_stamps != file_stamps)
+    return std::nullopt;
+  BottleDetailsData details = it->second.details;
+  details.is_snapshot = true;
+  return details;
+}
+
+/**
+ * \brief Store the bottle details in the snapshot (in-memory, see save()). Details with errors are not stored.
+ * \param[in] details Bottle details
+ * \param[in] file_stamps Modification times of the bottle files, taken before the details were read
+ */
+void BottleDetailsCache::put(const BottleDetailsData& details, const std::vector<std::string>& file_stamps)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!is_loaded_)
+    load();
+  if (!details.error_messages.empty())
+  {
+    is_changed_ |= (entries_.erase(details.prefix_path) > 0);
+    return;
+  }
+  entries_[details.prefix_path] = Entry{file_stamps, details};
+  is_changed_ = true;
+}
+
+/**
+ * \brief Remove the bottles that no longer exist from the snapshot
+ * \param[in] prefix_paths Prefixes of all the current bottles
+ */
+void BottleDetailsCache::retain(const std::vector<std::string>& prefix_paths)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!is_loaded_)
+    load();
+  std::set<std::string> current(prefix_paths.begin(), prefix_paths.end());
+  is_changed_ |= (std::erase_if(entries_, [&current](const auto& entry) { return !current.contains(entry.first); }) > 0);
+}
+
+/**
+ * \brief Write the snapshot to disk (only when it is changed)
+ */
+void BottleDetailsCache::save()
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!is_changed_)
+    return;
+  try
+  {
+    auto keyfile = Glib::KeyFile::create();
+    int index = 0;
+    for (const auto& [prefix_path, entry] : entries_)
+    {
+      const BottleDetailsData& details = entry.details;
+      // A prefix path is not always a valid group name, so the path is stored as a value
+      Glib::ustring group = "Bottle." + std::to_string(index++);
+      keyfile->set_string(group, "Path", prefix_path);
+      keyfile->set_string_list(group, "FileStamps", std::vector<Glib::ustring>(entry.file_stamps.begin(), entry.file_stamps.end()));
+      keyfile->set_string(group, "FolderName", details.folder_name);
+      keyfile->set_string(group, "Name", details.config.name);
+      keyfile->set_string(group, "Description", details.config.description);
+      keyfile->set_string(group, "WineBinaryPath", details.config.wine_bin_path);
+      keyfile->set_boolean(group, "UseWine64", details.config.use_wine64);
+      keyfile->set_boolean(group, "LoggingEnabled", details.config.logging_enabled);
+      keyfile->set_integer(group, "DebugLevel", details.config.debug_log_level);
+      std::vector<Glib::ustring> env_vars;
+      for (const auto& [key, value] : details.config.env_vars)
+      {
+        env_vars.emplace_back(key);
+        env_vars.emplace_back(value);
+      }
+      keyfile->set_string_list(group, "EnvironmentVariables", env_vars);
+      std::vector<Glib::ustring> applications;
+      for (const auto& [_, app_data] : details.app_list)
+      {
+        applications.emplace_back(app_data.name);
+        applications.emplace_back(app_data.description);
+        applications.emplace_back(app_data.command);
+      }
+      keyfile->set_string_list(group, "Applications", applications);
+      keyfile->set_boolean(group, "Status", details.status);
+      keyfile->set_integer(group, "Windows", static_cast<int>(details.windows));
+      keyfile->set_integer(group, "Bit", static_cast<int>(details.bit));
+      keyfile->set_string(group, "WineVersion", details.wine_version);
+      keyfile->set_string(group, "CDriveLocation", details.c_drive_location);
+      keyfile->set_string(group, "LastWineUpdated", details.last_time_wine_updated);
+      keyfile->set_integer(group, "AudioDriver", static_cast<int>(details.audio_driver));
+      keyfile->set_string(group, "VirtualDesktop", details.virtual_desktop);
+    }
+    std::string cache_dir = Glib::path_get_dirname(cache_file_path_);
+    if (!Glib::file_test(cache_dir, Glib::FileTest::IS_DIR))
+    {
+      Glib::RefPtr<Gio::File> directory = Gio::File::create_for_path(cache_dir);
+      if (directory)
+        directory->make_directory_with_parents();
+    }
+    keyfile->save_to_file(cache_file_path_);
+    is_changed_ = false;
+  }
+  catch (const Glib::Error& ex)
+  {
+    std::cerr << "Error: Exception while writing bottle details cache file: " << ex.what() << std::endl;
+  }
+}
+
+/**
+ * \brief Read the persisted snapshot (if present), must be called with the mutex locked
+ */
+void BottleDetailsCache::load()
+{
+  is_loaded_ = true;
+  if (!Glib::file_test(cache_file_path_, Glib::FileTest::IS_REGULAR))
+    return;
+  try
+  {
+    auto keyfile = Glib::KeyFile::create();
+    keyfile->load_from_file(cache_file_path_);
+    for (const Glib::ustring& group : keyfile->get_groups())
+    {
+      Entry entry;
+      for (const Glib::ustring& file_stamp : keyfile->get_string_list(group, "FileStamps"))
+      {
+        entry.file_stamps.emplace_back(file_stamp);
+      }
+      BottleDetailsData& details = entry.details;
+      details.prefix_path = keyfile->get_string(group, "Path");
+      details.folder_name = keyfile->get_string(group, "FolderName");
+      details.config.name = keyfile->get_string(group, "Name");
+      details.config.description = keyfile->get_string(group, "Description");
+      details.config.wine_bin_path = keyfile->get_string(group, "WineBinaryPath");
+      details.config.use_wine64 = keyfile->get_boolean(group, "UseWine64");
+      details.config.logging_enabled = keyfile->get_boolean(group, "LoggingEnabled");
+      details.config.debug_log_level = keyfile->get_integer(group, "DebugLevel");
+      std::vector<Glib::ustring> env_vars = keyfile->get_string_list(group, "EnvironmentVariables");
+      for (std::size_t i = 0; i + 1 < env_vars.size(); i += 2)
+      {
+        details.config.env_vars.emplace_back(env_vars[i], env_vars[i + 1]);
+      }
+      std::vector<Glib::ustring> applications = keyfile->get_string_list(group, "Applications");
+      for (std::size_t i = 0; i + 2 < applications.size(); i += 3)
+      {
+        details.app_list.emplace(static_cast<int>(i / 3), ApplicationData{applications[i], applications[i + 1], applications[i + 2]});
+      }
+      details.status = keyfile->get_boolean(group, "Status");
+      details.windows = static_cast<BottleTypes::Windows>(keyfile->get_integer(group, "Windows"));
+      details.bit = static_cast<BottleTypes::Bit>(keyfile->get_integer(group, "Bit"));
+      details.wine_version = keyfile->get_string(group, "WineVersion");
+      details.c_drive_location = keyfile->get_string(group, "CDriveLocation");
+      details.last_time_wine_updated = keyfile->get_string(group, "LastWineUpdated");
+      details.audio_driver = static_cast<BottleTypes::AudioDriver>(keyfile->get_integer(group, "AudioDriver"));
+      details.virtual_desktop = keyfile->get_string(group, "VirtualDesktop");
+      entries_.emplace(details.prefix_path, std::move(entry));
+    }
+  }
+  catch (const Glib::Error& ex)
+  {
+    std::cerr << "Error: Exception while reading bottle details cache file: " << ex.what() << std::endl;
+    // Start with an empty snapshot, every bottle is read again
+    entries_.clear();
+  }
+}
@@ -59,11 +59,39 @@ BottleItem::BottleItem(const BottleItem& bottle_item) : BottleItem()
     debug_log_level_ = bottle_item.debug_log_level();
     env_vars_ = bottle_item.env_vars();
     app_list_ = bottle_item.app_list();
+    is_loading_ = bottle_item.is_loading();
   }
 
   CreateUI();
 }
 
+/**
+ * \brief Construct a placeholder Wine Bottle Item, shown while the details are read from disk
+ * \param[in] folder_name Folder name of the bottle
+ * \param[in] wine_location Bottle prefix
+ */
+BottleItem::BottleItem(const Glib::ustring& folder_name, const Glib::ustring& wine_location)
+    : name_(""),
+      folder_name_(folder_name),
+      wine_bin_path_(""),
+      description_(""),
+      is_status_ok_(false),
+      win_(WineDefaults::WindowsOs),
+      bit_(BottleTypes::Bit::win32),
+      wine_version_(""),
+      is_wine64_bit_(false),
+      use_wine64_(false),
+      wine_location_(wine_location),
+      wine_c_drive_(""),
+      wine_last_changed_(""),
+      audio_driver_(WineDefaults::AudioDriver),
+      virtual_desktop_(""),
+      is_debug_logging_(false),
+      debug_log_level_(1),
+      is_loading_(true) {
+        // Gui will be created during the copy constructor called by Gtk
+      };
+
 /**
  * \brief Construct a new Wine Bottle Item with limited inputs
  */
@@ -141,41 +169,17 @@ BottleItem::BottleItem(Glib::ustring& name,
 
 void BottleItem::CreateUI()
 {
-  // To lower case
-  std::string windows_str = BottleItem::str_tolower(BottleTypes::to_string(this->windows()));
-  // Remove spaces
-  windows_str.erase(std::remove_if(std::begin(windows_str), std::end(windows_str), [l = std::locale{}](auto ch) { return std::isspace(ch, l); }),
-                    end(windows_str));
-  Glib::ustring bit_str = BottleTypes::to_string(this->bit());
-  Glib::ustring filename_str = windows_str + "_" + bit_str + ".png";
-  Glib::ustring name_str = this->name();
-  Glib::ustring folder_name_str = this->folder_name();
-  Glib::ustring name_label_text = (!name_str.empty()) ? name_str : folder_name_str; // Fallback to folder name
-  bool is_status = this->status();
-
   // Set left side of the GUI
-  image.set(Helper::get_image_location("windows/" + filename_str));
   image.set_pixel_size(32);
   image.set_margin_start(6);
   image.set_halign(Gtk::Align::START);
 
   name_label.set_xalign(0.0);
-  name_label.set_markup("<span size=\"medium\"><b>" + Glib::Markup::escape_text(name_label_text) + "</b></span>");
 
-  Glib::ustring status_text = "Ready";
-  if (is_status)
-  {
-    status_icon.set(Helper::get_image_location("ready.png"));
-  }
-  else
-  {
-    status_text = "Not Ready";
-    status_icon.set(Helper::get_image_location("not_ready.png"));
-  }
   status_icon.set_size_request(2, -1);
   status_icon.set_halign(Gtk::Align::START);
+  spinner.set_halign(Gtk::Align::START);
 
-  status_label.set_text(status_text);
   status_label.set_xalign(0.0);
 
   grid.set_valign(Gtk::Align::CENTER);
@@ -190,12 +194,55 @@ void BottleItem::CreateUI()
   grid.attach_next_to(name_label, image, Gtk::PositionType::RIGHT, 10, 1);
 
   grid.attach(status_icon, 1, 1, 1, 1);
+  grid.attach(spinner, 1, 1, 1, 1);
   grid.attach_next_to(status_label, status_icon, Gtk::PositionType::RIGHT, 1, 1);
 
   set_size_request(-1, 65); // More height then default
 
   // Finally at the grid to the ListBoxRow
   set_child(grid);
+
+  update_ui();
+}
+
+/**
+ * \brief Update the widgets of the row with the current bottle data (eg. after the details are loaded)
+ */
+void BottleItem::update_ui()
+{
+  // To lower case
+  std::string windows_str = BottleItem::str_tolower(BottleTypes::to_string(this->windows()));
+  // Remove spaces
+  windows_str.erase(std::remove_if(std::begin(windows_str), std::end(windows_str), [l = std::locale{}](auto ch) { return std::isspace(ch, l); }),
+                    end(windows_str));
+  Glib::ustring bit_str = BottleTypes::to_string(this->bit());
+  Glib::ustring filename_str = windows_str + "_" + bit_str + ".png";
+  Glib::ustring name_str = this->name();
+  Glib::ustring folder_name_str = this->folder_name();
+  Glib::ustring name_label_text = (!name_str.empty()) ? name_str : folder_name_str; // Fallback to folder name
+  bool is_status = this->status();
+
+  image.set(Helper::get_image_location("windows/" + filename_str));
+  name_label.set_markup("<span size=\"medium\"><b>" + Glib::Markup::escape_text(name_label_text) + "</b></span>");
+
+  Glib::ustring status_text = "Ready";
+  if (is_loading_)
+  {
+    status_text = "Loading...";
+  }
+  else if (is_status)
+  {
+    status_icon.set(Helper::get_image_location("ready.png"));
+  }
+  else
+  {
+    status_text = "Not Ready";
+    status_icon.set(Helper::get_image_location("not_ready.png"));
+  }
+  status_icon.set_visible(!is_loading_);
+  spinner.set_visible(is_loading_);
+  spinner.set_spinning(is_loading_);
+  status_label.set_text(status_text);
 }
 
 /**
@@ -20,16 +20,32 @@
  */
 #include "bottle_manager.h"
 #include "bottle_config_file.h"
+#include "bottle_details_cache.h"
 #include "bottle_item.h"
+#include "bottle_trash.h"
 #include "general_config_file.h"
 #include "helper.h"
 #include "main_window.h"
+#include "output_ring_buffer.h"
+#include "prefix_templates.h"
 #include "signal_controller.h"
 #include "wine_defaults.h"
 #include <algorithm>
+#include <atomic>
+#include <numeric>
 
 #include <stdexcept>
 
+// Maximum output of a running program that is kept in memory, until it is written to the log file
+static constexpr std::size_t ProgramLogBufferSize = 1024 * 1024;
+// The log file of a bottle is rotated when it's larger than 10 MiB, at most 3 rotated log files are kept
+static constexpr std::size_t LogFileMaxSize = 10 * 1024 * 1024;
+static constexpr int LogFileMaxRotated = 3;
+// Maximum number of bottle jobs (installs, updates, ...) that run at the same time, programs are launched outside of these workers
+static const std::size_t JobWorkerCount = std::max(std::thread::hardware_concurrency(), 4U);
+// Winetricks verbs of the gaming packages, which can be installed when creating a new bottle
+static const std::vector<string> GamingPackages = {"vcrun2022", "d3dx9", "dxvk", "corefonts", "liberation"};
+
 /*************************************************************
  * Public member functions                                   *
  *************************************************************/
@@ -40,23 +56,34 @@
  */
 BottleManager::BottleManager(MainWindow& main_window)
     : error_message_mutex_(),
-      output_loging_mutex_(),
       error_message_winetricks_mutex_(),
       error_message_gpu_test_mutex_(),
+      loaded_bottles_details_mutex_(),
+      is_refresh_bottles_cancelled_(false),
+      log_writer_(std::make_shared<LogWriter>(LogFileMaxSize, LogFileMaxRotated)),
       main_window_(main_window),
       active_bottle_(nullptr),
       is_wine64_bit_(false),
       is_logging_stderr_(true),
+      is_refresh_pending_(false),
+      is_bottle_list_changed_(false),
       error_message_(),
       error_message_winetricks_(),
-      error_message_gpu_test_()
+      error_message_gpu_test_(),
+      deduplication_parent_(nullptr),
+      is_deduplication_dry_run_(true),
+      is_deduplication_hard_links_(false),
+      is_deduplication_job_cancelled_(false),
+      job_scheduler_(JobWorkerCount, [this] { jobs_changed_dispatcher.emit(); })
 {
   // Connect internal dispatcher(s)
   update_bottles_dispatcher_.connect(sigc::bind(sigc::mem_fun(*this, &BottleManager::update_config_and_bottles), "", false));
-  write_log_dispatcher_.connect(sigc::mem_fun(*this, &BottleManager::write_log_to_file));
   error_message_winetricks_dispatcher_.connect(sigc::mem_fun(*this, &BottleManager::on_error_winetricks));
   winetricks_finished_dispatcher_.connect(sigc::mem_fun(*this, &BottleManager::cleanup_install_update_winetricks_thread));
   error_message_gpu_test_dispatcher_.connect(sigc::mem_fun(*this, &BottleManager::on_error_gpu_test));
+  bottle_details_loaded_dispatcher_.connect(sigc::mem_fun(*this, &BottleManager::on_bottle_details_loaded));
+  refresh_bottles_finished_dispatcher_.connect(sigc::mem_fun(*this, &BottleManager::on_refresh_bottles_finished));
+  deduplication_finished_dispatcher_.connect(sigc::mem_fun(*this, &BottleManager::on_deduplication_finished));
 }
 
 /**
@@ -64,8 +91,12 @@ BottleManager::BottleManager(MainWindow& main_window)
  */
 BottleManager::~BottleManager()
 {
-  // Avoid zombie thread
+  bottle_changes_timeout_.disconnect();
+  // Avoid zombie threads
   this->cleanup_install_update_winetricks_thread();
+  is_refresh_bottles_cancelled_ = true;
+  this->cleanup_refresh_bottles_thread();
+  is_deduplication_cancelled_ = true;
 }
 
 /**
@@ -84,37 +115,37 @@ void BottleManager::prepare()
     install_or_update_winetricks_thread(false);
   }
 
-  // Start the initial read from disk to fetch the bottles & update GUI
+  // Start the initial read from disk to fetch the bottles & update GUI (the details are read in a thread)
   // "" - during startup (no bottle name to select)
   // true - during startup
-  // TODO: Run in separate thread, thus not blocking the main thread
   update_config_and_bottles("", true);
+
+  // Remove the deleted bottles that were not completely removed during the previous run (in the background)
+  BottleTrash::get_instance().sweep(bottle_location_);
+  BottleTrash::get_instance().sweep(Glib::get_home_dir()); // Trash of the default Wine bottle (~/.wine)
 }
 
 /**
- * \brief Write debugging logging to file handler
+ * \brief Helper method for cleaning the winetricks thread.
  */
-void BottleManager::write_log_to_file()
+void BottleManager::cleanup_install_update_winetricks_thread()
 {
-  std::lock_guard<std::mutex> lock(error_message_mutex_);
-  char last_char = output_logging_.back();
-  // Needs new line at end of string?
-  if (last_char != '\n')
+  if (thread_install_update_winetricks_ && thread_install_update_winetricks_->joinable())
   {
-    output_logging_ += '\n';
+    thread_install_update_winetricks_->join();
+    thread_install_update_winetricks_.reset();
   }
-  Helper::write_to_log_file(logging_bottle_prefix_, output_logging_);
 }
 
 /**
- * \brief Helper method for cleaning the winetricks thread.
+ * \brief Helper method for cleaning the refresh bottles thread.
  */
-void BottleManager::cleanup_install_update_winetricks_thread()
+void BottleManager::cleanup_refresh_bottles_thread()
 {
-  if (thread_install_update_winetricks_ && thread_install_update_winetricks_->joinable())
+  if (thread_refresh_bottles_ && thread_refresh_bottles_->joinable())
   {
-    thread_install_update_winetricks_->join();
-    thread_install_update_winetricks_.reset();
+    thread_refresh_bottles_->join();
+    thread_refresh_bottles_.reset();
   }
 }
 
@@ -140,6 +171,96 @@ void BottleManager::on_error_gpu_test()
   main_window_.show_error_message(error_message_gpu_test_);
 }
 
+/**
+ * \brief Signal handler when the deduplication job is finished.
+ * After the search the user is asked to deduplicate the found files, otherwise the result is shown.
+ */
+void BottleManager::on_deduplication_finished()
+{
+  main_window_.hide_busy_dialog();
+  std::lock_guard<std::mutex> lock(deduplication_mutex_);
+  const BottleDeduplicator::Report& report = deduplication_report_;
+  if (is_deduplication_job_cancelled_)
+  {
+    // Cancelled in the jobs window, nothing to report
+    is_deduplication_job_cancelled_ = false;
+  }
+  else if (!error_message_deduplication_.empty())
+  {
+    main_window_.show_error_message(error_message_deduplication_);
+  }
+  else if (is_deduplication_dry_run_)
+  {
+    if (report.duplicate_files == 0 && report.already_shared_files > 0)
+    {
+      main_window_.show_info_message("All the identical files in the Windows Machines already share their disk space (" +
+                                     std::to_string(report.already_shared_files) + " files, " + Glib::format_size(report.already_shared_bytes) + ").");
+      return;
+    }
+    if (report.duplicate_files == 0)
+    {
+      main_window_.show_info_message("No identical files found in the Windows Machines.");
+      return;
+    }
+    Glib::ustring confirm_message = "Found " + std::to_string(report.duplicate_files) + " identical files (" +
+                                    Glib::format_size(report.duplicate_bytes) + ") in the Windows Machines.\n\n" +
+                                    "Do you want the identical files to share their disk space?";
+    auto dialog = main_window_.show_question_dialog(deduplication_parent_, confirm_message);
+    dialog->signal_response.connect(
+        [this](DialogWindow::ResponseType result)
+        {
+          if (result == DialogWindow::ResponseType::YES)
+          {
+            Gtk::Window* parent = nullptr;
+            {
+              std::lock_guard<std::mutex> lock(deduplication_mutex_);
+              parent = deduplication_parent_;
+            }
+            main_window_.show_busy_dialog(*parent, "Deduplicate Windows Machines", "Sharing the disk space of the identical files.\n");
+            run_deduplication(false);
+          }
+        });
+  }
+  else if (!is_deduplication_hard_links_ && report.deduplicated_files < report.duplicate_files)
+  {
+    // Hard links are only used after a separate confirmation, since they share more than the disk space
+    std::uint64_t remaining_files = report.duplicate_files - report.deduplicated_files;
+    Glib::ustring confirm_message =
+        std::to_string(report.deduplicated_files) + " identical files are deduplicated, " + Glib::format_size(report.deduplicated_bytes) +
+        " of disk space is freed.\n\n" + std::to_string(remaining_files) +
+        " identical files could not share their disk space, the file system does not support sharing file data (like btrfs or XFS do).\n\n"
+        "Do you want to replace the <b>read-only</b> identical files by a hard link instead?\n\n"
+        "<i>Note:</i> A hard linked file is the same file in every machine: when a program changes its permissions "
+        "(eg. by removing the read-only attribute), it changes them in every machine.";
+    auto dialog = main_window_.show_question_dialog(deduplication_parent_, confirm_message, true);
+    dialog->signal_response.connect(
+        [this](DialogWindow::ResponseType result)
+        {
+          if (result == DialogWindow::ResponseType::YES)
+          {
+            Gtk::Window* parent = nullptr;
+            {
+              std::lock_guard<std::mutex> lock(deduplication_mutex_);
+              parent = deduplication_parent_;
+            }
+            main_window_.show_busy_dialog(*parent, "Deduplicate Windows Machines", "Replacing the read-only identical files by hard links.\n");
+            run_deduplication(false, true);
+          }
+        });
+  }
+  else if (report.deduplicated_files == 0)
+  {
+    main_window_.show_info_message("None of the identical files could share their disk space.\n\n"
+                                   "The file system does not support sharing file data (like btrfs or XFS do), "
+                                   "and only read-only files are replaced by a hard link.");
+  }
+  else
+  {
+    main_window_.show_info_message(std::to_string(report.deduplicated_files) + " identical files are deduplicated, " +
+                                   Glib::format_size(report.deduplicated_bytes) + " of disk space is freed.");
+  }
+}
+
 /**
  * \brief Install or self-update Winetricks within a thread.
  * \param install True to install/update winetricks, false to self-update
@@ -182,24 +303,24 @@ void BottleManager::install_or_update_winetricks_thread(bool install)
 }
 
 /**
- * \brief Update WineGUI Config and update bottles by reading the Wine Bottles from disk and update GUI
+ * \brief Update WineGUI Config and update bottles by reading the Wine Bottles from disk and update GUI.
+ * The bottle list is shown right away with placeholder rows, the details of each bottle are read from disk
+ * in a separate thread and update their row as soon as they are available (see on_bottle_details_loaded).
+ * Afterwards the bottles are watched, changes on disk only update the affected row (see on_bottle_changes_timeout).
  * \param select_bottle_name If set, try to find the bottle with this name and set it as active bottle (used for newly created bottles)
  * \param is_startup Set to true if this function is called during start-up, otherwise false
  */
 void BottleManager::update_config_and_bottles(const Glib::ustring& select_bottle_name, bool is_startup)
 {
-  // Registry files are cached in-memory only for the duration of this enumeration pass, to avoid
-  // re-reading the same user.reg/system.reg from disk many times per bottle. Clear the cache at the
-  // start so every refresh reads fresh from disk, and again on exit (all return paths) so the cache
-  // is empty at rest and never serves data that changed on disk afterwards (also from outside WineGUI).
-  Helper::invalidate_reg_cache();
-  struct RegCacheGuard
-  {
-    ~RegCacheGuard()
-    {
-      Helper::invalidate_reg_cache();
-    }
-  } reg_cache_guard;
+  if (thread_refresh_bottles_)
+  {
+    // A refresh is still running, stop it and refresh again once it is stopped (see on_refresh_bottles_finished)
+    is_refresh_bottles_cancelled_ = true;
+    is_refresh_pending_ = true;
+    if (!select_bottle_name.empty())
+      pending_select_bottle_name_ = select_bottle_name;
+    return;
+  }
 
   // Read general & save config in bottle manager
   GeneralConfigData config_data = load_and_save_general_config();
@@ -217,6 +338,11 @@ void BottleManager::update_config_and_bottles(const Glib::ustring& select_bottle
   // Clear bottles
   if (!bottles_.empty())
     bottles_.clear();
+  active_bottle_ = nullptr;
+  select_bottle_name_ = "";
+  // All the bottles are read again
+  changed_bottle_prefixes_.clear();
+  is_bottle_list_changed_ = false;
 
   // Get the bottle directories
   std::vector<string> bottle_dirs;
@@ -229,70 +355,60 @@ void BottleManager::update_config_and_bottles(const Glib::ustring& select_bottle
     main_window_.show_error_message(error.what());
     return; // stop
   }
+  watch_bottles(bottle_dirs);
+  BottleDetailsCache::get_instance().retain(bottle_dirs);
 
   if (bottle_dirs.size() > 0)
   {
-    try
-    {
-      // Create wine bottles from bottle directories and wine version
-      bottles_ = create_wine_bottles(bottle_dirs);
-    }
-    catch (const std::runtime_error& error)
-    {
-      main_window_.show_error_message(error.what());
-      return; // stop
-    }
+    // Show the bottles directly (from the snapshot, or with their folder name only)
+    bottles_ = create_wine_bottles(bottle_dirs);
+    main_window_.set_wine_bottles(bottles_);
 
-    if (!bottles_.empty())
+    // Is select_bottle_name set?
+    if (!select_bottle_name.empty())
     {
-      // Update main Window
-      main_window_.set_wine_bottles(bottles_);
-
-      // Is select_bottle_name set?
-      if (!select_bottle_name.empty())
-      {
-        // Check if there is a bottle with the same name and select as active bottle
-        auto it = std::find_if(bottles_.begin(), bottles_.end(),
-                               [&select_bottle_name](const BottleItem& bottle) { return bottle.name().compare(select_bottle_name) == 0; });
-        if (it != bottles_.end())
-        {
-          main_window_.select_row_bottle(*it);
-          active_bottle_ = &(*it);
-        }
-      }
-      // Is try_to_restore boolean true?
-      // And: Is the bottle list size the same?
-      // And: Is the previous index not bigger than the list size?
-      else if (try_to_restore && (bottles_.size() == previous_bottles_list_size_) && ((size_t)previous_active_bottle_index_ < bottles_.size()))
+      // Check if there is a bottle with the same name and select as active bottle
+      auto it = std::find_if(bottles_.begin(), bottles_.end(), [&select_bottle_name](const BottleItem& bottle)
+                             { return !bottle.is_loading() && bottle.name().compare(select_bottle_name) == 0; });
+      if (it != bottles_.end())
       {
-        // Let's reset the previous state!
-        auto front = bottles_.begin();
-        std::advance(front, previous_active_bottle_index_);
-        main_window_.select_row_bottle(*front);
-        // Set active bottle at the previous index
-        active_bottle_ = &(*front);
+        main_window_.select_row_bottle(*it);
+        active_bottle_ = &(*it);
       }
       else
       {
-        // Default behaviour: Bottle list is changed, let's set the first bottle in the detailed info panel.
-        // begin() gives us an iterator with the first element
-        auto first = bottles_.begin();
-        // Trigger select row, except during start-up (show_all will auto-select the first listbox item in GTK)
-        if (!is_startup)
-          main_window_.select_row_bottle(*first);
-        // Set active bottle at the first
-        active_bottle_ = &(*first);
+        // The bottle name is part of the details, select the bottle once its details are loaded
+        select_bottle_name_ = select_bottle_name;
       }
     }
+    // Is try_to_restore boolean true?
+    // And: Is the bottle list size the same?
+    // And: Is the previous index not bigger than the list size?
+    else if (try_to_restore && (bottles_.size() == previous_bottles_list_size_) && ((size_t)previous_active_bottle_index_ < bottles_.size()))
+    {
+      // Let's reset the previous state!
+      auto front = bottles_.begin();
+      std::advance(front, previous_active_bottle_index_);
+      main_window_.select_row_bottle(*front);
+      // Set active bottle at the previous index
+      active_bottle_ = &(*front);
+    }
     else
     {
-      main_window_.show_error_message("Could not create an overview of Windows Machines. Empty list.");
-
-      // Send reset signal to reset the active bottle to NULL
-      reset_active_bottle.emit();
-      // Reset locally
-      active_bottle_ = nullptr;
+      // Default behaviour: Bottle list is changed, let's set the first bottle in the detailed info panel.
+      // begin() gives us an iterator with the first element
+      auto first = bottles_.begin();
+      // Trigger select row, except during start-up (show_all will auto-select the first listbox item in GTK)
+      if (!is_startup)
+        main_window_.select_row_bottle(*first);
+      // Set active bottle at the first
+      active_bottle_ = &(*first);
     }
+
+    // Read the bottle details from disk (the rows are updated via the bottle details loaded dispatcher)
+    std::vector<std::size_t> bottle_indexes(bottle_dirs.size());
+    std::iota(bottle_indexes.begin(), bottle_indexes.end(), 0);
+    read_bottles_details(bottle_dirs, bottle_indexes);
   }
   else
   {
@@ -303,6 +419,194 @@ void BottleManager::update_config_and_bottles(const Glib::ustring& select_bottle
   }
 }
 
+/**
+ * \brief Signal handler when the details of one or more bottles are read from disk (by the refresh thread).
+ * Updates the placeholder rows of these bottles.
+ */
+void BottleManager::on_bottle_details_loaded()
+{
+  std::vector<std::pair<std::size_t, BottleDetailsData>> loaded_bottles_details;
+  {
+    std::lock_guard<std::mutex> lock(loaded_bottles_details_mutex_);
+    loaded_bottles_details.swap(loaded_bottles_details_);
+  }
+  // Details of a cancelled refresh are outdated, the list is rebuild anyway
+  if (is_refresh_bottles_cancelled_)
+    return;
+
+  for (auto& [index, details] : loaded_bottles_details)
+  {
+    if (index >= bottles_.size())
+      continue;
+    for (const string& error_message : details.error_messages)
+    {
+      main_window_.show_error_message(error_message);
+    }
+
+    BottleItem& bottle = *std::next(bottles_.begin(), static_cast<std::ptrdiff_t>(index));
+    // Bottle is already shown from the same snapshot
+    if (!bottle.is_loading() && details.is_snapshot)
+      continue;
+    set_bottle_details(bottle, details);
+    main_window_.update_wine_bottle(bottle);
+
+    // Check if this is the bottle with the same name to select as active bottle
+    if (!select_bottle_name_.empty() && bottle.name().compare(select_bottle_name_) == 0)
+    {
+      select_bottle_name_ = "";
+      main_window_.select_row_bottle(bottle);
+      active_bottle_ = &bottle;
+    }
+  }
+}
+
+/**
+ * \brief Signal handler when the refresh bottles thread is finished (or stopped).
+ */
+void BottleManager::on_refresh_bottles_finished()
+{
+  // Make sure all the loaded details are processed
+  on_bottle_details_loaded();
+  this->cleanup_refresh_bottles_thread();
+
+  if (is_refresh_pending_)
+  {
+    is_refresh_pending_ = false;
+    Glib::ustring select_bottle_name = pending_select_bottle_name_;
+    pending_select_bottle_name_ = "";
+    update_config_and_bottles(select_bottle_name, false);
+  }
+  else if (!select_bottle_name_.empty() && !bottles_.empty())
+  {
+    // Bottle name is not found, fall back to the first bottle
+    select_bottle_name_ = "";
+    main_window_.select_row_bottle(bottles_.front());
+    active_bottle_ = &bottles_.front();
+  }
+}
+
+/**
+ * \brief Signal handler when a file or directory is changed directly within the bottle location
+ * \param[in] file Changed file or directory
+ * \param[in] other_file New location in case of a rename (otherwise empty)
+ * \param[in] event Type of change
+ */
+void BottleManager::on_bottle_location_changed(const Glib::RefPtr<Gio::File>& /*file*/,
+                                               const Glib::RefPtr<Gio::File>& /*other_file*/,
+                                               Gio::FileMonitor::Event event)
+{
+  switch (event)
+  {
+  case Gio::FileMonitor::Event::CREATED:
+  case Gio::FileMonitor::Event::DELETED:
+  case Gio::FileMonitor::Event::MOVED_IN:
+  case Gio::FileMonitor::Event::MOVED_OUT:
+  case Gio::FileMonitor::Event::RENAMED:
+    is_bottle_list_changed_ = true;
+    schedule_bottle_changes();
+    break;
+  default:
+    break;
+  }
+}
+
+/**
+ * \brief Signal handler when a file is changed within a bottle prefix. Only the files the bottle details
+ * are read from are of interest (see BottleDetailsCache::is_source_file).
+ * \param[in] prefix_path Bottle prefix
+ * \param[in] file Changed file
+ * \param[in] other_file New location in case of a rename (otherwise empty), Wine replaces the registry files by a rename
+ * \param[in] event Type of change
+ */
+void BottleManager::on_bottle_files_changed(const string& prefix_path,
+                                            const Glib::RefPtr<Gio::File>& file,
+                                            const Glib::RefPtr<Gio::File>& other_file,
+                                            Gio::FileMonitor::Event event)
+{
+  if (event == Gio::FileMonitor::Event::CHANGES_DONE_HINT || event == Gio::FileMonitor::Event::ATTRIBUTE_CHANGED)
+    return;
+  if (event == Gio::FileMonitor::Event::DELETED && file && file->get_path() == prefix_path)
+  {
+    // The bottle itself is removed
+    is_bottle_list_changed_ = true;
+    schedule_bottle_changes();
+    return;
+  }
+  bool is_source_file = (file && BottleDetailsCache::is_source_file(file->get_basename())) ||
+                        (other_file && BottleDetailsCache::is_source_file(other_file->get_basename()));
+  if (is_source_file)
+  {
+    changed_bottle_prefixes_.insert(prefix_path);
+    schedule_bottle_changes();
+  }
+}
+
+/**
+ * \brief Signal handler of the debounce timer, once the watched bottle files are no longer changing.
+ * Added or removed bottles rebuild the bottle list (which is cheap due to the snapshot), otherwise only
+ * the rows of the changed bottles are read again and updated in place.
+ * \return true to try again later (a refresh is still running), otherwise false
+ */
+bool BottleManager::on_bottle_changes_timeout()
+{
+  if (thread_refresh_bottles_)
+    return true; // Try again once the running refresh is finished
+
+  std::set<string> changed_bottle_prefixes;
+  changed_bottle_prefixes.swap(changed_bottle_prefixes_);
+  bool is_bottle_list_changed = is_bottle_list_changed_;
+  is_bottle_list_changed_ = false;
+
+  std::vector<string> bottle_dirs;
+  try
+  {
+    bottle_dirs = get_bottle_paths();
+  }
+  catch (const std::runtime_error& error)
+  {
+    main_window_.show_error_message(error.what());
+    return false;
+  }
+  // Also watch new (not yet complete) bottle directories, to notice once their registry is written
+  watch_bottles(bottle_dirs);
+
+  std::vector<string> shown_bottle_dirs;
+  shown_bottle_dirs.reserve(bottles_.size());
+  for (const BottleItem& bottle : bottles_)
+  {
+    shown_bottle_dirs.emplace_back(bottle.wine_location());
+  }
+  auto is_shown = [&shown_bottle_dirs](const string& prefix)
+  { return std::find(shown_bottle_dirs.begin(), shown_bottle_dirs.end(), prefix) != shown_bottle_dirs.end(); };
+  if (is_bottle_list_changed || !std::all_of(changed_bottle_prefixes.begin(), changed_bottle_prefixes.end(), is_shown))
+  {
+    // Ignore new directories without a registry (yet), eg. a bottle that is still being created
+    std::erase_if(bottle_dirs, [&is_shown](const string& prefix)
+                  { return !is_shown(prefix) && !Helper::file_exists(Glib::build_filename(prefix, "system.reg")); });
+    if (bottle_dirs != shown_bottle_dirs)
+    {
+      update_config_and_bottles("", false);
+      return false;
+    }
+  }
+
+  // Read only the changed bottles again
+  std::vector<string> changed_bottle_dirs;
+  std::vector<std::size_t> bottle_indexes;
+  for (std::size_t index = 0; index < shown_bottle_dirs.size(); ++index)
+  {
+    if (changed_bottle_prefixes.contains(shown_bottle_dirs[index]))
+    {
+      Helper::invalidate_reg_cache(shown_bottle_dirs[index]);
+      changed_bottle_dirs.emplace_back(shown_bottle_dirs[index]);
+      bottle_indexes.emplace_back(index);
+    }
+  }
+  if (!changed_bottle_dirs.empty())
+    read_bottles_details(changed_bottle_dirs, bottle_indexes);
+  return false;
+}
+
 /**
  * \brief Create a new Wine Bottle (runs in thread!)
  * \param[in] caller                      - Signal Dispatcher pointer, in order to signal back events
@@ -321,7 +625,8 @@ void BottleManager::new_bottle(SignalController* caller,
                                const Glib::ustring& virtual_desktop_resolution,
                                bool disable_gecko_mono,
                                BottleTypes::AudioDriver audio,
-                               const Glib::ustring& wine_bin_path)
+                               const Glib::ustring& wine_bin_path,
+                               bool install_gaming_packages)
 {
   // New bottles always use the plain "wine" binary (it creates both 32-bit and 64-bit prefixes).
   // The wine64 binary is a per-bottle opt-in the user can enable afterwards in the Edit window.
@@ -373,8 +678,8 @@ void BottleManager::new_bottle(SignalController* caller,
 
   try
   {
-    // Now create a new Wine Bottle (always via the plain wine binary; use_wine64 defaults to false)
-    Helper::create_wine_bottle(false, prefix_path, bit, disable_gecko_mono, wine_bin_path);
+    // Now create a new Wine Bottle, copied from a pre-provisioned prefix template (which is built on first use)
+    PrefixTemplates::get_instance().create_bottle(prefix_path, bit, disable_gecko_mono, wine_bin_path);
     // Create default Bottle config data struct
     BottleConfigData bottle_config = BottleConfigFile::get_default_config(prefix_path);
     bottle_config.name = name;
@@ -456,6 +761,19 @@ void BottleManager::new_bottle(SignalController* caller,
     }
   }
 
+  // Install all the gaming packages with a single winetricks run, still within the Wine session of the settings above
+  if (bottle_created && install_gaming_packages)
+  {
+    std::vector<std::pair<string, string>> winetricks_env_vars;
+    if (!wine_bin_path.empty())
+    {
+      winetricks_env_vars.emplace_back("WINE", Helper::get_wine_executable_location(false, wine_bin_path));
+      winetricks_env_vars.emplace_back("WINESERVER", Helper::get_wineserver_executable_location(wine_bin_path));
+    }
+    Helper::run_program(prefix_path, 1, get_winetricks_install_command(GamingPackages), "", winetricks_env_vars, true, is_logging_stderr_,
+                        nullptr, create_output_sink(prefix_path, false));
+  }
+
   // Wait until wineserver terminates
   Helper::wait_until_wineserver_is_terminated(prefix_path, wine_bin_path);
 
@@ -688,9 +1006,30 @@ void BottleManager::clone_bottle(SignalController* caller,
     // First do a clone of the bottle, using the new folder name as new prefix
     std::vector<string> dirs{bottle_location_, folder_name};
     string clone_prefix_path = Glib::build_path(G_DIR_SEPARATOR_S, dirs);
+    is_clone_cancelled_.store(false);
+    clone_bytes_done_.store(0);
+    clone_bytes_total_.store(0);
     try
     {
-      Helper::copy_wine_bottle_folder(orginal_prefix_path, clone_prefix_path);
+      // Only signal the GUI when the progress changed at least 0.1%
+      std::uint64_t last_permille = 0;
+      auto progress_cb = [this, caller, &last_permille](std::uint64_t bytes_done, std::uint64_t bytes_total)
+      {
+        clone_bytes_done_.store(bytes_done);
+        clone_bytes_total_.store(bytes_total);
+        std::uint64_t permille = (bytes_total > 0) ? (bytes_done * 1000 / bytes_total) : 0;
+        if (permille != last_permille)
+        {
+          last_permille = permille;
+          caller->signal_clone_progress();
+        }
+      };
+      if (!Helper::copy_wine_bottle_folder(orginal_prefix_path, clone_prefix_path, progress_cb, &is_clone_cancelled_))
+      {
+        // Cancelled by the user, the partial clone is already removed
+        caller->signal_bottle_clone_cancelled();
+        return;
+      }
     }
     catch (const std::runtime_error& error)
     {
@@ -736,6 +1075,23 @@ void BottleManager::clone_bottle(SignalController* caller,
   caller->signal_bottle_cloned();
 }
 
+/**
+ * \brief Cancel the running bottle clone (the partial clone is removed)
+ */
+void BottleManager::cancel_clone()
+{
+  is_clone_cancelled_.store(true);
+}
+
+/**
+ * \brief Get the progress of the running bottle clone (thread-safe)
+ * \return Pair of bytes done & bytes total
+ */
+std::pair<std::uint64_t, std::uint64_t> BottleManager::get_clone_progress() const
+{
+  return {clone_bytes_done_.load(), clone_bytes_total_.load()};
+}
+
 /**
  * \brief Remove the current active Wine bottle
  */
@@ -746,6 +1102,13 @@ void BottleManager::delete_bottle(Gtk::Window* parent)
     try
     {
       string prefix_path = active_bottle_->wine_location();
+      if (job_scheduler_.has_running_jobs(prefix_path))
+      {
+        main_window_.show_warning_message("The machine can't be removed while programs or installs are still running in it.\n\n"
+                                          "Please, wait until they are finished or use <i>Kill processes</i> first.",
+                                          true);
+        return;
+      }
       Glib::ustring windows = BottleTypes::to_string(active_bottle_->windows());
       // Are you sure?
       Glib::ustring confirm_message = "Are you sure you want to <b>PERMANENTLY</b> remove machine named '" +
@@ -757,10 +1120,26 @@ void BottleManager::delete_bottle(Gtk::Window* parent)
           {
             if (result == DialogWindow::ResponseType::YES)
             {
+              // Drop the queued jobs of the bottle, otherwise Wine would re-create the bottle at the same location.
+              // Check the running jobs afterwards, a job might be started while the question was shown.
+              job_scheduler_.cancel_bottle_jobs(prefix_path);
+              if (job_scheduler_.has_running_jobs(prefix_path))
+              {
+                main_window_.show_error_message("The machine is not removed, programs or installs are still running in it.");
+                return;
+              }
               // Signal that bottle is removed (which only closes the edit window)
               bottle_removed.emit();
-              // Remove the actual bottle
-              Helper::remove_wine_bottle(prefix_path);
+              Helper::invalidate_reg_cache(prefix_path);
+              try
+              {
+                // Move the bottle into the trash, the files are removed in the background
+                BottleTrash::get_instance().remove(prefix_path);
+              }
+              catch (const std::runtime_error& error)
+              {
+                main_window_.show_error_message(error.what());
+              }
               // Update the config and bottles listing
               this->update_config_and_bottles("", false);
             }
@@ -777,6 +1156,32 @@ void BottleManager::delete_bottle(Gtk::Window* parent)
   }
 }
 
+/**
+ * \brief Search for identical files in all the bottles, and let them share their data on disk (after confirmation)
+ * \param[in] parent Parent GTK Window
+ */
+void BottleManager::deduplicate_bottles(Gtk::Window* parent)
+{
+  std::vector<string> prefix_paths;
+  for (BottleItem& bottle : bottles_)
+  {
+    prefix_paths.push_back(bottle.wine_location());
+  }
+  if (prefix_paths.empty())
+  {
+    main_window_.show_info_message("There are no Windows Machines to deduplicate.");
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(deduplication_mutex_);
+    deduplication_parent_ = parent;
+    deduplication_prefix_paths_ = std::move(prefix_paths);
+  }
+  // First only search for the duplicates, the user decides whether the files are changed
+  main_window_.show_busy_dialog(*parent, "Deduplicate Windows Machines", "Searching for identical files in all the machines.\n");
+  run_deduplication(true);
+}
+
 /**
  * \brief Signal handler when the active bottle changes, update active bottle
  * \param[in] bottle - New bottle
@@ -813,6 +1218,27 @@ std::vector<string> BottleManager::get_bottle_wine_bin_paths() const
   return wine_bin_paths;
 }
 
+/**
+ * \brief Get the running & queued jobs of all bottles (shown in the jobs window)
+ * \return List of jobs, running jobs first
+ */
+std::vector<JobScheduler::JobInfo> BottleManager::get_jobs() const
+{
+  return job_scheduler_.get_jobs();
+}
+
+/**
+ * \brief Cancel a queued job, a running job can't be cancelled
+ * \param[in] job_id Job ID
+ */
+void BottleManager::cancel_job(std::size_t job_id)
+{
+  if (!job_scheduler_.cancel(job_id))
+  {
+    std::cout << "INFO: Job is already started, it can't be cancelled anymore" << std::endl;
+  }
+}
+
 /**
  * \brief Run an executable (exe) or MSI file in Wine (using the current active bottle)
  * \param[in] program Path of the program (selected by the user)
@@ -832,25 +1258,15 @@ void BottleManager::run_executable(string program, bool is_msi_file = false)
     program = program_prefix + " \"" + program + "\"";
     auto& env_vars = active_bottle_->env_vars();
 
-    std::thread t(
+    // Programs can run for hours, so they don't take a worker nor lock the bottle
+    job_scheduler_.launch(
+        "Run program", wine_prefix,
         [wine64 = active_bottle_->use_wine64(), wine_bin_path, wine_prefix, debug_log_level, program, working_directory, env_vars,
-         logging_stderr = std::move(is_logging_stderr_), debug_logging = std::move(is_debug_logging),
-         output_logging_mutex = std::ref(output_loging_mutex_), logging_bottle_prefix = std::ref(logging_bottle_prefix_),
-         output_logging = std::ref(output_logging_), write_log_dispatcher = &write_log_dispatcher_]
+         logging_stderr = std::move(is_logging_stderr_), output_sink = create_output_sink(wine_prefix, is_debug_logging)]
         {
-          string output = Helper::run_program_under_wine(wine64, wine_prefix, debug_log_level, program, working_directory, env_vars, true,
-                                                         logging_stderr, wine_bin_path);
-          if (debug_logging && !output.empty())
-          {
-            {
-              std::lock_guard<std::mutex> lock(output_logging_mutex);
-              logging_bottle_prefix.get() = wine_prefix;
-              output_logging.get() = output;
-            }
-            write_log_dispatcher->emit();
-          }
+          Helper::run_program_under_wine(wine64, wine_prefix, debug_log_level, program, working_directory, env_vars, true, logging_stderr,
+                                         wine_bin_path, nullptr, output_sink);
         });
-    t.detach();
   }
 }
 
@@ -882,38 +1298,40 @@ void BottleManager::run_program(string program)
       // Enable the full DXVK HUD overlay
       env_vars.insert(env_vars.begin(), {"DXVK_HUD", "full"});
 
-      std::thread t(
+      // The test window stays open until the user closes it, the test result is shared with the job.
+      // It's only reported when the test is finished before WineGUI is closed.
+      auto exit_code = std::make_shared<int>(0);
+      // Only keep the last part of the output for the error message (the most relevant error lines are at the end)
+      auto output_tail_buffer = std::make_shared<OutputRingBuffer>(1500);
+      job_scheduler_.launch(
+          "GPU test", wine_prefix,
           [wine64 = active_bottle_->use_wine64(), wine_bin_path, wine_prefix, debug_log_level, program, env_vars,
-           logging_stderr = std::move(is_logging_stderr_), debug_logging = std::move(is_debug_logging),
-           output_logging_mutex = std::ref(output_loging_mutex_), logging_bottle_prefix = std::ref(logging_bottle_prefix_),
-           output_logging = std::ref(output_logging_), write_log_dispatcher = &write_log_dispatcher_,
-           error_message_mutex = std::ref(error_message_gpu_test_mutex_), error_message = std::ref(error_message_gpu_test_),
-           error_dispatcher = &error_message_gpu_test_dispatcher_]
+           logging_stderr = std::move(is_logging_stderr_), output_sink = create_output_sink(wine_prefix, is_debug_logging), exit_code,
+           output_tail_buffer]
           {
-            int exit_code = 0;
-            string output = Helper::run_program_under_wine(wine64, wine_prefix, debug_log_level, program, "", env_vars, false, logging_stderr,
-                                                           wine_bin_path, &exit_code);
-            if (exit_code != 0)
+            Helper::run_program_under_wine(wine64, wine_prefix, debug_log_level, program, "", env_vars, false, logging_stderr, wine_bin_path,
+                                           exit_code.get(),
+                                           [&output_tail_buffer, &output_sink](std::string_view output)
+                                           {
+                                             output_tail_buffer->write(output);
+                                             output_sink(output);
+                                           });
+          },
+          [exit_code, output_tail_buffer, error_message_mutex = std::ref(error_message_gpu_test_mutex_),
+           error_message = std::ref(error_message_gpu_test_), error_dispatcher = &error_message_gpu_test_dispatcher_]
+          {
+            if (*exit_code != 0)
             {
-              // Only show the last part of the output (the most relevant error lines are at the end)
-              string output_tail = (output.size() > 1500) ? "...\n" + output.substr(output.size() - 1500) : output;
+              string output_tail;
+              if (output_tail_buffer->read(output_tail) > 0)
+                output_tail.insert(0, "...\n");
               {
                 std::lock_guard<std::mutex> lock(error_message_mutex.get());
                 error_message.get() = "The GPU test (Direct3D 11 triangle) exited with an error.\n\nTest output:\n" + output_tail;
               }
               error_dispatcher->emit();
             }
-            if (debug_logging && !output.empty())
-            {
-              {
-                std::lock_guard<std::mutex> lock(output_logging_mutex);
-                logging_bottle_prefix.get() = wine_prefix;
-                output_logging.get() = output;
-              }
-              write_log_dispatcher->emit();
-            }
           });
-      t.detach();
     }
     // For all other programs (except winetricks)
     else if (!program.ends_with("winetricks --gui -q"))
@@ -936,47 +1354,26 @@ void BottleManager::run_program(string program)
       }
       auto& env_vars = active_bottle_->env_vars();
 
-      std::thread t(
+      job_scheduler_.launch(
+          "Run program", wine_prefix,
           [wine64 = active_bottle_->use_wine64(), wine_bin_path, wine_prefix, debug_log_level, program, working_directory, env_vars,
-           logging_stderr = std::move(is_logging_stderr_), debug_logging = std::move(is_debug_logging),
-           output_logging_mutex = std::ref(output_loging_mutex_), logging_bottle_prefix = std::ref(logging_bottle_prefix_),
-           output_logging = std::ref(output_logging_), write_log_dispatcher = &write_log_dispatcher_]
+           logging_stderr = std::move(is_logging_stderr_), output_sink = create_output_sink(wine_prefix, is_debug_logging)]
           {
-            string output = Helper::run_program_under_wine(wine64, wine_prefix, debug_log_level, program, working_directory, env_vars, true,
-                                                           logging_stderr, wine_bin_path);
-            if (debug_logging && !output.empty())
-            {
-              {
-                std::lock_guard<std::mutex> lock(output_logging_mutex);
-                logging_bottle_prefix.get() = wine_prefix;
-                output_logging.get() = output;
-              }
-              write_log_dispatcher->emit();
-            }
+            Helper::run_program_under_wine(wine64, wine_prefix, debug_log_level, program, working_directory, env_vars, true, logging_stderr,
+                                           wine_bin_path, nullptr, output_sink);
           });
-      t.detach();
     }
     else
     {
-      // We have an exception for winetricks, since that doesn't need the wine command
-      std::thread t(
+      // We have an exception for winetricks, since that doesn't need the wine command.
+      // The winetricks GUI stays open as long as the user wants, just like a program.
+      job_scheduler_.launch(
+          "Winetricks", wine_prefix,
           [wine_prefix, wine_bin_path, winetricks_env_vars, debug_log_level, program, logging_stderr = std::move(is_logging_stderr_),
-           debug_logging = std::move(is_debug_logging), output_logging_mutex = std::ref(output_loging_mutex_),
-           logging_bottle_prefix = std::ref(logging_bottle_prefix_), output_logging = std::ref(output_logging_),
-           write_log_dispatcher = &write_log_dispatcher_]
+           output_sink = create_output_sink(wine_prefix, is_debug_logging)]
           {
-            string output = Helper::run_program(wine_prefix, debug_log_level, program, "", winetricks_env_vars, true, logging_stderr);
-            if (debug_logging && !output.empty())
-            {
-              {
-                std::lock_guard<std::mutex> lock(output_logging_mutex);
-                logging_bottle_prefix.get() = wine_prefix;
-                output_logging.get() = output;
-              }
-              write_log_dispatcher->emit();
-            }
+            Helper::run_program(wine_prefix, debug_log_level, program, "", winetricks_env_vars, true, logging_stderr, nullptr, output_sink);
           });
-      t.detach();
     }
   }
 }
@@ -1006,25 +1403,15 @@ void BottleManager::reboot()
     string wine_bin_path = active_bottle_->wine_bin_path();
     bool is_debug_logging = active_bottle_->is_debug_logging();
     int debug_log_level = active_bottle_->debug_log_level();
-    std::thread t(
+    // Don't wait for the other jobs of the bottle, a reboot should also rescue a hanging bottle (like killing the processes)
+    job_scheduler_.submit(
+        "Reboot", wine_prefix, JobScheduler::Lock::None,
         [wine64 = active_bottle_->use_wine64(), wine_bin_path, wine_prefix, debug_log_level, logging_stderr = std::move(is_logging_stderr_),
-         debug_logging = std::move(is_debug_logging), output_logging_mutex = std::ref(output_loging_mutex_),
-         logging_bottle_prefix = std::ref(logging_bottle_prefix_), output_logging = std::ref(output_logging_),
-         write_log_dispatcher = &write_log_dispatcher_]
+         output_sink = create_output_sink(wine_prefix, is_debug_logging)]
         {
-          string output =
-              Helper::run_program_under_wine(wine64, wine_prefix, debug_log_level, "wineboot -r", "", {}, true, logging_stderr, wine_bin_path);
-          if (debug_logging && !output.empty())
-          {
-            {
-              std::lock_guard<std::mutex> lock(output_logging_mutex);
-              logging_bottle_prefix.get() = wine_prefix;
-              output_logging.get() = output;
-            }
-            write_log_dispatcher->emit();
-          }
+          Helper::run_program_under_wine(wine64, wine_prefix, debug_log_level, "wineboot -r", "", {}, true, logging_stderr, wine_bin_path, nullptr,
+                                         output_sink);
         });
-    t.detach();
     main_window_.show_info_message("Machine emulate reboot requested.");
   }
 }
@@ -1040,28 +1427,17 @@ void BottleManager::update()
     string wine_bin_path = active_bottle_->wine_bin_path();
     bool is_debug_logging = active_bottle_->is_debug_logging();
     int debug_log_level = active_bottle_->debug_log_level();
-    std::thread t(
+    job_scheduler_.submit(
+        "Update", wine_prefix, JobScheduler::Lock::Exclusive,
         [wine64 = active_bottle_->use_wine64(), wine_bin_path, wine_prefix, debug_log_level, update_bottles_dispatcher = &update_bottles_dispatcher_,
-         logging_stderr = std::move(is_logging_stderr_), debug_logging = std::move(is_debug_logging),
-         output_logging_mutex = std::ref(output_loging_mutex_), logging_bottle_prefix = std::ref(logging_bottle_prefix_),
-         output_logging = std::ref(output_logging_), write_log_dispatcher = &write_log_dispatcher_]
+         logging_stderr = std::move(is_logging_stderr_), output_sink = create_output_sink(wine_prefix, is_debug_logging)]
         {
-          string output =
-              Helper::run_program_under_wine(wine64, wine_prefix, debug_log_level, "wineboot -u", "", {}, true, logging_stderr, wine_bin_path);
-          if (debug_logging && !output.empty())
-          {
-            {
-              std::lock_guard<std::mutex> lock(output_logging_mutex);
-              logging_bottle_prefix.get() = wine_prefix;
-              output_logging.get() = output;
-            }
-            write_log_dispatcher->emit();
-          }
+          Helper::run_program_under_wine(wine64, wine_prefix, debug_log_level, "wineboot -u", "", {}, true, logging_stderr, wine_bin_path, nullptr,
+                                         output_sink);
           Helper::wait_until_wineserver_is_terminated(wine_prefix, wine_bin_path);
           // Emit update bottles (via dispatcher, so the GUI update can take place in the GUI thread)
           update_bottles_dispatcher->emit();
         });
-    t.detach();
   }
 }
 
@@ -1100,25 +1476,14 @@ void BottleManager::kill_processes()
     string wine_bin_path = active_bottle_->wine_bin_path();
     bool is_debug_logging = active_bottle_->is_debug_logging();
     int debug_log_level = active_bottle_->debug_log_level();
-    std::thread t(
+    job_scheduler_.submit(
+        "Kill processes", wine_prefix, JobScheduler::Lock::None,
         [wine64 = active_bottle_->use_wine64(), wine_bin_path, wine_prefix, debug_log_level, logging_stderr = std::move(is_logging_stderr_),
-         debug_logging = std::move(is_debug_logging), output_logging_mutex = std::ref(output_loging_mutex_),
-         logging_bottle_prefix = std::ref(logging_bottle_prefix_), output_logging = std::ref(output_logging_),
-         write_log_dispatcher = &write_log_dispatcher_]
+         output_sink = create_output_sink(wine_prefix, is_debug_logging)]
         {
-          string output =
-              Helper::run_program_under_wine(wine64, wine_prefix, debug_log_level, "wineboot -k", "", {}, true, logging_stderr, wine_bin_path);
-          if (debug_logging && !output.empty())
-          {
-            {
-              std::lock_guard<std::mutex> lock(output_logging_mutex);
-              logging_bottle_prefix.get() = wine_prefix;
-              output_logging.get() = output;
-            }
-            write_log_dispatcher->emit();
-          }
+          Helper::run_program_under_wine(wine64, wine_prefix, debug_log_level, "wineboot -k", "", {}, true, logging_stderr, wine_bin_path, nullptr,
+                                         output_sink);
         });
-    t.detach();
     main_window_.show_info_message("Kill processes requested.");
   }
 }
@@ -1140,33 +1505,7 @@ void BottleManager::install_d3dx9(Gtk::Window* parent, const string& version)
     {
       package += "_" + version;
     }
-    string wine_prefix = active_bottle_->wine_location();
-    string wine_bin_path = active_bottle_->wine_bin_path();
-    auto winetricks_env_vars = get_winetricks_env_vars();
-    bool is_debug_logging = active_bottle_->is_debug_logging();
-    int debug_log_level = active_bottle_->debug_log_level();
-    string program = Helper::get_winetricks_location() + " -q " + package;
-    // finished_package_install_dispatcher signal is needed in order to close the busy dialog again
-    std::thread t(
-        [wine_prefix, wine_bin_path, winetricks_env_vars, debug_log_level, program, logging_stderr = std::move(is_logging_stderr_),
-         debug_logging = std::move(is_debug_logging), output_logging_mutex = std::ref(output_loging_mutex_),
-         logging_bottle_prefix = std::ref(logging_bottle_prefix_), output_logging = std::ref(output_logging_),
-         write_log_dispatcher = &write_log_dispatcher_, finish_dispatcher = &finished_package_install_dispatcher]
-        {
-          string output = Helper::run_program(wine_prefix, debug_log_level, program, "", winetricks_env_vars, true, logging_stderr);
-          if (debug_logging && !output.empty())
-          {
-            {
-              std::lock_guard<std::mutex> lock(output_logging_mutex);
-              logging_bottle_prefix.get() = wine_prefix;
-              output_logging.get() = output;
-            }
-            write_log_dispatcher->emit();
-          }
-          Helper::wait_until_wineserver_is_terminated(wine_prefix, wine_bin_path);
-          finish_dispatcher->emit();
-        });
-    t.detach();
+    queue_winetricks_verbs({package});
   }
 }
 
@@ -1185,54 +1524,7 @@ void BottleManager::install_gallium_nine(Gtk::Window* parent)
     main_window_.show_busy_install_dialog(*parent, "Installing Gallium Nine (DirectX 9 directly via the Mesa graphics driver).\n");
 
     string package = "galliumnine";
-    string wine_prefix = active_bottle_->wine_location();
-    string wine_bin_path = active_bottle_->wine_bin_path();
-    auto winetricks_env_vars = get_winetricks_env_vars();
-    bool is_debug_logging = active_bottle_->is_debug_logging();
-    int debug_log_level = active_bottle_->debug_log_level();
-    string program = Helper::get_winetricks_location() + " -q " + package;
-    // finished_package_install_dispatcher signal is needed in order to close the busy dialog again
-    std::thread t(
-        [wine_prefix, wine_bin_path, winetricks_env_vars, debug_log_level, program, logging_stderr = std::move(is_logging_stderr_),
-         debug_logging = std::move(is_debug_logging), output_logging_mutex = std::ref(output_loging_mutex_),
-         logging_bottle_prefix = std::ref(logging_bottle_prefix_), output_logging = std::ref(output_logging_),
-         write_log_dispatcher = &write_log_dispatcher_, update_bottles_dispatcher = &update_bottles_dispatcher_,
-         finish_dispatcher = &finished_package_install_dispatcher]
-        {
-          string output = Helper::run_program(wine_prefix, debug_log_level, program, "", winetricks_env_vars, true, logging_stderr);
-          if (debug_logging && !output.empty())
-          {
-            {
-              std::lock_guard<std::mutex> lock(output_logging_mutex);
-              logging_bottle_prefix.get() = wine_prefix;
-              output_logging.get() = output;
-            }
-            write_log_dispatcher->emit();
-          }
-          Helper::wait_until_wineserver_is_terminated(wine_prefix, wine_bin_path);
-          // When the install actually succeeded (winetricks ran ninewinecfg -e, which sets the 'd3d9'
-          // DLL override), add a custom app shortcut for the Gallium Nine settings GUI (ninewinecfg.exe),
-          // so the user can enable/disable Gallium Nine afterwards (and remove the shortcut again if desired)
-          bool added_shortcut = false;
-          try
-          {
-            if (Helper::get_dll_override(wine_prefix, "d3d9"))
-            {
-              added_shortcut = BottleManager::add_gallium_nine_shortcut(wine_prefix);
-            }
-          }
-          catch (const std::runtime_error& error)
-          {
-            std::cout << "Error: " << error.what() << std::endl;
-          }
-          if (added_shortcut)
-          {
-            // Refresh the bottles so the new app shortcut shows up in the application list
-            update_bottles_dispatcher->emit();
-          }
-          finish_dispatcher->emit();
-        });
-    t.detach();
+    queue_winetricks_verbs({package});
   }
 }
 
@@ -1291,33 +1583,7 @@ void BottleManager::install_dxvk(Gtk::Window* parent, const string& version)
     {
       package += version;
     }
-    string wine_prefix = active_bottle_->wine_location();
-    string wine_bin_path = active_bottle_->wine_bin_path();
-    auto winetricks_env_vars = get_winetricks_env_vars();
-    bool is_debug_logging = active_bottle_->is_debug_logging();
-    int debug_log_level = active_bottle_->debug_log_level();
-    string program = Helper::get_winetricks_location() + " -q " + package;
-    // finished_package_install_dispatcher signal is needed in order to close the busy dialog again
-    std::thread t(
-        [wine_prefix, wine_bin_path, winetricks_env_vars, debug_log_level, program, logging_stderr = std::move(is_logging_stderr_),
-         debug_logging = std::move(is_debug_logging), output_logging_mutex = std::ref(output_loging_mutex_),
-         logging_bottle_prefix = std::ref(logging_bottle_prefix_), output_logging = std::ref(output_logging_),
-         write_log_dispatcher = &write_log_dispatcher_, finish_dispatcher = &finished_package_install_dispatcher]
-        {
-          string output = Helper::run_program(wine_prefix, debug_log_level, program, "", winetricks_env_vars, true, logging_stderr);
-          if (debug_logging && !output.empty())
-          {
-            {
-              std::lock_guard<std::mutex> lock(output_logging_mutex);
-              logging_bottle_prefix.get() = wine_prefix;
-              output_logging.get() = output;
-            }
-            write_log_dispatcher->emit();
-          }
-          Helper::wait_until_wineserver_is_terminated(wine_prefix, wine_bin_path);
-          finish_dispatcher->emit();
-        });
-    t.detach();
+    queue_winetricks_verbs({package});
   }
 }
 
@@ -1333,33 +1599,7 @@ void BottleManager::install_vkd3d(Gtk::Window* parent)
     main_window_.show_busy_install_dialog(*parent, "Installing VKD3D (Vulkan-based implementation of DirectX 12).\n");
 
     string package = "vkd3d";
-    string wine_prefix = active_bottle_->wine_location();
-    string wine_bin_path = active_bottle_->wine_bin_path();
-    auto winetricks_env_vars = get_winetricks_env_vars();
-    bool is_debug_logging = active_bottle_->is_debug_logging();
-    int debug_log_level = active_bottle_->debug_log_level();
-    string program = Helper::get_winetricks_location() + " -q " + package;
-    // finished_package_install_dispatcher signal is needed in order to close the busy dialog again
-    std::thread t(
-        [wine_prefix, wine_bin_path, winetricks_env_vars, debug_log_level, program, logging_stderr = std::move(is_logging_stderr_),
-         debug_logging = std::move(is_debug_logging), output_logging_mutex = std::ref(output_loging_mutex_),
-         logging_bottle_prefix = std::ref(logging_bottle_prefix_), output_logging = std::ref(output_logging_),
-         write_log_dispatcher = &write_log_dispatcher_, finish_dispatcher = &finished_package_install_dispatcher]
-        {
-          string output = Helper::run_program(wine_prefix, debug_log_level, program, "", winetricks_env_vars, true, logging_stderr);
-          if (debug_logging && !output.empty())
-          {
-            {
-              std::lock_guard<std::mutex> lock(output_logging_mutex);
-              logging_bottle_prefix.get() = wine_prefix;
-              output_logging.get() = output;
-            }
-            write_log_dispatcher->emit();
-          }
-          Helper::wait_until_wineserver_is_terminated(wine_prefix, wine_bin_path);
-          finish_dispatcher->emit();
-        });
-    t.detach();
+    queue_winetricks_verbs({package});
   }
 }
 
@@ -1376,33 +1616,7 @@ void BottleManager::install_visual_cpp_package(Gtk::Window* parent, const string
     main_window_.show_busy_install_dialog(*parent, "Installing Visual C++ package (" + version + ").");
 
     string package = "vcrun" + version;
-    string wine_prefix = active_bottle_->wine_location();
-    string wine_bin_path = active_bottle_->wine_bin_path();
-    auto winetricks_env_vars = get_winetricks_env_vars();
-    bool is_debug_logging = active_bottle_->is_debug_logging();
-    int debug_log_level = active_bottle_->debug_log_level();
-    string program = Helper::get_winetricks_location() + " -q " + package;
-    // finished_package_install_dispatcher signal is needed in order to close the busy dialog again
-    std::thread t(
-        [wine_prefix, wine_bin_path, winetricks_env_vars, debug_log_level, program, logging_stderr = std::move(is_logging_stderr_),
-         debug_logging = std::move(is_debug_logging), output_logging_mutex = std::ref(output_loging_mutex_),
-         logging_bottle_prefix = std::ref(logging_bottle_prefix_), output_logging = std::ref(output_logging_),
-         write_log_dispatcher = &write_log_dispatcher_, finish_dispatcher = &finished_package_install_dispatcher]
-        {
-          string output = Helper::run_program(wine_prefix, debug_log_level, program, "", winetricks_env_vars, true, logging_stderr);
-          if (debug_logging && !output.empty())
-          {
-            {
-              std::lock_guard<std::mutex> lock(output_logging_mutex);
-              logging_bottle_prefix.get() = wine_prefix;
-              output_logging.get() = output;
-            }
-            write_log_dispatcher->emit();
-          }
-          Helper::wait_until_wineserver_is_terminated(wine_prefix, wine_bin_path);
-          finish_dispatcher->emit();
-        });
-    t.detach();
+    queue_winetricks_verbs({package});
   }
 }
 
@@ -1450,26 +1664,16 @@ void BottleManager::install_dot_net(Gtk::Window* parent, const string& version)
               program = install_command;
             }
             // finished_package_install_dispatcher signal is needed in order to close the busy dialog again
-            std::thread t(
+            job_scheduler_.submit(
+                "Install .NET", wine_prefix, JobScheduler::Lock::Exclusive,
                 [wine_prefix, wine_bin_path, winetricks_env_vars, debug_log_level, program, logging_stderr = std::move(is_logging_stderr_),
-                 debug_logging = std::move(is_debug_logging), output_logging_mutex = std::ref(output_loging_mutex_),
-                 logging_bottle_prefix = std::ref(logging_bottle_prefix_), output_logging = std::ref(output_logging_),
-                 write_log_dispatcher = &write_log_dispatcher_, finish_dispatcher = &finished_package_install_dispatcher]
+                 output_sink = create_output_sink(wine_prefix, is_debug_logging), finish_dispatcher = &finished_package_install_dispatcher]
                 {
-                  string output = Helper::run_program(wine_prefix, debug_log_level, program, "", winetricks_env_vars, true, logging_stderr);
-                  if (debug_logging && !output.empty())
-                  {
-                    {
-                      std::lock_guard<std::mutex> lock(output_logging_mutex);
-                      logging_bottle_prefix.get() = wine_prefix;
-                      output_logging.get() = output;
-                    }
-                    write_log_dispatcher->emit();
-                  }
+                  Helper::run_program(wine_prefix, debug_log_level, program, "", winetricks_env_vars, true, logging_stderr, nullptr, output_sink);
                   Helper::wait_until_wineserver_is_terminated(wine_prefix, wine_bin_path);
                   finish_dispatcher->emit();
-                });
-            t.detach();
+                },
+                [finish_dispatcher = &finished_package_install_dispatcher] { finish_dispatcher->emit(); });
           }
         });
   }
@@ -1507,26 +1711,16 @@ void BottleManager::install_mono(Gtk::Window* parent)
     // First deinstall Mono (if present) then let Wine (re)install it
     string program = (!deinstall_command.empty()) ? (deinstall_command + "; " + install_command) : install_command;
     // finished_package_install_dispatcher signal is needed in order to close the busy dialog again
-    std::thread t(
+    job_scheduler_.submit(
+        "Install Wine Mono", wine_prefix, JobScheduler::Lock::Exclusive,
         [wine_prefix, wine_bin_path, winetricks_env_vars, debug_log_level, program, logging_stderr = std::move(is_logging_stderr_),
-         debug_logging = std::move(is_debug_logging), output_logging_mutex = std::ref(output_loging_mutex_),
-         logging_bottle_prefix = std::ref(logging_bottle_prefix_), output_logging = std::ref(output_logging_),
-         write_log_dispatcher = &write_log_dispatcher_, finish_dispatcher = &finished_package_install_dispatcher]
+         output_sink = create_output_sink(wine_prefix, is_debug_logging), finish_dispatcher = &finished_package_install_dispatcher]
         {
-          string output = Helper::run_program(wine_prefix, debug_log_level, program, "", winetricks_env_vars, true, logging_stderr);
-          if (debug_logging && !output.empty())
-          {
-            {
-              std::lock_guard<std::mutex> lock(output_logging_mutex);
-              logging_bottle_prefix.get() = wine_prefix;
-              output_logging.get() = output;
-            }
-            write_log_dispatcher->emit();
-          }
+          Helper::run_program(wine_prefix, debug_log_level, program, "", winetricks_env_vars, true, logging_stderr, nullptr, output_sink);
           Helper::wait_until_wineserver_is_terminated(wine_prefix, wine_bin_path);
           finish_dispatcher->emit();
-        });
-    t.detach();
+        },
+        [finish_dispatcher = &finished_package_install_dispatcher] { finish_dispatcher->emit(); });
   }
 }
 
@@ -1541,33 +1735,7 @@ void BottleManager::install_core_fonts(Gtk::Window* parent)
     // Before we execute the install, show busy dialog
     main_window_.show_busy_install_dialog(*parent, "Installing MS Core fonts.");
 
-    string wine_prefix = active_bottle_->wine_location();
-    string wine_bin_path = active_bottle_->wine_bin_path();
-    auto winetricks_env_vars = get_winetricks_env_vars();
-    bool is_debug_logging = active_bottle_->is_debug_logging();
-    int debug_log_level = active_bottle_->debug_log_level();
-    string program = Helper::get_winetricks_location() + " -q corefonts";
-    // finished_package_install_dispatcher signal is needed in order to close the busy dialog again
-    std::thread t(
-        [wine_prefix, wine_bin_path, winetricks_env_vars, debug_log_level, program, logging_stderr = std::move(is_logging_stderr_),
-         debug_logging = std::move(is_debug_logging), output_logging_mutex = std::ref(output_loging_mutex_),
-         logging_bottle_prefix = std::ref(logging_bottle_prefix_), output_logging = std::ref(output_logging_),
-         write_log_dispatcher = &write_log_dispatcher_, finish_dispatcher = &finished_package_install_dispatcher]
-        {
-          string output = Helper::run_program(wine_prefix, debug_log_level, program, "", winetricks_env_vars, true, logging_stderr);
-          if (debug_logging && !output.empty())
-          {
-            {
-              std::lock_guard<std::mutex> lock(output_logging_mutex);
-              logging_bottle_prefix.get() = wine_prefix;
-              output_logging.get() = output;
-            }
-            write_log_dispatcher->emit();
-          }
-          Helper::wait_until_wineserver_is_terminated(wine_prefix, wine_bin_path);
-          finish_dispatcher->emit();
-        });
-    t.detach();
+    queue_winetricks_verbs({"corefonts"});
   }
 }
 
@@ -1582,33 +1750,7 @@ void BottleManager::install_liberation(Gtk::Window* parent)
     // Before we execute the install, show busy dialog
     main_window_.show_busy_install_dialog(*parent, "Installing Liberation open-source fonts.");
 
-    string wine_prefix = active_bottle_->wine_location();
-    string wine_bin_path = active_bottle_->wine_bin_path();
-    auto winetricks_env_vars = get_winetricks_env_vars();
-    bool is_debug_logging = active_bottle_->is_debug_logging();
-    int debug_log_level = active_bottle_->debug_log_level();
-    string program = Helper::get_winetricks_location() + " -q liberation";
-    // finished_package_install_dispatcher signal is needed in order to close the busy dialog again
-    std::thread t(
-        [wine_prefix, wine_bin_path, winetricks_env_vars, debug_log_level, program, logging_stderr = std::move(is_logging_stderr_),
-         debug_logging = std::move(is_debug_logging), output_logging_mutex = std::ref(output_loging_mutex_),
-         logging_bottle_prefix = std::ref(logging_bottle_prefix_), output_logging = std::ref(output_logging_),
-         write_log_dispatcher = &write_log_dispatcher_, finish_dispatcher = &finished_package_install_dispatcher]
-        {
-          string output = Helper::run_program(wine_prefix, debug_log_level, program, "", winetricks_env_vars, true, logging_stderr);
-          if (debug_logging && !output.empty())
-          {
-            {
-              std::lock_guard<std::mutex> lock(output_logging_mutex);
-              logging_bottle_prefix.get() = wine_prefix;
-              output_logging.get() = output;
-            }
-            write_log_dispatcher->emit();
-          }
-          Helper::wait_until_wineserver_is_terminated(wine_prefix, wine_bin_path);
-          finish_dispatcher->emit();
-        });
-    t.detach();
+    queue_winetricks_verbs({"liberation"});
   }
 }
 
@@ -1637,9 +1779,61 @@ bool BottleManager::is_bottle_not_null()
   {
     main_window_.show_error_message("No Windows Machine selected/empty. First create a new machine!\n\nAborted.");
   }
+  else if (active_bottle_->is_loading())
+  {
+    main_window_.show_error_message("The Windows Machine is still loading. Please try again in a moment.\n\nAborted.");
+    return false;
+  }
   return !is_null;
 }
 
+/**
+ * \brief Run the deduplication of the bottles in a job, the result is handled by on_deduplication_finished()
+ * \param[in] is_dry_run Only search for the identical files, don't change any file
+ * \param[in] allow_hard_links Replace the read-only identical files by hard links, when their data can't be shared
+ */
+void BottleManager::run_deduplication(bool is_dry_run, bool allow_hard_links)
+{
+  std::vector<string> prefix_paths;
+  {
+    std::lock_guard<std::mutex> lock(deduplication_mutex_);
+    prefix_paths = deduplication_prefix_paths_;
+  }
+  job_scheduler_.submit(is_dry_run ? "Search identical files" : "Deduplicate files", "", JobScheduler::Lock::None,
+                        [this, prefix_paths, is_dry_run, allow_hard_links]
+                        {
+                          BottleDeduplicator::Options options;
+                          options.is_dry_run = is_dry_run;
+                          options.allow_hard_links = allow_hard_links;
+                          BottleDeduplicator::Report report;
+                          Glib::ustring error_message;
+                          try
+                          {
+                            report = BottleDeduplicator::get_instance().deduplicate(prefix_paths, options, is_deduplication_cancelled_);
+                          }
+                          catch (const std::runtime_error& error)
+                          {
+                            error_message = error.what();
+                          }
+                          {
+                            std::lock_guard<std::mutex> lock(deduplication_mutex_);
+                            is_deduplication_dry_run_ = is_dry_run;
+                            is_deduplication_hard_links_ = allow_hard_links;
+                            deduplication_report_ = report;
+                            error_message_deduplication_ = error_message;
+                          }
+                          deduplication_finished_dispatcher_.emit();
+                        },
+                        [this]
+                        {
+                          {
+                            std::lock_guard<std::mutex> lock(deduplication_mutex_);
+                            is_deduplication_job_cancelled_ = true;
+                          }
+                          deduplication_finished_dispatcher_.emit();
+                        });
+}
+
 /**
  * \brief Environment variables to make winetricks (and Wine itself) use the bottle's custom Wine build (if set).
  * Winetricks honors the WINE & WINESERVER environment variables, without them it would silently use the system Wine.
@@ -1684,25 +1878,6 @@ string BottleManager::get_deinstall_mono_command()
   return command;
 }
 
-/**
- * \brief Try to get Wine version
- * \return Wine version
- */
-string BottleManager::get_wine_version(const string& prefix_path, const string& wine_bin_path, bool use_wine64)
-{
-  string wine_version = "?";
-  try
-  {
-    // Use the per-bottle wine64 opt-in (runners ignore it and prefer the unified wine binary anyway)
-    wine_version = Helper::get_wine_version(use_wine64, prefix_path, wine_bin_path);
-  }
-  catch (const std::runtime_error& error)
-  {
-    main_window_.show_error_message(error.what());
-  }
-  return wine_version;
-}
-
 /**
  * \brief Get Bottle Paths
  * \throws runtime_error when we can not created a Wine bottle directory or configuration folder could not be found
@@ -1733,104 +1908,418 @@ std::vector<string> BottleManager::get_bottle_paths()
 
 /**
  * \brief Create wine BottleItem objects and add them to a list.
+ * Bottles in the snapshot (see BottleDetailsCache) are shown with all their details right away, the other
+ * bottles are shown as a placeholder (showing the folder name only) until the refresh thread read their details.
  * \param[in] bottle_dirs  The list of bottle directories
- * \returns Array of Bottle Items
+ * \returns Array of Bottle Items (in the same order as the bottle directories)
  */
 std::list<BottleItem> BottleManager::create_wine_bottles(const std::vector<string>& bottle_dirs)
 {
   std::list<BottleItem> bottles;
-
-  // Retrieve detailed info for each wine bottle prefix
   for (const string& prefix : bottle_dirs)
   {
-    // Reset variables
-    Glib::ustring folder_name = "";
-    Glib::ustring virtual_desktop = "";
-    BottleTypes::Bit bit = BottleTypes::Bit::win32;
-    Glib::ustring c_drive_location = "- Unknown -";
-    Glib::ustring last_time_wine_updated = "- Unknown -";
-    BottleTypes::AudioDriver audio_driver = BottleTypes::AudioDriver::pulseaudio;
-    BottleTypes::Windows windows = WineDefaults::WindowsOs;
-    bool status = false;
-
-    // Retrieve bottle config data & custom app list
-    BottleConfigData bottle_config;
-    std::map<int, ApplicationData> bottle_app_list;
-    std::tie(bottle_config, bottle_app_list) = BottleConfigFile::read_config_file(prefix);
-
-    try
+    BottleItem bottle(Helper::get_folder_name(prefix), prefix);
+    if (std::optional<BottleDetailsData> snapshot = BottleDetailsCache::get_instance().get(prefix, BottleDetailsCache::get_file_stamps(prefix)))
     {
-      folder_name = Helper::get_folder_name(prefix);
+      set_bottle_details(bottle, snapshot.value());
     }
-    catch (const std::runtime_error& error)
+    // The copy (constructor) creates the GUI of the row
+    bottles.emplace_back(bottle);
+  }
+  return bottles;
+}
+
+/**
+ * \brief Set the bottle details to a bottle item (and mark it as loaded), the GUI of the row is not updated
+ * \param[in] bottle  Bottle item
+ * \param[in] details  Bottle details
+ */
+void BottleManager::set_bottle_details(BottleItem& bottle, const BottleDetailsData& details)
+{
+  bottle.name(details.config.name);
+  bottle.folder_name(details.folder_name);
+  bottle.wine_bin_path(details.config.wine_bin_path);
+  bottle.description(details.config.description);
+  bottle.status(details.status);
+  bottle.windows(details.windows);
+  bottle.bit(details.bit);
+  bottle.wine_version(details.wine_version);
+  // Informational only: whether the system Wine provides a separate wine64 binary. The actual binary
+  // selection is driven by the per-bottle use_wine64 opt-in (default: the unified wine binary).
+  bottle.is_wine64_bit(details.config.wine_bin_path.empty() ? is_wine64_bit_ : true);
+  bottle.use_wine64(details.config.use_wine64);
+  bottle.wine_c_drive(details.c_drive_location);
+  bottle.wine_last_changed(details.last_time_wine_updated);
+  bottle.audio_driver(details.audio_driver);
+  bottle.virtual_desktop(details.virtual_desktop);
+  bottle.is_debug_logging(details.config.logging_enabled);
+  bottle.debug_log_level(details.config.debug_log_level);
+  bottle.env_vars(details.config.env_vars);
+  bottle.app_list(details.app_list);
+  bottle.is_loading(false);
+}
+
+/**
+ * \brief Create the destination of the output of a program that is run within a thread.
+ * The output is never collected in memory: it's either discarded or (when debug logging is enabled) buffered in a
+ * fixed-size ring buffer, which is written to the log file by the log writer thread.
+ * \param[in] prefix_path Bottle prefix path
+ * \param[in] is_debug_logging Write the output to the log file of the bottle
+ * \return Output callback, which can be used by any thread (until the program is finished)
+ */
+std::function<void(std::string_view output)> BottleManager::create_output_sink(const string& prefix_path, bool is_debug_logging)
+{
+  if (!is_debug_logging)
+    return [](std::string_view) {};
+
+  auto output = std::make_shared<OutputRingBuffer>(ProgramLogBufferSize);
+  log_writer_->add_output(prefix_path, output);
+
+  // Mark the output as finished once the last copy of the callback is destroyed (the program is finished)
+  struct OutputWriter
+  {
+    std::shared_ptr<OutputRingBuffer> output;
+    std::shared_ptr<LogWriter> log_writer;
+    ~OutputWriter()
     {
-      main_window_.show_error_message(error.what());
+      output->close();
+      log_writer->notify();
     }
+  };
+  auto writer = std::make_shared<OutputWriter>(output, log_writer_);
+  return [writer](std::string_view data)
+  {
+    // Only notify the log writer when there wasn't any pending output already
+    if (writer->output->write(data))
+      writer->log_writer->notify();
+  };
+}
 
-    try
+/**
+ * \brief Queue winetricks verbs for the active bottle. Verbs of the same bottle that are queued before the install job
+ * started are added to that job, so all of them are installed by a single winetricks run (and a single wineserver wait).
+ * \param[in] verbs Winetricks verbs
+ */
+void BottleManager::queue_winetricks_verbs(const std::vector<string>& verbs)
+{
+  string wine_prefix = active_bottle_->wine_location();
+  {
+    std::lock_guard<std::mutex> lock(pending_winetricks_verbs_mutex_);
+    auto pending = pending_winetricks_verbs_.find(wine_prefix);
+    if (pending != pending_winetricks_verbs_.end())
     {
-      bit = Helper::get_windows_bitness(prefix);
+      // The install job of the bottle is still queued, it will install these verbs as well
+      for (const string& verb : verbs)
+      {
+        if (std::find(pending->second.begin(), pending->second.end(), verb) == pending->second.end())
+          pending->second.push_back(verb);
+      }
+      return;
     }
-    catch (const std::runtime_error& error)
+    pending_winetricks_verbs_.emplace(wine_prefix, verbs);
+  }
+
+  string wine_bin_path = active_bottle_->wine_bin_path();
+  auto winetricks_env_vars = get_winetricks_env_vars();
+  bool is_debug_logging = active_bottle_->is_debug_logging();
+  int debug_log_level = active_bottle_->debug_log_level();
+  // finished_package_install_dispatcher signal is needed in order to close the busy dialog again
+  job_scheduler_.submit(
+      "Install packages", wine_prefix, JobScheduler::Lock::Exclusive,
+      [this, wine_prefix, wine_bin_path, winetricks_env_vars, debug_log_level, logging_stderr = std::move(is_logging_stderr_),
+       output_sink = create_output_sink(wine_prefix, is_debug_logging), finish_dispatcher = &finished_package_install_dispatcher]
+      {
+        // Take all the verbs queued so far, verbs that are queued from now on get a new install job
+        std::vector<string> verbs;
+        {
+          std::lock_guard<std::mutex> lock(pending_winetricks_verbs_mutex_);
+          auto pending = pending_winetricks_verbs_.find(wine_prefix);
+          if (pending != pending_winetricks_verbs_.end())
+          {
+            verbs = std::move(pending->second);
+            pending_winetricks_verbs_.erase(pending);
+          }
+        }
+        Helper::run_program(wine_prefix, debug_log_level, get_winetricks_install_command(verbs), "", winetricks_env_vars, true, logging_stderr,
+                            nullptr, output_sink);
+        Helper::wait_until_wineserver_is_terminated(wine_prefix, wine_bin_path);
+
+        if (std::find(verbs.begin(), verbs.end(), "galliumnine") != verbs.end())
+        {
+          // When the install actually succeeded (winetricks ran ninewinecfg -e, which sets the 'd3d9'
+          // DLL override), add a custom app shortcut for the Gallium Nine settings GUI (ninewinecfg.exe),
+          // so the user can enable/disable Gallium Nine afterwards (and remove the shortcut again if desired)
+          bool added_shortcut = false;
+          try
+          {
+            if (Helper::get_dll_override(wine_prefix, "d3d9"))
+            {
+              added_shortcut = BottleManager::add_gallium_nine_shortcut(wine_prefix);
+            }
+          }
+          catch (const std::runtime_error& error)
+          {
+            std::cout << "Error: " << error.what() << std::endl;
+          }
+          if (added_shortcut)
+          {
+            // Refresh the bottles so the new app shortcut shows up in the application list
+            update_bottles_dispatcher_.emit();
+          }
+        }
+        finish_dispatcher->emit();
+      },
+      [this, wine_prefix, finish_dispatcher = &finished_package_install_dispatcher]
+      {
+        {
+          std::lock_guard<std::mutex> lock(pending_winetricks_verbs_mutex_);
+          pending_winetricks_verbs_.erase(wine_prefix);
+        }
+        finish_dispatcher->emit();
+      });
+}
+
+/**
+ * \brief Get the winetricks command that installs the verbs (unattended)
+ * \param[in] verbs Winetricks verbs
+ * \return Winetricks command
+ */
+string BottleManager::get_winetricks_install_command(const std::vector<string>& verbs)
+{
+  string program = Helper::get_winetricks_location() + " -q";
+  for (const string& verb : verbs)
+  {
+    program += " " + Glib::shell_quote(verb);
+  }
+  return program;
+}
+
+/**
+ * \brief Read the details of the bottles in a separate thread, the rows are updated via the bottle details loaded dispatcher
+ * \param[in] bottle_dirs  The list of bottle directories to read
+ * \param[in] bottle_indexes  Index of the row in the bottle list, for each bottle directory
+ */
+void BottleManager::read_bottles_details(const std::vector<string>& bottle_dirs, const std::vector<std::size_t>& bottle_indexes)
+{
+  is_refresh_bottles_cancelled_ = false;
+  thread_refresh_bottles_ = std::make_unique<std::thread>(
+      [this, bottle_dirs, bottle_indexes]
+      {
+        // The registry file cache is kept up-to-date by the bottle watchers (see on_bottle_changes_timeout) and
+        // validated against the file status on every lookup, so there is no blanket clear for every refresh.
+        // The entries of a bottle are only dropped once its details are collected (they are kept in the bottle list).
+        get_bottles_details(bottle_dirs,
+                            [this, &bottle_dirs, &bottle_indexes](std::size_t index, BottleDetailsData details)
+                            {
+                              Helper::invalidate_reg_cache(bottle_dirs[index]);
+                              {
+                                std::lock_guard<std::mutex> lock(loaded_bottles_details_mutex_);
+                                loaded_bottles_details_.emplace_back(bottle_indexes[index], std::move(details));
+                              }
+                              this->bottle_details_loaded_dispatcher_.emit();
+                              return !is_refresh_bottles_cancelled_;
+                            });
+        BottleDetailsCache::get_instance().save();
+        this->refresh_bottles_finished_dispatcher_.emit(); // Clean-up the thread pointer
+      });
+}
+
+/**
+ * \brief Watch the bottle location (for added/removed bottles) and the files of every bottle (for changed details)
+ * \param[in] bottle_dirs  The list of bottle directories
+ */
+void BottleManager::watch_bottles(const std::vector<string>& bottle_dirs)
+{
+  try
+  {
+    if (!bottle_location_monitor_ || bottle_location_monitored_ != bottle_location_)
     {
-      main_window_.show_error_message(error.what());
+      bottle_location_monitor_ = Gio::File::create_for_path(bottle_location_)->monitor_directory(Gio::FileMonitorFlags::WATCH_MOVES);
+      bottle_location_monitor_->signal_changed().connect(sigc::mem_fun(*this, &BottleManager::on_bottle_location_changed));
+      bottle_location_monitored_ = bottle_location_;
     }
+  }
+  catch (const Glib::Error& ex)
+  {
+    std::cerr << "Error: Could not watch the bottle location: " << ex.what() << std::endl;
+  }
+
+  // Stop watching removed bottles
+  std::erase_if(bottle_monitors_, [&bottle_dirs](const auto& monitor)
+                { return std::find(bottle_dirs.begin(), bottle_dirs.end(), monitor.first) == bottle_dirs.end(); });
+  for (const string& prefix : bottle_dirs)
+  {
+    if (bottle_monitors_.contains(prefix))
+      continue;
     try
     {
-      c_drive_location = Helper::get_c_letter_drive(prefix);
-    }
-    catch (const std::runtime_error& error)
-    {
-      main_window_.show_error_message(error.what());
+      // Watch the prefix directory itself, Wine replaces the registry files (instead of writing them in place)
+      auto monitor = Gio::File::create_for_path(prefix)->monitor_directory(Gio::FileMonitorFlags::WATCH_MOVES);
+      monitor->signal_changed().connect(
+          [this, prefix](const Glib::RefPtr<Gio::File>& file, const Glib::RefPtr<Gio::File>& other_file, Gio::FileMonitor::Event event)
+          { on_bottle_files_changed(prefix, file, other_file, event); });
+      bottle_monitors_.emplace(prefix, monitor);
     }
-    try
+    catch (const Glib::Error& ex)
     {
-      last_time_wine_updated = Helper::get_last_wine_updated(prefix);
+      std::cerr << "Error: Could not watch bottle " << prefix << ": " << ex.what() << std::endl;
     }
-    catch (const std::runtime_error& error)
+  }
+}
+
+/**
+ * \brief (Re)start the debounce timer, so a burst of changes (eg. Wine writing all its registry files) is handled at once
+ */
+void BottleManager::schedule_bottle_changes()
+{
+  int time_interval = 500; // ms
+  bottle_changes_timeout_.disconnect();
+  bottle_changes_timeout_ = Glib::signal_timeout().connect(sigc::mem_fun(*this, &BottleManager::on_bottle_changes_timeout), time_interval);
+}
+
+/**
+ * \brief Gather the details of multiple bottles, using a bounded pool of worker threads.
+ * Every bottle costs a couple of (registry) file reads and a Wine process (wine --version), so the
+ * bottles are spread over the workers. The bottles are picked up in the order of the bottle directories,
+ * so the first bottles (in the list) are also the first to be completed.
+ * \param[in] bottle_dirs  The list of bottle directories
+ * \param[in] on_bottle_details  Called (from a worker thread) with the index of the bottle directory and its details
+ * as soon as a bottle is completed. Return false to stop gathering the remaining bottles.
+ */
+void BottleManager::get_bottles_details(const std::vector<string>& bottle_dirs,
+                                        const std::function<bool(std::size_t index, BottleDetailsData details)>& on_bottle_details)
+{
+  std::atomic<std::size_t> next_index = 0;
+  std::atomic<bool> is_stopped = false;
+  auto worker = [&bottle_dirs, &on_bottle_details, &next_index, &is_stopped]
+  {
+    for (std::size_t index = next_index++; index < bottle_dirs.size() && !is_stopped; index = next_index++)
     {
-      main_window_.show_error_message(error.what());
+      if (!on_bottle_details(index, get_bottle_details(bottle_dirs[index])))
+        is_stopped = true;
     }
+  };
+
+  // Limit to the number of cores (at least 2, the work is partially I/O bound)
+  std::size_t worker_count = std::min<std::size_t>(std::max(std::thread::hardware_concurrency(), 2U), bottle_dirs.size());
+  std::vector<std::thread> workers;
+  workers.reserve(worker_count);
+  for (std::size_t i = 1; i < worker_count; ++i)
+  {
+    workers.emplace_back(worker);
+  }
+  // The calling thread is also one of the workers
+  worker();
+  for (std::thread& thread : workers)
+  {
+    thread.join();
+  }
+}
+
+/**
+ * \brief Read all the details of a single bottle from disk (thread-safe, no GUI calls).
+ * The details are taken from the snapshot when the bottle files are unchanged, otherwise the bottle is read
+ * again and the snapshot is updated. Errors do not stop the gathering, instead they are collected in the error_messages field.
+ * \param[in] prefix_path  Bottle prefix
+ * \returns Bottle details
+ */
+BottleDetailsData BottleManager::get_bottle_details(const string& prefix_path)
+{
+  BottleDetailsCache& snapshot_cache = BottleDetailsCache::get_instance();
+  // Taken before reading, so a file that changes during the read invalidates the snapshot entry again
+  std::vector<string> file_stamps = BottleDetailsCache::get_file_stamps(prefix_path);
+  if (std::optional<BottleDetailsData> snapshot = snapshot_cache.get(prefix_path, file_stamps))
+  {
     try
     {
-      audio_driver = Helper::get_audio_driver(prefix);
-    }
-    catch (const std::runtime_error& error)
-    {
-      main_window_.show_error_message(error.what());
-    }
-    {
-      std::tuple<bool, BottleTypes::Windows, std::string> result = Helper::get_bottle_status_and_windows_version(prefix);
-      status = std::get<0>(result);
-      windows = std::get<1>(result);
-      if (!status)
+      // Only the Wine version is not covered by the snapshot (eg. Wine is upgraded), it is cached per Wine binary anyway
+      string wine_version = Helper::get_wine_version(snapshot->config.use_wine64, prefix_path, snapshot->config.wine_bin_path);
+      if (wine_version != snapshot->wine_version)
       {
-        main_window_.show_error_message(std::get<2>(result));
+        snapshot->wine_version = wine_version;
+        snapshot->is_snapshot = false;
+        snapshot_cache.put(snapshot.value(), file_stamps);
       }
+      return snapshot.value();
     }
-    try
+    catch (const std::runtime_error&)
     {
-      virtual_desktop = Helper::get_virtual_desktop(prefix);
+      // Read the whole bottle again below, which reports the error
     }
-    catch (const std::runtime_error& error)
+  }
+
+  BottleDetailsData details;
+  details.prefix_path = prefix_path;
+
+  // Retrieve bottle config data & custom app list
+  std::tie(details.config, details.app_list) = BottleConfigFile::read_config_file(prefix_path);
+
+  try
+  {
+    details.folder_name = Helper::get_folder_name(prefix_path);
+  }
+  catch (const std::runtime_error& error)
+  {
+    details.error_messages.emplace_back(error.what());
+  }
+  try
+  {
+    details.bit = Helper::get_windows_bitness(prefix_path);
+  }
+  catch (const std::runtime_error& error)
+  {
+    details.error_messages.emplace_back(error.what());
+  }
+  try
+  {
+    details.c_drive_location = Helper::get_c_letter_drive(prefix_path);
+  }
+  catch (const std::runtime_error& error)
+  {
+    details.error_messages.emplace_back(error.what());
+  }
+  try
+  {
+    details.last_time_wine_updated = Helper::get_last_wine_updated(prefix_path);
+  }
+  catch (const std::runtime_error& error)
+  {
+    details.error_messages.emplace_back(error.what());
+  }
+  try
+  {
+    details.audio_driver = Helper::get_audio_driver(prefix_path);
+  }
+  catch (const std::runtime_error& error)
+  {
+    details.error_messages.emplace_back(error.what());
+  }
+  {
+    std::tuple<bool, BottleTypes::Windows, std::string> result = Helper::get_bottle_status_and_windows_version(prefix_path);
+    details.status = std::get<0>(result);
+    details.windows = std::get<1>(result);
+    if (!details.status)
     {
-      main_window_.show_error_message(error.what());
+      details.error_messages.emplace_back(std::get<2>(result));
     }
-
-    // Convert to Glib ustrings
-    Glib::ustring name(bottle_config.name);
-    Glib::ustring wine_bin_path_u(bottle_config.wine_bin_path);
-    Glib::ustring description(bottle_config.description);
-    Glib::ustring prefix_path(prefix);
-    Glib::ustring wine_version = get_wine_version(prefix, bottle_config.wine_bin_path, bottle_config.use_wine64);
-    // Informational only: whether the system Wine provides a separate wine64 binary. The actual binary
-    // selection is driven by the per-bottle use_wine64 opt-in (default: the unified wine binary).
-    bool is_bottle_wine64_bit = bottle_config.wine_bin_path.empty() ? is_wine64_bit_ : true;
-    BottleItem* bottle =
-        new BottleItem(name, folder_name, wine_bin_path_u, description, status, windows, bit, wine_version, is_bottle_wine64_bit, prefix_path,
-                       c_drive_location, last_time_wine_updated, audio_driver, virtual_desktop, bottle_config.logging_enabled,
-                       bottle_config.debug_log_level, bottle_config.use_wine64, bottle_config.env_vars, bottle_app_list);
-    bottles.emplace_back(*bottle);
   }
-  return bottles;
+  try
+  {
+    details.virtual_desktop = Helper::get_virtual_desktop(prefix_path);
+  }
+  catch (const std::runtime_error& error)
+  {
+    details.error_messages.emplace_back(error.what());
+  }
+  try
+  {
+    // Use the per-bottle wine64 opt-in (runners ignore it and prefer the unified wine binary anyway)
+    details.wine_version = Helper::get_wine_version(details.config.use_wine64, prefix_path, details.config.wine_bin_path);
+  }
+  catch (const std::runtime_error& error)
+  {
+    details.error_messages.emplace_back(error.what());
+  }
+  snapshot_cache.put(details, file_stamps);
+  return details;
 }
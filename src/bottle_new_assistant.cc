@@ -44,6 +44,7 @@ BottleNewAssistant::BottleNewAssistant()
       confirm_label("Confirmation page"),
       virtual_desktop_check("Enable Virtual Desktop Window"),
       disable_gecko_mono_check("Disable Gecko & Mono"),
+      gaming_packages_check("Install gaming packages (Visual C++ 2022, D3DX9, DXVK, MS Core & Liberation fonts)"),
       manage_runners_button("Manage runners...")
 {
   set_default_size(640, 400);
@@ -113,6 +114,7 @@ void BottleNewAssistant::set_default_values()
   audio_driver_combobox.set_active_id(std::to_string(BottleTypes::DefaultAudioDriverIndex));
   virtual_desktop_check.set_active(false);
   disable_gecko_mono_check.set_active(false);
+  gaming_packages_check.set_active(false);
   virtual_desktop_resolution_entry.set_text("1024x768");
   loading_bar.set_fraction(0.0);
   // Hide resolution label & entry
@@ -224,6 +226,7 @@ void BottleNewAssistant::create_third_page()
   vbox2.append(hbox_virtual_desktop);
 
   vbox2.append(disable_gecko_mono_check);
+  vbox2.append(gaming_packages_check);
 
   append_page(vbox2);
   set_page_complete(vbox2, true);
@@ -325,6 +328,7 @@ NewBottleStruct BottleNewAssistant::get_result()
   auto name = name_entry.get_text();
   auto vd_res = Glib::ustring("");
   auto disable_gecko_mono = false;
+  auto install_gaming_packages = false;
   auto wine_bin_path = Glib::ustring("");
 
   // An installed Wine runner selection carries the wine binary directory as ID ("system" = system Wine)
@@ -364,6 +368,7 @@ NewBottleStruct BottleNewAssistant::get_result()
   }
 
   disable_gecko_mono = disable_gecko_mono_check.get_active();
+  install_gaming_packages = gaming_packages_check.get_active();
 
   try
   {
@@ -380,7 +385,7 @@ NewBottleStruct BottleNewAssistant::get_result()
   catch (const std::out_of_range& e)
   {
   }
-  return {name, windows_version, bit, vd_res, disable_gecko_mono, audio, wine_bin_path};
+  return {name, windows_version, bit, vd_res, disable_gecko_mono, audio, wine_bin_path, install_gaming_packages};
 }
 
 /**
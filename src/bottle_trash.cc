@@ -0,0 +1,298 @@
+/**
+ * Copyright (c) 2026 WineGUI
+ *
+ * \file    bottle_trash.cc
+ * \brief   Removes deleted Wine bottles in the background
+ * \author  Melroy van den Berg <webmaster1989@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "bottle_trash.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <dirent.h>
+#include <fcntl.h>
+#include <filesystem>
+#include <iostream>
+#include <stdexcept>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+// I/O priority (see ioprio_set(2)), the idle class only gets disk time when no other program needs the disk
+static constexpr int IoprioWhoProcess = 1;
+static constexpr int IoprioClassIdle = 3;
+static constexpr int IoprioClassShift = 13;
+
+/**
+ * \brief Lower the CPU & disk priority of the calling thread, the threads it creates inherit the priorities
+ */
+static void set_low_priority()
+{
+  pid_t thread_id = static_cast<pid_t>(syscall(SYS_gettid));
+  setpriority(PRIO_PROCESS, static_cast<id_t>(thread_id), 19);
+  syscall(SYS_ioprio_set, IoprioWhoProcess, thread_id, IoprioClassIdle << IoprioClassShift);
+}
+
+/**
+ * \brief Remove the files (not the sub-folders) of a single folder, the sub-folders are returned
+ * \param[in] path Folder path
+ * \param[out] sub_dirs The sub-folders are appended
+ * \return true when all files are removed, otherwise false
+ */
+static bool remove_files(const std::string& path, std::vector<std::string>& sub_dirs)
+{
+  int dir_fd = open(path.c_str(), O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+  if (dir_fd < 0)
+    return false;
+  // The files of a read-only folder can't be removed
+  struct stat dir_stat;
+  if (fstat(dir_fd, &dir_stat) == 0 && (dir_stat.st_mode & S_IRWXU) != S_IRWXU)
+    fchmod(dir_fd, dir_stat.st_mode | S_IRWXU);
+  DIR* dir = fdopendir(dir_fd);
+  if (dir == nullptr)
+  {
+    close(dir_fd);
+    return false;
+  }
+  bool is_removed = true;
+  while (const struct dirent* entry = readdir(dir))
+  {
+    std::string_view name = entry->d_name;
+    if (name == "." || name == "..")
+      continue;
+    bool is_dir = (entry->d_type == DT_DIR);
+    if (entry->d_type == DT_UNKNOWN)
+    {
+      struct stat entry_stat;
+      is_dir = (fstatat(dir_fd, entry->d_name, &entry_stat, AT_SYMLINK_NOFOLLOW) == 0 && S_ISDIR(entry_stat.st_mode));
+    }
+    if (is_dir)
+      sub_dirs.push_back(path + "/" + entry->d_name);
+    else if (unlinkat(dir_fd, entry->d_name, 0) != 0 && errno != ENOENT)
+      is_removed = false;
+  }
+  closedir(dir); // Closes dir_fd as well
+  return is_removed;
+}
+
+/**
+ * \brief Start the low-priority remove thread
+ * \param[in] thread_count Number of threads that remove a single folder
+ */
+BottleTrash::BottleTrash(unsigned int thread_count)
+    : is_stopping_(false), thread_count_(std::max(thread_count, 1U)), thread_(&BottleTrash::run, this)
+{
+}
+
+/**
+ * \brief Stop the remove thread, folders that are not removed yet stay in the trash (until the next sweep())
+ */
+BottleTrash::~BottleTrash()
+{
+  {
+    // Set while holding the lock, so the thread can't miss the notification in between checking and waiting
+    std::lock_guard<std::mutex> lock(mutex_);
+    is_stopping_.store(true);
+  }
+  condition_.notify_all();
+  if (thread_.joinable())
+    thread_.join();
+}
+
+/**
+ * \brief Get the trash of WineGUI
+ * \return Trash instance
+ */
+BottleTrash& BottleTrash::get_instance()
+{
+  static BottleTrash instance(4);
+  return instance;
+}
+
+/**
+ * \brief Move a bottle into the trash folder next to it, the bottle is directly gone from its location
+ * \param[in] prefix_path Bottle prefix path
+ * \throws runtime_error when the bottle could not be moved
+ * \return Path of the bottle in the trash
+ */
+std::string BottleTrash::move_to_trash(const std::string& prefix_path)
+{
+  fs::path prefix = fs::path(prefix_path).lexically_normal();
+  if (!prefix.has_filename())
+    prefix = prefix.parent_path();
+  fs::path trash_dir = prefix.parent_path() / TrashDirName;
+  std::error_code error_code;
+  fs::create_directory(trash_dir, error_code);
+  if (error_code)
+    throw std::runtime_error("Could not create the trash folder: " + trash_dir.string() + " (" + error_code.message() + ")");
+  // The same name could be deleted before (and still be in the trash)
+  auto unique_id = std::chrono::system_clock::now().time_since_epoch().count();
+  fs::path trash_path = trash_dir / (prefix.filename().string() + "." + std::to_string(unique_id));
+  fs::rename(prefix, trash_path, error_code);
+  if (error_code)
+  {
+    std::cerr << "Error: Couldn't move Wine bottle to the trash. Wine prefix path: " << prefix_path << ", error: " << error_code.message()
+              << std::endl;
+    throw std::runtime_error("Could not remove the machine: " + prefix_path + "\n\n" + error_code.message());
+  }
+  return trash_path.string();
+}
+
+/**
+ * \brief Remove a folder tree, the files of different folders are removed in parallel
+ * \param[in] path Folder to remove
+ * \param[in] thread_count Number of threads
+ * \param[in] cancel Cancellation flag, polled between folders
+ * \return true if the folder is removed, false when cancelled or some files could not be removed
+ */
+bool BottleTrash::remove_tree(const std::string& path, unsigned int thread_count, const std::atomic<bool>& cancel)
+{
+  struct stat path_stat;
+  if (lstat(path.c_str(), &path_stat) != 0)
+    return errno == ENOENT;
+  if (!S_ISDIR(path_stat.st_mode))
+    return unlink(path.c_str()) == 0;
+
+  // First remove all the files, folder by folder in parallel, while collecting all the folders
+  std::mutex mutex;
+  std::condition_variable condition;
+  std::vector<std::string> pending_dirs{path};
+  std::vector<std::string> all_dirs{path};
+  unsigned int busy_threads = 0;
+  bool is_removed = true;
+  auto remove_files_worker = [&]()
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true)
+    {
+      condition.wait(lock, [&] { return !pending_dirs.empty() || busy_threads == 0 || cancel.load(); });
+      if (cancel.load() || (pending_dirs.empty() && busy_threads == 0))
+        break;
+      std::string dir_path = std::move(pending_dirs.back());
+      pending_dirs.pop_back();
+      ++busy_threads;
+      lock.unlock();
+      std::vector<std::string> sub_dirs;
+      bool is_dir_removed = remove_files(dir_path, sub_dirs);
+      lock.lock();
+      --busy_threads;
+      is_removed = is_removed && is_dir_removed;
+      pending_dirs.insert(pending_dirs.end(), sub_dirs.begin(), sub_dirs.end());
+      all_dirs.insert(all_dirs.end(), sub_dirs.begin(), sub_dirs.end());
+      condition.notify_all();
+    }
+    condition.notify_all();
+  };
+  std::vector<std::thread> threads;
+  for (unsigned int i = 1; i < std::max(thread_count, 1U); ++i)
+    threads.emplace_back(remove_files_worker);
+  remove_files_worker();
+  for (std::thread& thread : threads)
+    thread.join();
+  if (cancel.load())
+    return false;
+
+  // Now the folders only contain (empty) folders, remove the deepest folders first
+  std::stable_sort(all_dirs.begin(), all_dirs.end(), [](const std::string& a, const std::string& b)
+                   { return std::count(a.begin(), a.end(), '/') > std::count(b.begin(), b.end(), '/'); });
+  for (const std::string& dir_path : all_dirs)
+  {
+    if (rmdir(dir_path.c_str()) != 0 && errno != ENOENT)
+      is_removed = false;
+  }
+  return is_removed;
+}
+
+/**
+ * \brief Delete a bottle: directly move it into the trash, the files are removed in the background
+ * \param[in] prefix_path Bottle prefix path
+ * \throws runtime_error when the bottle could not be moved into the trash
+ */
+void BottleTrash::remove(const std::string& prefix_path)
+{
+  std::string trash_path = move_to_trash(prefix_path);
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    paths_.push_back(trash_path);
+  }
+  condition_.notify_all();
+}
+
+/**
+ * \brief Remove the leftovers of a previous run, the bottles in the trash folder of the given location
+ * \param[in] location Folder that contains bottles (like the default bottle location)
+ */
+void BottleTrash::sweep(const std::string& location)
+{
+  fs::path trash_dir = fs::path(location) / TrashDirName;
+  std::error_code error_code;
+  std::vector<std::string> leftovers;
+  for (const auto& entry : fs::directory_iterator(trash_dir, error_code))
+    leftovers.push_back(entry.path().string());
+  if (leftovers.empty())
+    return; // Non-critical, also when the trash can't be read
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const std::string& leftover : leftovers)
+    {
+      if (std::find(paths_.begin(), paths_.end(), leftover) == paths_.end())
+        paths_.push_back(leftover);
+    }
+  }
+  condition_.notify_all();
+}
+
+/**
+ * \brief Wait until all the trashed folders are removed
+ */
+void BottleTrash::wait_until_idle()
+{
+  std::unique_lock<std::mutex> lock(mutex_);
+  idle_condition_.wait(lock, [this] { return paths_.empty() && !is_removing_; });
+}
+
+/**
+ * \brief Remove thread, removes the trashed folders one by one (with low CPU & disk priority)
+ */
+void BottleTrash::run()
+{
+  set_low_priority();
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true)
+  {
+    condition_.wait(lock, [this] { return !paths_.empty() || is_stopping_.load(); });
+    if (is_stopping_.load())
+      break;
+    std::string path = std::move(paths_.front());
+    paths_.pop_front();
+    is_removing_ = true;
+    lock.unlock();
+    if (!remove_tree(path, thread_count_, is_stopping_) && !is_stopping_.load())
+      std::cerr << "Error: Couldn't remove all the files of the deleted machine: " << path << std::endl;
+    lock.lock();
+    is_removing_ = false;
+    if (paths_.empty())
+      idle_condition_.notify_all();
+  }
+  is_removing_ = false;
+  idle_condition_.notify_all();
+}
@@ -0,0 +1,270 @@
+/**
+ * Copyright (c) 2026 WineGUI
+ *
+ * \file    download_cache.cc
+ * \brief   Content-addressed cache of downloaded archives
+ * \author  Melroy van den Berg <webmaster1989@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "download_cache.h"
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <glibmm/keyfile.h>
+#include <glibmm/miscutils.h>
+#include <iostream>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+// Unfinished downloads that are not resumed within this time are removed
+static constexpr std::chrono::hours MaxPartAge = std::chrono::hours(24 * 14);
+
+/// Serializes the read-modify-write of the index file (multiple downloads can finish at the same time)
+static std::mutex index_mutex;
+
+/**
+ * \brief Read the index file, an empty index when the file is missing or unreadable
+ */
+static Glib::RefPtr<Glib::KeyFile> load_index(const std::string& index_path)
+{
+  auto keyfile = Glib::KeyFile::create();
+  std::error_code error_code;
+  if (!fs::is_regular_file(index_path, error_code))
+    return keyfile;
+  try
+  {
+    keyfile->load_from_file(index_path);
+  }
+  catch (const Glib::Error& ex)
+  {
+    std::cerr << "Error: Exception while reading the download cache index: " << ex.what() << std::endl;
+    keyfile = Glib::KeyFile::create();
+  }
+  return keyfile;
+}
+
+/**
+ * \brief Write the index file, an index that could not be written only makes the cache less effective
+ */
+static void save_index(const Glib::RefPtr<Glib::KeyFile>& keyfile, const std::string& index_path)
+{
+  try
+  {
+    keyfile->save_to_file(index_path);
+  }
+  catch (const Glib::Error& ex)
+  {
+    std::cerr << "Error: Exception while writing the download cache index: " << ex.what() << std::endl;
+  }
+}
+
+/**
+ * \brief Constructor, the cache directory is created when the first archive is stored
+ * \param[in] cache_dir Cache directory
+ * \param[in] max_size Maximum total size of the cached archives in bytes
+ */
+DownloadCache::DownloadCache(std::string cache_dir, std::uint64_t max_size)
+    : cache_dir_(std::move(cache_dir)),
+      index_path_(Glib::build_filename(cache_dir_, "index.ini")),
+      max_size_(max_size)
+{
+}
+
+/**
+ * \brief Check if the string is a hex digest (SHA-256 or SHA-512). Digests originate from a download,
+ * so they are validated before they are used as a file name.
+ * \param[in] digest Lowercase hex digest
+ * \return True when valid
+ */
+bool DownloadCache::is_digest(const std::string& digest)
+{
+  auto is_hex_digit = [](char character) { return (character >= '0' && character <= '9') || (character >= 'a' && character <= 'f'); };
+  return (digest.size() == 64 || digest.size() == 128) && std::all_of(digest.begin(), digest.end(), is_hex_digit);
+}
+
+/**
+ * \brief Path of the unfinished download of a file
+ * \param[in] file_name File name of the archive (must be a safe file name)
+ * \return Path of the .part file
+ */
+std::string DownloadCache::get_part_path(const std::string& file_name) const
+{
+  return Glib::build_filename(cache_dir_, file_name + ".part");
+}
+
+/**
+ * \brief Find the checksum of a cached archive by its file name (no network access needed)
+ * \param[in] file_name File name of the archive
+ * \return Lowercase hex digest, or nullopt when the archive is not in the cache
+ */
+std::optional<std::string> DownloadCache::find_digest(const std::string& file_name) const
+{
+  std::lock_guard<std::mutex> lock(index_mutex);
+  auto keyfile = load_index(index_path_);
+  if (!keyfile->has_group(file_name) || !keyfile->has_key(file_name, "Digest"))
+    return std::nullopt;
+  std::string digest = keyfile->get_string(file_name, "Digest");
+  std::error_code error_code;
+  if (!is_digest(digest) || !fs::is_regular_file(Glib::build_filename(cache_dir_, digest), error_code))
+    return std::nullopt;
+  return digest;
+}
+
+/**
+ * \brief Get the path of a cached archive by its checksum. The archive is marked as recently used.
+ * \param[in] digest Lowercase hex digest
+ * \return Path of the archive, or nullopt when the archive is not in the cache
+ */
+std::optional<std::string> DownloadCache::get_file_path(const std::string& digest) const
+{
+  if (!is_digest(digest))
+    return std::nullopt;
+  std::string file_path = Glib::build_filename(cache_dir_, digest);
+  std::error_code error_code;
+  if (!fs::is_regular_file(file_path, error_code))
+    return std::nullopt;
+  fs::last_write_time(file_path, fs::file_time_type::clock::now(), error_code);
+  return file_path;
+}
+
+/**
+ * \brief Move a downloaded (and verified) archive into the cache. The least recently used archives are removed
+ * when the cache grows beyond its maximum size, the new archive is always kept.
+ * \param[in] file_name File name of the archive
+ * \param[in] digest Lowercase hex digest of the archive
+ * \param[in] source_path Path of the archive, on the same filesystem as the cache (eg. the .part file)
+ * \throws std::runtime_error when the archive could not be moved into the cache
+ */
+void DownloadCache::store(const std::string& file_name, const std::string& digest, const std::string& source_path)
+{
+  if (!is_digest(digest))
+    throw std::runtime_error("Refusing to cache the download: invalid checksum.");
+  std::error_code error_code;
+  fs::create_directories(cache_dir_, error_code);
+  fs::rename(source_path, Glib::build_filename(cache_dir_, digest), error_code);
+  if (error_code)
+    throw std::runtime_error("Could not move the download into the cache: " + error_code.message());
+  {
+    std::lock_guard<std::mutex> lock(index_mutex);
+    auto keyfile = load_index(index_path_);
+    keyfile->set_string(file_name, "Digest", digest);
+    save_index(keyfile, index_path_);
+  }
+  evict(digest);
+}
+
+/**
+ * \brief Remove an archive from the cache (eg. when it turned out to be corrupt)
+ * \param[in] digest Lowercase hex digest
+ */
+void DownloadCache::remove(const std::string& digest)
+{
+  if (!is_digest(digest))
+    return;
+  std::error_code error_code;
+  fs::remove(Glib::build_filename(cache_dir_, digest), error_code);
+  std::lock_guard<std::mutex> lock(index_mutex);
+  auto keyfile = load_index(index_path_);
+  for (const Glib::ustring& group : keyfile->get_groups())
+  {
+    if (keyfile->has_key(group, "Digest") && keyfile->get_string(group, "Digest") == digest)
+      keyfile->remove_group(group);
+  }
+  save_index(keyfile, index_path_);
+}
+
+/**
+ * \brief Total size of the cached archives (without the unfinished downloads)
+ * \return Size in bytes
+ */
+std::uint64_t DownloadCache::get_size() const
+{
+  std::uint64_t size = 0;
+  std::error_code error_code;
+  for (const auto& entry : fs::directory_iterator(cache_dir_, error_code))
+  {
+    if (is_digest(entry.path().filename().string()) && entry.is_regular_file(error_code))
+      size += entry.file_size(error_code);
+  }
+  return size;
+}
+
+/**
+ * \brief Remove the least recently used archives beyond the maximum size, and unfinished downloads that were
+ * abandoned long ago. Index entries of removed archives are dropped.
+ * \param[in] keep_digest Archive that is never removed
+ */
+void DownloadCache::evict(const std::string& keep_digest)
+{
+  struct CachedFile
+  {
+    fs::path path;
+    std::uint64_t size;
+    fs::file_time_type last_used;
+  };
+  std::vector<CachedFile> files;
+  std::error_code error_code;
+  auto now = fs::file_time_type::clock::now();
+  for (const auto& entry : fs::directory_iterator(cache_dir_, error_code))
+  {
+    if (!entry.is_regular_file(error_code))
+      continue;
+    std::string name = entry.path().filename().string();
+    fs::file_time_type last_write_time = entry.last_write_time(error_code);
+    if (error_code)
+      continue;
+    if (name.ends_with(".part") || name.ends_with(".part.ini"))
+    {
+      if (now - last_write_time > MaxPartAge)
+        fs::remove(entry.path(), error_code);
+    }
+    else if (is_digest(name) && name != keep_digest)
+    {
+      files.push_back({entry.path(), entry.file_size(error_code), last_write_time});
+    }
+  }
+  // Most recently used first
+  std::sort(files.begin(), files.end(), [](const CachedFile& a, const CachedFile& b) { return a.last_used > b.last_used; });
+  std::uint64_t total_size = 0;
+  if (auto keep_path = get_file_path(keep_digest); keep_path.has_value())
+    total_size = fs::file_size(keep_path.value(), error_code);
+  bool is_removed = false;
+  for (const CachedFile& file : files)
+  {
+    total_size += file.size;
+    if (total_size > max_size_)
+    {
+      fs::remove(file.path, error_code);
+      is_removed = true;
+    }
+  }
+  if (!is_removed)
+    return;
+  std::lock_guard<std::mutex> lock(index_mutex);
+  auto keyfile = load_index(index_path_);
+  for (const Glib::ustring& group : keyfile->get_groups())
+  {
+    if (!keyfile->has_key(group, "Digest") || !is_digest(keyfile->get_string(group, "Digest")) ||
+        !fs::is_regular_file(Glib::build_filename(cache_dir_, keyfile->get_string(group, "Digest")), error_code))
+    {
+      keyfile->remove_group(group);
+    }
+  }
+  save_index(keyfile, index_path_);
+}
@@ -20,6 +20,7 @@
  */
 #include "general_config_file.h"
 #include "project_config.h"
+#include <algorithm>
 #include <giomm.h>
 #include <glibmm.h>
 #include <iostream>
@@ -59,6 +60,7 @@ bool GeneralConfigFile::write_config_file(const GeneralConfigData& general_confi
     keyfile->set_boolean("General", "DisplayDefaultWineMachine", general_config.display_default_wine_machine);
     keyfile->set_boolean("General", "EnableLoggingStderr", general_config.enable_logging_stderr);
     keyfile->set_boolean("General", "CheckForUpdatesStartup", general_config.check_for_updates_startup);
+    keyfile->set_integer("General", "MaxRunnerDownloads", general_config.max_runner_downloads);
     success = keyfile->save_to_file(config_file_path);
   }
   catch (const Glib::Error& ex)
@@ -126,6 +128,9 @@ GeneralConfigData GeneralConfigFile::read_config_file()
       general_config.display_default_wine_machine = keyfile->get_boolean("General", "DisplayDefaultWineMachine");
       general_config.enable_logging_stderr = keyfile->get_boolean("General", "EnableLoggingStderr");
       general_config.check_for_updates_startup = keyfile->get_boolean("General", "CheckForUpdatesStartup");
+      // Added later, older config files don't have this key
+      if (keyfile->has_key("General", "MaxRunnerDownloads"))
+        general_config.max_runner_downloads = std::clamp(keyfile->get_integer("General", "MaxRunnerDownloads"), 1, 8);
     }
     catch (const Glib::Error& ex)
     {
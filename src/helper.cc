@@ -20,7 +20,13 @@
  */
 // cppcheck-suppress-file unusedPrivateFunction
 #include "helper.h"
+#include "bottle_cloner.h"
+#include "bottle_trash.h"
+#include "process_launcher.h"
+#include "registry_file.h"
 #include "wine_defaults.h"
+#include "wine_version_cache.h"
+#include "wineserver_monitor.h"
 #include <algorithm>
 #include <array>
 #include <cctype>
@@ -39,6 +45,7 @@
 #include <pwd.h>
 #include <stdexcept>
 #include <stdio.h>
+#include <string_view>
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <time.h>
@@ -63,19 +70,18 @@ static const string SystemReg = "system.reg";
 static const string UserReg = "user.reg";
 // static const string UserdefReg = "userdef.reg";
 
-// In-memory cache of registry file contents (pre-split into lines), keyed by absolute file path.
-// This avoids re-reading the same user.reg/system.reg from disk multiple times during a single
-// bottle enumeration pass. Every lookup re-validates the entry against the file's current
-// mtime + size (a single stat() call, no file read), so the cache can never serve data that
-// changed on disk. Registry files are also rewritten outside WineGUI (winetricks, running
-// Windows programs, regedit, manual edits). On top of that the cache is cleared at the start &
-// end of every bottle refresh (see BottleManager::update_config_and_bottles) and invalidated
-// per-prefix by the reg mutating setters, keeping it empty at rest.
+// In-memory cache of parsed registry files (see RegistryFile), keyed by absolute file path.
+// Each file version is read & indexed only once, so looking up a key no longer scans the
+// whole file. Every lookup re-validates the entry against the file's current mtime + size (a single
+// stat() call, no file read), so the cache can never serve data that changed on disk. Registry
+// files are also rewritten outside WineGUI (winetricks, running Windows programs, regedit, manual
+// edits). On top of that the cache is invalidated per-prefix by the reg mutating setters and by the
+// bottle watchers (see BottleManager::on_bottle_changes_timeout), and once the details of a bottle are read.
 struct RegFileCacheEntry
 {
   struct timespec mtime;
   off_t size;
-  std::shared_ptr<const std::vector<std::string>> lines;
+  std::shared_ptr<const RegistryFile> registry;
 };
 static std::map<std::string, RegFileCacheEntry> reg_file_cache;
 static std::mutex reg_file_cache_mutex;
@@ -184,7 +190,8 @@ vector<string> Helper::get_bottles_paths(const string& dir_path, bool display_de
   while (!name.empty())
   {
     auto path = Glib::build_filename(dir_path, name);
-    if (Glib::file_test(path, Glib::FileTest::IS_DIR))
+    // Skip the trash folder, with the deleted bottles that are still being removed
+    if (name != BottleTrash::TrashDirName && Glib::file_test(path, Glib::FileTest::IS_DIR))
     {
       list.emplace_back(path);
     }
@@ -206,7 +213,7 @@ vector<string> Helper::get_bottles_paths(const string& dir_path, bool display_de
 
 /**
  * \brief Run any program with only setting the WINEPREFIX env variable (run this method async).
- * Returns stdout output. Redirect stderr to stdout (2>&1), if you want stderr as well.
+ * Returns stdout output. The program is started without a shell, unless it uses shell features (see ProcessLauncher::run_command).
  * Improvement/TODO: We could now also log the output from the program into a GUI console window.
  * \param[in] prefix_path The path to wine bottle
  * \param[in] debug_log_level Debug log level
@@ -216,7 +223,8 @@ vector<string> Helper::get_bottles_paths(const string& dir_path, bool display_de
  * \param[in] stderr_output Also output stderr (together with stout)
  * \param[in] env_vars Array of environment variables to set
  * \param[out] exit_code (Optionally) Retrieve the exit code of the program (only set when give_error is false)
- * \return Terminal stdout output
+ * \param[in] on_output (Optionally) Stream the output while the program runs, instead of returning all the output at once
+ * \return Terminal stdout output (empty when the output is streamed)
  */
 string Helper::run_program(const string& prefix_path,
                            int debug_log_level,
@@ -225,36 +233,37 @@ string Helper::run_program(const string& prefix_path,
                            const vector<pair<string, string>>& env_vars,
                            bool give_error,
                            bool stderr_output,
-                           int* exit_code)
+                           int* exit_code,
+                           const std::function<void(std::string_view output)>& on_output)
 {
-  string output;
-
-  string debug = (debug_log_level != 1) ? "WINEDEBUG=" + Helper::log_level_to_winedebug_string(debug_log_level) + " " : "";
-  string exec_program = (stderr_output) ? program + " 2>&1" : program;
-  string change_directory = working_directory.empty() ? "" : "cd \"" + working_directory + "\" && ";
-  string env_vars_str(debug + "WINEPREFIX=\"" + prefix_path + "\" ");
-
-  // Convert key/value pair to string, append to env_vars_str
-  for (const auto& [key, value] : env_vars)
+  vector<pair<string, string>> program_env_vars;
+  program_env_vars.reserve(env_vars.size() + 2);
+  if (debug_log_level != 1)
   {
-    env_vars_str += key + "=\"" + value + "\" ";
+    program_env_vars.emplace_back("WINEDEBUG", Helper::log_level_to_winedebug_string(debug_log_level));
   }
+  program_env_vars.emplace_back("WINEPREFIX", prefix_path);
+  program_env_vars.insert(program_env_vars.end(), env_vars.begin(), env_vars.end());
 
-  string command = change_directory + env_vars_str + exec_program;
+  string output;
+  int exit_code_value = 0;
+  if (on_output)
+    exit_code_value = ProcessLauncher::run_command(program, program_env_vars, working_directory, stderr_output, on_output);
+  else
+    std::tie(exit_code_value, output) = ProcessLauncher::run_command(program, program_env_vars, working_directory, stderr_output);
   if (give_error)
   {
-    // Execute the command that also shows an error message to the user when exit code is non-zero
-    output = exec_error_message(command);
+    // Show an error message to the user when exit code is non-zero
+    if (exit_code_value != 0)
+    {
+      // Dispatcher will run the connected slot in the main loop (this method runs in a thread)
+      Helper::get_instance().failure_on_exec.emit();
+    }
   }
-  else
+  else if (exit_code != nullptr)
   {
     // No error message when exit code is non-zero, but we can still return the output and log to disk (if logging is enabled)
-    const auto& [exit_code_value, output_value] = exec(command);
-    if (exit_code != nullptr)
-    {
-      *exit_code = exit_code_value;
-    }
-    output = output_value;
+    *exit_code = exit_code_value;
   }
   return output;
 }
@@ -273,7 +282,8 @@ string Helper::run_program(const string& prefix_path,
  * \param[in] env_vars Array of environment variables to set
  * \param[in] wine_bin_path Path to Wine binary
  * \param[out] exit_code (Optionally) Retrieve the exit code of the program (only set when give_error is false)
- * \return Terminal stdout output
+ * \param[in] on_output (Optionally) Stream the output while the program runs, instead of returning all the output at once
+ * \return Terminal stdout output (empty when the output is streamed)
  */
 string Helper::run_program_under_wine(bool wine_64_bit,
                                       const string& prefix_path,
@@ -284,30 +294,11 @@ string Helper::run_program_under_wine(bool wine_64_bit,
                                       bool give_error,
                                       bool stderr_output,
                                       const string& wine_bin_path,
-                                      int* exit_code)
-{
-  return Helper::run_program(prefix_path, debug_log_level, Helper::get_wine_executable_location(wine_64_bit, wine_bin_path) + " " + program,
-                             working_directory, env_vars, give_error, stderr_output, exit_code);
-}
-
-/**
- * \brief Write/append logging to WineGUI log file
- * \param logging_bottle_prefix Wine Bottle prefix location
- * \param logging Logging data
- */
-void Helper::write_to_log_file(const string& logging_bottle_prefix, const string& logging)
+                                      int* exit_code,
+                                      const std::function<void(std::string_view output)>& on_output)
 {
-  string log_path = Helper::get_log_file_path(logging_bottle_prefix);
-  auto file = Gio::File::create_for_path(log_path);
-  try
-  {
-    auto output = file->append_to(Gio::File::CreateFlags::NONE);
-    output->write(logging);
-  }
-  catch (const Glib::Error& ex)
-  {
-    std::cerr << "Error: Couldn't write debug logging to log file. Error " << ex.what() << std::endl;
-  }
+  return Helper::run_program(prefix_path, debug_log_level, Glib::shell_quote(Helper::get_wine_executable_location(wine_64_bit, wine_bin_path)) + " " + program,
+                             working_directory, env_vars, give_error, stderr_output, exit_code, on_output);
 }
 
 /**
@@ -324,18 +315,34 @@ string Helper::get_log_file_path(const string& logging_bottle_prefix)
  * \brief Blocking wait (with timeout functionality) until wineserver is terminated.
  * \param[in] prefix_path The path to bottle wine directory
  * \param[in] wine_bin_path (Optionally) Path to a custom Wine binary directory; its wineserver is used when present
+ * \param[in] timeout Maximum time to wait
+ * \return true if the wineserver is terminated (or wasn't running), false on time-out
  */
-void Helper::wait_until_wineserver_is_terminated(const string& prefix_path, const string& wine_bin_path)
+bool Helper::wait_until_wineserver_is_terminated(const string& prefix_path, const string& wine_bin_path, std::chrono::seconds timeout)
 {
+  try
+  {
+    if (WineserverMonitor::get_instance().wait(prefix_path, timeout))
+      return true;
+    std::cout << "INFO: Time-out of wineserver wait triggered (wineserver is still running..)" << std::endl;
+    return false;
+  }
+  catch (const std::runtime_error&)
+  {
+    // Process file descriptors are not supported (Linux < 5.3), fall-back to 'wineserver -w'
+  }
+
   // Use the wineserver that belongs to the bottle's custom Wine build (if any),
   // the system wineserver might be a different (incompatible) version
   string wineserver_executable = get_wineserver_executable_location(wine_bin_path);
-  const auto& [exit_code, output] = exec("WINEPREFIX=\"" + prefix_path + "\" timeout 60 \"" + wineserver_executable + "\" -w 2>&1");
+  const auto& [exit_code, output] =
+      ProcessLauncher::run({"timeout", std::to_string(timeout.count()), wineserver_executable, "-w"}, {{"WINEPREFIX", prefix_path}}, "", true);
   if (exit_code == 124)
   {
     std::cout << "INFO: Time-out of wineserver wait command triggered (wineserver is still running..)" << std::endl;
     std::cout << "INFO: Output of wineserver: " << output << std::endl;
   }
+  return exit_code == 0;
 }
 
 /**
@@ -346,20 +353,14 @@ int Helper::determine_wine_executable()
 {
   int return_status = -1;
   // Try wine (32-bit or unified binary)
-  const auto& [exit_code32, _] = exec("command -v " + WineExecutable);
-  if (exit_code32 == 0)
+  if (!Glib::find_program_in_path(WineExecutable).empty())
   {
     return_status = 0;
   }
   // Try the separate wine64 binary
-  if (return_status != 0)
+  else if (!Glib::find_program_in_path(WineExecutable64).empty())
   {
-    // cppcheck-suppress shadowVariable
-    const auto& [exit_code64, _] = exec("command -v " + WineExecutable64);
-    if (exit_code64 == 0)
-    {
-      return_status = 1;
-    }
+    return_status = 1;
   }
   return return_status;
 }
@@ -402,8 +403,7 @@ string Helper::get_wine_executable_location(bool prefer_wine64, const string& wi
     // otherwise gracefully fall back to the plain "wine" binary
     if (prefer_wine64)
     {
-      const auto& [exit_code, _] = exec("command -v " + WineExecutable64);
-      if (exit_code == 0)
+      if (!Glib::find_program_in_path(WineExecutable64).empty())
       {
         return WineExecutable64;
       }
@@ -449,7 +449,7 @@ string Helper::get_winetricks_location()
 }
 
 /**
- * \brief Get Wine version from CLI
+ * \brief Get Wine version, the version of each distinct Wine binary is only determined once (see WineVersionCache)
  * \param[in] wine_64_bit If true use Wine 64-bit binary, false use 32-bit binary
  * \param[in] prefix_path The path to bottle wine directory (only used for the error message)
  * \param[in] wine_bin_path The path to the Wine binary directory
@@ -458,7 +458,22 @@ string Helper::get_winetricks_location()
  */
 string Helper::get_wine_version(bool wine_64_bit, const string& prefix_path, const string& wine_bin_path)
 {
-  const auto& [exit_code, output] = exec(Helper::get_wine_executable_location(wine_64_bit, wine_bin_path) + " --version 2>&1");
+  return WineVersionCache::get_instance().get_version(Helper::get_wine_executable_location(wine_64_bit, wine_bin_path),
+                                                      [&prefix_path, &wine_bin_path](const string& wine_executable)
+                                                      { return exec_wine_version(wine_executable, prefix_path, wine_bin_path); });
+}
+
+/**
+ * \brief Get Wine version from CLI
+ * \param[in] wine_executable The Wine executable
+ * \param[in] prefix_path The path to bottle wine directory (only used for the error message)
+ * \param[in] wine_bin_path The path to the Wine binary directory (only used for the error message)
+ * \throws runtime_error we could not determine Wine version
+ * \return Return the wine version
+ */
+string Helper::exec_wine_version(const string& wine_executable, const string& prefix_path, const string& wine_bin_path)
+{
+  const auto& [exit_code, output] = ProcessLauncher::run({wine_executable, "--version"}, {}, "", true);
   if (exit_code == 0 && !output.empty())
   {
     vector<string> results = split(output, '-');
@@ -476,16 +491,14 @@ string Helper::get_wine_version(bool wine_64_bit, const string& prefix_path, con
       else
       {
         std::cerr << "Error: Couldn't determine Wine version for machine: " << get_folder_name(prefix_path)
-                  << ". Using wine executable: " << Helper::get_wine_executable_location(wine_64_bit, wine_bin_path) << ", output: " << output
-                  << std::endl;
+                  << ". Using wine executable: " << wine_executable << ", output: " << output << std::endl;
         throw std::runtime_error("Could not determine Wine version?\nSomething went wrong.");
       }
     }
     else
     {
       std::cerr << "Error: Couldn't determine Wine version for machine " << get_folder_name(prefix_path)
-                << ". Using wine executable: " << Helper::get_wine_executable_location(wine_64_bit, wine_bin_path) << ", output: " << output
-                << std::endl;
+                << ". Using wine executable: " << wine_executable << ", output: " << output << std::endl;
       throw std::runtime_error("Could not determine Wine version?\nSomething went wrong.");
     }
   }
@@ -494,8 +507,7 @@ string Helper::get_wine_version(bool wine_64_bit, const string& prefix_path, con
     std::cerr << "Error: Couldn't determine Wine version. No output." << std::endl;
     std::cerr << "Wine Binary path: " << wine_bin_path << std::endl;
     throw std::runtime_error("Could not determine Wine version for machine: " + get_folder_name(prefix_path) + ".\nUsing wine executable: '" +
-                             Helper::get_wine_executable_location(wine_64_bit, wine_bin_path) +
-                             "'.\n\nIs Wine installed correctly or did you provide the correct path for this machine?");
+                             wine_executable + "'.\n\nIs Wine installed correctly or did you provide the correct path for this machine?");
   }
 }
 
@@ -537,22 +549,25 @@ string Helper::open_file_from_uri(const string& uri)
 void Helper::create_wine_bottle(
     bool wine_64_bit, const string& prefix_path, BottleTypes::Bit bit, const bool disable_gecko_mono, const string& wine_bin_path)
 {
-  string wine_arch = "";
+  vector<pair<string, string>> env_vars{{"WINEPREFIX", prefix_path}};
   switch (bit)
   {
   case BottleTypes::Bit::win32:
-    wine_arch = " WINEARCH=win32";
+    env_vars.emplace_back("WINEARCH", "win32");
     break;
   case BottleTypes::Bit::win64:
-    wine_arch = " WINEARCH=win64";
+    env_vars.emplace_back("WINEARCH", "win64");
     break;
   }
-  string wine_dll_overrides = (disable_gecko_mono) ? " WINEDLLOVERRIDES=\"mscoree=d;mshtml=d\"" : "";
-  string command = "WINEPREFIX=\"" + prefix_path + "\"" + wine_arch + wine_dll_overrides + " " +
-                   Helper::get_wine_executable_location(wine_64_bit, wine_bin_path) + " wineboot";
-  const auto& [exit_code, output] = exec(command + " 2>&1");
+  if (disable_gecko_mono)
+  {
+    env_vars.emplace_back("WINEDLLOVERRIDES", "mscoree=d;mshtml=d");
+  }
+  string wine_executable = Helper::get_wine_executable_location(wine_64_bit, wine_bin_path);
+  const auto& [exit_code, output] = ProcessLauncher::run({wine_executable, "wineboot"}, env_vars, "", true);
   if (exit_code != 0)
   {
+    string command = "WINEPREFIX=\"" + prefix_path + "\" " + wine_executable + " wineboot";
     std::cerr << "Error: Couldn't create Wine bottle. Command: " << command << ", output: " << output << std::endl;
     throw std::runtime_error("Failed to create Wine prefix: " + get_folder_name(prefix_path) + ". \n\nWith the following output:\n\n" + output +
                              "\n\nCommand executed:\n" + command);
@@ -568,7 +583,7 @@ void Helper::remove_wine_bottle(const string& prefix_path)
 {
   if (Helper::dir_exists(prefix_path))
   {
-    const auto& [exit_code, output] = exec("rm -rf \"" + prefix_path + "\" 2>&1");
+    const auto& [exit_code, output] = ProcessLauncher::run({"rm", "-rf", "--", prefix_path}, {}, "", true);
     if (exit_code != 0)
     {
       std::cerr << "Error: Couldn't remove Wine bottle. Wine prefix path: " << prefix_path << ", output: " << output << std::endl;
@@ -594,7 +609,7 @@ void Helper::rename_wine_bottle_folder(const string& current_prefix_path, const
 {
   if (Helper::dir_exists(current_prefix_path))
   {
-    const auto& [exit_code, output] = exec("mv \"" + current_prefix_path + "\" \"" + new_prefix_path + "\" 2>&1");
+    const auto& [exit_code, output] = ProcessLauncher::run({"mv", "--", current_prefix_path, new_prefix_path}, {}, "", true);
     if (exit_code != 0)
     {
       std::cerr << "Error: Couldn't rename Wine bottle. Wine prefix path: " << current_prefix_path << ", output: " << output << std::endl;
@@ -611,21 +626,32 @@ void Helper::rename_wine_bottle_folder(const string& current_prefix_path, const
 }
 
 /**
- * \brief Copy Wine bottle folder
+ * \brief Copy Wine bottle folder, file data is shared (reflinked) when the file system supports it
  * \param[in] source_prefix_path Current source wine bottle path
  * \param[in] destination_prefix_path Destination wine bottle path
+ * \param[in] progress_cb (Optionally) Called with the bytes done & the bytes total
+ * \param[in] cancel (Optionally) Cancellation flag
  * \throws runtime_error when we could not copy the Wine Bottle
+ * \return true when copied, false when cancelled
  */
-void Helper::copy_wine_bottle_folder(const string& source_prefix_path, const string& destination_prefix_path)
+bool Helper::copy_wine_bottle_folder(const string& source_prefix_path,
+                                     const string& destination_prefix_path,
+                                     const std::function<void(std::uint64_t, std::uint64_t)>& progress_cb,
+                                     const std::atomic<bool>* cancel)
 {
   if (Helper::dir_exists(source_prefix_path))
   {
-    const auto& [exit_code, output] = exec("cp -r \"" + source_prefix_path + "\" \"" + destination_prefix_path + "\" 2>&1");
-    if (exit_code != 0)
+    static const std::atomic<bool> not_cancelled{false};
+    try
     {
-      std::cerr << "Error: Couldn't copy Wine bottle. Wine prefix path: " << source_prefix_path << ", output: " << output << std::endl;
+      return BottleCloner::clone(source_prefix_path, destination_prefix_path, progress_cb, cancel != nullptr ? *cancel : not_cancelled);
+    }
+    catch (const std::runtime_error& error)
+    {
+      std::cerr << "Error: Couldn't copy Wine bottle. Wine prefix path: " << source_prefix_path << ", error: " << error.what() << std::endl;
       throw std::runtime_error("Failed to copy the folder. Wine machine: " + get_folder_name(source_prefix_path) +
-                               "\n\nSource full path location: " + source_prefix_path + ". Tried to copy to destination: " + destination_prefix_path);
+                               "\n\nSource full path location: " + source_prefix_path + ". Tried to copy to destination: " + destination_prefix_path +
+                               "\n\n" + error.what());
     }
   }
   else
@@ -770,8 +796,11 @@ string Helper::get_last_wine_updated(const string& prefix_path)
     if (!epoch_time.empty())
     {
       time_t secsSinceEpoch = strtoul(epoch_time.c_str(), NULL, 0);
+      // Thread-safe variant of localtime(), bottles are read in parallel
+      struct tm time_info;
+      localtime_r(&secsSinceEpoch, &time_info);
       std::stringstream stringStream;
-      stringStream << std::put_time(localtime(&secsSinceEpoch), "%c");
+      stringStream << std::put_time(&time_info, "%c");
       return stringStream.str();
     }
     else
@@ -1033,9 +1062,10 @@ void Helper::install_or_update_winetricks()
   }
 
   const auto& [exit_code, output] =
-      exec("cd \"$(mktemp -d)\" && wget -q https://raw.githubusercontent.com/Winetricks/winetricks/master/src/winetricks "
-           "&& chmod +x winetricks && mv winetricks " +
-           WinetricksExecutable + " 2>&1");
+      ProcessLauncher::run_command("cd \"$(mktemp -d)\" && wget -q https://raw.githubusercontent.com/Winetricks/winetricks/master/src/winetricks "
+                                   "&& chmod +x winetricks && mv winetricks " +
+                                       WinetricksExecutable,
+                                   {}, "", true);
   if (exit_code != 0)
   {
     std::cerr << "Error: Downloading Winetricks failed. Winetricks path: " << WinetricksExecutable << std::endl;
@@ -1060,7 +1090,7 @@ void Helper::self_update_winetricks()
 {
   if (file_exists(WinetricksExecutable))
   {
-    const auto& [exit_code, output] = exec(WinetricksExecutable + " --self-update 2>&1");
+    const auto& [exit_code, output] = ProcessLauncher::run({WinetricksExecutable, "--self-update"}, {}, "", true);
     if (exit_code != 0)
     {
       // TODO: This could be a bug as well, maybe fallback to redownloading the winetricks binary?
@@ -1087,7 +1117,7 @@ void Helper::set_windows_version(const string& prefix_path, BottleTypes::Windows
   if (file_exists(WinetricksExecutable))
   {
     string win = BottleTypes::get_winetricks_string(windows);
-    const auto& [exit_code, output] = exec("WINEPREFIX=\"" + prefix_path + "\" " + WinetricksExecutable + " " + win + " 2>&1");
+    const auto& [exit_code, output] = ProcessLauncher::run({WinetricksExecutable, win}, {{"WINEPREFIX", prefix_path}}, "", true);
     if (exit_code != 0)
     {
       std::cerr << "Error: Couldn't set Windows OS version. Wine prefix path: " << prefix_path << ", Winetricks path: " << WinetricksExecutable
@@ -1136,7 +1166,7 @@ void Helper::set_virtual_desktop(const string& prefix_path, string resolution)
         resolution = "640x480";
       }
 
-      const auto [exit_code, output] = exec("WINEPREFIX=\"" + prefix_path + "\" " + WinetricksExecutable + " vd=" + resolution + " 2>&1");
+      const auto [exit_code, output] = ProcessLauncher::run({WinetricksExecutable, "vd=" + resolution}, {{"WINEPREFIX", prefix_path}}, "", true);
       if (exit_code != 0)
       {
         std::cerr << "Error: Couldn't set virtual desktop resolution. Wine prefix path: " << prefix_path
@@ -1169,7 +1199,7 @@ void Helper::disable_virtual_desktop(const string& prefix_path)
 {
   if (file_exists(WinetricksExecutable))
   {
-    const auto& [exit_code, output] = exec("WINEPREFIX=\"" + prefix_path + "\" " + WinetricksExecutable + " vd=off 2>&1");
+    const auto& [exit_code, output] = ProcessLauncher::run({WinetricksExecutable, "vd=off"}, {{"WINEPREFIX", prefix_path}}, "", true);
     if (exit_code != 0)
     {
       std::cerr << "Error: Couldn't disable desktop, Winetricks path: " << WinetricksExecutable << ", output: " << output << std::endl;
@@ -1195,7 +1225,7 @@ void Helper::set_audio_driver(const string& prefix_path, BottleTypes::AudioDrive
   if (file_exists(WinetricksExecutable))
   {
     string audio = BottleTypes::get_winetricks_string(audio_driver);
-    const auto& [exit_code, output] = exec("WINEPREFIX=\"" + prefix_path + "\" " + WinetricksExecutable + " sound=" + audio + " 2>&1");
+    const auto& [exit_code, output] = ProcessLauncher::run({WinetricksExecutable, "sound=" + audio}, {{"WINEPREFIX", prefix_path}}, "", true);
     if (exit_code != 0)
     {
       std::cerr << "Error: Couldn't set audio driver. Wine prefix path: " << prefix_path << ", Winetricks path: " << WinetricksExecutable
@@ -1282,13 +1312,21 @@ string Helper::log_level_to_winedebug_string(int log_level)
  */
 string Helper::get_wine_guid(bool wine_64_bit, const string& prefix_path, const string& application_name, const string& wine_bin_path)
 {
-  auto [exit_code, output] = exec("WINEPREFIX=\"" + prefix_path + "\" " + Helper::get_wine_executable_location(wine_64_bit, wine_bin_path) +
-                                  " uninstaller --list | grep \"" + application_name + "\" | cut -d \"{\" -f2 | cut -d \"}\" -f1 2>&1");
-  if (exit_code == 0 && !output.empty())
+  const auto& [exit_code, output] =
+      ProcessLauncher::run({Helper::get_wine_executable_location(wine_64_bit, wine_bin_path), "uninstaller", "--list"}, {{"WINEPREFIX", prefix_path}});
+  if (exit_code != 0)
+    return "";
+  // Each line looks like: {GUID}|||Application name
+  for (const string& line : split(output, '\n'))
   {
-    output.erase(std::remove(output.begin(), output.end(), '\n'), output.end());
+    if (line.find(application_name) == string::npos)
+      continue;
+    size_t begin = line.find('{');
+    size_t end = line.find('}', begin);
+    if (begin != string::npos && end != string::npos)
+      return line.substr(begin + 1, end - begin - 1);
   }
-  return output;
+  return "";
 }
 
 /**
@@ -1333,28 +1371,25 @@ string Helper::get_uninstaller(const string& prefix_path, const string& uninstal
  */
 bool Helper::has_uninstaller_display_name_prefix(const string& prefix_path, const string& display_name_prefix)
 {
-  static const string uninstall_key_prefix = "[Software\\\\Microsoft\\\\Windows\\\\CurrentVersion\\\\Uninstall\\\\";
+  static const string uninstall_key_prefix = "Software\\\\Microsoft\\\\Windows\\\\CurrentVersion\\\\Uninstall\\\\";
   static const string display_name_pattern = "\"DisplayName\"=\"";
   string file_path = Glib::build_filename(prefix_path, SystemReg);
-  auto lines = get_reg_file_lines(file_path);
-  if (!lines)
+  auto registry = get_reg_file(file_path);
+  if (!registry)
   {
     std::cerr << "Error: Couldn't open registry file during has_uninstaller_display_name_prefix(). Trying to read from file: " << file_path
               << "(using display name prefix: " << display_name_prefix << ")" << std::endl;
     throw std::runtime_error("Could not open registry file!");
   }
 
-  bool inside_uninstall_section = false;
-  for (const string& line : *lines)
+  for (const RegistryFile::Key& key : registry->get_keys())
   {
-    if (line.starts_with('['))
-    {
-      // New key section; check whether it's an uninstaller subkey
-      inside_uninstall_section = line.starts_with(uninstall_key_prefix);
-    }
-    else if (inside_uninstall_section && line.starts_with(display_name_pattern))
+    // Only check the uninstaller subkeys
+    if (!key.name.starts_with(uninstall_key_prefix))
+      continue;
+    for (std::string_view entry : registry->get_entries(key))
     {
-      if (line.compare(display_name_pattern.size(), display_name_prefix.size(), display_name_prefix) == 0)
+      if (entry.starts_with(display_name_pattern) && entry.substr(display_name_pattern.size()).starts_with(display_name_prefix))
         return true;
     }
   }
@@ -1752,95 +1787,6 @@ string Helper::to_filename_part(const string& input)
  *  Private methods                                                         *
  ****************************************************************************/
 
-/**
- * \brief Execute command on terminal. Returns both the exit code as well as stdout output.
- * Note: Redirect stderr to stdout (2>&1), if you want stderr as well.
- * Usage: const auto& [exit_code, output] = exec("echo 1");
- * \param[in] command The command to be executed
- * \throws runtime_error when popen failed (empty pipe pointer)
- * \return Exit code and terminal stdout output as a pair
- */
-std::pair<int, string> Helper::exec(const string& command)
-{
-  int exit_code = -1;
-  string output = "";
-
-  // local scope kicks off pclose before returning exit_code
-  {
-    std::array<char, 128> buffer{};
-    // And use the standard C pclose method during stream closure.
-    auto deleter = [&exit_code](std::FILE* ptr) { exit_code = pclose(ptr); };
-
-    // Execute command using popen,
-    std::unique_ptr<std::FILE, decltype(deleter)> pipe(popen(command.c_str(), "r"), deleter);
-    if (!pipe)
-    {
-      throw std::runtime_error("popen() failed!");
-    }
-    while (std::fgets(buffer.data(), buffer.size(), pipe.get()) != nullptr)
-    {
-      output += buffer.data();
-    }
-  }
-  return std::make_pair(exit_code, output);
-}
-
-/**
- * \brief Execute command on terminal, give user an error message when exit code is non-zero.
- * Returns stdout output. Redirect stderr to stdout (2>&1), if you want stderr as well.
- * \param[in] command The command to be executed
- * \throws runtime_error when popen failed (empty pipe pointer)
- * \return Terminal stdout output
- */
-string Helper::exec_error_message(const string& command)
-{
-  // Max 128 characters
-  std::array<char, 128> buffer;
-  string output = "";
-
-  // Execute command using popen
-  struct custom_file_deleter
-  {
-    void operator()(std::FILE* fp)
-    {
-      // Use a custom close file function during the pipe close (close_exec_stream)
-      // See close_exec_stream below.
-      Helper::close_exec_stream(fp);
-    }
-  };
-  using unique_file_custom_deleter = std::unique_ptr<std::FILE, custom_file_deleter>;
-  unique_file_custom_deleter pipe{popen(command.c_str(), "r")};
-  if (!pipe)
-  {
-    throw std::runtime_error("popen() failed!");
-  }
-  while (fgets(buffer.data(), buffer.size(), pipe.get()) != nullptr)
-  {
-    output += buffer.data();
-  }
-  return output;
-}
-
-/**
- * Custom pclose method, which is executed during the stream closure of C popen command.
- * Check on pclose return value, signal a failure/pop-up to the user, when exit-code is non-zero.
- */
-int Helper::close_exec_stream(std::FILE* file)
-{
-  if (file)
-  {
-    if (pclose(file) != 0)
-    {
-      // Dispatcher will run the connected slot in the main loop,
-      // instead of the same context/thread in case of a signal.emit() call.
-      // This is needed because the CloseFile is called in a different context then usual!
-      // Signal error message to the user:
-      Helper::get_instance().failure_on_exec.emit();
-    }
-  }
-  return 0; // Just always return OK
-}
-
 /**
  * \brief Write C buffer (gchar *) to file
  * \param[in] filename Filename
@@ -2004,7 +1950,7 @@ string Helper::get_winetricks_version()
   string version = "unknown";
   if (file_exists(WinetricksExecutable))
   {
-    const auto& [exit_code, output] = exec(WinetricksExecutable + " --version");
+    const auto& [exit_code, output] = ProcessLauncher::run({WinetricksExecutable, "--version"});
     if (exit_code == 0 && !output.empty())
     {
       if (output.length() >= 8)
@@ -2028,27 +1974,16 @@ string Helper::get_reg_value(const string& file_path, const string& key_name, co
 {
   string output;
   output.reserve(10);
-  auto lines = get_reg_file_lines(file_path);
-  if (lines)
+  auto registry = get_reg_file(file_path);
+  if (registry)
   {
-    bool match = false;
-    for (const string& line : *lines)
+    if (const RegistryFile::Key* key = registry->find_key(key_name))
     {
-      if (!match)
+      if (auto data = registry->find_value(*key, value_name))
       {
-        match = line.starts_with(key_name);
-      }
-      else
-      {
-        string value_pattern = '"' + value_name + "\"=";
-        std::size_t pos = line.find(value_pattern);
-        if (pos != std::string::npos)
-        {
-          output = line.substr(pos + value_pattern.size());
-          // Remove quotes
-          output.erase(std::remove(output.begin(), output.end(), '\"'), output.end());
-          break;
-        }
+        output = *data;
+        // Remove quotes
+        output.erase(std::remove(output.begin(), output.end(), '\"'), output.end());
       }
     }
   }
@@ -2072,22 +2007,14 @@ vector<string> Helper::get_reg_keys(const string& file_path, const string& key_n
 {
   vector<string> keys;
   keys.reserve(10);
-  auto lines = get_reg_file_lines(file_path);
-  if (lines)
+  auto registry = get_reg_file(file_path);
+  if (registry)
   {
-    bool match = false;
-    for (const string& line : *lines)
+    if (const RegistryFile::Key* key = registry->find_key(key_name))
     {
-      if (!match)
+      for (std::string_view entry : registry->get_entries(*key))
       {
-        match = line.starts_with(key_name);
-      }
-      else
-      {
-        if (line.empty())
-          break; // End of key section in registry
-        if (!line.starts_with('#'))
-          keys.emplace_back(line);
+        keys.emplace_back(entry);
       }
     }
   }
@@ -2144,34 +2071,26 @@ vector<pair<string, string>> Helper::get_reg_keys_name_data_pair_filter_ignore(c
 {
   vector<pair<string, string>> pairs;
   pairs.reserve(3);
-  auto lines = get_reg_file_lines(file_path);
-  if (lines)
+  auto registry = get_reg_file(file_path);
+  if (registry)
   {
-    bool match = false;
-    for (string line : *lines)
+    if (const RegistryFile::Key* key = registry->find_key(key_name))
     {
-      if (!match)
+      for (std::string_view entry : registry->get_entries(*key))
       {
-        match = line.starts_with(key_name);
-      }
-      else
-      {
-        if (line.empty())
-          break; // End of key section in registry
-
-        line = unescape_reg_key_data(line);
-        // Skip '#' elements and if filter is not empty it will only continue if the line contains the filter string
-        if (!line.starts_with('#') && (key_value_filter.empty() || line.find(key_value_filter) != string::npos) &&
+        string line = unescape_reg_key_data(string(entry));
+        // If filter is not empty it will only continue if the line contains the filter string
+        if ((key_value_filter.empty() || line.find(key_value_filter) != string::npos) &&
             (key_name_ignore_filter.empty() || line.find(key_name_ignore_filter) == string::npos))
         {
           auto results = split(line, '"');
           if (results.size() >= 5)
           {
-            auto key = results.at(1);
-            key.erase(std::remove(key.begin(), key.end(), '\"'), key.end());
+            auto name = results.at(1);
+            name.erase(std::remove(name.begin(), name.end(), '\"'), name.end());
             auto value = results.at(3);
             value.erase(std::remove(value.begin(), value.end(), '\"'), value.end());
-            pairs.emplace_back(std::make_pair(key, value));
+            pairs.emplace_back(std::make_pair(name, value));
           }
         }
       }
@@ -2229,24 +2148,16 @@ vector<string> Helper::get_reg_keys_value_data_filter_ignore(const string& file_
 {
   vector<string> keys;
   keys.reserve(10);
-  auto lines = get_reg_file_lines(file_path);
-  if (lines)
+  auto registry = get_reg_file(file_path);
+  if (registry)
   {
-    bool match = false;
-    for (string line : *lines)
+    if (const RegistryFile::Key* key = registry->find_key(key_name))
     {
-      if (!match)
-      {
-        match = line.starts_with(key_name);
-      }
-      else
+      for (std::string_view entry : registry->get_entries(*key))
       {
-        if (line.empty())
-          break; // End of key section in registry
-
-        line = unescape_reg_key_data(line);
-        // Skip '#' elements and if filter is not empty it will only continue if the line contains the filter string
-        if (!line.starts_with('#') && (key_value_filter.empty() || line.find(key_value_filter) != string::npos) &&
+        string line = unescape_reg_key_data(string(entry));
+        // If filter is not empty it will only continue if the line contains the filter string
+        if ((key_value_filter.empty() || line.find(key_value_filter) != string::npos) &&
             (key_name_ignore_filter.empty() || line.find(key_name_ignore_filter) == string::npos))
         {
           auto results = split(line, '"');
@@ -2281,20 +2192,14 @@ string Helper::get_reg_meta_data(const string& file_path, const string& meta_val
 {
   string output;
   output.reserve(10);
-  auto lines = get_reg_file_lines(file_path);
-  if (lines)
+  auto registry = get_reg_file(file_path);
+  if (registry)
   {
-    string meta_pattern = "#" + meta_value_name + "=";
-    for (const string& line : *lines)
+    if (auto data = registry->get_meta_data(meta_value_name))
     {
-      std::size_t pos = line.find(meta_pattern);
-      if (pos != std::string::npos)
-      {
-        output = line.substr(pos + meta_pattern.size());
-        // Remove quotes
-        output.erase(std::remove(output.begin(), output.end(), '\"'), output.end());
-        break;
-      }
+      output = *data;
+      // Remove quotes
+      output.erase(std::remove(output.begin(), output.end(), '\"'), output.end());
     }
   }
   else
@@ -2370,68 +2275,53 @@ vector<string> Helper::read_file_lines(const string& file_path)
 }
 
 /**
- * \brief Get the lines of a registry file, using the in-memory cache.
+ * \brief Get the parsed registry file, using the in-memory cache.
  * Every call stats the file and compares mtime + size against the cached entry; the cached
- * snapshot is only served while the file is unchanged on disk, otherwise it is re-read. This
- * keeps the cache correct even when the registry is rewritten outside WineGUI. The returned
- * shared_ptr is a stable snapshot, so a caller can keep iterating even if the cache entry is
- * invalidated or replaced concurrently.
+ * registry is only served while the file is unchanged on disk, otherwise it is re-read and
+ * re-indexed. This keeps the cache correct even when the registry is rewritten outside WineGUI.
+ * The returned shared_ptr is a stable snapshot, so a caller can keep using it even if the cache
+ * entry is invalidated or replaced concurrently.
  * \param[in] file_path File location of the registry file
- * \return Shared pointer to the (cached) file lines, or nullptr when the file could not be opened
+ * \return Shared pointer to the (cached) registry, or nullptr when the file could not be opened
  */
-std::shared_ptr<const vector<string>> Helper::get_reg_file_lines(const string& file_path)
+std::shared_ptr<const RegistryFile> Helper::get_reg_file(const string& file_path)
 {
-  std::lock_guard<std::mutex> lock(reg_file_cache_mutex);
   struct stat file_stat;
   if (stat(file_path.c_str(), &file_stat) != 0)
   {
     // File is gone (or unreadable); drop any stale entry and let the caller emit its own error
+    std::lock_guard<std::mutex> lock(reg_file_cache_mutex);
     reg_file_cache.erase(file_path);
     return nullptr;
   }
-  auto it = reg_file_cache.find(file_path);
-  if (it != reg_file_cache.end() && it->second.mtime.tv_sec == file_stat.st_mtim.tv_sec && it->second.mtime.tv_nsec == file_stat.st_mtim.tv_nsec &&
-      it->second.size == file_stat.st_size)
   {
-    return it->second.lines;
+    std::lock_guard<std::mutex> lock(reg_file_cache_mutex);
+    auto it = reg_file_cache.find(file_path);
+    if (it != reg_file_cache.end() && it->second.mtime.tv_sec == file_stat.st_mtim.tv_sec &&
+        it->second.mtime.tv_nsec == file_stat.st_mtim.tv_nsec && it->second.size == file_stat.st_size)
+    {
+      return it->second.registry;
+    }
   }
 
-  std::ifstream reg_file(file_path);
-  if (!reg_file.is_open())
+  // Read & index the file, without holding the lock (bottles are read in parallel). The cache entry is
+  // validated against the status of the file that was actually read, in case the file got replaced in between.
+  auto registry = RegistryFile::read(file_path, &file_stat);
+  std::lock_guard<std::mutex> lock(reg_file_cache_mutex);
+  if (!registry)
   {
     // Let the caller emit its own (function-specific) error and throw
     reg_file_cache.erase(file_path);
     return nullptr;
   }
-  auto lines = std::make_shared<vector<string>>();
-  lines->reserve(50);
-  string line;
-  line.reserve(128);
-  while (std::getline(reg_file, line))
-  {
-    lines->emplace_back(line);
-  }
-  reg_file.close();
-  auto cached = std::shared_ptr<const vector<string>>(std::move(lines));
-  reg_file_cache[file_path] = RegFileCacheEntry{file_stat.st_mtim, file_stat.st_size, cached};
-  return cached;
-}
-
-/**
- * \brief Clear the whole in-memory registry file cache.
- * Called at the start & end of every bottle refresh so the cache is empty at rest and
- * every refresh re-reads the registry files fresh from disk.
- */
-void Helper::invalidate_reg_cache()
-{
-  std::lock_guard<std::mutex> lock(reg_file_cache_mutex);
-  reg_file_cache.clear();
+  reg_file_cache[file_path] = RegFileCacheEntry{file_stat.st_mtim, file_stat.st_size, registry};
+  return registry;
 }
 
 /**
  * \brief Invalidate the cached registry files (user.reg & system.reg) for a single bottle prefix.
  * Call this right after mutating a bottle's registry so a subsequent read cannot serve the
- * pre-write value.
+ * pre-write value, or when the registry of the bottle is changed on disk.
  * \param[in] prefix_path Bottle prefix whose registry files should be dropped from the cache
  */
 void Helper::invalidate_reg_cache(const string& prefix_path)
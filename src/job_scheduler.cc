@@ -0,0 +1,355 @@
+/**
+ * Copyright (c) 2026 WineGUI
+ *
+ * \file    job_scheduler.cc
+ * \brief   Runs the bottle jobs (programs, installs, ...) on a bounded pool of worker threads
+ * \author  Melroy van den Berg <webmaster1989@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "job_scheduler.h"
+
+#include <algorithm>
+#include <iostream>
+#include <set>
+#include <stdexcept>
+#include <system_error>
+
+/**
+ * \brief Start the worker threads
+ * \param[in] worker_count Maximum number of jobs that run at the same time
+ * \param[in] on_jobs_changed Called (from any thread) when the job list is changed, may be empty
+ * \throws invalid_argument when the worker count is zero
+ */
+JobScheduler::JobScheduler(std::size_t worker_count, std::function<void()> on_jobs_changed)
+    : next_id_(1),
+      is_stopping_(false),
+      on_jobs_changed_(std::move(on_jobs_changed)),
+      launched_(std::make_shared<LaunchedJobs>())
+{
+  if (worker_count == 0)
+    throw std::invalid_argument("Job scheduler needs at least one worker");
+  launched_->on_jobs_changed = on_jobs_changed_;
+  workers_.reserve(worker_count);
+  for (std::size_t i = 0; i < worker_count; ++i)
+  {
+    workers_.emplace_back(&JobScheduler::run_worker, this);
+  }
+}
+
+/**
+ * \brief Cancel the queued jobs and wait until the running jobs are finished.
+ * Launched jobs are not waited for, they keep running (without calling back).
+ */
+JobScheduler::~JobScheduler()
+{
+  {
+    std::lock_guard<std::mutex> lock(launched_->mutex);
+    launched_->is_stopped = true;
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    is_stopping_ = true;
+    queue_.clear();
+  }
+  job_condition_.notify_all();
+  for (std::thread& worker : workers_)
+  {
+    if (worker.joinable())
+      worker.join();
+  }
+}
+
+/**
+ * \brief Add a job to the queue
+ * \param[in] name Description of the job (shown to the user)
+ * \param[in] bottle_prefix Bottle prefix path the job runs in
+ * \param[in] lock Serialization with the other jobs of the same bottle
+ * \param[in] job Work to do (on a worker thread)
+ * \param[in] on_cancelled Called (on the cancelling thread) when the job is cancelled before it started, may be empty.
+ * Not called for the jobs that are still queued when the scheduler is destroyed.
+ * \return Job ID
+ */
+std::size_t JobScheduler::submit(
+    const std::string& name, const std::string& bottle_prefix, Lock lock, std::function<void()> job, std::function<void()> on_cancelled)
+{
+  std::size_t id = 0;
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    id = next_id_++;
+    queue_.push_back({{id, name, bottle_prefix, lock, State::Queued}, std::move(job), std::move(on_cancelled)});
+  }
+  job_condition_.notify_one();
+  if (on_jobs_changed_)
+    on_jobs_changed_();
+  return id;
+}
+
+/**
+ * \brief Run a long-lived job (eg. a program) right away on its own thread, outside of the workers.
+ * The job doesn't lock its bottle and is not waited for when the scheduler is destroyed,
+ * so it may only use data it owns (or shares).
+ * \param[in] name Description of the job (shown to the user)
+ * \param[in] bottle_prefix Bottle prefix path the job runs in
+ * \param[in] job Work to do (on its own thread)
+ * \param[in] on_finished Called (on the same thread) after the job, only if the scheduler still exists, may be empty
+ * \return Job ID
+ */
+std::size_t JobScheduler::launch(const std::string& name,
+                                 const std::string& bottle_prefix,
+                                 std::function<void()> job,
+                                 std::function<void()> on_finished)
+{
+  std::size_t id = 0;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    id = next_id_++;
+  }
+  std::shared_ptr<LaunchedJobs> launched = launched_;
+  std::list<JobInfo>::iterator job_it;
+  {
+    std::lock_guard<std::mutex> lock(launched->mutex);
+    job_it = launched->jobs.insert(launched->jobs.end(), {id, name, bottle_prefix, Lock::None, State::Running});
+  }
+  try
+  {
+    std::thread(
+        [launched, job_it, job = std::move(job), on_finished = std::move(on_finished)]() mutable
+        {
+          try
+          {
+            job();
+          }
+          catch (const std::exception& error)
+          {
+            std::cerr << "Error: Job '" << job_it->name << "' failed: " << error.what() << std::endl;
+          }
+          // Release the resources of the job (eg. close the program output), before it's marked as finished
+          job = nullptr;
+
+          // Calling back while holding the lock, so the scheduler can't be destroyed in the meantime
+          std::lock_guard<std::mutex> lock(launched->mutex);
+          launched->jobs.erase(job_it);
+          if (launched->is_stopped)
+            return;
+          if (on_finished)
+            on_finished();
+          if (launched->on_jobs_changed)
+            launched->on_jobs_changed();
+        })
+        .detach();
+  }
+  catch (const std::system_error&)
+  {
+    std::lock_guard<std::mutex> lock(launched->mutex);
+    launched->jobs.erase(job_it);
+    throw;
+  }
+  if (on_jobs_changed_)
+    on_jobs_changed_();
+  return id;
+}
+
+/**
+ * \brief Remove a job from the queue, a running job can't be cancelled
+ * \param[in] id Job ID
+ * \return true if the job is removed from the queue, false if the job is already started (or finished)
+ */
+bool JobScheduler::cancel(std::size_t id)
+{
+  std::list<Job> cancelled_jobs;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = std::find_if(queue_.begin(), queue_.end(), [id](const Job& job) { return job.info.id == id; });
+    if (it == queue_.end())
+      return false;
+    // Destroy the job outside the lock
+    cancelled_jobs.splice(cancelled_jobs.end(), queue_, it);
+  }
+  // Other jobs of the bottle might be waiting for the cancelled job
+  job_condition_.notify_all();
+  idle_condition_.notify_all();
+  if (cancelled_jobs.front().on_cancelled)
+    cancelled_jobs.front().on_cancelled();
+  if (on_jobs_changed_)
+    on_jobs_changed_();
+  return true;
+}
+
+/**
+ * \brief Remove all queued jobs of a bottle
+ * \param[in] bottle_prefix Bottle prefix path
+ * \return Number of cancelled jobs
+ */
+std::size_t JobScheduler::cancel_bottle_jobs(const std::string& bottle_prefix)
+{
+  std::list<Job> cancelled_jobs;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto it = queue_.begin(); it != queue_.end();)
+    {
+      auto next = std::next(it);
+      if (it->info.bottle_prefix == bottle_prefix)
+        cancelled_jobs.splice(cancelled_jobs.end(), queue_, it);
+      it = next;
+    }
+  }
+  if (!cancelled_jobs.empty())
+  {
+    idle_condition_.notify_all();
+    for (Job& job : cancelled_jobs)
+    {
+      if (job.on_cancelled)
+        job.on_cancelled();
+    }
+    if (on_jobs_changed_)
+      on_jobs_changed_();
+  }
+  return cancelled_jobs.size();
+}
+
+/**
+ * \brief Check if a job of the bottle is running (incl. the launched jobs)
+ * \param[in] bottle_prefix Bottle prefix path
+ * \return true if one or more jobs of the bottle are running, otherwise false
+ */
+bool JobScheduler::has_running_jobs(const std::string& bottle_prefix) const
+{
+  auto is_bottle_job = [&bottle_prefix](const JobInfo& job) { return job.bottle_prefix == bottle_prefix; };
+  {
+    std::lock_guard<std::mutex> lock(launched_->mutex);
+    if (std::any_of(launched_->jobs.begin(), launched_->jobs.end(), is_bottle_job))
+      return true;
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  return std::any_of(running_.begin(), running_.end(), is_bottle_job);
+}
+
+/**
+ * \brief Get the running jobs (incl. the launched jobs), followed by the queued jobs (in the order they will be started)
+ * \return List of jobs
+ */
+std::vector<JobScheduler::JobInfo> JobScheduler::get_jobs() const
+{
+  std::vector<JobInfo> jobs;
+  {
+    std::lock_guard<std::mutex> lock(launched_->mutex);
+    jobs.assign(launched_->jobs.begin(), launched_->jobs.end());
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  jobs.insert(jobs.begin(), running_.begin(), running_.end());
+  jobs.reserve(jobs.size() + queue_.size());
+  for (const Job& job : queue_)
+  {
+    jobs.push_back(job.info);
+  }
+  return jobs;
+}
+
+/**
+ * \brief Wait until all the jobs are finished (no queued nor running jobs), launched jobs are not waited for
+ */
+void JobScheduler::wait_until_idle()
+{
+  std::unique_lock<std::mutex> lock(mutex_);
+  idle_condition_.wait(lock, [this] { return queue_.empty() && running_.empty(); });
+}
+
+/**
+ * \brief Worker thread, runs the jobs one by one
+ */
+void JobScheduler::run_worker()
+{
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true)
+  {
+    auto job_it = queue_.end();
+    job_condition_.wait(lock,
+                        [this, &job_it]
+                        {
+                          if (is_stopping_)
+                            return true;
+                          job_it = find_runnable_job();
+                          return job_it != queue_.end();
+                        });
+    if (is_stopping_)
+      break;
+
+    Job job = std::move(*job_it);
+    queue_.erase(job_it);
+    job.info.state = State::Running;
+    auto running_it = running_.insert(running_.end(), job.info);
+    lock.unlock();
+    if (on_jobs_changed_)
+      on_jobs_changed_();
+
+    try
+    {
+      job.execute();
+    }
+    catch (const std::exception& error)
+    {
+      std::cerr << "Error: Job '" << job.info.name << "' failed: " << error.what() << std::endl;
+    }
+    // Release the resources of the job (eg. close the program output), before it's marked as finished
+    job.execute = nullptr;
+
+    lock.lock();
+    running_.erase(running_it);
+    lock.unlock();
+    // Jobs of the same bottle might be waiting for this job
+    job_condition_.notify_all();
+    if (on_jobs_changed_)
+      on_jobs_changed_();
+    idle_condition_.notify_all();
+    lock.lock();
+  }
+}
+
+/**
+ * \brief Find the first queued job that can be started, while keeping the submit order of the jobs of each bottle
+ * \return Iterator to the job, or the end of the queue if no job can be started
+ */
+std::list<JobScheduler::Job>::iterator JobScheduler::find_runnable_job()
+{
+  std::set<std::string> waiting_bottles;
+  for (auto it = queue_.begin(); it != queue_.end(); ++it)
+  {
+    const JobInfo& job = it->info;
+    if (job.lock == Lock::None)
+      return it;
+    if (waiting_bottles.contains(job.bottle_prefix))
+      continue;
+    if (is_runnable(job))
+      return it;
+    waiting_bottles.insert(job.bottle_prefix);
+  }
+  return queue_.end();
+}
+
+/**
+ * \brief Check if a job can run next to the running jobs of its bottle
+ * \param[in] job Queued job
+ * \return true if the job can be started, otherwise false
+ */
+bool JobScheduler::is_runnable(const JobInfo& job) const
+{
+  return std::none_of(running_.begin(), running_.end(),
+                      [&job](const JobInfo& running)
+                      {
+                        if (running.bottle_prefix != job.bottle_prefix || running.lock == Lock::None)
+                          return false;
+                        return job.lock == Lock::Exclusive || running.lock == Lock::Exclusive;
+                      });
+}
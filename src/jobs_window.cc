@@ -0,0 +1,152 @@
+/**
+ * Copyright (c) 2026 WineGUI
+ *
+ * \file    jobs_window.cc
+ * \brief   Running & queued jobs of the machines GTK4 window class
+ * \author  Melroy van den Berg <webmaster1989@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "jobs_window.h"
+
+#include <glibmm/miscutils.h>
+
+/**
+ * \brief Constructor
+ * \param parent Reference to parent GTK Window
+ */
+JobsWindow::JobsWindow(Gtk::Window& parent)
+    : vbox(Gtk::Orientation::VERTICAL, 4),
+      hbox_buttons(Gtk::Orientation::HORIZONTAL, 4),
+      header_jobs_label("Running & queued jobs"),
+      close_button("Close")
+{
+  set_transient_for(parent);
+  set_title("Jobs");
+  set_default_size(450, 350);
+  Pango::FontDescription fd_label;
+  fd_label.set_size(12 * PANGO_SCALE);
+  fd_label.set_weight(Pango::Weight::BOLD);
+  auto font_label = Pango::Attribute::create_attr_font_desc(fd_label);
+  Pango::AttrList attr_list_header_label;
+  attr_list_header_label.insert(font_label);
+  header_jobs_label.set_attributes(attr_list_header_label);
+  header_jobs_label.set_margin_top(5);
+  header_jobs_label.set_margin_bottom(5);
+
+  empty_label.set_markup("<i>No jobs are running.</i>");
+  empty_label.set_halign(Gtk::Align::CENTER);
+  empty_label.set_valign(Gtk::Align::CENTER);
+  empty_label.set_expand();
+
+  jobs_listbox.set_selection_mode(Gtk::SelectionMode::NONE);
+  jobs_listbox.add_css_class("boxed-list");
+  jobs_scroll.set_child(jobs_listbox);
+  jobs_scroll.set_policy(Gtk::PolicyType::NEVER, Gtk::PolicyType::AUTOMATIC);
+  jobs_scroll.set_margin(6);
+  jobs_scroll.set_expand();
+
+  hbox_buttons.set_halign(Gtk::Align::END);
+  hbox_buttons.set_margin(6);
+  hbox_buttons.append(close_button);
+
+  vbox.append(header_jobs_label);
+  vbox.append(empty_label);
+  vbox.append(jobs_scroll);
+  vbox.append(hbox_buttons);
+  set_child(vbox);
+  set_jobs({});
+
+  // Signals
+  close_button.signal_clicked().connect(sigc::mem_fun(*this, &JobsWindow::on_close_button_clicked));
+  // Hide window instead of destroy
+  signal_close_request().connect(
+      [this]() -> bool
+      {
+        set_visible(false);
+        return true; // stop default destroy
+      },
+      false);
+}
+
+/**
+ * \brief Destructor
+ */
+JobsWindow::~JobsWindow()
+{
+}
+
+/**
+ * \brief Show the window
+ */
+void JobsWindow::show()
+{
+  present();
+}
+
+/**
+ * \brief Replace the jobs list (also when the window is hidden, so it's up-to-date once shown)
+ * \param[in] jobs Running jobs, followed by the queued jobs
+ */
+void JobsWindow::set_jobs(const std::vector<JobScheduler::JobInfo>& jobs)
+{
+  while (Gtk::ListBoxRow* row = jobs_listbox.get_row_at_index(0))
+  {
+    jobs_listbox.remove(*row);
+  }
+
+  for (const JobScheduler::JobInfo& job : jobs)
+  {
+    auto* name_label = Gtk::make_managed<Gtk::Label>();
+    name_label->set_markup("<b>" + Glib::Markup::escape_text(job.name) + "</b>");
+    name_label->set_xalign(0.0);
+    Glib::ustring bottle_name = job.bottle_prefix.empty() ? "All machines" : Glib::path_get_basename(job.bottle_prefix);
+    Glib::ustring state = (job.state == JobScheduler::State::Running) ? "Running" : "Queued";
+    auto* status_label = Gtk::make_managed<Gtk::Label>(bottle_name + " - " + state);
+    status_label->set_xalign(0.0);
+    status_label->add_css_class("dim-label");
+
+    auto* label_vbox = Gtk::make_managed<Gtk::Box>(Gtk::Orientation::VERTICAL, 2);
+    label_vbox->append(*name_label);
+    label_vbox->append(*status_label);
+    label_vbox->set_hexpand(true);
+
+    auto* row_hbox = Gtk::make_managed<Gtk::Box>(Gtk::Orientation::HORIZONTAL, 8);
+    row_hbox->set_margin(6);
+    row_hbox->append(*label_vbox);
+    // Only jobs that are not started yet can be cancelled
+    if (job.state == JobScheduler::State::Queued)
+    {
+      auto* cancel_button = Gtk::make_managed<Gtk::Button>("Cancel");
+      cancel_button->set_valign(Gtk::Align::CENTER);
+      cancel_button->signal_clicked().connect([this, job_id = job.id] { cancel_job.emit(job_id); });
+      row_hbox->append(*cancel_button);
+    }
+
+    auto* row = Gtk::make_managed<Gtk::ListBoxRow>();
+    row->set_child(*row_hbox);
+    row->set_activatable(false);
+    jobs_listbox.append(*row);
+  }
+  empty_label.set_visible(jobs.empty());
+  jobs_scroll.set_visible(!jobs.empty());
+}
+
+/**
+ * \brief Triggered when close button is clicked
+ */
+void JobsWindow::on_close_button_clicked()
+{
+  set_visible(false);
+}
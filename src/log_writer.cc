@@ -0,0 +1,252 @@
+/**
+ * Copyright (c) 2026 WineGUI
+ *
+ * \file    log_writer.cc
+ * \brief   Writes the output of running programs to the bottle log files (thread)
+ * \author  Melroy van den Berg <webmaster1989@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "log_writer.h"
+#include "helper.h"
+#include "output_ring_buffer.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <iostream>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+
+/**
+ * \brief Start the log writer thread
+ * \param[in] max_file_size Maximum size (in bytes) of a log file, before it's rotated
+ * \param[in] max_rotated_files Number of rotated log files to keep (winegui.log.1 up to winegui.log.N)
+ */
+LogWriter::LogWriter(std::size_t max_file_size, int max_rotated_files)
+    : is_notified_(false),
+      is_stopping_(false),
+      max_file_size_(max_file_size),
+      max_rotated_files_(max_rotated_files),
+      thread_(&LogWriter::run, this)
+{
+}
+
+/**
+ * \brief Write the remaining output to disk and stop the log writer thread
+ */
+LogWriter::~LogWriter()
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    is_stopping_ = true;
+  }
+  condition_.notify_one();
+  if (thread_.joinable())
+    thread_.join();
+}
+
+/**
+ * \brief Write the output of a program to the log file of the bottle, until the output is closed
+ * \param[in] bottle_prefix Bottle prefix path
+ * \param[in] output Output buffer of the program, call notify() when output is added to the buffer or when it's closed
+ */
+void LogWriter::add_output(const std::string& bottle_prefix, const std::shared_ptr<OutputRingBuffer>& output)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  sources_.push_back({bottle_prefix, output, '\n'});
+}
+
+/**
+ * \brief Wake up the writer thread, new output is available (can be called from any thread)
+ */
+void LogWriter::notify()
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    is_notified_ = true;
+  }
+  condition_.notify_one();
+}
+
+/**
+ * \brief Writer thread, writes the output of all programs to disk each time it's notified
+ */
+void LogWriter::run()
+{
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true)
+  {
+    condition_.wait(lock, [this] { return is_notified_ || is_stopping_; });
+    is_notified_ = false;
+    bool is_stopping = is_stopping_;
+    // Only this thread removes sources, so the sources stay valid while the lock is released
+    std::vector<Source*> sources;
+    for (Source& source : sources_)
+    {
+      sources.push_back(&source);
+    }
+    lock.unlock();
+
+    std::vector<Source*> finished_sources;
+    for (Source* source : sources)
+    {
+      // Check before reading, so no output is missed when the program finishes in between
+      bool is_finished = source->output->is_closed();
+      write_output(*source, is_finished);
+      if (is_finished)
+        finished_sources.push_back(source);
+    }
+
+    lock.lock();
+    sources_.remove_if([&finished_sources](const Source& source)
+                       { return std::find(finished_sources.begin(), finished_sources.end(), &source) != finished_sources.end(); });
+    // Close the log files of bottles without running programs
+    std::vector<std::string> idle_bottles;
+    for (const auto& [bottle_prefix, log_file] : files_)
+    {
+      if (is_stopping || std::none_of(sources_.begin(), sources_.end(), [&](const Source& source) { return source.bottle_prefix == bottle_prefix; }))
+        idle_bottles.push_back(bottle_prefix);
+    }
+    for (const std::string& bottle_prefix : idle_bottles)
+    {
+      close_log_file(bottle_prefix);
+    }
+    if (is_stopping)
+      break;
+  }
+}
+
+/**
+ * \brief Write the buffered output of a program to the log file of its bottle
+ * \param[in,out] source Program output
+ * \param[in] is_finished The program is finished, this is the last output
+ */
+void LogWriter::write_output(Source& source, bool is_finished)
+{
+  std::string output;
+  std::size_t dropped = source.output->read(output);
+  if (dropped > 0)
+  {
+    std::string skipped_message = "[WineGUI] " + std::to_string(dropped) + " bytes of output skipped\n";
+    output.insert(0, (source.last_char != '\n') ? "\n" + skipped_message : skipped_message);
+  }
+  // Needs new line at end of the output of the program?
+  if (is_finished && (output.empty() ? source.last_char : output.back()) != '\n')
+    output += '\n';
+  if (output.empty())
+    return;
+
+  LogFile* log_file = &open_log_file(source.bottle_prefix);
+  if (log_file->fd >= 0 && log_file->size > 0 && log_file->size + output.size() > max_file_size_)
+  {
+    rotate_log_file(source.bottle_prefix, *log_file);
+    log_file = &open_log_file(source.bottle_prefix);
+  }
+  if (log_file->fd < 0)
+    return;
+
+  const char* data = output.data();
+  std::size_t remaining = output.size();
+  while (remaining > 0)
+  {
+    ssize_t count = ::write(log_file->fd, data, remaining);
+    if (count < 0)
+    {
+      if (errno == EINTR)
+        continue;
+      std::cerr << "Error: Couldn't write debug logging to log file. Error " << std::strerror(errno) << std::endl;
+      break;
+    }
+    data += count;
+    remaining -= static_cast<std::size_t>(count);
+    log_file->size += static_cast<std::size_t>(count);
+  }
+  source.last_char = output.back();
+}
+
+/**
+ * \brief Get the opened log file of a bottle, the log file is opened (or created) when needed
+ * \param[in] bottle_prefix Bottle prefix path
+ * \return Log file, the file descriptor is -1 if the log file could not be opened
+ */
+LogWriter::LogFile& LogWriter::open_log_file(const std::string& bottle_prefix)
+{
+  auto it = files_.find(bottle_prefix);
+  if (it != files_.end())
+  {
+    struct stat file_stat;
+    if (it->second.fd < 0 || (fstat(it->second.fd, &file_stat) == 0 && file_stat.st_nlink > 0))
+      return it->second;
+    // The log file is removed in the meantime (eg. by the user), create a new one
+    close_log_file(bottle_prefix);
+  }
+
+  std::string log_path = Helper::get_log_file_path(bottle_prefix);
+  LogFile log_file{::open(log_path.c_str(), O_WRONLY | O_APPEND | O_CREAT | O_CLOEXEC, 0644), 0};
+  if (log_file.fd < 0)
+  {
+    std::cerr << "Error: Couldn't open log file " << log_path << ". Error " << std::strerror(errno) << std::endl;
+  }
+  else
+  {
+    struct stat file_stat;
+    if (fstat(log_file.fd, &file_stat) == 0)
+      log_file.size = static_cast<std::size_t>(file_stat.st_size);
+  }
+  return files_[bottle_prefix] = log_file;
+}
+
+/**
+ * \brief Rotate the log file of a bottle (winegui.log becomes winegui.log.1, winegui.log.1 becomes winegui.log.2, etc.)
+ * \param[in] bottle_prefix Bottle prefix path
+ * \param[in] log_file Opened log file, which is closed
+ */
+void LogWriter::rotate_log_file(const std::string& bottle_prefix, LogFile& log_file)
+{
+  std::string log_path = Helper::get_log_file_path(bottle_prefix);
+  if (max_rotated_files_ > 0)
+  {
+    // The oldest log file is overwritten
+    for (int i = max_rotated_files_ - 1; i > 0; --i)
+    {
+      std::rename((log_path + "." + std::to_string(i)).c_str(), (log_path + "." + std::to_string(i + 1)).c_str());
+    }
+    std::rename(log_path.c_str(), (log_path + ".1").c_str());
+  }
+  else if (log_file.fd >= 0 && ftruncate(log_file.fd, 0) == 0)
+  {
+    // Nothing to keep, start again with an empty log file
+    log_file.size = 0;
+    return;
+  }
+  close_log_file(bottle_prefix);
+}
+
+/**
+ * \brief Close the log file of a bottle
+ * \param[in] bottle_prefix Bottle prefix path
+ */
+void LogWriter::close_log_file(const std::string& bottle_prefix)
+{
+  auto it = files_.find(bottle_prefix);
+  if (it == files_.end())
+    return;
+  if (it->second.fd >= 0)
+    ::close(it->second.fd);
+  files_.erase(it);
+}
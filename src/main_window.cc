@@ -314,6 +314,20 @@ void MainWindow::set_wine_bottles(std::list<BottleItem>& bottles)
   set_sensitive_toolbar_buttons(bottles.size() > 0);
 }
 
+/**
+ * \brief Update a single bottle row after its details are changed (eg. loaded from disk), without rebuilding the list
+ * \param[in] bottle - Wine Bottle item object
+ */
+void MainWindow::update_wine_bottle(BottleItem& bottle)
+{
+  bottle.update_ui();
+  // Also refresh the detailed info panel when it shows this bottle
+  if (bottle.is_selected())
+  {
+    on_bottle_row_clicked(&bottle);
+  }
+}
+
 /**
  * \brief Set provided bottle as current selected row (if nothing was selected yet)
  * \param[in] bottle - Wine Bottle item object
@@ -454,7 +468,18 @@ DialogWindow* MainWindow::show_question_dialog(Gtk::Window* parent, const Glib::
  */
 void MainWindow::show_busy_install_dialog(Gtk::Window& parent, const Glib::ustring& message)
 {
-  busy_dialog_.set_message("Installing software", message);
+  show_busy_dialog(parent, "Installing software", message);
+}
+
+/**
+ * \brief Show busy indicator with a custom heading, with another parent
+ * \param[in] parent Parent GTK Window (set to be the GTK transient for)
+ * \param[in] heading Heading of the busy dialog
+ * \param[in] message Given the user more information what is going on
+ */
+void MainWindow::show_busy_dialog(Gtk::Window& parent, const Glib::ustring& heading, const Glib::ustring& message)
+{
+  busy_dialog_.set_message(heading, message);
   busy_dialog_.set_transient_for(parent);
   busy_dialog_.present();
 }
@@ -641,10 +666,20 @@ void MainWindow::on_bottle_row_clicked(Gtk::ListBoxRow* row)
     auto current_bottle = dynamic_cast<BottleItem*>(row);
     // Set bottle details
     set_detailed_info(*current_bottle);
-    // Set application list
-    set_application_list(current_bottle->wine_location(), current_bottle->app_list(), current_bottle->bit());
+    if (current_bottle->is_loading())
+    {
+      // The application list is set once the details are loaded (see update_wine_bottle)
+      reset_application_list();
+    }
+    else
+    {
+      // Set application list
+      set_application_list(current_bottle->wine_location(), current_bottle->app_list(), current_bottle->bit());
+    }
     // Clear the application filter
     app_list_search_entry.set_text("");
+    // Actions on a bottle that is still loading would use incomplete details
+    set_sensitive_toolbar_buttons(!current_bottle->is_loading());
 
     // Signal activate Bottle with current BottleItem as parameter to the dispatcher
     // Which updates the connected modules accordingly.
@@ -667,6 +702,9 @@ void MainWindow::on_bottle_row_right_click(BottleItem* bottle, double x, double
   // Edit/Clone/Configure/Delete actions operate on the bottle the user actually clicked.
   if (!bottle->is_selected())
     bottles_listbox.select_row(*bottle);
+  // No actions until the details of the bottle are loaded
+  if (bottle->is_loading())
+    return;
 
   // Translate the click position to the scrolled window (context menu parent) coordinate space
   double dest_x = x;
@@ -891,6 +929,14 @@ bool MainWindow::on_delete_window()
  */
 void MainWindow::set_detailed_info(const BottleItem& bottle)
 {
+  if (bottle.is_loading())
+  {
+    reset_detailed_info();
+    folder_name_label.set_text(bottle.folder_name());
+    wine_location_label.set_text(bottle.wine_location());
+    name_label.set_text("Loading...");
+    return;
+  }
   // Set right side of the GUI
   // General
   name_label.set_text(bottle.name());
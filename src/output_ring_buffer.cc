@@ -0,0 +1,108 @@
+/**
+ * Copyright (c) 2026 WineGUI
+ *
+ * \file    output_ring_buffer.cc
+ * \brief   Fixed-size buffer for streaming program output
+ * \author  Melroy van den Berg <webmaster1989@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "output_ring_buffer.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+/**
+ * \brief Construct an empty ring buffer
+ * \param[in] capacity Maximum number of bytes kept in the buffer
+ * \throws invalid_argument when the capacity is zero
+ */
+OutputRingBuffer::OutputRingBuffer(std::size_t capacity) : buffer_(capacity)
+{
+  if (capacity == 0)
+    throw std::invalid_argument("Ring buffer capacity can not be zero");
+}
+
+/**
+ * \brief Append output to the buffer, the oldest output is overwritten when the buffer is full
+ * \param[in] data Output
+ * \return true if the buffer was empty (the reader needs to be notified), otherwise false
+ */
+bool OutputRingBuffer::write(std::string_view data)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  bool was_empty = (size_ == 0);
+  std::size_t capacity = buffer_.size();
+  if (data.size() >= capacity)
+  {
+    // Only the last part of the data fits
+    dropped_ += size_ + (data.size() - capacity);
+    data = data.substr(data.size() - capacity);
+    start_ = 0;
+    size_ = 0;
+  }
+  else if (size_ + data.size() > capacity)
+  {
+    std::size_t overflow = size_ + data.size() - capacity;
+    start_ = (start_ + overflow) % capacity;
+    size_ -= overflow;
+    dropped_ += overflow;
+  }
+
+  // Copy in (at most) two parts, in case the data wraps around the end of the buffer
+  std::size_t end = (start_ + size_) % capacity;
+  std::size_t first_part = std::min(data.size(), capacity - end);
+  std::copy_n(data.data(), first_part, buffer_.begin() + static_cast<std::ptrdiff_t>(end));
+  std::copy_n(data.data() + first_part, data.size() - first_part, buffer_.begin());
+  size_ += data.size();
+  return was_empty;
+}
+
+/**
+ * \brief Take all the output from the buffer
+ * \param[out] output The buffered output is appended to this string
+ * \return Number of bytes that are dropped (overwritten) since the previous read, these bytes came before the output
+ */
+std::size_t OutputRingBuffer::read(std::string& output)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::size_t capacity = buffer_.size();
+  std::size_t first_part = std::min(size_, capacity - start_);
+  output.append(buffer_.data() + start_, first_part);
+  output.append(buffer_.data(), size_ - first_part);
+  start_ = 0;
+  size_ = 0;
+  std::size_t dropped = dropped_;
+  dropped_ = 0;
+  return dropped;
+}
+
+/**
+ * \brief Mark the writer as finished, the remaining output can still be read
+ */
+void OutputRingBuffer::close()
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  is_closed_ = true;
+}
+
+/**
+ * \brief Check if the writer is finished
+ * \return true if no output will be added anymore, otherwise false
+ */
+bool OutputRingBuffer::is_closed() const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return is_closed_;
+}
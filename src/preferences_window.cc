@@ -70,6 +70,8 @@ PreferencesWindow::PreferencesWindow(Gtk::Window& parent)
   logging_stderr_header.set_markup("<b>Log Standard Error</b>");
   check_for_updates_header.set_halign(Gtk::Align::START);
   check_for_updates_header.set_markup("<b>Check for Updates</b>");
+  runner_downloads_header.set_halign(Gtk::Align::START);
+  runner_downloads_header.set_markup("<b>Parallel Wine Runner Downloads</b>");
 
   // Default Wine storage location
   Gtk::Box* default_folder_vbox = Gtk::make_managed<Gtk::Box>(Gtk::Orientation::VERTICAL, 6);
@@ -135,6 +137,24 @@ PreferencesWindow::PreferencesWindow(Gtk::Window& parent)
 
   vbox.append(*Gtk::make_managed<Gtk::Separator>(Gtk::Orientation::HORIZONTAL));
 
+  // Parallel Wine runner downloads
+  runner_downloads_spin_button.set_adjustment(Gtk::Adjustment::create(3.0, 1.0, 8.0, 1.0));
+  runner_downloads_spin_button.set_valign(Gtk::Align::CENTER);
+  Gtk::Box* runner_downloads_vbox = Gtk::make_managed<Gtk::Box>(Gtk::Orientation::VERTICAL, 6);
+  runner_downloads_vbox->set_hexpand(true);
+  runner_downloads_vbox->set_halign(Gtk::Align::START);
+  runner_downloads_vbox->append(runner_downloads_header);
+  runner_downloads_vbox->append(
+      *Gtk::make_managed<Gtk::Label>("Maximum number of Wine runners that are installed at the same time (applies after a restart)."));
+  Gtk::Box* runner_downloads_box = Gtk::make_managed<Gtk::Box>(Gtk::Orientation::HORIZONTAL, 6);
+  runner_downloads_box->append(*runner_downloads_vbox);
+  runner_downloads_box->append(runner_downloads_spin_button);
+  runner_downloads_box->set_margin_top(10);
+  runner_downloads_box->set_margin_bottom(10);
+  vbox.append(*runner_downloads_box);
+
+  vbox.append(*Gtk::make_managed<Gtk::Separator>(Gtk::Orientation::HORIZONTAL));
+
   // Save/cancel buttons
   hbox_buttons.set_halign(Gtk::Align::END);
   hbox_buttons.set_valign(Gtk::Align::END);
@@ -177,6 +197,7 @@ void PreferencesWindow::show()
   display_default_wine_machine_switch.set_active(general_config.display_default_wine_machine);
   enable_logging_stderr_switch.set_active(general_config.enable_logging_stderr);
   check_for_updates_switch.set_active(general_config.check_for_updates_startup);
+  runner_downloads_spin_button.set_value(general_config.max_runner_downloads);
   // Call parent present
   present();
 }
@@ -238,6 +259,7 @@ void PreferencesWindow::on_save_button_clicked()
   general_config.display_default_wine_machine = display_default_wine_machine_switch.get_active();
   general_config.enable_logging_stderr = enable_logging_stderr_switch.get_active();
   general_config.check_for_updates_startup = check_for_updates_switch.get_active();
+  general_config.max_runner_downloads = runner_downloads_spin_button.get_value_as_int();
   if (!GeneralConfigFile::write_config_file(general_config))
   {
     Gtk::MessageDialog dialog(*this, "Error occurred during saving generic config file.", false, Gtk::MessageType::ERROR, Gtk::ButtonsType::OK);
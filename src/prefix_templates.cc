@@ -0,0 +1,370 @@
+/**
+ * Copyright (c) 2026 WineGUI
+ *
+ * \file    prefix_templates.cc
+ * \brief   Pre-provisioned Wine prefixes, used to create new bottles fast
+ * \author  Melroy van den Berg <webmaster1989@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "prefix_templates.h"
+#include "helper.h"
+#include "registry_file.h"
+#include "wine_version_cache.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <glibmm/fileutils.h>
+#include <glibmm/miscutils.h>
+#include <iostream>
+#include <optional>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+// Marker file next to a template directory, which is only present when the template is completely built
+static const std::string TemplateReadySuffix = ".ready";
+// Maximum time to wait until the registry of a new template is written to disk
+static constexpr std::chrono::minutes TemplateBuildTimeout(5);
+// Registry values (key & value name in system.reg) that identify the machine, these are unique per bottle
+static const std::vector<std::pair<std::string, std::string>> MachineIdValues = {
+    {"Software\\\\Microsoft\\\\Cryptography", "MachineGuid"},
+    {"Software\\\\Microsoft\\\\SQMClient", "MachineId"},
+};
+
+/**
+ * \brief Stable (across runs) 64-bit hash of a string (FNV-1a), formatted as hexadecimal
+ * \param[in] data Data to hash
+ * \return Hash, 16 hexadecimal characters
+ */
+static std::string hash_string(const std::string& data)
+{
+  std::uint64_t hash = 14695981039346656037ULL;
+  for (unsigned char c : data)
+  {
+    hash ^= c;
+    hash *= 1099511628211ULL;
+  }
+  static constexpr char HexDigits[] = "0123456789abcdef";
+  std::string result(16, '0');
+  for (int i = 15; i >= 0; --i)
+  {
+    result[static_cast<std::size_t>(i)] = HexDigits[hash & 0xF];
+    hash >>= 4;
+  }
+  return result;
+}
+
+/**
+ * \brief Replace all occurrences of a string
+ * \param[in,out] text Text
+ * \param[in] from String to search for
+ * \param[in] to Replacement
+ * \return true if at least one occurrence is replaced
+ */
+static bool replace_all(std::string& text, const std::string& from, const std::string& to)
+{
+  bool is_replaced = false;
+  for (std::size_t pos = text.find(from); pos != std::string::npos; pos = text.find(from, pos + to.size()))
+  {
+    text.replace(pos, from.size(), to);
+    is_replaced = true;
+  }
+  return is_replaced;
+}
+
+/**
+ * \brief Convert an absolute Unix path to the (escaped) notation Wine uses in its registry files (Z:\\path\\to)
+ * \param[in] path Unix path
+ * \return Registry notation of the path
+ */
+static std::string to_registry_path(const std::string& path)
+{
+  std::string registry_path = "Z:" + path;
+  replace_all(registry_path, "/", "\\\\");
+  return registry_path;
+}
+
+/**
+ * \brief Create a random (version 4) GUID
+ * \param[in] is_upper_case Use uppercase hexadecimal digits
+ * \return GUID, eg. 5b8f4bd6-2c3a-4e1f-9d7b-0a1b2c3d4e5f
+ */
+static std::string create_guid(bool is_upper_case)
+{
+  std::random_device random_device;
+  std::uniform_int_distribution<unsigned int> distribution(0, 255);
+  std::array<unsigned int, 16> bytes;
+  for (unsigned int& byte : bytes)
+  {
+    byte = distribution(random_device);
+  }
+  bytes[6] = (bytes[6] & 0x0F) | 0x40; // Version 4
+  bytes[8] = (bytes[8] & 0x3F) | 0x80; // Variant 1
+  const char* hex_digits = is_upper_case ? "0123456789ABCDEF" : "0123456789abcdef";
+  std::string guid;
+  for (std::size_t i = 0; i < bytes.size(); ++i)
+  {
+    if (i == 4 || i == 6 || i == 8 || i == 10)
+      guid += '-';
+    guid += hex_digits[bytes[i] >> 4];
+    guid += hex_digits[bytes[i] & 0xF];
+  }
+  return guid;
+}
+
+/**
+ * \brief Replace strings in the registry files of a bottle
+ * \param[in] prefix_path Bottle prefix path
+ * \param[in] replacements Pairs of the string to search for & its replacement
+ * \throws runtime_error when a registry file could not be written
+ */
+static void replace_in_registry_files(const std::string& prefix_path, const std::vector<std::pair<std::string, std::string>>& replacements)
+{
+  for (const char* file_name : {"system.reg", "user.reg", "userdef.reg"})
+  {
+    std::string file_path = Glib::build_filename(prefix_path, file_name);
+    std::ifstream input(file_path, std::ios::binary);
+    if (!input.is_open())
+      continue;
+    std::stringstream buffer;
+    buffer << input.rdbuf();
+    input.close();
+    std::string contents = buffer.str();
+    bool is_changed = false;
+    for (const auto& [from, to] : replacements)
+    {
+      is_changed |= replace_all(contents, from, to);
+    }
+    if (!is_changed)
+      continue;
+    std::ofstream output(file_path, std::ios::binary | std::ios::trunc);
+    output << contents;
+    if (!output)
+      throw std::runtime_error("Could not update registry file: " + file_path);
+  }
+}
+
+/**
+ * \brief Constructor
+ * \param[in] templates_dir Directory where the templates are stored
+ */
+PrefixTemplates::PrefixTemplates(std::string templates_dir) : templates_dir_(std::move(templates_dir))
+{
+}
+
+/**
+ * \brief Get the templates of the WineGUI data directory
+ * \return Templates instance
+ */
+PrefixTemplates& PrefixTemplates::get_instance()
+{
+  static PrefixTemplates instance(Glib::build_path(G_DIR_SEPARATOR_S, std::vector<std::string>{Glib::get_user_data_dir(), "winegui", "templates"}));
+  return instance;
+}
+
+/**
+ * \brief Get the directory name of the template for the given settings
+ * \param[in] wine_executable Resolved Wine executable path
+ * \param[in] wine_version Wine version
+ * \param[in] bit Bottle bitness
+ * \param[in] disable_gecko_mono Gecko & Mono are disabled
+ * \return Template name: <runner hash>-<version hash>-<bitness>-<gecko-mono setting>
+ */
+std::string PrefixTemplates::get_template_name(const std::string& wine_executable,
+                                               const std::string& wine_version,
+                                               BottleTypes::Bit bit,
+                                               bool disable_gecko_mono)
+{
+  return hash_string(wine_executable) + "-" + hash_string(wine_version) + "-" + (bit == BottleTypes::Bit::win32 ? "win32" : "win64") + "-" +
+         (disable_gecko_mono ? "no-gecko-mono" : "gecko-mono");
+}
+
+/**
+ * \brief Fix the paths in a bottle that is copied from a template, the registry files could still refer to the template
+ * location. The user directories (drive_c/users/<user>) are already correct, since the templates are per user.
+ * \param[in] template_path Template directory the bottle is copied from
+ * \param[in] prefix_path Bottle prefix path
+ * \throws runtime_error when a registry file could not be written
+ */
+void PrefixTemplates::fix_user_paths(const std::string& template_path, const std::string& prefix_path)
+{
+  replace_in_registry_files(prefix_path, {{template_path, prefix_path}, {to_registry_path(template_path), to_registry_path(prefix_path)}});
+}
+
+/**
+ * \brief Give a bottle that is copied from a template its own machine IDs (eg. the MachineGuid some programs use to
+ * identify the machine), otherwise all the bottles of the same template would share them.
+ * \param[in] prefix_path Bottle prefix path
+ * \throws runtime_error when a registry file could not be written
+ */
+void PrefixTemplates::regenerate_machine_ids(const std::string& prefix_path)
+{
+  std::shared_ptr<const RegistryFile> system_reg = RegistryFile::read(Glib::build_filename(prefix_path, "system.reg"));
+  if (!system_reg)
+    return;
+  std::vector<std::pair<std::string, std::string>> replacements;
+  for (const auto& [key_name, value_name] : MachineIdValues)
+  {
+    const RegistryFile::Key* key = system_reg->find_key(key_name);
+    if (key == nullptr)
+      continue;
+    std::optional<std::string_view> value = system_reg->find_value(*key, value_name);
+    // Only GUID string values, eg. "5b8f4bd6-..." or "{5B8F4BD6-...}"
+    if (!value || value->size() < 2 || value->front() != '"' || value->back() != '"')
+      continue;
+    std::string guid(value->substr(1, value->size() - 2));
+    bool has_braces = guid.starts_with('{') && guid.ends_with('}');
+    if (guid.size() != (has_braces ? 38u : 36u))
+      continue;
+    bool is_upper_case = std::any_of(guid.begin(), guid.end(), [](char c) { return c >= 'A' && c <= 'F'; });
+    std::string new_guid = create_guid(is_upper_case);
+    replacements.emplace_back(guid, has_braces ? "{" + new_guid + "}" : new_guid);
+  }
+  if (!replacements.empty())
+    replace_in_registry_files(prefix_path, replacements);
+}
+
+/**
+ * \brief Create a new bottle from the template with the same settings, the template is built first when needed.
+ * Bottles that need a template that is being built wait for it, the others are created at the same time.
+ * \param[in] prefix_path Bottle prefix path to create
+ * \param[in] bit Bottle bitness
+ * \param[in] disable_gecko_mono Disable Gecko & Mono
+ * \param[in] wine_bin_path Path to the Wine runner binary directory (empty for system Wine)
+ * \throws runtime_error when the template could not be built or the bottle could not be copied
+ */
+void PrefixTemplates::create_bottle(const std::string& prefix_path, BottleTypes::Bit bit, bool disable_gecko_mono, const std::string& wine_bin_path)
+{
+  // Bottles are always created via the plain wine binary
+  std::string wine_executable = WineVersionCache::resolve_executable(Helper::get_wine_executable_location(false, wine_bin_path));
+  std::string wine_version = Helper::get_wine_version(false, prefix_path, wine_bin_path);
+  std::string template_name = get_template_name(wine_executable, wine_version, bit, disable_gecko_mono);
+  std::string template_path = Glib::build_filename(templates_dir_, template_name);
+  bool is_build_needed = false;
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    template_built_.wait(lock, [this, &template_name] { return !templates_building_.contains(template_name); });
+    is_build_needed = !Helper::file_exists(template_path + TemplateReadySuffix);
+    if (is_build_needed)
+    {
+      remove_outdated_templates(template_name);
+      templates_building_.insert(template_name);
+    }
+    ++templates_in_use_[template_name];
+  }
+
+  // The template isn't removed (by building a template of a newer Wine version) while it's built or copied
+  struct TemplateUse
+  {
+    PrefixTemplates* templates;
+    std::string template_name;
+    bool is_building;
+    void finish_build()
+    {
+      {
+        std::lock_guard<std::mutex> lock(templates->mutex_);
+        templates->templates_building_.erase(template_name);
+      }
+      is_building = false;
+      templates->template_built_.notify_all();
+    }
+    ~TemplateUse()
+    {
+      if (is_building)
+        finish_build();
+      std::lock_guard<std::mutex> lock(templates->mutex_);
+      if (--templates->templates_in_use_[template_name] == 0)
+        templates->templates_in_use_.erase(template_name);
+    }
+  };
+  TemplateUse template_use{this, template_name, is_build_needed};
+  if (is_build_needed)
+  {
+    // When the template isn't ready in time, this bottle is still copied from it (the template is built again next time)
+    build_template(template_name, bit, disable_gecko_mono, wine_bin_path);
+    template_use.finish_build();
+  }
+  Helper::copy_wine_bottle_folder(template_path, prefix_path);
+  fix_user_paths(template_path, prefix_path);
+  regenerate_machine_ids(prefix_path);
+}
+
+/**
+ * \brief Remove the templates of other versions of the same Wine runner & a possibly incomplete template with the same
+ * name (unless they are being built or copied). Call while holding the mutex.
+ * \param[in] template_name Template name (see get_template_name())
+ */
+void PrefixTemplates::remove_outdated_templates(const std::string& template_name)
+{
+  std::string runner_prefix = template_name.substr(0, template_name.find('-') + 1);
+  std::string version_prefix = template_name.substr(0, template_name.find('-', runner_prefix.size()) + 1);
+  std::error_code error_code;
+  for (const auto& entry : fs::directory_iterator(templates_dir_, error_code))
+  {
+    std::string entry_name = entry.path().filename().string();
+    std::string entry_template_name = entry_name;
+    if (entry_template_name.ends_with(TemplateReadySuffix))
+      entry_template_name.resize(entry_template_name.size() - TemplateReadySuffix.size());
+    // Never remove a template while it's built or copied into a new bottle
+    if (templates_in_use_.contains(entry_template_name))
+      continue;
+    if (entry_name.starts_with(runner_prefix) && (!entry_name.starts_with(version_prefix) || entry_name.starts_with(template_name)))
+    {
+      std::error_code remove_error;
+      fs::remove_all(entry.path(), remove_error);
+    }
+  }
+}
+
+/**
+ * \brief Build a template (full 'wineboot' run). Call without holding the mutex, while the template is marked as being built.
+ * \param[in] template_name Template name (see get_template_name())
+ * \param[in] bit Bottle bitness
+ * \param[in] disable_gecko_mono Disable Gecko & Mono
+ * \param[in] wine_bin_path Path to the Wine runner binary directory (empty for system Wine)
+ * \throws runtime_error when the template could not be built
+ * \return true if the template is ready, false if the wineserver didn't terminate in time (the registry might not be complete)
+ */
+bool PrefixTemplates::build_template(const std::string& template_name,
+                                     BottleTypes::Bit bit,
+                                     bool disable_gecko_mono,
+                                     const std::string& wine_bin_path)
+{
+  std::string template_path = Glib::build_filename(templates_dir_, template_name);
+  std::error_code error_code;
+  fs::create_directories(templates_dir_, error_code);
+  if (error_code)
+    throw std::runtime_error("Could not create the templates directory: " + templates_dir_);
+
+  std::cout << "INFO: Building a new prefix template: " << template_name << std::endl;
+  Helper::create_wine_bottle(false, template_path, bit, disable_gecko_mono, wine_bin_path);
+  // The registry is only written to disk once the wineserver is terminated, which takes longer when Gecko & Mono are installed
+  if (!Helper::wait_until_wineserver_is_terminated(template_path, wine_bin_path, TemplateBuildTimeout))
+  {
+    std::cout << "INFO: The prefix template is not marked as ready, the wineserver is still running: " << template_name << std::endl;
+    return false;
+  }
+  std::ofstream ready_file(template_path + TemplateReadySuffix);
+  if (!ready_file)
+    throw std::runtime_error("Could not mark the prefix template as ready: " + template_path);
+  return true;
+}
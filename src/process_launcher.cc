@@ -0,0 +1,314 @@
+/**
+ * Copyright (c) 2026 WineGUI
+ *
+ * \file    process_launcher.cc
+ * \brief   Launch processes without a shell (posix_spawn)
+ * \author  Melroy van den Berg <webmaster1989@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "process_launcher.h"
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <glibmm.h>
+#include <map>
+#include <signal.h>
+#include <spawn.h>
+#include <stdexcept>
+#include <sys/wait.h>
+#include <unistd.h>
+
+extern char** environ;
+
+// Read the output in large chunks (the default pipe buffer size is 64 KiB)
+static constexpr std::size_t ReadBufferSize = 65536;
+
+/**
+ * \brief Run a program (without a shell) and wait until it is finished. Returns both the exit code as well as the output.
+ * Usage: const auto& [exit_code, output] = ProcessLauncher::run({"wine", "--version"});
+ * \param[in] argv Program (searched in PATH, unless it contains a slash) followed by its arguments
+ * \param[in] env_vars Environment variables to set (on top of the environment of WineGUI)
+ * \param[in] working_directory Working directory of the program (empty = current working directory)
+ * \param[in] stderr_output Also capture stderr (together with stdout)
+ * \throws runtime_error when the output pipe could not be created
+ * \return Exit code (127 when the program could not be started, 128 + signal number when killed by a signal) and stdout output
+ */
+std::pair<int, std::string> ProcessLauncher::run(const std::vector<std::string>& argv,
+                                                 const std::vector<std::pair<std::string, std::string>>& env_vars,
+                                                 const std::string& working_directory,
+                                                 bool stderr_output)
+{
+  std::string output;
+  int exit_code = run(argv, env_vars, working_directory, stderr_output, [&output](std::string_view data) { output.append(data); });
+  return std::make_pair(exit_code, output);
+}
+
+/**
+ * \brief Run a program (without a shell) and wait until it is finished. The output is streamed while the program runs,
+ * instead of collecting all the output in memory (a program like a game can run for hours).
+ * \param[in] argv Program (searched in PATH, unless it contains a slash) followed by its arguments
+ * \param[in] env_vars Environment variables to set (on top of the environment of WineGUI)
+ * \param[in] working_directory Working directory of the program (empty = current working directory)
+ * \param[in] stderr_output Also capture stderr (together with stdout)
+ * \param[in] on_output Called (from the calling thread) with every chunk of output as soon as it is available
+ * \throws runtime_error when the output pipe could not be created
+ * \return Exit code (127 when the program could not be started, 128 + signal number when killed by a signal)
+ */
+int ProcessLauncher::run(const std::vector<std::string>& argv,
+                         const std::vector<std::pair<std::string, std::string>>& env_vars,
+                         const std::string& working_directory,
+                         bool stderr_output,
+                         const std::function<void(std::string_view output)>& on_output)
+{
+  if (argv.empty())
+    throw std::invalid_argument("No program to run");
+
+  // Environment of WineGUI, with the given environment variables added (a later value of the same variable wins)
+  std::map<std::string, std::string> overrides;
+  for (const auto& [key, value] : env_vars)
+  {
+    overrides.insert_or_assign(key, value);
+  }
+  std::vector<std::string> environment;
+  for (char** var = environ; var != nullptr && *var != nullptr; ++var)
+  {
+    std::string_view entry(*var);
+    if (!overrides.contains(std::string(entry.substr(0, entry.find('=')))))
+      environment.emplace_back(entry);
+  }
+  for (const auto& [key, value] : overrides)
+  {
+    environment.emplace_back(key + "=" + value);
+  }
+
+  std::vector<char*> argv_ptrs;
+  argv_ptrs.reserve(argv.size() + 1);
+  for (const std::string& arg : argv)
+  {
+    argv_ptrs.push_back(const_cast<char*>(arg.c_str()));
+  }
+  argv_ptrs.push_back(nullptr);
+  std::vector<char*> envp_ptrs;
+  envp_ptrs.reserve(environment.size() + 1);
+  for (const std::string& var : environment)
+  {
+    envp_ptrs.push_back(const_cast<char*>(var.c_str()));
+  }
+  envp_ptrs.push_back(nullptr);
+
+  // Close-on-exec, so the pipe doesn't leak into processes that are started concurrently by other threads
+  int pipe_fds[2];
+  if (pipe2(pipe_fds, O_CLOEXEC) != 0)
+    throw std::runtime_error("pipe() failed!");
+
+  posix_spawn_file_actions_t file_actions;
+  posix_spawn_file_actions_init(&file_actions);
+  posix_spawn_file_actions_adddup2(&file_actions, pipe_fds[1], STDOUT_FILENO);
+  if (stderr_output)
+    posix_spawn_file_actions_adddup2(&file_actions, pipe_fds[1], STDERR_FILENO);
+  if (!working_directory.empty())
+    posix_spawn_file_actions_addchdir_np(&file_actions, working_directory.c_str());
+
+  // Start with the default signal handling & no blocked signals (GLib or the calling thread might block signals)
+  posix_spawnattr_t attributes;
+  posix_spawnattr_init(&attributes);
+  sigset_t no_signals;
+  sigemptyset(&no_signals);
+  posix_spawnattr_setsigmask(&attributes, &no_signals);
+  sigset_t default_signals;
+  sigemptyset(&default_signals);
+  sigaddset(&default_signals, SIGPIPE);
+  posix_spawnattr_setsigdefault(&attributes, &default_signals);
+  posix_spawnattr_setflags(&attributes, POSIX_SPAWN_SETSIGMASK | POSIX_SPAWN_SETSIGDEF);
+
+  pid_t pid = 0;
+  int spawn_error = posix_spawnp(&pid, argv_ptrs[0], &file_actions, &attributes, argv_ptrs.data(), envp_ptrs.data());
+  posix_spawnattr_destroy(&attributes);
+  posix_spawn_file_actions_destroy(&file_actions);
+  close(pipe_fds[1]);
+  if (spawn_error != 0)
+  {
+    close(pipe_fds[0]);
+    // Same exit code as a shell, when the program is not found (or could not be executed)
+    if (stderr_output)
+      on_output(argv[0] + ": " + std::strerror(spawn_error) + "\n");
+    return 127;
+  }
+
+  std::array<char, ReadBufferSize> buffer;
+  while (true)
+  {
+    ssize_t count = read(pipe_fds[0], buffer.data(), buffer.size());
+    if (count > 0)
+      on_output(std::string_view(buffer.data(), static_cast<std::size_t>(count)));
+    else if (count == 0 || errno != EINTR)
+      break;
+  }
+  close(pipe_fds[0]);
+
+  int wait_status = 0;
+  while (waitpid(pid, &wait_status, 0) < 0)
+  {
+    if (errno != EINTR)
+      return -1;
+  }
+  return decode_exit_status(wait_status);
+}
+
+/**
+ * \brief Run a command line and wait until it is finished. The command line is split into its arguments and run
+ * without a shell (see run()). Only when the command uses shell features (eg. pipes, redirects, variables or
+ * multiple commands) it is run by /bin/sh.
+ * \param[in] command Command line, leading variable assignments (eg. WINEDLLOVERRIDES="mscoree=b" wine) are supported
+ * \param[in] env_vars Environment variables to set (on top of the environment of WineGUI)
+ * \param[in] working_directory Working directory of the program (empty = current working directory)
+ * \param[in] stderr_output Also capture stderr (together with stdout)
+ * \throws runtime_error when the output pipe could not be created
+ * \return Exit code and stdout output
+ */
+std::pair<int, std::string> ProcessLauncher::run_command(const std::string& command,
+                                                         const std::vector<std::pair<std::string, std::string>>& env_vars,
+                                                         const std::string& working_directory,
+                                                         bool stderr_output)
+{
+  std::string output;
+  int exit_code = run_command(command, env_vars, working_directory, stderr_output, [&output](std::string_view data) { output.append(data); });
+  return std::make_pair(exit_code, output);
+}
+
+/**
+ * \brief Run a command line (without a shell, when possible) and wait until it is finished, the output is streamed (see run()).
+ * \param[in] command Command line, leading variable assignments (eg. WINEDLLOVERRIDES="mscoree=b" wine) are supported
+ * \param[in] env_vars Environment variables to set (on top of the environment of WineGUI)
+ * \param[in] working_directory Working directory of the program (empty = current working directory)
+ * \param[in] stderr_output Also capture stderr (together with stdout)
+ * \param[in] on_output Called (from the calling thread) with every chunk of output as soon as it is available
+ * \throws runtime_error when the output pipe could not be created
+ * \return Exit code
+ */
+int ProcessLauncher::run_command(const std::string& command,
+                                 const std::vector<std::pair<std::string, std::string>>& env_vars,
+                                 const std::string& working_directory,
+                                 bool stderr_output,
+                                 const std::function<void(std::string_view output)>& on_output)
+{
+  std::vector<std::pair<std::string, std::string>> command_env_vars = env_vars;
+  std::vector<std::string> argv = parse_command(command, command_env_vars);
+  if (argv.empty())
+    return run({"/bin/sh", "-c", command}, env_vars, working_directory, stderr_output, on_output);
+  return run(argv, command_env_vars, working_directory, stderr_output, on_output);
+}
+
+/**
+ * \brief Split a command line into its arguments (shell quoting rules)
+ * \param[in] command Command line
+ * \param[in,out] env_vars Leading variable assignments of the command line are appended to the environment variables
+ * \return Program & arguments, or an empty list when the command line requires a shell
+ */
+std::vector<std::string> ProcessLauncher::parse_command(const std::string& command, std::vector<std::pair<std::string, std::string>>& env_vars)
+{
+  if (needs_shell(command))
+    return {};
+  std::vector<std::string> argv;
+  try
+  {
+    for (const std::string& arg : Glib::shell_parse_argv(command))
+    {
+      argv.emplace_back(arg);
+    }
+  }
+  catch (const Glib::ShellError&)
+  {
+    return {};
+  }
+
+  // Move the leading variable assignments (NAME=value) to the environment
+  std::size_t assignments = 0;
+  for (; assignments < argv.size(); ++assignments)
+  {
+    const std::string& arg = argv[assignments];
+    std::size_t equal_sign = arg.find('=');
+    if (equal_sign == std::string::npos || equal_sign == 0 || std::isdigit(static_cast<unsigned char>(arg[0])) ||
+        !std::all_of(arg.begin(), arg.begin() + static_cast<std::ptrdiff_t>(equal_sign),
+                     [](char c) { return std::isalnum(static_cast<unsigned char>(c)) || c == '_'; }))
+      break;
+    env_vars.emplace_back(arg.substr(0, equal_sign), arg.substr(equal_sign + 1));
+  }
+  if (assignments == argv.size())
+    return {}; // Only assignments, leave it to the shell
+  argv.erase(argv.begin(), argv.begin() + static_cast<std::ptrdiff_t>(assignments));
+  return argv;
+}
+
+/**
+ * \brief Decode the (waitpid) status of a finished process into an exit code, the same way a shell does
+ * \param[in] wait_status Status as returned by waitpid() or pclose()
+ * \return Exit code of the process, or 128 + signal number when the process is killed by a signal
+ */
+int ProcessLauncher::decode_exit_status(int wait_status)
+{
+  if (WIFEXITED(wait_status))
+    return WEXITSTATUS(wait_status);
+  if (WIFSIGNALED(wait_status))
+    return 128 + WTERMSIG(wait_status);
+  return -1;
+}
+
+/**
+ * \brief Check if the command line uses shell features, which require the command to be run by /bin/sh
+ * \param[in] command Command line
+ * \return true if a shell is needed, false if the command can be executed directly
+ */
+bool ProcessLauncher::needs_shell(const std::string& command)
+{
+  bool in_single_quotes = false;
+  bool in_double_quotes = false;
+  for (std::size_t i = 0; i < command.size(); ++i)
+  {
+    char c = command[i];
+    if (in_single_quotes)
+    {
+      in_single_quotes = (c != '\'');
+    }
+    else if (c == '\\')
+    {
+      ++i; // Escaped character
+    }
+    else if (in_double_quotes)
+    {
+      if (c == '"')
+        in_double_quotes = false;
+      else if (c == '$' || c == '`')
+        return true; // Expansion
+    }
+    else if (c == '\'')
+    {
+      in_single_quotes = true;
+    }
+    else if (c == '"')
+    {
+      in_double_quotes = true;
+    }
+    else if (std::strchr("|&;<>()$`*?[~#{\n", c) != nullptr)
+    {
+      return true; // Pipe, redirect, command list, expansion, glob or comment
+    }
+  }
+  return false;
+}
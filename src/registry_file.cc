@@ -0,0 +1,212 @@
+/**
+ * Copyright (c) 2026 WineGUI
+ *
+ * \file    registry_file.cc
+ * \brief   Parsed & indexed in-memory model of a Wine registry file
+ * \author  Melroy van den Berg <webmaster1989@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "registry_file.h"
+
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <utility>
+
+/**
+ * \brief Construct the registry model from the raw file contents and build the key index
+ * \param[in] contents Registry file contents
+ */
+RegistryFile::RegistryFile(std::string contents) : buffer_(std::move(contents)), contents_(buffer_)
+{
+  parse();
+}
+
+/**
+ * \brief Read & parse a registry file from disk.
+ * The whole file is read into a single buffer (sized up-front), so no per-line allocations are needed and the
+ * memory use stays close to the file size. The file isn't memory mapped: the parsed registry is kept in a cache,
+ * and a mapping of a file that is truncated in place (eg. by an editor) would crash on the next access.
+ * \param[in] file_path File location of the registry file
+ * \param[out] file_stat (Optionally) The status of the file that was actually read (eg. to validate a cache entry)
+ * \return Shared pointer to the parsed registry, or nullptr when the file could not be read
+ */
+std::shared_ptr<const RegistryFile> RegistryFile::read(const std::string& file_path, struct stat* file_stat)
+{
+  int fd = open(file_path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0)
+    return nullptr;
+  struct stat fd_stat;
+  if (fstat(fd, &fd_stat) != 0 || !S_ISREG(fd_stat.st_mode))
+  {
+    close(fd);
+    return nullptr;
+  }
+  if (file_stat != nullptr)
+    *file_stat = fd_stat;
+  std::string contents(static_cast<std::size_t>(fd_stat.st_size), '\0');
+  std::size_t size = 0;
+  while (size < contents.size())
+  {
+    ssize_t bytes_read = ::read(fd, contents.data() + size, contents.size() - size);
+    if (bytes_read < 0 && errno == EINTR)
+      continue;
+    if (bytes_read < 0)
+    {
+      close(fd);
+      return nullptr;
+    }
+    if (bytes_read == 0)
+      break; // The file is truncated in the meantime
+    size += static_cast<std::size_t>(bytes_read);
+  }
+  close(fd);
+  contents.resize(size);
+  return std::make_shared<const RegistryFile>(std::move(contents));
+}
+
+/**
+ * \brief Find a registry key.
+ * A key name ending with ']' is looked up exactly via the index. A key name without the closing bracket
+ * is treated as a prefix, and the first key (in file order) starting with that prefix is returned.
+ * \param[in] key_name Full or part of the path of the key, optionally starting with '[' (eg. [Software\\\\Wine\\\\Explorer])
+ * \return Pointer to the key or nullptr when not found
+ */
+const RegistryFile::Key* RegistryFile::find_key(std::string_view key_name) const
+{
+  if (key_name.starts_with('['))
+    key_name.remove_prefix(1);
+  if (key_name.ends_with(']'))
+  {
+    key_name.remove_suffix(1);
+    auto it = key_index_.find(key_name);
+    return (it != key_index_.end()) ? &keys_[it->second] : nullptr;
+  }
+  for (const Key& key : keys_)
+  {
+    if (key.name.starts_with(key_name))
+      return &key;
+  }
+  return nullptr;
+}
+
+/**
+ * \brief Get all value entries (raw lines, eg. "Audio"="pulse") of a key
+ * \param[in] key Registry key
+ * \return Value entries of the key, meta lines (starting with '#') are excluded
+ */
+std::span<const std::string_view> RegistryFile::get_entries(const Key& key) const
+{
+  return std::span<const std::string_view>(entries_).subspan(key.first_entry, key.entry_count);
+}
+
+/**
+ * \brief Find the data of a named value within a key
+ * \param[in] key Registry key
+ * \param[in] value_name Registry value name (eg. Desktop)
+ * \return Raw data after the equal sign (eg. "pulse" including quotes), or std::nullopt when not found
+ */
+std::optional<std::string_view> RegistryFile::find_value(const Key& key, std::string_view value_name) const
+{
+  for (std::string_view entry : get_entries(key))
+  {
+    // Match: "<value_name>"=
+    if (entry.size() > value_name.size() + 2 && entry[0] == '"' && entry.substr(1, value_name.size()) == value_name &&
+        entry.substr(value_name.size() + 1, 2) == "\"=")
+    {
+      return entry.substr(value_name.size() + 3);
+    }
+  }
+  return std::nullopt;
+}
+
+/**
+ * \brief Get a meta value from the registry file header (eg. arch of "#arch=win64")
+ * \param[in] meta_name Meta value name (eg. arch)
+ * \return Meta data, or std::nullopt when not found
+ */
+std::optional<std::string_view> RegistryFile::get_meta_data(std::string_view meta_name) const
+{
+  auto it = meta_data_.find(meta_name);
+  if (it != meta_data_.end())
+    return it->second;
+  return std::nullopt;
+}
+
+/**
+ * \brief Get all keys in file order
+ * \return Registry keys
+ */
+const std::vector<RegistryFile::Key>& RegistryFile::get_keys() const
+{
+  return keys_;
+}
+
+/**
+ * \brief Split the contents in lines and build the key index in a single pass.
+ * A key section starts with a "[key] timestamp" line and ends at the first empty line (or the next key).
+ * Lines starting with '#' in front of the first key are file meta data, inside a key they are skipped.
+ */
+void RegistryFile::parse()
+{
+  const std::string_view contents = contents_;
+  // Estimate the number of entries (a value line is roughly 40 bytes), to avoid most of the re-allocations
+  entries_.reserve(contents.size() / 40);
+  bool inside_key = false;
+  std::size_t pos = 0;
+  while (pos < contents.size())
+  {
+    std::size_t end = contents.find('\n', pos);
+    if (end == std::string_view::npos)
+      end = contents.size();
+    std::string_view line = contents.substr(pos, end - pos);
+    pos = end + 1;
+    if (line.ends_with('\r'))
+      line.remove_suffix(1);
+
+    if (line.starts_with('['))
+    {
+      // Key names are escaped by Wine, the closing bracket is followed by the modification timestamp
+      std::size_t close_pos = line.rfind(']');
+      if (close_pos == std::string_view::npos || close_pos == 0)
+      {
+        inside_key = false;
+        continue;
+      }
+      std::string_view name = line.substr(1, close_pos - 1);
+      keys_.emplace_back(Key{name, entries_.size(), 0});
+      key_index_.emplace(name, keys_.size() - 1);
+      inside_key = true;
+    }
+    else if (line.empty())
+    {
+      inside_key = false; // End of key section in registry
+    }
+    else if (line.starts_with('#'))
+    {
+      if (keys_.empty())
+      {
+        std::size_t equal_pos = line.find('=');
+        if (equal_pos != std::string_view::npos)
+          meta_data_.emplace(line.substr(1, equal_pos - 1), line.substr(equal_pos + 1));
+      }
+    }
+    else if (inside_key)
+    {
+      entries_.emplace_back(line);
+      keys_.back().entry_count++;
+    }
+  }
+}
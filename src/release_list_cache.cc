@@ -0,0 +1,176 @@
+/**
+ * Copyright (c) 2026 WineGUI
+ *
+ * \file    release_list_cache.cc
+ * \brief   Persisted release lists of the Wine runner sources
+ * \author  Melroy van den Berg <webmaster1989@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "release_list_cache.h"
+
+#include <giomm.h>
+#include <glibmm.h>
+#include <iostream>
+#include <utility>
+
+// Increase when the parsing of the GitHub release list changes, older files are ignored
+static constexpr int CacheVersion = 1;
+
+/**
+ * \brief Construct a (empty) release list cache, the cache file is read on first use
+ * \param[in] cache_file_path File location of the persisted cache
+ */
+ReleaseListCache::ReleaseListCache(std::string cache_file_path) : cache_file_path_(std::move(cache_file_path))
+{
+}
+
+/**
+ * \brief Get the application wide instance, persisted in the WineGUI data directory
+ * \return ReleaseListCache reference (singleton)
+ */
+ReleaseListCache& ReleaseListCache::get_instance()
+{
+  static ReleaseListCache instance(Glib::build_filename(
+      Glib::build_path(G_DIR_SEPARATOR_S, std::vector<std::string>{Glib::get_user_data_dir(), "winegui"}), "runner_releases.ini"));
+  return instance;
+}
+
+/**
+ * \brief Get the persisted release list of a source
+ * \param[in] source_id Source ID
+ * \return Release list with its validators, or std::nullopt when the list was never fetched
+ */
+std::optional<ReleaseListCache::Entry> ReleaseListCache::get(WineRunner::SourceId source_id)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!is_loaded_)
+    load();
+  auto it = entries_.find(source_id);
+  if (it == entries_.end())
+    return std::nullopt;
+  return it->second;
+}
+
+/**
+ * \brief Store the release list of a source, the file is written right away
+ * \param[in] source_id Source ID
+ * \param[in] entry Release list with its validators
+ */
+void ReleaseListCache::put(WineRunner::SourceId source_id, const Entry& entry)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!is_loaded_)
+    load();
+  entries_[source_id] = entry;
+  save();
+}
+
+/**
+ * \brief Read the persisted release lists (if present), must be called with the mutex locked
+ */
+void ReleaseListCache::load()
+{
+  is_loaded_ = true;
+  if (!Glib::file_test(cache_file_path_, Glib::FileTest::IS_REGULAR))
+    return;
+  try
+  {
+    auto keyfile = Glib::KeyFile::create();
+    keyfile->load_from_file(cache_file_path_);
+    if (!keyfile->has_group("General") || keyfile->get_integer("General", "Version") != CacheVersion)
+      return;
+    for (const Glib::ustring& group : keyfile->get_groups())
+    {
+      if (!group.raw().starts_with("Source") || group.raw().find('.') != std::string::npos)
+        continue;
+      auto source_id = static_cast<WineRunner::SourceId>(keyfile->get_integer(group, "Id"));
+      Entry entry;
+      entry.etag = keyfile->get_string(group, "ETag");
+      entry.last_modified = keyfile->get_string(group, "LastModified");
+      int release_count = keyfile->get_integer(group, "Releases");
+      for (int index = 0; index < release_count; ++index)
+      {
+        Glib::ustring release_group = group + ".Release" + std::to_string(index);
+        WineRunner::Release release;
+        release.source = source_id;
+        release.tag_name = keyfile->get_string(release_group, "Tag");
+        release.version = keyfile->get_string(release_group, "Version");
+        release.variant = keyfile->get_string(release_group, "Variant");
+        release.wow64 = keyfile->get_boolean(release_group, "WoW64");
+        release.asset_name = keyfile->get_string(release_group, "AssetName");
+        release.download_url = keyfile->get_string(release_group, "DownloadURL");
+        release.size_bytes = keyfile->get_uint64(release_group, "Size");
+        release.published_at = keyfile->get_string(release_group, "PublishedAt");
+        release.checksum_type = static_cast<WineRunner::ChecksumType>(keyfile->get_integer(release_group, "ChecksumType"));
+        release.checksum_url = keyfile->get_string(release_group, "ChecksumURL");
+        entry.releases.emplace_back(std::move(release));
+      }
+      entries_[source_id] = std::move(entry);
+    }
+  }
+  catch (const Glib::Error& ex)
+  {
+    std::cerr << "Error: Exception while reading the runner release list cache file: " << ex.what() << std::endl;
+    // Start with an empty cache
+    entries_.clear();
+  }
+}
+
+/**
+ * \brief Write the release lists to the cache file, must be called with the mutex locked
+ */
+void ReleaseListCache::save()
+{
+  try
+  {
+    auto keyfile = Glib::KeyFile::create();
+    keyfile->set_integer("General", "Version", CacheVersion);
+    for (const auto& [source_id, entry] : entries_)
+    {
+      Glib::ustring group = "Source" + std::to_string(static_cast<int>(source_id));
+      keyfile->set_integer(group, "Id", static_cast<int>(source_id));
+      keyfile->set_string(group, "ETag", entry.etag);
+      keyfile->set_string(group, "LastModified", entry.last_modified);
+      keyfile->set_integer(group, "Releases", static_cast<int>(entry.releases.size()));
+      for (std::size_t index = 0; index < entry.releases.size(); ++index)
+      {
+        const WineRunner::Release& release = entry.releases.at(index);
+        Glib::ustring release_group = group + ".Release" + std::to_string(index);
+        keyfile->set_string(release_group, "Tag", release.tag_name);
+        keyfile->set_string(release_group, "Version", release.version);
+        keyfile->set_string(release_group, "Variant", release.variant);
+        keyfile->set_boolean(release_group, "WoW64", release.wow64);
+        keyfile->set_string(release_group, "AssetName", release.asset_name);
+        keyfile->set_string(release_group, "DownloadURL", release.download_url);
+        keyfile->set_uint64(release_group, "Size", release.size_bytes);
+        keyfile->set_string(release_group, "PublishedAt", release.published_at);
+        keyfile->set_integer(release_group, "ChecksumType", static_cast<int>(release.checksum_type));
+        keyfile->set_string(release_group, "ChecksumURL", release.checksum_url);
+      }
+    }
+    std::string cache_dir = Glib::path_get_dirname(cache_file_path_);
+    if (!Glib::file_test(cache_dir, Glib::FileTest::IS_DIR))
+    {
+      Glib::RefPtr<Gio::File> directory = Gio::File::create_for_path(cache_dir);
+      if (directory)
+        directory->make_directory_with_parents();
+    }
+    keyfile->save_to_file(cache_file_path_);
+  }
+  catch (const Glib::Error& ex)
+  {
+    std::cerr << "Error: Exception while writing the runner release list cache file: " << ex.what() << std::endl;
+  }
+}
@@ -0,0 +1,464 @@
+/**
+ * Copyright (c) 2026 WineGUI
+ *
+ * \file    resumable_download.cc
+ * \brief   Download a file over HTTP(S) into a .part file that survives a cancel or a broken connection
+ * \author  Melroy van den Berg <webmaster1989@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "resumable_download.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <filesystem>
+#include <glibmm/fileutils.h>
+#include <glibmm/keyfile.h>
+#include <glibmm/spawn.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdexcept>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+// Data that is read from a wget process (and passed to the data callback) at once
+static constexpr std::size_t BufferSize = 1024 * 1024;
+// Smaller segments are not worth an extra connection
+static constexpr std::uint64_t MinSegmentSize = 16 * 1024 * 1024;
+// Successive attempts of a segment that fail without any progress, before the download is given up
+static constexpr unsigned int MaxAttempts = 5;
+// Interval of storing the progress & checking the cancellation flag
+static constexpr std::chrono::milliseconds StateInterval = std::chrono::milliseconds(250);
+
+/**
+ * \brief Open a process file descriptor, which becomes readable once the process is terminated
+ * \param[in] pid Process ID
+ * \return File descriptor, or -1 when not supported by the kernel
+ */
+static int open_pidfd(pid_t pid)
+{
+#ifdef SYS_pidfd_open
+  return static_cast<int>(syscall(SYS_pidfd_open, pid, 0));
+#else
+  (void)pid;
+  return -1;
+#endif
+}
+
+/**
+ * \brief Open the .part file and read the progress of a previous run (if any)
+ * \param[in] url URL of the file
+ * \param[in] part_path Path of the .part file (created when missing)
+ * \param[in] size Size of the file in bytes, 0 when unknown (a single segment is used)
+ * \param[in] segment_count Maximum number of segments that are downloaded in parallel, only used for a new download
+ * \throws std::runtime_error when the .part file could not be opened
+ */
+ResumableDownload::ResumableDownload(std::string url, std::string part_path, std::uint64_t size, unsigned int segment_count)
+    : url_(std::move(url)),
+      part_path_(std::move(part_path)),
+      state_path_(part_path_ + ".ini"),
+      size_(size),
+      part_fd_(-1),
+      resumed_bytes_(0),
+      delivered_bytes_(0)
+{
+  part_fd_ = open(part_path_.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+  if (part_fd_ < 0)
+    throw std::runtime_error("Could not open '" + part_path_ + "': " + std::strerror(errno));
+  load_state();
+  if (segments_.empty())
+  {
+    // Start from scratch
+    if (ftruncate(part_fd_, 0) != 0)
+    {
+      close(part_fd_);
+      throw std::runtime_error("Could not truncate '" + part_path_ + "': " + std::strerror(errno));
+    }
+    std::uint64_t count = (size_ > 0) ? std::clamp<std::uint64_t>(size_ / MinSegmentSize, 1, std::max(segment_count, 1U)) : 1;
+    for (std::uint64_t index = 0; index < count; ++index)
+    {
+      Segment segment;
+      segment.start = index * (size_ / count);
+      segment.length = (index + 1 == count) ? size_ - segment.start : size_ / count;
+      segments_.emplace_back(segment);
+    }
+  }
+  resumed_bytes_ = get_downloaded_bytes();
+}
+
+/**
+ * \brief Stops the running wget processes, the .part file is kept
+ */
+ResumableDownload::~ResumableDownload()
+{
+  stop_all_segments();
+  if (part_fd_ >= 0)
+    close(part_fd_);
+}
+
+/**
+ * \brief Remove the .part file and its progress (eg. when the downloaded data turned out to be corrupt)
+ * \param[in] part_path Path of the .part file
+ */
+void ResumableDownload::discard(const std::string& part_path)
+{
+  std::error_code error_code;
+  std::filesystem::remove(part_path, error_code);
+  std::filesystem::remove(part_path + ".ini", error_code);
+}
+
+/**
+ * \brief Download the (remaining part of the) file. Blocking, the progress is stored on every exit path.
+ * \param[in] data_cb Callback that gets all data of the file in order, starting with the data of a previous run.
+ * An exception thrown by the callback stops the download and is passed on.
+ * \param[in] progress_cb Progress callback (bytes downloaded, file size or 0 when unknown), after every received chunk of data (not
+ * rate-limited); may be empty
+ * \param[in] cancel Cancellation flag (polled); on cancel the wget processes are terminated
+ * \throws std::runtime_error when the download failed (after retrying), the data downloaded so far is kept
+ * \return True when the file is completely downloaded, false when cancelled
+ */
+bool ResumableDownload::run(const std::function<void(const char*, std::size_t)>& data_cb,
+                            const std::function<void(std::uint64_t, std::uint64_t)>& progress_cb,
+                            const std::atomic<bool>& cancel)
+{
+  buffer_.resize(BufferSize);
+  delivered_bytes_ = 0;
+  auto last_state_time = std::chrono::steady_clock::now();
+  try
+  {
+    // Data of the previous run first, no network needed
+    deliver(data_cb);
+    std::vector<struct pollfd> poll_fds;
+    std::vector<Segment*> poll_segments;
+    while (true)
+    {
+      if (cancel.load())
+      {
+        stop_all_segments();
+        save_state();
+        return false;
+      }
+      auto now = std::chrono::steady_clock::now();
+      auto timeout = StateInterval;
+      poll_fds.clear();
+      poll_segments.clear();
+      for (Segment& segment : segments_)
+      {
+        if (segment.is_finished)
+          continue;
+        if (segment.pid == 0 && now >= segment.retry_time)
+          start_segment(segment);
+        if (segment.output_fd >= 0)
+        {
+          // The output is read until its end, the process fd reports the exit of wget right away
+          poll_fds.push_back({segment.output_fd, POLLIN, 0});
+          poll_fds.push_back({segment.process_fd, POLLIN, 0});
+          poll_segments.push_back(&segment);
+        }
+        else if (segment.pid == 0)
+        {
+          // Wake up in time for the next attempt
+          timeout = std::min(timeout, std::chrono::ceil<std::chrono::milliseconds>(segment.retry_time - now));
+        }
+      }
+      if (std::all_of(segments_.begin(), segments_.end(), [](const Segment& segment) { return segment.is_finished; }))
+        break;
+      if (poll(poll_fds.data(), poll_fds.size(), static_cast<int>(timeout.count())) < 0 && errno != EINTR)
+        throw std::runtime_error("Could not wait for the download: " + std::string(std::strerror(errno)));
+      std::uint64_t downloaded_bytes = get_downloaded_bytes();
+      for (std::size_t index = 0; index < poll_segments.size(); ++index)
+      {
+        Segment& segment = *poll_segments[index];
+        if (poll_fds[index * 2].revents != 0)
+          read_segment(segment, data_cb);
+        // wget exited: read the remaining output (ends with the end of the data), so the segment is finished or retried now
+        while (poll_fds[index * 2 + 1].revents != 0 && segment.output_fd >= 0)
+          read_segment(segment, data_cb);
+      }
+      deliver(data_cb);
+      // The progress is pushed as soon as data arrived
+      if (progress_cb && get_downloaded_bytes() != downloaded_bytes)
+        progress_cb(get_downloaded_bytes(), size_);
+      now = std::chrono::steady_clock::now();
+      if (now - last_state_time >= StateInterval)
+      {
+        last_state_time = now;
+        save_state();
+      }
+    }
+  }
+  catch (...)
+  {
+    stop_all_segments();
+    save_state();
+    throw;
+  }
+  save_state();
+  if (progress_cb)
+    progress_cb(get_downloaded_bytes(), size_);
+  return true;
+}
+
+/**
+ * \brief Bytes that were already downloaded by a previous run (resumed)
+ */
+std::uint64_t ResumableDownload::get_resumed_bytes() const
+{
+  return resumed_bytes_;
+}
+
+/**
+ * \brief Number of segments the file is downloaded in
+ */
+unsigned int ResumableDownload::get_segment_count() const
+{
+  return static_cast<unsigned int>(segments_.size());
+}
+
+/**
+ * \brief Read the progress of a previous run. The progress is only used when it belongs to the same URL & size,
+ * and the .part file really contains the data.
+ */
+void ResumableDownload::load_state()
+{
+  if (!Glib::file_test(state_path_, Glib::FileTest::IS_REGULAR))
+    return;
+  struct stat part_stat{};
+  if (fstat(part_fd_, &part_stat) != 0)
+    return;
+  try
+  {
+    auto keyfile = Glib::KeyFile::create();
+    keyfile->load_from_file(state_path_);
+    if (keyfile->get_string("Download", "URL") != url_ || keyfile->get_uint64("Download", "Size") != size_)
+      return;
+    int segment_count = keyfile->get_integer("Download", "Segments");
+    std::vector<Segment> segments;
+    std::uint64_t expected_start = 0;
+    for (int index = 0; index < segment_count; ++index)
+    {
+      Glib::ustring group = "Segment" + std::to_string(index);
+      Segment segment;
+      segment.start = keyfile->get_uint64(group, "Start");
+      segment.length = keyfile->get_uint64(group, "Length");
+      segment.done = keyfile->get_uint64(group, "Done");
+      if (segment.start != expected_start || (segment.length > 0 && segment.done > segment.length) ||
+          segment.start + segment.done > static_cast<std::uint64_t>(part_stat.st_size))
+        return;
+      segment.is_finished = (segment.length > 0 && segment.done == segment.length) || keyfile->get_boolean(group, "Finished");
+      expected_start = segment.start + segment.length;
+      segments.emplace_back(segment);
+    }
+    if (segments.empty() || (size_ > 0 && expected_start != size_))
+      return;
+    segments_ = std::move(segments);
+  }
+  catch (const Glib::Error& ex)
+  {
+    // Start from scratch
+  }
+}
+
+/**
+ * \brief Store the progress of every segment next to the .part file (never throws)
+ */
+void ResumableDownload::save_state() const
+{
+  try
+  {
+    auto keyfile = Glib::KeyFile::create();
+    keyfile->set_string("Download", "URL", url_);
+    keyfile->set_uint64("Download", "Size", size_);
+    keyfile->set_integer("Download", "Segments", static_cast<int>(segments_.size()));
+    for (std::size_t index = 0; index < segments_.size(); ++index)
+    {
+      const Segment& segment = segments_[index];
+      Glib::ustring group = "Segment" + std::to_string(index);
+      keyfile->set_uint64(group, "Start", segment.start);
+      keyfile->set_uint64(group, "Length", segment.length);
+      keyfile->set_uint64(group, "Done", segment.done);
+      keyfile->set_boolean(group, "Finished", segment.is_finished);
+    }
+    keyfile->save_to_file(state_path_);
+  }
+  catch (const Glib::Error& ex)
+  {
+    // The download only restarts from scratch next time
+  }
+}
+
+/**
+ * \brief Start a wget process for the remaining bytes of the segment.
+ * wget requests the data from the offset onwards (HTTP range request); when the server does not support ranges,
+ * wget skips the first bytes itself.
+ */
+void ResumableDownload::start_segment(Segment& segment)
+{
+  std::vector<std::string> argv{"wget", "--quiet", "--timeout=30", "--tries=1"};
+  if (segment.start + segment.done > 0)
+    argv.emplace_back("--start-pos=" + std::to_string(segment.start + segment.done));
+  argv.emplace_back("--output-document=-");
+  argv.emplace_back(url_);
+  try
+  {
+    Glib::Pid pid = 0;
+    Glib::spawn_async_with_pipes("", argv, Glib::SpawnFlags::SEARCH_PATH | Glib::SpawnFlags::DO_NOT_REAP_CHILD, {}, &pid, nullptr,
+                                 &segment.output_fd, nullptr);
+    segment.pid = pid;
+    segment.process_fd = open_pidfd(pid);
+  }
+  catch (const Glib::Error& error)
+  {
+    throw std::runtime_error("Could not start wget: " + std::string(error.what()));
+  }
+  segment.done_at_start = segment.done;
+}
+
+/**
+ * \brief Stop the wget process of a segment
+ * \param[in] is_kill Terminate the process, otherwise wait until it exited by itself
+ * \return Wait status of the process (0 when there was no process)
+ */
+int ResumableDownload::stop_segment(Segment& segment, bool is_kill)
+{
+  if (segment.output_fd >= 0)
+  {
+    close(segment.output_fd);
+    segment.output_fd = -1;
+  }
+  if (segment.process_fd >= 0)
+  {
+    close(segment.process_fd);
+    segment.process_fd = -1;
+  }
+  int wait_status = 0;
+  if (segment.pid > 0)
+  {
+    if (is_kill)
+      kill(segment.pid, SIGTERM);
+    while (waitpid(segment.pid, &wait_status, 0) < 0 && errno == EINTR)
+    {
+    }
+    Glib::spawn_close_pid(segment.pid);
+    segment.pid = 0;
+  }
+  return wait_status;
+}
+
+/**
+ * \brief Terminate all running wget processes
+ */
+void ResumableDownload::stop_all_segments()
+{
+  for (Segment& segment : segments_)
+  {
+    stop_segment(segment, true);
+  }
+}
+
+/**
+ * \brief Read the available data of a segment into the .part file.
+ * The data is passed to the data callback right away when it is next in order.
+ * \throws std::runtime_error when the segment failed too often, or the .part file could not be written
+ */
+void ResumableDownload::read_segment(Segment& segment, const std::function<void(const char*, std::size_t)>& data_cb)
+{
+  ssize_t count = read(segment.output_fd, buffer_.data(), buffer_.size());
+  if (count < 0 && (errno == EINTR || errno == EAGAIN))
+    return;
+  if (count <= 0)
+  {
+    // End of the data: wget exited (or failed), a segment with a known length should be complete by now
+    int wait_status = stop_segment(segment, false);
+    bool is_exit_success = WIFEXITED(wait_status) && WEXITSTATUS(wait_status) == 0;
+    if ((segment.length > 0) ? (segment.done == segment.length) : is_exit_success)
+    {
+      segment.is_finished = true;
+      return;
+    }
+    // Retry with a growing delay, the next attempt continues where this one stopped
+    if (segment.done > segment.done_at_start)
+      segment.failures = 0;
+    if (++segment.failures >= MaxAttempts)
+      throw std::runtime_error("Could not download " + url_ +
+                               (WIFEXITED(wait_status) ? " (wget exit status " + std::to_string(WEXITSTATUS(wait_status)) + ")" : ""));
+    segment.retry_time = std::chrono::steady_clock::now() + std::chrono::seconds(segment.failures);
+    return;
+  }
+
+  // wget sends the data until the end of the file, the data of the next segment is dropped
+  std::uint64_t size = static_cast<std::uint64_t>(count);
+  if (segment.length > 0)
+    size = std::min(size, segment.length - segment.done);
+  std::uint64_t offset = segment.start + segment.done;
+  for (std::uint64_t written = 0; written < size;)
+  {
+    ssize_t result = pwrite(part_fd_, buffer_.data() + written, size - written, static_cast<off_t>(offset + written));
+    if (result < 0 && errno != EINTR)
+      throw std::runtime_error("Could not write '" + part_path_ + "': " + std::strerror(errno));
+    if (result > 0)
+      written += static_cast<std::uint64_t>(result);
+  }
+  segment.done += size;
+  if (offset == delivered_bytes_)
+  {
+    data_cb(buffer_.data(), size);
+    delivered_bytes_ += size;
+  }
+  if (segment.length > 0 && segment.done == segment.length)
+  {
+    stop_segment(segment, true);
+    segment.is_finished = true;
+  }
+}
+
+/**
+ * \brief Pass the data that is next in order from the .part file to the data callback,
+ * eg. the data of a previous run or the data of the next segment (which was downloaded in parallel)
+ */
+void ResumableDownload::deliver(const std::function<void(const char*, std::size_t)>& data_cb)
+{
+  while (true)
+  {
+    auto segment = std::find_if(segments_.begin(), segments_.end(), [this](const Segment& segment)
+                                { return segment.length == 0 || delivered_bytes_ < segment.start + segment.length; });
+    if (segment == segments_.end() || delivered_bytes_ >= segment->start + segment->done)
+      return;
+    std::size_t size = static_cast<std::size_t>(std::min<std::uint64_t>(segment->start + segment->done - delivered_bytes_, buffer_.size()));
+    ssize_t count = pread(part_fd_, buffer_.data(), size, static_cast<off_t>(delivered_bytes_));
+    if (count < 0 && errno == EINTR)
+      continue;
+    if (count <= 0)
+      throw std::runtime_error("Could not read '" + part_path_ + "': " + (count < 0 ? std::strerror(errno) : "unexpected end of the file"));
+    data_cb(buffer_.data(), static_cast<std::size_t>(count));
+    delivered_bytes_ += static_cast<std::uint64_t>(count);
+  }
+}
+
+/**
+ * \brief Bytes of the file in the .part file
+ */
+std::uint64_t ResumableDownload::get_downloaded_bytes() const
+{
+  std::uint64_t bytes = 0;
+  for (const Segment& segment : segments_)
+  {
+    bytes += segment.done;
+  }
+  return bytes;
+}
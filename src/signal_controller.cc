@@ -29,6 +29,7 @@
 #include "bottle_new_assistant.h"
 #include "create_shortcut_window.h"
 #include "helper.h"
+#include "jobs_window.h"
 #include "main_window.h"
 #include "preferences_window.h"
 #include "remove_app_window.h"
@@ -47,7 +48,8 @@ SignalController::SignalController(MainWindow* main_window,
                                    AddAppWindow& add_app_window,
                                    RemoveAppWindow& remove_app_window,
                                    CreateShortcutWindow& create_shortcut_window,
-                                   WineRunnerWindow& wine_runner_window)
+                                   WineRunnerWindow& wine_runner_window,
+                                   JobsWindow& jobs_window)
     : main_window_(main_window),
       manager_(manager),
       preferences_window_(preferences_window),
@@ -58,7 +60,8 @@ SignalController::SignalController(MainWindow* main_window,
       add_app_window_(add_app_window),
       remove_app_window_(remove_app_window),
       create_shortcut_window_(create_shortcut_window),
-      wine_runner_window_(wine_runner_window)
+      wine_runner_window_(wine_runner_window),
+      jobs_window_(jobs_window)
 {
   // Nothing
 }
@@ -101,6 +104,9 @@ void SignalController::dispatch_signals()
   // Package install finished (in settings window), hide the busy dialog & refresh the settings window
   manager_.finished_package_install_dispatcher.connect(sigc::mem_fun(*main_window_, &MainWindow::hide_busy_dialog));
   manager_.finished_package_install_dispatcher.connect(sigc::mem_fun(configure_window_, &BottleConfigureWindow::update_installed));
+  // Jobs changed, update the jobs window
+  manager_.jobs_changed_dispatcher.connect([this]() { jobs_window_.set_jobs(manager_.get_jobs()); });
+  jobs_window_.cancel_job.connect(sigc::mem_fun(manager_, &BottleManager::cancel_job));
 
   // Toolbar actions
   main_window_->new_bottle.connect(sigc::mem_fun(*this, &SignalController::on_new_bottle));
@@ -129,6 +135,7 @@ void SignalController::dispatch_signals()
 
   // Clone Window
   clone_window_.clone_bottle.connect(sigc::mem_fun(*this, &SignalController::on_clone_bottle));
+  clone_window_.cancel_clone.connect(sigc::mem_fun(manager_, &BottleManager::cancel_clone));
 
   // Note: the bottle list right-click context menu (Edit/Clone/Configure/Delete) is handled
   // internally in MainWindow; only the Delete action routes back here via main_window_->delete_bottle above.
@@ -137,6 +144,8 @@ void SignalController::dispatch_signals()
   bottle_created_dispatcher_.connect(sigc::mem_fun(*this, &SignalController::on_new_bottle_created));
   bottle_updated_dispatcher_.connect(sigc::mem_fun(*this, &SignalController::on_bottle_updated));
   bottle_cloned_dispatcher_.connect(sigc::mem_fun(*this, &SignalController::on_bottle_cloned));
+  bottle_clone_cancelled_dispatcher_.connect(sigc::mem_fun(*this, &SignalController::on_bottle_clone_cancelled));
+  clone_progress_dispatcher_.connect(sigc::mem_fun(*this, &SignalController::on_clone_progress));
   error_message_created_dispatcher_.connect(sigc::mem_fun(*this, &SignalController::on_error_message_created));
   error_message_updated_dispatcher_.connect(sigc::mem_fun(*this, &SignalController::on_error_message_updated));
   error_message_cloned_dispatcher_.connect(sigc::mem_fun(*this, &SignalController::on_error_message_cloned));
@@ -213,6 +222,22 @@ void SignalController::signal_bottle_cloned()
   bottle_cloned_dispatcher_.emit();
 }
 
+/**
+ * \brief Signal bottle clone is cancelled by the user, called from the thread.
+ */
+void SignalController::signal_bottle_clone_cancelled()
+{
+  bottle_clone_cancelled_dispatcher_.emit();
+}
+
+/**
+ * \brief Signal the bottle clone progress changed, called from the thread.
+ */
+void SignalController::signal_clone_progress()
+{
+  clone_progress_dispatcher_.emit();
+}
+
 /**
  * \brief Signal error message during bottle creation,
  * called from the thread.
@@ -295,7 +320,7 @@ void SignalController::on_new_bottle(const NewBottleStruct& new_bottle_struct)
         {
           manager_.new_bottle(this, new_bottle_struct.name, new_bottle_struct.windows_version, new_bottle_struct.bit,
                               new_bottle_struct.virtual_desktop_resolution, new_bottle_struct.disable_gecko_mono, new_bottle_struct.audio,
-                              new_bottle_struct.wine_bin_path);
+                              new_bottle_struct.wine_bin_path, new_bottle_struct.install_gaming_packages);
         });
   }
 }
@@ -393,6 +418,27 @@ void SignalController::on_bottle_cloned()
   manager_.update_config_and_bottles(new_cloned_bottle_name, false);
 }
 
+/**
+ * \brief Signal handler when bottle clone is cancelled, dispatched from the manager thread.
+ * There is no new bottle, so the bottle list is not updated.
+ */
+void SignalController::on_bottle_clone_cancelled()
+{
+  this->cleanup_bottle_manager_thread();
+
+  // Hide the busy dialog & the clone window
+  clone_window_.on_bottle_clone_cancelled();
+}
+
+/**
+ * \brief Signal handler when the clone progress changed, dispatched from the manager thread
+ */
+void SignalController::on_clone_progress()
+{
+  const auto& [bytes_done, bytes_total] = manager_.get_clone_progress();
+  clone_window_.on_clone_progress(bytes_done, bytes_total);
+}
+
 /**
  * \brief Fetch the error message from the manager during bottle creation (in a thread-safe manner),
  * and report it to the main window (runs on the GUI thread).
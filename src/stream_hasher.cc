@@ -0,0 +1,183 @@
+/**
+ * Copyright (c) 2026 WineGUI
+ *
+ * \file    stream_hasher.cc
+ * \brief   SHA-256/512 digest of a data stream, computed on a separate thread
+ * \author  Melroy van den Berg <webmaster1989@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "stream_hasher.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+
+// Large blocks keep the synchronization between the threads rare, a few blocks allow the caller to run ahead
+static constexpr std::size_t BlockSize = 2 * 1024 * 1024;
+static constexpr std::size_t BlockCount = 4;
+static constexpr std::size_t BlockAlignment = 4096;
+
+/**
+ * \brief Constructor, starts the hash thread
+ * \param[in] algorithm Hash algorithm
+ * \throws std::runtime_error when the hash algorithm is not available
+ */
+StreamHasher::StreamHasher(Algorithm algorithm)
+    : context_(EVP_MD_CTX_new()),
+      current_block_(allocate_block()),
+      current_size_(0),
+      is_finished_(false)
+{
+  const EVP_MD* digest_type = (algorithm == Algorithm::Sha512) ? EVP_sha512() : EVP_sha256();
+  if (context_ == nullptr || EVP_DigestInit_ex(context_, digest_type, nullptr) != 1)
+  {
+    EVP_MD_CTX_free(context_);
+    throw std::runtime_error("Could not initialize the checksum calculation.");
+  }
+  for (std::size_t i = 1; i < BlockCount; ++i)
+    free_blocks_.push_back(allocate_block());
+  thread_ = std::thread(&StreamHasher::hash_blocks, this);
+}
+
+/**
+ * \brief Destructor, stops the hash thread (the data that is not hashed yet is dropped)
+ */
+StreamHasher::~StreamHasher()
+{
+  if (thread_.joinable())
+  {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      full_blocks_.clear();
+      is_finished_ = true;
+    }
+    cv_.notify_all();
+    thread_.join();
+  }
+  EVP_MD_CTX_free(context_);
+}
+
+/**
+ * \brief Add the next part of the data. Blocks only when the hash thread is behind by multiple blocks.
+ * \param[in] data Data
+ * \param[in] size Size of the data in bytes
+ * \throws std::runtime_error when hashing failed
+ */
+void StreamHasher::update(const char* data, std::size_t size)
+{
+  while (size > 0)
+  {
+    std::size_t count = std::min(size, BlockSize - current_size_);
+    std::memcpy(current_block_.get() + current_size_, data, count);
+    current_size_ += count;
+    data += count;
+    size -= count;
+    if (current_size_ == BlockSize)
+      submit_block();
+  }
+}
+
+/**
+ * \brief Wait until all data is hashed, and get the digest (call once, after the last update)
+ * \throws std::runtime_error when hashing failed
+ * \return Lowercase hex digest
+ */
+std::string StreamHasher::finish()
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (current_size_ > 0)
+      full_blocks_.emplace_back(std::move(current_block_), current_size_);
+    current_size_ = 0;
+    is_finished_ = true;
+  }
+  cv_.notify_all();
+  thread_.join();
+  if (!error_message_.empty())
+    throw std::runtime_error(error_message_);
+
+  unsigned char digest[EVP_MAX_MD_SIZE];
+  unsigned int digest_size = 0;
+  if (EVP_DigestFinal_ex(context_, digest, &digest_size) != 1)
+    throw std::runtime_error("Could not finish the checksum calculation.");
+  static constexpr char HexDigits[] = "0123456789abcdef";
+  std::string hex_digest;
+  hex_digest.reserve(digest_size * 2);
+  for (unsigned int i = 0; i < digest_size; ++i)
+  {
+    hex_digest.push_back(HexDigits[digest[i] >> 4]);
+    hex_digest.push_back(HexDigits[digest[i] & 0x0f]);
+  }
+  return hex_digest;
+}
+
+/**
+ * \brief Allocate a data block
+ * \throws std::bad_alloc when out of memory
+ * \return Block of BlockSize bytes
+ */
+StreamHasher::Block StreamHasher::allocate_block()
+{
+  void* data = std::aligned_alloc(BlockAlignment, BlockSize);
+  if (data == nullptr)
+    throw std::bad_alloc();
+  return Block(static_cast<char*>(data), std::free);
+}
+
+/**
+ * \brief Pass the (full) current block to the hash thread, and continue with a free block
+ * \throws std::runtime_error when hashing failed
+ */
+void StreamHasher::submit_block()
+{
+  std::unique_lock<std::mutex> lock(mutex_);
+  full_blocks_.emplace_back(std::move(current_block_), current_size_);
+  cv_.notify_all();
+  cv_.wait(lock, [this]() { return !free_blocks_.empty() || !error_message_.empty(); });
+  if (!error_message_.empty())
+    throw std::runtime_error(error_message_);
+  current_block_ = std::move(free_blocks_.back());
+  free_blocks_.pop_back();
+  current_size_ = 0;
+}
+
+/**
+ * \brief Hash thread, hashes the full blocks in order until the end of the data
+ */
+void StreamHasher::hash_blocks()
+{
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true)
+  {
+    cv_.wait(lock, [this]() { return !full_blocks_.empty() || is_finished_; });
+    if (full_blocks_.empty())
+      return;
+    auto [block, size] = std::move(full_blocks_.front());
+    full_blocks_.pop_front();
+    lock.unlock();
+    bool is_updated = EVP_DigestUpdate(context_, block.get(), size) == 1;
+    lock.lock();
+    if (!is_updated)
+    {
+      error_message_ = "Could not calculate the checksum.";
+      cv_.notify_all();
+      return;
+    }
+    free_blocks_.push_back(std::move(block));
+    cv_.notify_all();
+  }
+}
@@ -2,7 +2,7 @@
  * Copyright (c) 2026 WineGUI
  *
  * \file    wine_runner_install_task.cc
- * \brief   Asynchronous facade around WineRunnerManager (worker thread + Glib::Dispatcher signals)
+ * \brief   Asynchronous facade around WineRunnerManager (worker threads + Glib::Dispatcher signals)
  * \author  Melroy van den Berg <webmaster1989@gmail.com>
  *
  * This program is free software: you can redistribute it and/or modify
@@ -22,27 +22,37 @@
 
 #include "wine_runner_manager.h"
 
+#include <algorithm>
 #include <stdexcept>
 
+// Minimum interval between two progress notifications of a job (the phase changes & the end of the download are always notified)
+static constexpr std::chrono::milliseconds ProgressInterval = std::chrono::milliseconds(100);
+
 /**
  * \brief Constructor. Construct on the GUI thread (Glib::Dispatcher requirement).
- * The internal cleanup handlers are connected first, so they run before any UI handler
- * connected to the same dispatchers.
+ * The internal handlers are connected first, so they run before any UI handler
+ * connected to the same dispatchers (the pending progress flag is cleared before the UI reads the progress).
+ * \param[in] max_running_jobs Maximum number of installs & removals that run at the same time
  */
-WineRunnerInstallTask::WineRunnerInstallTask()
+WineRunnerInstallTask::WineRunnerInstallTask(std::size_t max_running_jobs) : scheduler_(std::max<std::size_t>(max_running_jobs, 1), {})
 {
+  progress_changed.connect([this] { is_progress_pending_.store(false); });
   releases_fetched.connect(sigc::mem_fun(*this, &WineRunnerInstallTask::cleanup_thread));
   fetch_failed.connect(sigc::mem_fun(*this, &WineRunnerInstallTask::cleanup_thread));
-  install_finished.connect(sigc::mem_fun(*this, &WineRunnerInstallTask::cleanup_thread));
-  remove_finished.connect(sigc::mem_fun(*this, &WineRunnerInstallTask::cleanup_thread));
 }
 
 /**
- * \brief Destructor. Cancels a running operation and waits for the worker thread.
+ * \brief Destructor. Cancels the queued & running operations and waits for the worker threads.
  */
 WineRunnerInstallTask::~WineRunnerInstallTask()
 {
-  cancel_requested_.store(true);
+  {
+    std::lock_guard<std::mutex> lock(jobs_mutex_);
+    for (const auto& [id, state] : jobs_)
+    {
+      state->cancel_requested.store(true);
+    }
+  }
   if (thread_ && thread_->joinable())
   {
     thread_->join();
@@ -51,25 +61,24 @@ WineRunnerInstallTask::~WineRunnerInstallTask()
 }
 
 /**
- * \brief Whether an operation is currently running
- * \return True when busy (new operations are refused)
+ * \brief Whether a release list fetch is currently running
+ * \return True when fetching (new fetches are refused)
  */
-bool WineRunnerInstallTask::is_busy() const
+bool WineRunnerInstallTask::is_fetching() const
 {
-  return is_busy_.load();
+  return is_fetching_.load();
 }
 
 /**
  * \brief Fetch the release list of a runner source (async).
- * Fires releases_fetched or fetch_failed when done. No-op when busy.
+ * Fires releases_fetched or fetch_failed when done. No-op when a fetch is running.
  * \param[in] source_id Source ID
  */
 void WineRunnerInstallTask::fetch_releases_async(WineRunner::SourceId source_id)
 {
-  if (is_busy_.exchange(true))
+  if (is_fetching_.exchange(true))
     return;
   cleanup_thread();
-  cancel_requested_.store(false);
   fetched_source_id_.store(source_id);
   thread_ = std::make_unique<std::thread>(
       [this, source_id]
@@ -82,7 +91,7 @@ void WineRunnerInstallTask::fetch_releases_async(WineRunner::SourceId source_id)
             releases_ = std::move(releases);
           }
           fetched_source_id_.store(source_id);
-          is_busy_.store(false);
+          is_fetching_.store(false);
           releases_fetched.emit();
         }
         catch (const std::runtime_error& error)
@@ -91,100 +100,97 @@ void WineRunnerInstallTask::fetch_releases_async(WineRunner::SourceId source_id)
             std::lock_guard<std::mutex> lock(data_mutex_);
             error_message_ = error.what();
           }
-          is_busy_.store(false);
+          is_fetching_.store(false);
           fetch_failed.emit();
         }
       });
 }
 
 /**
- * \brief Download & install a runner release (async).
- * Fires progress_changed during the install and install_finished when done. No-op when busy.
+ * \brief Queue the download & install of a runner release.
+ * Fires progress_changed during the install and job_finished when done.
  * \param[in] release Release to install
+ * \return Job ID, or 0 when the runner already has a queued or running job
  */
-void WineRunnerInstallTask::install_async(const WineRunner::Release& release)
+std::size_t WineRunnerInstallTask::install_async(const WineRunner::Release& release)
 {
-  if (is_busy_.exchange(true))
-    return;
-  cleanup_thread();
-  cancel_requested_.store(false);
-  bytes_done_.store(0);
-  bytes_total_.store(release.size_bytes);
-  phase_.store(WineRunner::InstallPhase::Idle);
-  thread_ = std::make_unique<std::thread>(
-      [this, release]
-      {
-        try
-        {
-          bool success = WineRunnerManager::download_and_install(
-              release,
-              [this](std::uint64_t bytes_done, std::uint64_t bytes_total)
-              {
-                bytes_done_.store(bytes_done);
-                bytes_total_.store(bytes_total);
-                progress_changed.emit();
-              },
-              [this](WineRunner::InstallPhase phase)
-              {
-                phase_.store(phase);
-                progress_changed.emit();
-              },
-              cancel_requested_);
-          status_.store(success ? WineRunner::InstallStatus::Success : WineRunner::InstallStatus::Cancelled);
-        }
-        catch (const std::runtime_error& error)
-        {
-          {
-            std::lock_guard<std::mutex> lock(data_mutex_);
-            error_message_ = error.what();
-          }
-          status_.store(WineRunner::InstallStatus::Error);
-        }
-        phase_.store(WineRunner::InstallPhase::Idle);
-        is_busy_.store(false);
-        install_finished.emit();
-      });
+  auto state = std::make_unique<JobState>();
+  state->job.type = JobType::Install;
+  state->job.name = WineRunnerManager::expected_install_dir_name(release);
+  state->job.display_name = WineRunnerManager::derive_display_name(state->job.name);
+  state->job.asset_name = release.asset_name;
+  state->bytes_total.store(release.size_bytes);
+  return submit(std::move(state),
+                [this, release](JobState& job_state)
+                {
+                  return WineRunnerManager::download_and_install(
+                      release,
+                      [this, &job_state](std::uint64_t bytes_done, std::uint64_t bytes_total)
+                      {
+                        job_state.bytes_done.store(bytes_done);
+                        job_state.bytes_total.store(bytes_total);
+                        notify_progress(job_state, bytes_done == bytes_total);
+                      },
+                      [this, &job_state](WineRunner::InstallPhase phase)
+                      {
+                        job_state.phase.store(phase);
+                        notify_progress(job_state, true);
+                      },
+                      job_state.cancel_requested);
+                });
 }
 
 /**
- * \brief Remove an installed runner (async).
- * Fires remove_finished when done (empty error message = success). No-op when busy.
+ * \brief Queue the removal of an installed runner.
+ * Fires job_finished when done (empty error message = success).
  * \param[in] runner Installed runner to remove
+ * \return Job ID, or 0 when the runner already has a queued or running job
  */
-void WineRunnerInstallTask::remove_async(const WineRunner::InstalledRunner& runner)
+std::size_t WineRunnerInstallTask::remove_async(const WineRunner::InstalledRunner& runner)
 {
-  if (is_busy_.exchange(true))
-    return;
-  cleanup_thread();
-  cancel_requested_.store(false);
-  thread_ = std::make_unique<std::thread>(
-      [this, runner]
-      {
-        Glib::ustring error_message = "";
-        try
-        {
-          WineRunnerManager::remove_runner(runner);
-        }
-        catch (const std::runtime_error& error)
-        {
-          error_message = error.what();
-        }
-        {
-          std::lock_guard<std::mutex> lock(data_mutex_);
-          error_message_ = error_message;
-        }
-        is_busy_.store(false);
-        remove_finished.emit();
-      });
+  auto state = std::make_unique<JobState>();
+  state->job.type = JobType::Remove;
+  state->job.name = runner.name;
+  state->job.display_name = runner.display_name;
+  return submit(std::move(state),
+                [runner](JobState&)
+                {
+                  WineRunnerManager::remove_runner(runner);
+                  return true;
+                });
 }
 
 /**
- * \brief Request cancellation of the running install.
- * The install_finished dispatcher will fire with InstallStatus::Cancelled.
+ * \brief Request the cancellation of a job. A queued job is removed from the queue right away, a running install
+ * stops as soon as possible. The job_finished dispatcher fires with InstallStatus::Cancelled (a removal can't be
+ * cancelled once it is started).
+ * \param[in] job_id Job ID
  */
-void WineRunnerInstallTask::cancel()
+void WineRunnerInstallTask::cancel(std::size_t job_id)
 {
-  cancel_requested_.store(true);
+  JobState* state = nullptr;
+  {
+    std::lock_guard<std::mutex> lock(jobs_mutex_);
+    auto it = jobs_.find(job_id);
+    if (it == jobs_.end() || it->second->job.is_finished)
+      return;
+    state = it->second.get();
+    state->cancel_requested.store(true);
+  }
+  if (scheduler_.cancel(state->scheduler_id))
+    finish_job(*state, WineRunner::InstallStatus::Cancelled, "");
+}
+
+/**
+ * \brief Check if a runner has a queued or running job (eg. to prevent installing the same release twice)
+ * \param[in] name Runner directory name
+ * \return True when a job of the runner is not finished yet
+ */
+bool WineRunnerInstallTask::has_pending_job(const std::string& name) const
+{
+  std::lock_guard<std::mutex> lock(jobs_mutex_);
+  return std::any_of(jobs_.begin(), jobs_.end(),
+                     [&name](const auto& entry) { return entry.second->job.name == name && !entry.second->job.is_finished; });
 }
 
 /**
@@ -207,48 +213,154 @@ WineRunner::SourceId WineRunnerInstallTask::get_fetched_source_id() const
 }
 
 /**
- * \brief Get the current download progress
- * \return Pair of bytes done & bytes total (total 0 = unknown, show a pulsing progress bar)
+ * \brief Get the error message of the last release list fetch
+ * \return Error message (empty string when there was no error)
  */
-std::pair<std::uint64_t, std::uint64_t> WineRunnerInstallTask::get_progress() const
+Glib::ustring WineRunnerInstallTask::get_error_message() const
 {
-  return {bytes_done_.load(), bytes_total_.load()};
+  std::lock_guard<std::mutex> lock(data_mutex_);
+  return error_message_;
 }
 
 /**
- * \brief Get the current install phase
- * \return Install phase
+ * \brief Get the queued & running jobs with their current progress (in the order they were added)
+ * \return List of jobs
  */
-WineRunner::InstallPhase WineRunnerInstallTask::get_phase() const
+std::vector<WineRunnerInstallTask::Job> WineRunnerInstallTask::get_jobs() const
 {
-  return phase_.load();
+  std::lock_guard<std::mutex> lock(jobs_mutex_);
+  std::vector<Job> jobs;
+  for (const auto& [id, state] : jobs_)
+  {
+    if (state->job.is_finished)
+      continue;
+    Job job = state->job;
+    job.phase = state->phase.load();
+    job.bytes_done = state->bytes_done.load();
+    job.bytes_total = state->bytes_total.load();
+    jobs.emplace_back(std::move(job));
+  }
+  return jobs;
 }
 
 /**
- * \brief Get the final status of the last install (after install_finished fired)
- * \return Install status
+ * \brief Get the finished jobs (after job_finished fired), the jobs are forgotten afterwards
+ * \return List of finished jobs with their status & error message
  */
-WineRunner::InstallStatus WineRunnerInstallTask::get_install_status() const
+std::vector<WineRunnerInstallTask::Job> WineRunnerInstallTask::take_finished_jobs()
 {
-  return status_.load();
+  std::lock_guard<std::mutex> lock(jobs_mutex_);
+  std::vector<Job> jobs;
+  for (auto it = jobs_.begin(); it != jobs_.end();)
+  {
+    if (it->second->job.is_finished)
+    {
+      jobs.emplace_back(it->second->job);
+      it = jobs_.erase(it);
+    }
+    else
+    {
+      ++it;
+    }
+  }
+  return jobs;
 }
 
+/*************************************************************
+ * Private member functions                                  *
+ *************************************************************/
+
 /**
- * \brief Get the error message of the last operation
- * \return Error message (empty string when there was no error)
+ * \brief Add a job and queue its operation. Jobs of the same runner run one after the other.
+ * \param[in] state New job
+ * \param[in] operation Blocking operation (on a worker thread), returns false when cancelled and throws
+ * std::runtime_error on failure
+ * \return Job ID, or 0 when the runner already has a queued or running job
  */
-Glib::ustring WineRunnerInstallTask::get_error_message() const
+std::size_t WineRunnerInstallTask::submit(std::unique_ptr<JobState> state, const std::function<bool(JobState&)>& operation)
 {
-  std::lock_guard<std::mutex> lock(data_mutex_);
-  return error_message_;
+  // Jobs are only added on the GUI thread
+  if (has_pending_job(state->job.name))
+    return 0;
+  JobState* job_state = state.get();
+  std::size_t id = 0;
+  {
+    std::lock_guard<std::mutex> lock(jobs_mutex_);
+    id = next_job_id_++;
+    state->job.id = id;
+    state->job.phase = WineRunner::InstallPhase::Queued;
+    jobs_.emplace(id, std::move(state));
+    job_state->scheduler_id = scheduler_.submit(job_state->job.display_name, job_state->job.name, JobScheduler::Lock::Exclusive,
+                                                [this, job_state, operation] { run_job(*job_state, operation); });
+  }
+  // Show the queued job
+  if (!is_progress_pending_.exchange(true))
+    progress_changed.emit();
+  return id;
 }
 
-/*************************************************************
- * Private member functions                                  *
- *************************************************************/
+/**
+ * \brief Run the operation of a job (on a worker thread of the scheduler)
+ * \param[in] state Job
+ * \param[in] operation Blocking operation, returns false when cancelled
+ */
+void WineRunnerInstallTask::run_job(JobState& state, const std::function<bool(JobState&)>& operation)
+{
+  state.phase.store(WineRunner::InstallPhase::Idle);
+  notify_progress(state, true);
+  if (state.cancel_requested.load())
+  {
+    finish_job(state, WineRunner::InstallStatus::Cancelled, "");
+    return;
+  }
+  try
+  {
+    bool success = operation(state);
+    finish_job(state, success ? WineRunner::InstallStatus::Success : WineRunner::InstallStatus::Cancelled, "");
+  }
+  catch (const std::runtime_error& error)
+  {
+    finish_job(state, WineRunner::InstallStatus::Error, error.what());
+  }
+}
+
+/**
+ * \brief Mark a job as finished and notify the GUI (called on any thread)
+ * \param[in] state Job
+ * \param[in] status Final status
+ * \param[in] error_message Error message (empty when there was no error)
+ */
+void WineRunnerInstallTask::finish_job(JobState& state, WineRunner::InstallStatus status, const Glib::ustring& error_message)
+{
+  {
+    std::lock_guard<std::mutex> lock(jobs_mutex_);
+    state.job.phase = WineRunner::InstallPhase::Idle;
+    state.job.status = status;
+    state.job.error_message = error_message;
+    state.job.is_finished = true;
+  }
+  job_finished.emit();
+}
+
+/**
+ * \brief Notify the GUI about the stored progress of a job (called on any thread). The notifications are rate-limited
+ * per job and coalesced: at most one notification is queued, the GUI reads the latest progress of all jobs when it
+ * handles the notification.
+ * \param[in] state Job
+ * \param[in] is_forced Notify regardless of the rate limit (eg. a phase change)
+ */
+void WineRunnerInstallTask::notify_progress(JobState& state, bool is_forced)
+{
+  auto now = std::chrono::steady_clock::now();
+  if (!is_forced && now - state.last_progress_time < ProgressInterval)
+    return;
+  state.last_progress_time = now;
+  if (!is_progress_pending_.exchange(true))
+    progress_changed.emit();
+}
 
 /**
- * \brief Join & release a finished worker thread (called on the GUI thread via the dispatchers)
+ * \brief Join & release a finished fetch thread (called on the GUI thread via the dispatchers)
  */
 void WineRunnerInstallTask::cleanup_thread()
 {
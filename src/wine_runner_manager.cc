@@ -20,25 +20,31 @@
  */
 #include "wine_runner_manager.h"
 
+#include "archive_extractor.h"
+#include "download_cache.h"
 #include "helper.h"
+#include "release_list_cache.h"
+#include "resumable_download.h"
+#include "stream_hasher.h"
 
 #include <algorithm>
 #include <cctype>
 #include <cerrno>
+#include <chrono>
 #include <cstring>
+#include <fcntl.h>
 #include <filesystem>
-#include <fstream>
-#include <glibmm/checksum.h>
 #include <glibmm/fileutils.h>
 #include <glibmm/miscutils.h>
 #include <glibmm/spawn.h>
-#include <glibmm/timer.h>
 #include <iostream>
 #include <map>
+#include <memory>
 #include <nlohmann/json.hpp>
-#include <signal.h>
 #include <sstream>
 #include <stdexcept>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include <sys/types.h>
 #include <sys/wait.h>
 #include <unistd.h>
@@ -53,7 +59,12 @@ static const std::vector<WineRunner::Source> RunnerSources = {
      "proton-ge-custom"},
 };
 
-/// Per-session cache of the fetched GitHub release lists (protects against the GitHub API rate limit)
+/// Archives are downloaded in this many parallel segments (HTTP range requests), small archives in fewer segments
+static constexpr unsigned int DownloadSegmentCount = 4;
+/// Maximum total size of the downloaded archives that are kept for a reinstall (a GE-Proton archive is ~600 MB)
+static constexpr std::uint64_t DownloadCacheMaxSize = 2ULL * 1024 * 1024 * 1024;
+
+/// Release lists that are revalidated with GitHub in this session (protects against the GitHub API rate limit)
 static std::map<WineRunner::SourceId, std::vector<WineRunner::Release>> release_cache;
 static std::mutex release_cache_mutex;
 
@@ -115,6 +126,66 @@ static std::string variant_display_name(const std::string& variant)
   return join_string(display_tokens, 0, display_tokens.size(), '-');
 }
 
+/**
+ * \brief Read a file in chunks (eg. an archive from the download cache). The file is memory-mapped, so the chunks are
+ * passed without copying them into a buffer first, and the kernel reads ahead since the access is sequential.
+ * \param[in] file_path File to read
+ * \param[in] data_cb Callback that gets the data of the file in order
+ * \param[in] progress_cb Progress callback (bytes read, file size), after every chunk; may be empty
+ * \param[in] cancel Cancellation flag (polled)
+ * \throws std::runtime_error when the file could not be read
+ * \return True when the file is completely read, false when cancelled
+ */
+static bool read_file(const std::string& file_path,
+                      const std::function<void(const char*, std::size_t)>& data_cb,
+                      const std::function<void(std::uint64_t, std::uint64_t)>& progress_cb,
+                      const std::atomic<bool>& cancel)
+{
+  static constexpr std::size_t ChunkSize = 4 * 1024 * 1024;
+  int fd = open(file_path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0)
+    throw std::runtime_error("Could not open '" + file_path + "': " + std::strerror(errno));
+  struct stat file_stat{};
+  if (fstat(fd, &file_stat) != 0)
+  {
+    int error = errno;
+    close(fd);
+    throw std::runtime_error("Could not read '" + file_path + "': " + std::strerror(error));
+  }
+  std::size_t file_size = static_cast<std::size_t>(file_stat.st_size);
+  if (file_size == 0)
+  {
+    close(fd);
+    return !cancel.load();
+  }
+  void* mapping = mmap(nullptr, file_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  int error = errno;
+  close(fd);
+  if (mapping == MAP_FAILED)
+    throw std::runtime_error("Could not read '" + file_path + "': " + std::strerror(error));
+  madvise(mapping, file_size, MADV_SEQUENTIAL);
+  const char* data = static_cast<const char*>(mapping);
+  std::size_t bytes_done = 0;
+  try
+  {
+    while (bytes_done < file_size && !cancel.load())
+    {
+      std::size_t count = std::min(ChunkSize, file_size - bytes_done);
+      data_cb(data + bytes_done, count);
+      bytes_done += count;
+      if (progress_cb)
+        progress_cb(bytes_done, file_size);
+    }
+  }
+  catch (...)
+  {
+    munmap(mapping, file_size);
+    throw;
+  }
+  munmap(mapping, file_size);
+  return !cancel.load();
+}
+
 /**
  * \brief Get the curated list of supported runner providers
  * \return List of runner sources
@@ -140,11 +211,31 @@ const WineRunner::Source& WineRunnerManager::get_source(WineRunner::SourceId sou
   return *it;
 }
 
+/**
+ * \brief Get the release list of a runner provider as it was last fetched, without any network access
+ * \param[in] source_id Source ID
+ * \return List of releases (newest first), or nullopt when the list was never fetched
+ */
+std::optional<std::vector<WineRunner::Release>> WineRunnerManager::get_cached_releases(WineRunner::SourceId source_id)
+{
+  {
+    std::lock_guard<std::mutex> lock(release_cache_mutex);
+    if (auto it = release_cache.find(source_id); it != release_cache.end())
+      return it->second;
+  }
+  std::optional<ReleaseListCache::Entry> cached = ReleaseListCache::get_instance().get(source_id);
+  if (!cached.has_value())
+    return std::nullopt;
+  return cached->releases;
+}
+
 /**
  * \brief Fetch the list of downloadable releases of a runner provider from the GitHub API.
- * The result is cached for the rest of the session (see also invalidate_release_cache()).
+ * The list is persisted on disk, and revalidated with a conditional request (an unchanged list is not transferred again).
+ * When GitHub can't be reached, the persisted list is returned. The result is cached for the rest of the session
+ * (see also invalidate_release_cache()).
  * \param[in] source_id Source ID
- * \throws std::runtime_error when the list could not be fetched or parsed (eg. offline or GitHub rate limit)
+ * \throws std::runtime_error when the list could not be fetched or parsed, and no list was persisted (eg. offline or GitHub rate limit)
  * \return List of releases, newest first
  */
 std::vector<WineRunner::Release> WineRunnerManager::get_releases(WineRunner::SourceId source_id)
@@ -157,18 +248,34 @@ std::vector<WineRunner::Release> WineRunnerManager::get_releases(WineRunner::Sou
 
   const WineRunner::Source& source = get_source(source_id);
   std::string url = "https://api.github.com/repos/" + source.github_owner + "/" + source.github_repo + "/releases?per_page=100";
-  std::string json_body;
+  ReleaseListCache& release_list_cache = ReleaseListCache::get_instance();
+  std::optional<ReleaseListCache::Entry> cached = release_list_cache.get(source_id);
+  ReleaseListCache::Entry entry;
+  if (cached.has_value())
+    entry = cached.value();
+  std::vector<WineRunner::Release> releases;
   try
   {
-    json_body = fetch_url(url);
+    std::optional<std::string> json_body = fetch_url_if_modified(url, entry.etag, entry.last_modified);
+    if (json_body.has_value())
+    {
+      entry.releases = parse_github_releases_json(source_id, json_body.value());
+      release_list_cache.put(source_id, entry);
+    }
+    releases = entry.releases;
   }
   catch (const std::runtime_error& error)
   {
-    throw std::runtime_error("Could not fetch the release list of " + source.display_name +
-                             " from GitHub.\n\nEither you are offline or the GitHub API rate limit was reached (max 60 requests per hour).\nAlready "
-                             "installed runners keep working. Please, try again later.");
+    if (!cached.has_value())
+    {
+      throw std::runtime_error("Could not fetch the release list of " + source.display_name +
+                               " from GitHub.\n\nEither you are offline or the GitHub API rate limit was reached (max 60 requests per "
+                               "hour).\nAlready installed runners keep working. Please, try again later.");
+    }
+    // Offline: keep using the persisted list, it is revalidated again on the next call
+    std::cout << "WARN: Could not revalidate the release list of " << source.display_name << ", using the saved list." << std::endl;
+    return cached->releases;
   }
-  std::vector<WineRunner::Release> releases = parse_github_releases_json(source_id, json_body);
 
   std::lock_guard<std::mutex> lock(release_cache_mutex);
   release_cache[source_id] = releases;
@@ -176,7 +283,7 @@ std::vector<WineRunner::Release> WineRunnerManager::get_releases(WineRunner::Sou
 }
 
 /**
- * \brief Clear the cached release lists, so the next get_releases() call fetches a fresh list
+ * \brief Clear the release lists of this session, so the next get_releases() call revalidates the lists with GitHub
  */
 void WineRunnerManager::invalidate_release_cache()
 {
@@ -486,7 +593,8 @@ std::vector<WineRunner::InstalledRunner> WineRunnerManager::get_installed_runner
       runner.wow64 = classified.has_value() && classified->wow64;
       try
       {
-        // Request the 64-bit binary, get_wine_executable_location() falls back to the unified wine binary for WoW64 builds
+        // Request the 64-bit binary, get_wine_executable_location() falls back to the unified wine binary for WoW64 builds.
+        // The version is cached per binary, so an unchanged runner is only probed once.
         runner.wine_version = Helper::get_wine_version(true, "", runner.bin_dir);
       }
       catch (const std::runtime_error& version_error)
@@ -622,14 +730,57 @@ std::optional<std::string> WineRunnerManager::parse_checksum_file(const std::str
   return std::nullopt;
 }
 
+/**
+ * \brief Parse the HTTP response headers as printed by wget --server-response. After a redirect,
+ * only the headers of the final response are used.
+ * \param[in] server_response Standard error output of wget
+ * \param[out] etag ETag header of the response (empty if none)
+ * \param[out] last_modified Last-Modified header of the response (empty if none)
+ * \return HTTP status code of the final response, 0 when no response was received
+ */
+int WineRunnerManager::parse_server_response(const std::string& server_response, std::string& etag, std::string& last_modified)
+{
+  int status_code = 0;
+  for (const std::string& line : split_string(server_response, '\n'))
+  {
+    std::string header = line.substr(std::min(line.find_first_not_of(' '), line.size()));
+    if (!header.empty() && header.back() == '\r')
+      header.pop_back();
+    if (header.starts_with("HTTP/"))
+    {
+      // Status line of the next response
+      std::istringstream status_line(header);
+      std::string protocol;
+      status_line >> protocol >> status_code;
+      etag.clear();
+      last_modified.clear();
+      continue;
+    }
+    std::string::size_type colon = header.find(':');
+    if (colon == std::string::npos)
+      continue;
+    std::string name = header.substr(0, colon);
+    std::transform(name.begin(), name.end(), name.begin(), [](unsigned char character) { return std::tolower(character); });
+    std::string value = header.substr(std::min(header.find_first_not_of(' ', colon + 1), header.size()));
+    if (name == "etag")
+      etag = value;
+    else if (name == "last-modified")
+      last_modified = value;
+  }
+  return status_code;
+}
+
 /**
  * \brief Download & install a Wine runner release into the WineGUI runners directory.
- * Downloads the archive, verifies the published checksum, extracts to a staging directory,
- * validates the archive layout and finally moves the runner into place (atomic rename).
+ * The archive is extracted to a staging directory while it is downloading. A cancelled or failed download continues where
+ * it stopped on the next try, and verified archives are kept in a download cache (so a reinstall needs no network).
+ * Once the download is finished, the checksum of the archive is compared with the published checksum, the archive layout
+ * is validated and finally the runner is moved into place (atomic rename). A corrupted download never ends up installed.
  * \param[in] release Release to install
- * \param[in] progress_cb Progress callback (bytes done, bytes total), invoked from the calling thread; may be empty
+ * \param[in] progress_cb Progress callback (bytes done, bytes total), invoked from the calling thread for every chunk of data (not
+ * rate-limited); may be empty
  * \param[in] phase_cb Phase change callback, invoked from the calling thread; may be empty
- * \param[in] cancel Cancellation flag (polled during the download and between phases)
+ * \param[in] cancel Cancellation flag (polled during the download & extraction and between phases)
  * \throws std::runtime_error on failure
  * \return True on success, false when cancelled
  */
@@ -656,16 +807,11 @@ bool WineRunnerManager::download_and_install(const WineRunner::Release& release,
     throw std::runtime_error("This Wine runner version is already installed.");
   }
 
-  std::string tmp_dir = Glib::build_filename(runners_dir, ".tmp");
-  fs::create_directories(tmp_dir, error_code);
-  if (error_code)
-  {
-    throw std::runtime_error("Could not create the temporary download directory: " + tmp_dir);
-  }
-  std::string archive_path = Glib::build_filename(tmp_dir, release.asset_name);
-  std::string staging_dir = Glib::build_filename(runners_dir, ".staging-" + std::to_string(getpid()));
+  // Multiple installs can run at the same time, each has its own staging directory
+  static std::atomic<unsigned int> staging_counter = 0;
+  std::string staging_dir = Glib::build_filename(runners_dir, get_staging_prefix() + std::to_string(++staging_counter));
 
-  // Remove the transient download & staging files again in every exit path (success, cancel & error)
+  // Remove the staging files again in every exit path (success, cancel & error)
   struct TransientFilesCleanup
   {
     std::vector<std::string> paths;
@@ -678,38 +824,107 @@ bool WineRunnerManager::download_and_install(const WineRunner::Release& release,
       }
     }
   } cleanup;
-  cleanup.paths = {archive_path, archive_path + ".part", staging_dir};
+  cleanup.paths = {staging_dir};
+
+  // Verified archives are cached under their checksum, so a reinstall does not need the network at all.
+  // Otherwise the published checksum is fetched up-front, the archive is hashed while it is downloaded & extracted.
+  DownloadCache download_cache(Glib::build_filename(runners_dir, ".cache"), DownloadCacheMaxSize);
+  std::string part_path = download_cache.get_part_path(release.asset_name);
+  std::optional<std::string> expected_digest = download_cache.find_digest(release.asset_name);
+  bool is_digest_fetched = !expected_digest.has_value();
+  if (is_digest_fetched)
+    expected_digest = fetch_expected_digest(release);
+  if (cancel.load())
+    return false;
 
   if (phase_cb)
     phase_cb(WineRunner::InstallPhase::Downloading);
-  if (!download_file(release.download_url, archive_path + ".part", release.size_bytes, progress_cb, cancel))
+  fs::create_directories(staging_dir, error_code);
+  if (error_code)
   {
-    return false; // Cancelled
+    throw std::runtime_error("Could not create the staging directory: " + staging_dir);
   }
-  fs::rename(archive_path + ".part", archive_path, error_code);
-  if (error_code)
+  std::optional<std::string> cached_archive_path = expected_digest.has_value() ? download_cache.get_file_path(expected_digest.value()) : std::nullopt;
+  std::optional<std::string> actual_digest;
+  // Only one install at a time extracts to the disk, the other installs only download in the meantime
+  std::unique_lock<std::timed_mutex> disk_lock(get_extraction_mutex(runners_dir), std::try_to_lock);
+  if (cached_archive_path.has_value())
+  {
+    if (!lock_disk(disk_lock, phase_cb, cancel))
+      return false;
+    if (phase_cb)
+      phase_cb(WineRunner::InstallPhase::Extracting);
+    bool is_cache_valid = false;
+    try
+    {
+      actual_digest = download_and_extract(release, cached_archive_path.value(), true, staging_dir, progress_cb, phase_cb, cancel);
+      is_cache_valid = !actual_digest.has_value() || actual_digest.value() == expected_digest.value();
+    }
+    catch (const std::runtime_error& error)
+    {
+      std::cout << "WARN: Could not install from the cached archive: " << error.what() << std::endl;
+    }
+    if (!is_cache_valid)
+    {
+      // Corrupted on disk, download the archive again
+      download_cache.remove(expected_digest.value());
+      cached_archive_path.reset();
+      fs::remove_all(staging_dir, error_code);
+      fs::create_directories(staging_dir, error_code);
+      if (!is_digest_fetched)
+        expected_digest = fetch_expected_digest(release);
+      if (phase_cb)
+        phase_cb(WineRunner::InstallPhase::Downloading);
+    }
+  }
+  auto verify_digest = [&]()
+  {
+    if (expected_digest.has_value() && actual_digest.value() != expected_digest.value())
+    {
+      ResumableDownload::discard(part_path);
+      throw std::runtime_error("Checksum verification of the downloaded archive failed!\n\nThe download is possibly corrupted (or tampered with). "
+                               "Please, try again.");
+    }
+  };
+  if (!cached_archive_path.has_value() && disk_lock.owns_lock())
   {
-    throw std::runtime_error("Could not move the downloaded archive: " + error_code.message());
+    actual_digest = download_and_extract(release, part_path, false, staging_dir, progress_cb, phase_cb, cancel);
   }
-  if (cancel.load())
+  else if (!cached_archive_path.has_value())
+  {
+    // Download (and verify) only, the archive is extracted from the .part file once the disk is free
+    actual_digest = download_and_extract(release, part_path, false, "", progress_cb, phase_cb, cancel);
+    if (!actual_digest.has_value() || cancel.load())
+      return false;
+    if (phase_cb)
+      phase_cb(WineRunner::InstallPhase::Verifying);
+    verify_digest();
+    if (!lock_disk(disk_lock, phase_cb, cancel))
+      return false;
+    if (phase_cb)
+      phase_cb(WineRunner::InstallPhase::Extracting);
+    actual_digest = download_and_extract(release, part_path, true, staging_dir, progress_cb, {}, cancel);
+  }
+  if (!actual_digest.has_value() || cancel.load())
     return false;
 
+  // Verify before anything is moved into place, the staging directory is removed on a mismatch
   if (phase_cb)
     phase_cb(WineRunner::InstallPhase::Verifying);
-  verify_archive_checksum(release, archive_path);
-  if (cancel.load())
-    return false;
-
-  if (phase_cb)
-    phase_cb(WineRunner::InstallPhase::Extracting);
-  fs::create_directories(staging_dir, error_code);
-  if (error_code)
+  verify_digest();
+  if (!cached_archive_path.has_value())
   {
-    throw std::runtime_error("Could not create the staging directory: " + staging_dir);
+    try
+    {
+      download_cache.store(release.asset_name, actual_digest.value(), part_path);
+    }
+    catch (const std::runtime_error& error)
+    {
+      // Non-critical, the next install downloads the archive again
+      std::cout << "WARN: " << error.what() << std::endl;
+    }
+    ResumableDownload::discard(part_path);
   }
-  extract_archive(archive_path, staging_dir);
-  if (cancel.load())
-    return false;
 
   // Validate the archive layout: expect exactly one top-level directory with a safe name, containing a wine binary
   std::vector<std::string> top_level_entries;
@@ -787,138 +1002,156 @@ std::string WineRunnerManager::fetch_url(const std::string& url)
 }
 
 /**
- * \brief Download a file to disk using a wget subprocess (no shell involved), with progress & cancellation support.
- * Progress is reported by polling the growing destination file size (roughly 4 times per second).
- * \param[in] url URL to download
- * \param[in] dest_path Destination file path
- * \param[in] expected_size Expected file size in bytes (from the GitHub API, for the progress callback)
- * \param[in] progress_cb Progress callback (bytes done, bytes total); may be empty
- * \param[in] cancel Cancellation flag (polled); on cancel the wget subprocess is terminated
+ * \brief Fetch a (small) file over HTTPS into memory with a conditional request, using a wget subprocess (no shell involved)
+ * \param[in] url URL to fetch
+ * \param[in,out] etag ETag of the version that is already present (empty if none), updated with the ETag of the response
+ * \param[in,out] last_modified Last-Modified of the version that is already present (empty if none), updated likewise
  * \throws std::runtime_error on failure
- * \return True on success, false when cancelled
+ * \return Response body, or nullopt when the file is not modified (HTTP 304)
  */
-bool WineRunnerManager::download_file(const std::string& url,
-                                      const std::string& dest_path,
-                                      std::uint64_t expected_size,
-                                      const std::function<void(std::uint64_t, std::uint64_t)>& progress_cb,
-                                      const std::atomic<bool>& cancel)
+std::optional<std::string> WineRunnerManager::fetch_url_if_modified(const std::string& url, std::string& etag, std::string& last_modified)
 {
-  Glib::Pid pid = 0;
+  std::vector<std::string> argv{"wget", "--quiet", "--server-response", "--timeout=30", "--tries=2", "--output-document=-"};
+  if (!etag.empty())
+    argv.emplace_back("--header=If-None-Match: " + etag);
+  if (!last_modified.empty())
+    argv.emplace_back("--header=If-Modified-Since: " + last_modified);
+  argv.emplace_back(url);
+  std::string standard_output;
+  std::string standard_error;
+  int wait_status = 0;
   try
   {
-    const std::vector<std::string> argv{"wget", "--quiet", "--timeout=30", "--output-document=" + dest_path, url};
-    Glib::spawn_async("", argv, Glib::SpawnFlags::SEARCH_PATH | Glib::SpawnFlags::DO_NOT_REAP_CHILD, {}, &pid);
+    Glib::spawn_sync("", argv, Glib::SpawnFlags::SEARCH_PATH, {}, &standard_output, &standard_error, &wait_status);
   }
   catch (const Glib::Error& error)
   {
     throw std::runtime_error("Could not start wget: " + std::string(error.what()));
   }
-
-  bool cancelled = false;
-  int wait_status = 0;
-  while (true)
-  {
-    pid_t wait_result = waitpid(pid, &wait_status, WNOHANG);
-    if (wait_result != 0)
-      break; // Process exited (or waitpid failed)
-    if (cancel.load())
-    {
-      kill(pid, SIGTERM);
-      waitpid(pid, &wait_status, 0);
-      cancelled = true;
-      break;
-    }
-    if (progress_cb)
-    {
-      std::error_code error_code;
-      std::uint64_t downloaded_size = fs::file_size(dest_path, error_code);
-      if (!error_code)
-        progress_cb(downloaded_size, expected_size);
-    }
-    Glib::usleep(250000); // 250 ms
-  }
-  Glib::spawn_close_pid(pid);
-
-  if (cancelled)
-  {
-    std::error_code error_code;
-    fs::remove(dest_path, error_code);
-    return false;
-  }
+  std::string response_etag;
+  std::string response_last_modified;
+  int status_code = parse_server_response(standard_error, response_etag, response_last_modified);
+  // wget exits with a server error status on a 304 response
+  if (status_code == 304 && (!etag.empty() || !last_modified.empty()))
+    return std::nullopt;
   if (!WIFEXITED(wait_status) || WEXITSTATUS(wait_status) != 0)
   {
-    std::error_code error_code;
-    fs::remove(dest_path, error_code);
-    throw std::runtime_error("Download failed. Are you still online?\n\nURL: " + url);
+    throw std::runtime_error("Could not fetch: " + url);
   }
-  if (progress_cb)
-    progress_cb(expected_size, expected_size);
-  return true;
+  etag = response_etag;
+  last_modified = response_last_modified;
+  return standard_output;
 }
 
 /**
- * \brief Extract a tar archive (tar.xz / tar.gz) into the given directory, using a tar subprocess (no shell involved).
- * GNU tar refuses absolute paths & ".." members by default, which keeps the extraction within the staging directory.
- * \param[in] archive_path Archive file path
- * \param[in] staging_dir Directory to extract into
+ * \brief Download an archive and extract it at the same time: the downloaded data is hashed and extracted in-process
+ * as soon as it arrives (the download itself is done by wget subprocesses, see ResumableDownload). So the install takes
+ * about as long as the download. The download is stored in a .part file, which is kept when the download is cancelled or
+ * failed. The extracted files must not be used before the digest is verified.
+ * \param[in] release Release of the archive (URL, file name, size & checksum type)
+ * \param[in] archive_path Path of the .part file, or of the cached archive
+ * \param[in] is_cached The archive is read from the download cache, instead of downloaded
+ * \param[in] staging_dir Directory to extract into, empty to only download & hash the archive
+ * \param[in] progress_cb Progress callback (bytes downloaded or read, bytes total), after every chunk; may be empty
+ * \param[in] phase_cb Phase change callback (extracting the last part, once the download is finished); may be empty
+ * \param[in] cancel Cancellation flag (polled); on cancel the download is stopped
  * \throws std::runtime_error on failure
+ * \return Lowercase hex digest of the archive, or nullopt when cancelled
  */
-void WineRunnerManager::extract_archive(const std::string& archive_path, const std::string& staging_dir)
+std::optional<std::string> WineRunnerManager::download_and_extract(const WineRunner::Release& release,
+                                                                   const std::string& archive_path,
+                                                                   bool is_cached,
+                                                                   const std::string& staging_dir,
+                                                                   const std::function<void(std::uint64_t, std::uint64_t)>& progress_cb,
+                                                                   const std::function<void(WineRunner::InstallPhase)>& phase_cb,
+                                                                   const std::atomic<bool>& cancel)
 {
-  std::string standard_output;
-  std::string standard_error;
-  int wait_status = 0;
-  try
+  std::unique_ptr<ArchiveExtractor> extractor;
+  if (!staging_dir.empty())
+    extractor = std::make_unique<ArchiveExtractor>(staging_dir, ArchiveExtractor::get_compression(release.asset_name));
+  // Hashed on a separate thread, so the hashing overlaps with the extraction
+  StreamHasher checksum((release.checksum_type == WineRunner::ChecksumType::Sha512) ? StreamHasher::Algorithm::Sha512
+                                                                                    : StreamHasher::Algorithm::Sha256);
+  std::string extract_error;
+  auto hash_and_extract = [&checksum, &extractor, &extract_error](const char* data, std::size_t size)
   {
-    const std::vector<std::string> argv{"tar", "-xf", archive_path, "-C", staging_dir, "--no-same-owner"};
-    Glib::spawn_sync("", argv, Glib::SpawnFlags::SEARCH_PATH, {}, &standard_output, &standard_error, &wait_status);
-  }
-  catch (const Glib::Error& error)
+    checksum.update(data, size);
+    if (!extractor)
+      return;
+    try
+    {
+      extractor->write(data, size);
+    }
+    catch (const std::runtime_error& error)
+    {
+      extract_error = error.what();
+      throw;
+    }
+  };
+
+  bool is_finished = false;
+  try
   {
-    throw std::runtime_error("Could not start tar: " + std::string(error.what()));
+    if (is_cached)
+    {
+      is_finished = read_file(archive_path, hash_and_extract, progress_cb, cancel);
+    }
+    else
+    {
+      std::error_code error_code;
+      fs::create_directories(Glib::path_get_dirname(archive_path), error_code);
+      ResumableDownload download(release.download_url, archive_path, release.size_bytes, DownloadSegmentCount);
+      if (download.get_resumed_bytes() > 0)
+        std::cout << "INFO: Resuming the download of " << release.asset_name << " at " << download.get_resumed_bytes() << " bytes." << std::endl;
+      is_finished = download.run(hash_and_extract, progress_cb, cancel);
+    }
   }
-  if (!WIFEXITED(wait_status) || WEXITSTATUS(wait_status) != 0)
+  catch (const std::runtime_error& error)
   {
-    throw std::runtime_error("Could not extract the archive.\n\n" + standard_error);
+    if (is_cached && extract_error.empty())
+      throw;
+    if (extract_error.empty())
+      throw std::runtime_error("Download failed. Are you still online?\n\nThe download continues where it stopped on the next try.\n\nURL: " +
+                               release.download_url);
+    // The downloaded data is corrupt, start from scratch next time
+    if (!is_cached)
+      ResumableDownload::discard(archive_path);
+    throw std::runtime_error("Could not extract the archive.\n\n" + extract_error);
   }
-}
+  if (!is_finished)
+    return std::nullopt;
+  if (!extractor)
+    return checksum.finish();
 
-/**
- * \brief Compute the checksum of a file (streamed in 1 MiB chunks)
- * \param[in] file_path File path
- * \param[in] checksum_type Checksum type (Sha256 or Sha512)
- * \throws std::runtime_error on failure
- * \return Lowercase hex digest
- */
-std::string WineRunnerManager::compute_checksum(const std::string& file_path, WineRunner::ChecksumType checksum_type)
-{
-  Glib::Checksum checksum((checksum_type == WineRunner::ChecksumType::Sha512) ? Glib::Checksum::Type::SHA512 : Glib::Checksum::Type::SHA256);
-  std::ifstream file(file_path, std::ios::binary);
-  if (!file.is_open())
+  // The xz decoder threads might still have a few blocks to write
+  if (phase_cb)
+    phase_cb(WineRunner::InstallPhase::Extracting);
+  try
   {
-    throw std::runtime_error("Could not open the downloaded archive for checksum verification.");
+    extractor->finish();
   }
-  std::vector<char> buffer(1024 * 1024);
-  while (file.read(buffer.data(), static_cast<std::streamsize>(buffer.size())) || file.gcount() > 0)
+  catch (const std::runtime_error& error)
   {
-    checksum.update(reinterpret_cast<const guchar*>(buffer.data()), static_cast<gssize>(file.gcount()));
+    if (!is_cached)
+      ResumableDownload::discard(archive_path);
+    throw std::runtime_error("Could not extract the archive.\n\n" + std::string(error.what()));
   }
-  return checksum.get_string();
+  return checksum.finish();
 }
 
 /**
- * \brief Verify the downloaded archive against the checksum published by the runner source
- * \param[in] release Release the archive belongs to
- * \param[in] archive_path Downloaded archive file path
- * \throws std::runtime_error on a checksum mismatch (the archive is removed by the caller's cleanup)
+ * \brief Get the checksum of the archive as published by the runner source
+ * \param[in] release Release of the archive
+ * \throws std::runtime_error when the checksum file could not be fetched or does not list the archive
+ * \return Lowercase hex digest, or nullopt when the source published no checksum for the release
  */
-void WineRunnerManager::verify_archive_checksum(const WineRunner::Release& release, const std::string& archive_path)
+std::optional<std::string> WineRunnerManager::fetch_expected_digest(const WineRunner::Release& release)
 {
   if (release.checksum_type == WineRunner::ChecksumType::None || release.checksum_url.empty())
   {
     // Both supported sources publish checksums for every release nowadays, only very old releases lack them
     std::cout << "WARN: No checksum published for " << release.asset_name << ", skipping the verification." << std::endl;
-    return;
+    return std::nullopt;
   }
   std::string checksum_file_content = fetch_url(release.checksum_url);
   std::optional<std::string> expected_digest = parse_checksum_file(checksum_file_content, release.asset_name);
@@ -926,12 +1159,55 @@ void WineRunnerManager::verify_archive_checksum(const WineRunner::Release& relea
   {
     throw std::runtime_error("Could not verify the download: the published checksum file does not list the archive.");
   }
-  std::string actual_digest = compute_checksum(archive_path, release.checksum_type);
-  if (actual_digest != expected_digest.value())
+  return expected_digest;
+}
+
+/**
+ * \brief Name prefix of the staging directories of this process
+ * \return Prefix, eg. ".staging-1234-"
+ */
+std::string WineRunnerManager::get_staging_prefix()
+{
+  return ".staging-" + std::to_string(getpid()) + "-";
+}
+
+/**
+ * \brief Get the lock that serializes the archive extraction to a disk. Parallel extractions to the same disk only make
+ * the disk seek, while the downloads themselves benefit from running in parallel.
+ * \param[in] path Path on the disk
+ * \return Mutex of the disk (filesystem device)
+ */
+std::timed_mutex& WineRunnerManager::get_extraction_mutex(const std::string& path)
+{
+  static std::mutex map_mutex;
+  static std::map<dev_t, std::timed_mutex> extraction_mutexes;
+  struct stat path_stat{};
+  dev_t device = (stat(path.c_str(), &path_stat) == 0) ? path_stat.st_dev : 0;
+  std::lock_guard<std::mutex> lock(map_mutex);
+  return extraction_mutexes[device];
+}
+
+/**
+ * \brief Wait until the disk is free for extracting an archive (see get_extraction_mutex)
+ * \param[in,out] disk_lock Lock of the disk, locked when this function returns true
+ * \param[in] phase_cb Phase change callback, informed while waiting; may be empty
+ * \param[in] cancel Cancellation flag (polled)
+ * \return True when the disk is locked, false when cancelled
+ */
+bool WineRunnerManager::lock_disk(std::unique_lock<std::timed_mutex>& disk_lock,
+                                  const std::function<void(WineRunner::InstallPhase)>& phase_cb,
+                                  const std::atomic<bool>& cancel)
+{
+  if (disk_lock.owns_lock())
+    return true;
+  if (phase_cb)
+    phase_cb(WineRunner::InstallPhase::WaitingForDisk);
+  while (!disk_lock.try_lock_for(std::chrono::milliseconds(100)))
   {
-    throw std::runtime_error("Checksum verification of the downloaded archive failed!\n\nThe download is possibly corrupted (or tampered with). "
-                             "Please, try again.");
+    if (cancel.load())
+      return false;
   }
+  return true;
 }
 
 /**
@@ -945,7 +1221,8 @@ void WineRunnerManager::sweep_leftover_temp_dirs(const std::string& runners_dir)
     Glib::Dir dir(runners_dir);
     for (const auto& entry_name : dir)
     {
-      if (entry_name == ".tmp" || entry_name.starts_with(".staging-"))
+      // The staging directories of this process belong to installs that are still running
+      if (entry_name == ".tmp" || (entry_name.starts_with(".staging-") && !entry_name.starts_with(get_staging_prefix())))
       {
         std::error_code error_code;
         fs::remove_all(fs::path(runners_dir) / entry_name, error_code);
@@ -20,6 +20,7 @@
  */
 #include "wine_runner_window.h"
 
+#include "general_config_file.h"
 #include "wine_runner_manager.h"
 
 #include <algorithm>
@@ -31,7 +32,7 @@
  */
 WineRunnerWindow::WineRunnerWindow(Gtk::Window& parent)
     : default_parent_(parent),
-      busy_dialog_(*this),
+      task_(static_cast<std::size_t>(GeneralConfigFile::read_config_file().max_runner_downloads)),
       error_dialog_(*this, DialogWindow::DialogType::ERROR),
       info_dialog_(*this, DialogWindow::DialogType::INFO)
 {
@@ -47,9 +48,7 @@ WineRunnerWindow::WineRunnerWindow(Gtk::Window& parent)
   task_.releases_fetched.connect(sigc::mem_fun(*this, &WineRunnerWindow::on_releases_fetched));
   task_.fetch_failed.connect(sigc::mem_fun(*this, &WineRunnerWindow::on_fetch_failed));
   task_.progress_changed.connect(sigc::mem_fun(*this, &WineRunnerWindow::on_progress_changed));
-  task_.install_finished.connect(sigc::mem_fun(*this, &WineRunnerWindow::on_install_finished));
-  task_.remove_finished.connect(sigc::mem_fun(*this, &WineRunnerWindow::on_remove_finished));
-  busy_dialog_.cancel_requested.connect([this]() { task_.cancel(); });
+  task_.job_finished.connect(sigc::mem_fun(*this, &WineRunnerWindow::on_job_finished));
 
   // Hide window instead of destroy
   signal_close_request().connect(
@@ -68,6 +67,7 @@ WineRunnerWindow::WineRunnerWindow(Gtk::Window& parent)
  */
 WineRunnerWindow::~WineRunnerWindow()
 {
+  pulse_timer_.disconnect();
 }
 
 /**
@@ -156,11 +156,24 @@ void WineRunnerWindow::create_layout()
   sidebar_stack_box.append(sidebar);
   sidebar_stack_box.append(stack);
 
+  // Installs & removals, multiple installs run at the same time
+  jobs_label.set_markup("<b>Installs &amp; removals</b>");
+  jobs_label.set_halign(Gtk::Align::START);
+  jobs_listbox.set_selection_mode(Gtk::SelectionMode::NONE);
+  jobs_listbox.add_css_class("boxed-list");
+  jobs_vbox.set_orientation(Gtk::Orientation::VERTICAL);
+  jobs_vbox.set_spacing(6);
+  jobs_vbox.set_margin(5);
+  jobs_vbox.append(jobs_label);
+  jobs_vbox.append(jobs_listbox);
+  jobs_vbox.set_visible(false);
+
   runner_box.set_orientation(Gtk::Orientation::VERTICAL);
   runner_box.set_margin(5);
   runner_box.set_spacing(8);
   runner_box.append(hint_label);
   runner_box.append(sidebar_stack_box);
+  runner_box.append(jobs_vbox);
   set_child(runner_box);
 }
 
@@ -277,13 +290,13 @@ void WineRunnerWindow::refresh_installed_list()
 }
 
 /**
- * \brief Refill all fetched version comboboxes (eg. to update the installed markers), keeping the selection
+ * \brief Refill all filled version comboboxes (eg. to update the installed markers), keeping the selection
  */
 void WineRunnerWindow::refresh_version_comboboxes()
 {
   for (const auto& page : source_pages_)
   {
-    if (page->fetched)
+    if (!page->releases.empty())
       fill_version_combobox(*page);
   }
 }
@@ -334,6 +347,31 @@ Glib::ustring WineRunnerWindow::format_release_label(const WineRunner::Release&
   return label;
 }
 
+/**
+ * \brief Show a release list on the pages of its source (each page shows the releases of its variant)
+ * \param[in] source_id Source the releases belong to
+ * \param[in] releases Releases of the source, newest first
+ */
+void WineRunnerWindow::fill_source_pages(WineRunner::SourceId source_id, const std::vector<WineRunner::Release>& releases)
+{
+  for (const auto& page : source_pages_)
+  {
+    if (page->source_id != source_id)
+      continue;
+    page->releases.clear();
+    for (const WineRunner::Release& release : releases)
+    {
+      if (release.variant == page->variant)
+        page->releases.emplace_back(release);
+    }
+    fill_version_combobox(*page);
+    if (page->releases.empty())
+      page->status_label.set_text("No downloadable releases found for this variant.");
+    else
+      page->status_label.set_text(std::to_string(page->releases.size()) + " releases available.");
+  }
+}
+
 /**
  * \brief Start fetching the release list for a page (or queue it when another operation is running)
  * \param[in] page Page to fetch for
@@ -342,7 +380,13 @@ void WineRunnerWindow::start_fetch(SourcePage& page)
 {
   if (page.fetched)
     return;
-  if (task_.is_busy())
+  // Show the saved release list right away (also when offline), while it is revalidated in the background
+  if (page.releases.empty())
+  {
+    if (std::optional<std::vector<WineRunner::Release>> releases = WineRunnerManager::get_cached_releases(page.source_id); releases.has_value())
+      fill_source_pages(page.source_id, releases.value());
+  }
+  if (task_.is_fetching())
   {
     page.fetch_pending = true;
     return;
@@ -399,7 +443,14 @@ WineRunnerWindow::SourcePage* WineRunnerWindow::get_visible_source_page()
  */
 void WineRunnerWindow::set_page_fetching_state(SourcePage& page, bool fetching)
 {
-  if (fetching)
+  if (fetching && !page.releases.empty())
+  {
+    // The saved release list stays usable during the revalidation
+    page.spinner.start();
+    page.status_label.set_text(std::to_string(page.releases.size()) + " releases available, checking GitHub for new releases...");
+    page.refresh_button.set_sensitive(false);
+  }
+  else if (fetching)
   {
     page.spinner.start();
     page.status_label.set_text("Fetching the release list from GitHub...");
@@ -433,7 +484,7 @@ void WineRunnerWindow::on_page_changed()
  */
 void WineRunnerWindow::on_refresh_clicked(SourcePage* page)
 {
-  if (task_.is_busy())
+  if (task_.is_fetching())
     return;
   WineRunnerManager::invalidate_release_cache();
   for (const auto& source_page : source_pages_)
@@ -456,7 +507,10 @@ void WineRunnerWindow::on_version_selection_changed(SourcePage* page)
   {
     std::size_t index = std::stoul(active_id.raw());
     if (index < page->releases.size())
-      can_install = !WineRunnerManager::is_installed(page->releases.at(index));
+    {
+      const WineRunner::Release& release = page->releases.at(index);
+      can_install = !WineRunnerManager::is_installed(release) && !task_.has_pending_job(WineRunnerManager::expected_install_dir_name(release));
+    }
   }
   page->install_button.set_sensitive(can_install);
 }
@@ -467,26 +521,19 @@ void WineRunnerWindow::on_version_selection_changed(SourcePage* page)
  */
 void WineRunnerWindow::on_install_clicked(SourcePage* page)
 {
-  if (task_.is_busy())
-  {
-    show_info_message("Another Wine runner operation is still running. Please, try again later.");
-    return;
-  }
   Glib::ustring active_id = page->version_combobox.get_active_id();
   if (active_id.empty())
     return;
   std::size_t index = std::stoul(active_id.raw());
   if (index >= page->releases.size())
     return;
-  const WineRunner::Release& release = page->releases.at(index);
-
-  installing_display_name_ = WineRunnerManager::derive_display_name(WineRunnerManager::expected_install_dir_name(release));
-  last_phase_ = WineRunner::InstallPhase::Idle;
-  busy_dialog_.set_message("Installing " + installing_display_name_, "Downloading " + Glib::ustring(release.asset_name) + "...");
-  busy_dialog_.set_cancelable(true);
-  busy_dialog_.set_progress(0.0);
-  busy_dialog_.present();
-  task_.install_async(release);
+  if (task_.install_async(page->releases.at(index)) == 0)
+  {
+    show_info_message("This Wine runner is already being installed or removed.");
+    return;
+  }
+  // Installs of other versions can be started right away
+  on_version_selection_changed(page);
 }
 
 /**
@@ -495,11 +542,6 @@ void WineRunnerWindow::on_install_clicked(SourcePage* page)
  */
 void WineRunnerWindow::on_remove_clicked(const WineRunner::InstalledRunner& runner)
 {
-  if (task_.is_busy())
-  {
-    show_info_message("Another Wine runner operation is still running. Please, try again later.");
-    return;
-  }
   Glib::ustring message;
   std::vector<std::string> bottle_paths = bottle_wine_bin_paths_provider_ ? bottle_wine_bin_paths_provider_() : std::vector<std::string>();
   if (WineRunnerManager::is_runner_used_by_bottle(runner, bottle_paths))
@@ -529,10 +571,52 @@ void WineRunnerWindow::on_remove_clicked(const WineRunner::InstalledRunner& runn
  */
 void WineRunnerWindow::remove_runner_confirmed(const WineRunner::InstalledRunner& runner)
 {
-  busy_dialog_.set_message("Removing " + Glib::ustring(runner.display_name), "Removing the Wine runner from disk.");
-  busy_dialog_.set_cancelable(false);
-  busy_dialog_.present();
-  task_.remove_async(runner);
+  if (task_.remove_async(runner) == 0)
+    show_info_message("This Wine runner is already being installed or removed.");
+}
+
+/**
+ * \brief Update the widgets of a job row to the state of the job
+ * \param[in] job_row Row to update
+ * \param[in] job Current state of the job
+ */
+void WineRunnerWindow::update_job_row(JobRow& job_row, const WineRunnerInstallTask::Job& job)
+{
+  Glib::ustring status;
+  bool has_progress = false;
+  switch (job.phase)
+  {
+  case WineRunner::InstallPhase::Queued:
+    status = "Waiting until another install or removal is finished...";
+    break;
+  case WineRunner::InstallPhase::Idle:
+    status = (job.type == WineRunnerInstallTask::JobType::Remove) ? "Removing the Wine runner from disk..." : "Preparing the download...";
+    break;
+  case WineRunner::InstallPhase::Downloading:
+    status = "Downloading & extracting " + Glib::ustring(job.asset_name) + "...";
+    has_progress = true;
+    break;
+  case WineRunner::InstallPhase::Verifying:
+    status = "Verifying the archive checksum...";
+    break;
+  case WineRunner::InstallPhase::WaitingForDisk:
+    status = "Downloaded, waiting until another Wine runner is extracted...";
+    break;
+  case WineRunner::InstallPhase::Extracting:
+    status = "Extracting the archive...";
+    has_progress = true;
+    break;
+  }
+  has_progress = has_progress && job.bytes_total > 0;
+  if (has_progress)
+  {
+    status += " " + Glib::format_size(job.bytes_done) + " of " + Glib::format_size(job.bytes_total);
+    job_row.progress_bar->set_fraction(static_cast<double>(job.bytes_done) / static_cast<double>(job.bytes_total));
+  }
+  job_row.status_label->set_text(status);
+  job_row.is_pulsing = !has_progress && job.phase != WineRunner::InstallPhase::Queued;
+  // A started removal can't be stopped halfway
+  job_row.cancel_button->set_sensitive(job.type == WineRunnerInstallTask::JobType::Install || job.phase == WineRunner::InstallPhase::Queued);
 }
 
 /**
@@ -541,26 +625,15 @@ void WineRunnerWindow::remove_runner_confirmed(const WineRunner::InstalledRunner
 void WineRunnerWindow::on_releases_fetched()
 {
   WineRunner::SourceId source_id = task_.get_fetched_source_id();
-  std::vector<WineRunner::Release> releases = task_.get_fetched_releases();
   for (const auto& page : source_pages_)
   {
     if (page->source_id != source_id)
       continue;
-    page->releases.clear();
-    for (const WineRunner::Release& release : releases)
-    {
-      if (release.variant == page->variant)
-        page->releases.emplace_back(release);
-    }
     page->fetched = true;
     page->fetch_pending = false;
     set_page_fetching_state(*page, false);
-    fill_version_combobox(*page);
-    if (page->releases.empty())
-      page->status_label.set_text("No downloadable releases found for this variant.");
-    else
-      page->status_label.set_text(std::to_string(page->releases.size()) + " releases available.");
   }
+  fill_source_pages(source_id, task_.get_fetched_releases());
   start_pending_fetch();
 }
 
@@ -583,82 +656,117 @@ void WineRunnerWindow::on_fetch_failed()
 }
 
 /**
- * \brief Signal handler when the install progress or phase changed (update the busy dialog)
+ * \brief Signal handler when a job was added, or the progress or phase of a job changed (update the jobs list)
  */
 void WineRunnerWindow::on_progress_changed()
 {
-  WineRunner::InstallPhase phase = task_.get_phase();
-  if (phase != last_phase_)
+  for (const WineRunnerInstallTask::Job& job : task_.get_jobs())
   {
-    last_phase_ = phase;
-    switch (phase)
+    auto it = job_rows_.find(job.id);
+    if (it == job_rows_.end())
     {
-    case WineRunner::InstallPhase::Downloading:
-      busy_dialog_.set_message("Installing " + installing_display_name_, "Downloading the archive...");
-      break;
-    case WineRunner::InstallPhase::Verifying:
-      busy_dialog_.set_message("Installing " + installing_display_name_, "Verifying the archive checksum...");
-      busy_dialog_.set_pulsing();
+      JobRow job_row;
+      auto* name_label = Gtk::make_managed<Gtk::Label>();
+      Glib::ustring action = (job.type == WineRunnerInstallTask::JobType::Remove) ? "Removing " : "Installing ";
+      name_label->set_markup("<b>" + Glib::Markup::escape_text(action + job.display_name) + "</b>");
+      name_label->set_xalign(0.0);
+      job_row.status_label = Gtk::make_managed<Gtk::Label>();
+      job_row.status_label->set_xalign(0.0);
+      job_row.status_label->add_css_class("dim-label");
+      job_row.progress_bar = Gtk::make_managed<Gtk::ProgressBar>();
+      job_row.progress_bar->set_pulse_step(0.3);
+
+      auto* label_vbox = Gtk::make_managed<Gtk::Box>(Gtk::Orientation::VERTICAL, 4);
+      label_vbox->append(*name_label);
+      label_vbox->append(*job_row.status_label);
+      label_vbox->append(*job_row.progress_bar);
+      label_vbox->set_hexpand(true);
+
+      job_row.cancel_button = Gtk::make_managed<Gtk::Button>("Cancel");
+      job_row.cancel_button->set_valign(Gtk::Align::CENTER);
+      job_row.cancel_button->signal_clicked().connect(sigc::bind(sigc::mem_fun(*this, &WineRunnerWindow::on_cancel_job_clicked), job.id));
+
+      auto* row_hbox = Gtk::make_managed<Gtk::Box>(Gtk::Orientation::HORIZONTAL, 8);
+      row_hbox->set_margin(6);
+      row_hbox->append(*label_vbox);
+      row_hbox->append(*job_row.cancel_button);
+
+      job_row.row = Gtk::make_managed<Gtk::ListBoxRow>();
+      job_row.row->set_child(*row_hbox);
+      job_row.row->set_activatable(false);
+      jobs_listbox.append(*job_row.row);
+      it = job_rows_.emplace(job.id, job_row).first;
+    }
+    update_job_row(it->second, job);
+  }
+  jobs_vbox.set_visible(!job_rows_.empty());
+  if (!job_rows_.empty() && !pulse_timer_.connected())
+    pulse_timer_ = Glib::signal_timeout().connect(sigc::mem_fun(*this, &WineRunnerWindow::on_pulse_timer), 200);
+}
+
+/**
+ * \brief Signal handler when one or more jobs finished (remove their rows & refresh the lists)
+ */
+void WineRunnerWindow::on_job_finished()
+{
+  bool is_runners_changed = false;
+  for (const WineRunnerInstallTask::Job& job : task_.take_finished_jobs())
+  {
+    if (auto it = job_rows_.find(job.id); it != job_rows_.end())
+    {
+      jobs_listbox.remove(*it->second.row);
+      job_rows_.erase(it);
+    }
+    switch (job.status)
+    {
+    case WineRunner::InstallStatus::Success:
+      is_runners_changed = true;
       break;
-    case WineRunner::InstallPhase::Extracting:
-      busy_dialog_.set_message("Installing " + installing_display_name_, "Extracting the archive...");
-      busy_dialog_.set_pulsing();
+    case WineRunner::InstallStatus::Cancelled:
       break;
-    case WineRunner::InstallPhase::Idle:
+    case WineRunner::InstallStatus::Error:
+      show_error_message(job.error_message);
       break;
     }
   }
-  if (phase == WineRunner::InstallPhase::Downloading)
+  jobs_vbox.set_visible(!job_rows_.empty());
+  if (job_rows_.empty())
+    pulse_timer_.disconnect();
+  if (is_runners_changed)
   {
-    const auto& [bytes_done, bytes_total] = task_.get_progress();
-    if (bytes_total > 0)
-    {
-      double fraction = static_cast<double>(bytes_done) / static_cast<double>(bytes_total);
-      busy_dialog_.set_progress(fraction, Glib::format_size(bytes_done) + " of " + Glib::format_size(bytes_total));
-    }
+    refresh_installed_list();
+    runners_changed.emit();
   }
+  // Update the installed markers & the install buttons
+  refresh_version_comboboxes();
 }
 
 /**
- * \brief Signal handler when the install finished (hide the busy dialog & refresh the lists)
+ * \brief Signal handler when the cancel button of a job is clicked
+ * \param[in] job_id Job ID
  */
-void WineRunnerWindow::on_install_finished()
+void WineRunnerWindow::on_cancel_job_clicked(std::size_t job_id)
 {
-  busy_dialog_.hide();
-  switch (task_.get_install_status())
+  task_.cancel(job_id);
+  if (auto it = job_rows_.find(job_id); it != job_rows_.end())
   {
-  case WineRunner::InstallStatus::Success:
-    refresh_installed_list();
-    refresh_version_comboboxes();
-    runners_changed.emit();
-    break;
-  case WineRunner::InstallStatus::Cancelled:
-    break;
-  case WineRunner::InstallStatus::Error:
-    show_error_message(task_.get_error_message());
-    break;
+    it->second.status_label->set_text("Cancelling...");
+    it->second.cancel_button->set_sensitive(false);
   }
-  start_pending_fetch();
 }
 
 /**
- * \brief Signal handler when the removal finished (hide the busy dialog & refresh the lists)
+ * \brief Timer handler, pulses the progress bars of the jobs with an unknown progress
+ * \return True to keep the timer running
  */
-void WineRunnerWindow::on_remove_finished()
+bool WineRunnerWindow::on_pulse_timer()
 {
-  busy_dialog_.hide();
-  Glib::ustring error_message = task_.get_error_message();
-  if (!error_message.empty())
+  for (auto& [id, job_row] : job_rows_)
   {
-    show_error_message(error_message);
+    if (job_row.is_pulsing)
+      job_row.progress_bar->pulse();
   }
-  else
-  {
-    refresh_installed_list();
-    refresh_version_comboboxes();
-    runners_changed.emit();
-  }
-  start_pending_fetch();
+  return true;
 }
 
 /**
@@ -0,0 +1,220 @@
+/**
+ * Copyright (c) 2026 WineGUI
+ *
+ * \file    wine_version_cache.cc
+ * \brief   Cache of Wine versions, per Wine binary
+ * \author  Melroy van den Berg <webmaster1989@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "wine_version_cache.h"
+
+#include <chrono>
+#include <giomm.h>
+#include <glibmm.h>
+#include <iostream>
+#include <stdlib.h>
+#include <utility>
+#include <vector>
+
+/**
+ * \brief Construct a (empty) Wine version cache, the cache file is read on first use
+ * \param[in] cache_file_path File location of the persisted cache
+ */
+WineVersionCache::WineVersionCache(std::string cache_file_path) : cache_file_path_(std::move(cache_file_path))
+{
+}
+
+/**
+ * \brief Get the application wide instance, persisted in the WineGUI data directory
+ * \return WineVersionCache reference (singleton)
+ */
+WineVersionCache& WineVersionCache::get_instance()
+{
+  static WineVersionCache instance(
+      Glib::build_filename(Glib::build_path(G_DIR_SEPARATOR_S, std::vector<std::string>{Glib::get_user_data_dir(), "winegui"}), "wine_versions.ini"));
+  return instance;
+}
+
+/**
+ * \brief Resolve a Wine executable to the absolute path of the actual binary (search PATH & resolve symlinks)
+ * \param[in] executable Executable name (eg. wine) or path
+ * \return Resolved path, or empty string when the executable could not be found
+ */
+std::string WineVersionCache::resolve_executable(const std::string& executable)
+{
+  std::string path = executable;
+  if (path.find(G_DIR_SEPARATOR) == std::string::npos)
+  {
+    path = Glib::find_program_in_path(executable);
+    if (path.empty())
+      return "";
+  }
+  char* resolved = realpath(path.c_str(), nullptr);
+  if (resolved == nullptr)
+    return "";
+  std::string resolved_path(resolved);
+  free(resolved);
+  return resolved_path;
+}
+
+/**
+ * \brief Get the Wine version of an executable, only probe when the binary is not in the cache (or changed on disk)
+ * \param[in] executable Wine executable name (eg. wine) or path
+ * \param[in] probe Determines the version of the executable (eg. by running wine --version), throws on failure
+ * \throws runtime_error (or any other exception thrown by the probe) when the version could not be determined
+ * \return Wine version
+ */
+std::string WineVersionCache::get_version(const std::string& executable, const std::function<std::string(const std::string& executable)>& probe)
+{
+  std::string resolved_path = resolve_executable(executable);
+  struct stat file_stat;
+  if (resolved_path.empty() || stat(resolved_path.c_str(), &file_stat) != 0)
+  {
+    // Nothing to key on, let the probe report the (missing executable) error
+    return probe(executable);
+  }
+
+  std::promise<std::optional<std::string>> promise;
+  std::shared_future<std::optional<std::string>> version;
+  bool is_probe_owner = false;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!is_loaded_)
+      load();
+    auto it = entries_.find(resolved_path);
+    if (it != entries_.end() && is_same_binary(it->second, file_stat))
+    {
+      version = it->second.version;
+    }
+    else
+    {
+      version = promise.get_future().share();
+      entries_[resolved_path] = Entry{file_stat.st_dev, file_stat.st_ino, file_stat.st_mtim, file_stat.st_size, version};
+      is_probe_owner = true;
+    }
+  }
+
+  if (!is_probe_owner)
+  {
+    std::optional<std::string> result = version.get();
+    if (result.has_value())
+      return result.value();
+    // The in-flight probe failed, probe again to get the error (message) of this request
+    return probe(executable);
+  }
+
+  try
+  {
+    std::string result = probe(executable);
+    promise.set_value(result);
+    std::lock_guard<std::mutex> lock(mutex_);
+    save();
+    return result;
+  }
+  catch (...)
+  {
+    promise.set_value(std::nullopt);
+    // Do not cache failures, the next request will probe again
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = entries_.find(resolved_path);
+    if (it != entries_.end() && it->second.version.wait_for(std::chrono::seconds(0)) == std::future_status::ready &&
+        !it->second.version.get().has_value())
+      entries_.erase(it);
+    throw;
+  }
+}
+
+/**
+ * \brief Check if the cache entry still belongs to the binary on disk
+ * \param[in] entry Cache entry
+ * \param[in] file_stat Current status of the binary
+ * \return true if the binary is unchanged, otherwise false
+ */
+bool WineVersionCache::is_same_binary(const Entry& entry, const struct stat& file_stat)
+{
+  return entry.device == file_stat.st_dev && entry.inode == file_stat.st_ino && entry.mtime.tv_sec == file_stat.st_mtim.tv_sec &&
+         entry.mtime.tv_nsec == file_stat.st_mtim.tv_nsec && entry.size == file_stat.st_size;
+}
+
+/**
+ * \brief Read the persisted cache file (if present), must be called with the mutex locked
+ */
+void WineVersionCache::load()
+{
+  is_loaded_ = true;
+  if (!Glib::file_test(cache_file_path_, Glib::FileTest::IS_REGULAR))
+    return;
+  try
+  {
+    auto keyfile = Glib::KeyFile::create();
+    keyfile->load_from_file(cache_file_path_);
+    for (const Glib::ustring& group : keyfile->get_groups())
+    {
+      std::promise<std::optional<std::string>> promise;
+      promise.set_value(keyfile->get_string(group, "Version"));
+      Entry entry{static_cast<dev_t>(keyfile->get_uint64(group, "Device")),
+                  static_cast<ino_t>(keyfile->get_uint64(group, "Inode")),
+                  {static_cast<time_t>(keyfile->get_int64(group, "ModifiedTime")), static_cast<long>(keyfile->get_int64(group, "ModifiedTimeNsec"))},
+                  static_cast<off_t>(keyfile->get_int64(group, "Size")),
+                  promise.get_future().share()};
+      entries_.emplace(keyfile->get_string(group, "Path"), std::move(entry));
+    }
+  }
+  catch (const Glib::Error& ex)
+  {
+    std::cerr << "Error: Exception while reading Wine version cache file: " << ex.what() << std::endl;
+    // Start with an empty cache
+    entries_.clear();
+  }
+}
+
+/**
+ * \brief Write the (successfully probed) versions to the cache file, must be called with the mutex locked
+ */
+void WineVersionCache::save()
+{
+  try
+  {
+    auto keyfile = Glib::KeyFile::create();
+    int index = 0;
+    for (const auto& [path, entry] : entries_)
+    {
+      // Skip in-flight & failed probes
+      if (entry.version.wait_for(std::chrono::seconds(0)) != std::future_status::ready || !entry.version.get().has_value())
+        continue;
+      // A file path is not always a valid group name, so the path is stored as a value
+      Glib::ustring group = "Binary" + std::to_string(index++);
+      keyfile->set_string(group, "Path", path);
+      keyfile->set_uint64(group, "Device", static_cast<guint64>(entry.device));
+      keyfile->set_uint64(group, "Inode", static_cast<guint64>(entry.inode));
+      keyfile->set_int64(group, "ModifiedTime", static_cast<gint64>(entry.mtime.tv_sec));
+      keyfile->set_int64(group, "ModifiedTimeNsec", static_cast<gint64>(entry.mtime.tv_nsec));
+      keyfile->set_int64(group, "Size", static_cast<gint64>(entry.size));
+      keyfile->set_string(group, "Version", entry.version.get().value());
+    }
+    std::string cache_dir = Glib::path_get_dirname(cache_file_path_);
+    if (!Glib::file_test(cache_dir, Glib::FileTest::IS_DIR))
+    {
+      Glib::RefPtr<Gio::File> directory = Gio::File::create_for_path(cache_dir);
+      if (directory)
+        directory->make_directory_with_parents();
+    }
+    keyfile->save_to_file(cache_file_path_);
+  }
+  catch (const Glib::Error& ex)
+  {
+    std::cerr << "Error: Exception while writing Wine version cache file: " << ex.what() << std::endl;
+  }
+}
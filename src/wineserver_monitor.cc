@@ -0,0 +1,337 @@
+/**
+ * Copyright (c) 2026 WineGUI
+ *
+ * \file    wineserver_monitor.cc
+ * \brief   Waits until the wineserver of a bottle is terminated (pidfd)
+ * \author  Melroy van den Berg <webmaster1989@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "wineserver_monitor.h"
+
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <fcntl.h>
+#include <future>
+#include <iostream>
+#include <map>
+#include <stdexcept>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+/**
+ * \brief Open a process file descriptor, which becomes readable once the process is terminated
+ * \param[in] pid Process ID
+ * \return File descriptor, or -1 on failure (see errno)
+ */
+static int open_pidfd(pid_t pid)
+{
+#ifdef SYS_pidfd_open
+  return static_cast<int>(syscall(SYS_pidfd_open, pid, 0));
+#else
+  (void)pid;
+  errno = ENOSYS;
+  return -1;
+#endif
+}
+
+/**
+ * \brief Format a number as lowercase hexadecimal (without prefix)
+ * \param[in] value Number
+ * \return Hexadecimal string
+ */
+static std::string to_hex(std::uint64_t value)
+{
+  std::array<char, 16> buffer;
+  char* end = std::to_chars(buffer.data(), buffer.data() + buffer.size(), value, 16).ptr;
+  return std::string(buffer.data(), end);
+}
+
+/**
+ * \brief Start the monitor (event loop) thread
+ * \throws runtime_error when the event loop could not be created
+ */
+WineserverMonitor::WineserverMonitor()
+    : is_stopping_(false),
+      is_stopped_(false),
+      epoll_fd_(epoll_create1(EPOLL_CLOEXEC)),
+      wakeup_fd_(eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK))
+{
+  if (epoll_fd_ < 0 || wakeup_fd_ < 0)
+  {
+    if (epoll_fd_ >= 0)
+      close(epoll_fd_);
+    if (wakeup_fd_ >= 0)
+      close(wakeup_fd_);
+    throw std::runtime_error("Could not create the wineserver monitor event loop");
+  }
+  epoll_event event{};
+  event.events = EPOLLIN;
+  event.data.fd = wakeup_fd_;
+  epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, wakeup_fd_, &event);
+  thread_ = std::thread(&WineserverMonitor::run, this);
+}
+
+/**
+ * \brief Stop the monitor thread, pending waits are finished as not terminated
+ */
+WineserverMonitor::~WineserverMonitor()
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    is_stopping_ = true;
+  }
+  wake_up();
+  if (thread_.joinable())
+    thread_.join();
+  close(wakeup_fd_);
+  close(epoll_fd_);
+}
+
+/**
+ * \brief Get the shared monitor
+ * \return Monitor instance
+ */
+WineserverMonitor& WineserverMonitor::get_instance()
+{
+  static WineserverMonitor instance;
+  return instance;
+}
+
+/**
+ * \brief Get the server directory of a bottle, the same way Wine determines it
+ * (/tmp/.wine-<uid>/server-<device>-<inode>, based on the device & inode number of the bottle prefix directory)
+ * \param[in] prefix_path Bottle prefix path
+ * \return Server directory path, or empty string when the bottle prefix doesn't exist
+ */
+std::string WineserverMonitor::get_server_directory(const std::string& prefix_path)
+{
+  struct stat prefix_stat;
+  if (stat(prefix_path.c_str(), &prefix_stat) != 0)
+    return "";
+  return "/tmp/.wine-" + std::to_string(getuid()) + "/server-" + to_hex(prefix_stat.st_dev) + "-" + to_hex(prefix_stat.st_ino);
+}
+
+/**
+ * \brief Find the running wineserver of a bottle, this is the process that holds the lock on the 'lock' file of the
+ * server directory (the same lock 'wineserver -w' waits for)
+ * \param[in] prefix_path Bottle prefix path
+ * \return Process ID of the wineserver, or 0 if no wineserver is running for the bottle
+ */
+pid_t WineserverMonitor::find_wineserver_pid(const std::string& prefix_path)
+{
+  std::string server_directory = get_server_directory(prefix_path);
+  if (server_directory.empty())
+    return 0;
+  int fd = open((server_directory + "/lock").c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0)
+    return 0;
+  struct flock lock_info{};
+  lock_info.l_type = F_WRLCK;
+  lock_info.l_whence = SEEK_SET;
+  lock_info.l_start = 0;
+  lock_info.l_len = 0; // Whole file
+  pid_t pid = 0;
+  if (fcntl(fd, F_GETLK, &lock_info) == 0 && lock_info.l_type != F_UNLCK)
+    pid = lock_info.l_pid;
+  close(fd);
+  return pid;
+}
+
+/**
+ * \brief Blocking wait until the wineserver of a bottle is terminated
+ * \param[in] prefix_path Bottle prefix path
+ * \param[in] timeout Maximum time to wait
+ * \throws runtime_error when process file descriptors (pidfd) are not supported by the kernel,
+ * or when the event loop stopped before the wineserver was terminated
+ * \return true if the wineserver is terminated (or wasn't running), false on time-out
+ */
+bool WineserverMonitor::wait(const std::string& prefix_path, std::chrono::milliseconds timeout)
+{
+  std::promise<bool> result;
+  std::future<bool> is_terminated = result.get_future();
+  wait_async(prefix_path, timeout, [&result](bool terminated) { result.set_value(terminated); });
+  bool terminated = is_terminated.get();
+  if (!terminated)
+  {
+    // Not a time-out when the event loop stopped while waiting
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (is_stopped_)
+      throw std::runtime_error("Wineserver monitor event loop is stopped");
+  }
+  return terminated;
+}
+
+/**
+ * \brief Wait until the wineserver of a bottle is terminated, without blocking the calling thread
+ * \param[in] prefix_path Bottle prefix path
+ * \param[in] timeout Maximum time to wait
+ * \param[in] on_finished Called with true when the wineserver is terminated (or wasn't running) or false on time-out.
+ * Called from the monitor thread, or directly from the calling thread when the wineserver isn't running.
+ * \throws runtime_error when process file descriptors (pidfd) are not supported by the kernel,
+ * or when the event loop is stopped (on_finished is not called in that case)
+ */
+void WineserverMonitor::wait_async(const std::string& prefix_path,
+                                   std::chrono::milliseconds timeout,
+                                   std::function<void(bool is_terminated)> on_finished)
+{
+  pid_t pid = find_wineserver_pid(prefix_path);
+  if (pid <= 0)
+  {
+    on_finished(true);
+    return;
+  }
+  int pidfd = open_pidfd(pid);
+  if (pidfd < 0)
+  {
+    if (errno == ESRCH)
+    {
+      on_finished(true); // Terminated in the meantime
+      return;
+    }
+    throw std::runtime_error("pidfd_open() failed: " + std::string(std::strerror(errno)));
+  }
+  // The process ID could be reused when the wineserver exited before the pidfd was opened
+  if (find_wineserver_pid(prefix_path) != pid)
+  {
+    close(pidfd);
+    on_finished(true);
+    return;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (is_stopped_)
+    {
+      close(pidfd);
+      throw std::runtime_error("Wineserver monitor event loop is stopped");
+    }
+    new_waiters_.push_back({pidfd, std::chrono::steady_clock::now() + timeout, std::move(on_finished)});
+  }
+  wake_up();
+}
+
+/**
+ * \brief Event loop, waits for all the pidfds at once
+ */
+void WineserverMonitor::run()
+{
+  std::map<int, Waiter> waiters; // By pidfd
+  auto finish = [this, &waiters](int pidfd, bool is_terminated)
+  {
+    auto it = waiters.find(pidfd);
+    if (it == waiters.end())
+      return;
+    auto on_finished = std::move(it->second.on_finished);
+    waiters.erase(it);
+    epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, pidfd, nullptr);
+    close(pidfd);
+    on_finished(is_terminated);
+  };
+
+  std::array<epoll_event, 16> events;
+  while (true)
+  {
+    bool is_stopping = false;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      is_stopping = is_stopping_;
+      for (Waiter& waiter : new_waiters_)
+      {
+        epoll_event event{};
+        event.events = EPOLLIN;
+        event.data.fd = waiter.pidfd;
+        epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, waiter.pidfd, &event);
+        waiters.emplace(waiter.pidfd, std::move(waiter));
+      }
+      new_waiters_.clear();
+    }
+    if (is_stopping)
+      break;
+
+    // Sleep until the first deadline
+    int timeout_ms = -1;
+    auto now = std::chrono::steady_clock::now();
+    for (const auto& [pidfd, waiter] : waiters)
+    {
+      auto remaining = std::chrono::ceil<std::chrono::milliseconds>(waiter.deadline - now).count();
+      int remaining_ms = static_cast<int>(std::clamp<decltype(remaining)>(remaining, 0, 3600000));
+      if (timeout_ms < 0 || remaining_ms < timeout_ms)
+        timeout_ms = remaining_ms;
+    }
+
+    int count = epoll_wait(epoll_fd_, events.data(), static_cast<int>(events.size()), timeout_ms);
+    if (count < 0 && errno != EINTR)
+    {
+      std::cerr << "Error: Wineserver monitor event loop failed: " << std::strerror(errno) << std::endl;
+      break;
+    }
+    for (int i = 0; i < count; ++i)
+    {
+      int fd = events[static_cast<std::size_t>(i)].data.fd;
+      if (fd == wakeup_fd_)
+      {
+        std::uint64_t value;
+        [[maybe_unused]] ssize_t size = read(wakeup_fd_, &value, sizeof(value));
+      }
+      else
+      {
+        finish(fd, true);
+      }
+    }
+
+    now = std::chrono::steady_clock::now();
+    std::vector<int> expired;
+    for (const auto& [pidfd, waiter] : waiters)
+    {
+      if (waiter.deadline <= now)
+        expired.push_back(pidfd);
+    }
+    for (int pidfd : expired)
+    {
+      finish(pidfd, false);
+    }
+  }
+
+  // Stopped (or failed): finish the remaining waits as not terminated, new waits are refused from now on
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    is_stopped_ = true;
+    for (Waiter& waiter : new_waiters_)
+    {
+      waiters.emplace(waiter.pidfd, std::move(waiter));
+    }
+    new_waiters_.clear();
+  }
+  while (!waiters.empty())
+  {
+    finish(waiters.begin()->first, false);
+  }
+}
+
+/**
+ * \brief Wake up the event loop (eg. to add new waiters)
+ */
+void WineserverMonitor::wake_up()
+{
+  std::uint64_t value = 1;
+  [[maybe_unused]] ssize_t size = write(wakeup_fd_, &value, sizeof(value));
+}
@@ -0,0 +1,157 @@
+#include "archive_extractor.h"
+#include "process_launcher.h"
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <gtest/gtest.h>
+#include <iterator>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+
+class ArchiveExtractorTest : public ::testing::Test
+{
+protected:
+  fs::path location_;
+
+  void SetUp() override
+  {
+    location_ = fs::temp_directory_path() / ("winegui_archive_extractor_test_" + std::to_string(getpid()));
+    fs::create_directories(location_ / "source" / "wine-11.13-amd64" / "bin");
+    fs::create_directories(location_ / "output");
+  }
+
+  void TearDown() override
+  {
+    fs::remove_all(location_);
+  }
+
+  // Runner-like directory tree: an executable, a large file, a long path, a symbolic link and a hard link
+  void create_runner()
+  {
+    fs::path runner = location_ / "source" / "wine-11.13-amd64";
+    std::ofstream(runner / "bin" / "wine") << "#!/bin/sh\n";
+    fs::permissions(runner / "bin" / "wine", fs::perms::owner_all | fs::perms::group_read | fs::perms::others_read);
+    std::ofstream large(runner / "large.bin", std::ios::binary);
+    for (int i = 0; i < 300000; ++i)
+      large << i << '\n';
+    large.close();
+    fs::path long_dir = runner / std::string(60, 'd') / std::string(60, 'e');
+    fs::create_directories(long_dir);
+    std::ofstream(long_dir / (std::string(80, 'f') + ".dll")) << "long";
+    fs::create_symlink("bin/wine", runner / "wine-link");
+    fs::create_hard_link(runner / "bin" / "wine", runner / "wine-hard");
+  }
+
+  fs::path create_archive(const std::string& name, const std::vector<std::string>& tar_options)
+  {
+    fs::path archive = location_ / name;
+    std::vector<std::string> argv{"tar", "-c", "-f", archive.string(), "-C", (location_ / "source").string()};
+    argv.insert(argv.end(), tar_options.begin(), tar_options.end());
+    argv.push_back("wine-11.13-amd64");
+    EXPECT_EQ(ProcessLauncher::run(argv).first, 0);
+    return archive;
+  }
+
+  // Pass the archive in small chunks, like the data arrives during a download
+  void extract(const fs::path& archive, ArchiveExtractor::Compression compression, std::size_t chunk_size = 1000)
+  {
+    std::ifstream file(archive, std::ios::binary);
+    std::string data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    ArchiveExtractor extractor((location_ / "output").string(), compression);
+    for (std::size_t offset = 0; offset < data.size(); offset += chunk_size)
+      extractor.write(data.data() + offset, std::min(chunk_size, data.size() - offset));
+    extractor.finish();
+  }
+
+  void expect_runner_extracted()
+  {
+    fs::path runner = location_ / "output" / "wine-11.13-amd64";
+    fs::path source = location_ / "source" / "wine-11.13-amd64";
+    EXPECT_EQ(fs::file_size(runner / "large.bin"), fs::file_size(source / "large.bin"));
+    EXPECT_NE(fs::status(runner / "bin" / "wine").permissions() & fs::perms::owner_exec, fs::perms::none);
+    // tar stores the modification time in seconds
+    EXPECT_EQ(std::chrono::floor<std::chrono::seconds>(fs::last_write_time(runner / "bin" / "wine")),
+              std::chrono::floor<std::chrono::seconds>(fs::last_write_time(source / "bin" / "wine")));
+    EXPECT_TRUE(fs::exists(runner / std::string(60, 'd') / std::string(60, 'e') / (std::string(80, 'f') + ".dll")));
+    EXPECT_EQ(fs::read_symlink(runner / "wine-link"), "bin/wine");
+    EXPECT_TRUE(fs::equivalent(runner / "wine-hard", runner / "bin" / "wine"));
+  }
+};
+
+TEST_F(ArchiveExtractorTest, GetCompression)
+{
+  EXPECT_EQ(ArchiveExtractor::get_compression("wine-11.13-amd64.tar.xz"), ArchiveExtractor::Compression::Xz);
+  EXPECT_EQ(ArchiveExtractor::get_compression("GE-Proton11-1.tar.gz"), ArchiveExtractor::Compression::Gzip);
+  EXPECT_EQ(ArchiveExtractor::get_compression("runner.tar"), ArchiveExtractor::Compression::None);
+}
+
+TEST_F(ArchiveExtractorTest, ExtractTarXz)
+{
+  create_runner();
+  extract(create_archive("runner.tar.xz", {"--xz"}), ArchiveExtractor::Compression::Xz);
+  expect_runner_extracted();
+}
+
+TEST_F(ArchiveExtractorTest, ExtractMultiBlockTarXzWithThreads)
+{
+  create_runner();
+  fs::path archive = create_archive("runner.tar", {});
+  // Multiple blocks, which are decoded in parallel
+  ASSERT_EQ(ProcessLauncher::run({"xz", "-T2", "--block-size=65536", archive.string()}).first, 0);
+  ArchiveExtractor extractor((location_ / "output").string(), ArchiveExtractor::Compression::Xz, 4);
+  std::ifstream file(archive.string() + ".xz", std::ios::binary);
+  std::vector<char> buffer(100000);
+  while (file.read(buffer.data(), static_cast<std::streamsize>(buffer.size())) || file.gcount() > 0)
+    extractor.write(buffer.data(), static_cast<std::size_t>(file.gcount()));
+  extractor.finish();
+  expect_runner_extracted();
+  // The hard link has no data of its own
+  fs::path source = location_ / "source" / "wine-11.13-amd64";
+  EXPECT_EQ(extractor.get_extracted_bytes(), fs::file_size(source / "bin" / "wine") + fs::file_size(source / "large.bin") + 4);
+  EXPECT_EQ(extractor.get_extracted_entries(), 9u);
+}
+
+TEST_F(ArchiveExtractorTest, ExtractPaxTarGz)
+{
+  create_runner();
+  extract(create_archive("runner.tar.gz", {"--gzip", "--format=pax"}), ArchiveExtractor::Compression::Gzip, 333);
+  expect_runner_extracted();
+}
+
+TEST_F(ArchiveExtractorTest, IncompleteArchive)
+{
+  create_runner();
+  fs::path archive = create_archive("runner.tar.xz", {"--xz"});
+  fs::resize_file(archive, fs::file_size(archive) / 2);
+  EXPECT_THROW(extract(archive, ArchiveExtractor::Compression::Xz), std::runtime_error);
+}
+
+TEST_F(ArchiveExtractorTest, RefusesPathsOutsideDestination)
+{
+  std::ofstream(location_ / "source" / "evil.txt") << "evil";
+  fs::path archive = location_ / "dotdot.tar";
+  ASSERT_EQ(ProcessLauncher::run({"tar", "-c", "-f", archive.string(), "-C", (location_ / "source" / "wine-11.13-amd64").string(),
+                                  "--absolute-names", "../evil.txt"})
+                .first,
+            0);
+  EXPECT_THROW(extract(archive, ArchiveExtractor::Compression::None), std::runtime_error);
+  EXPECT_FALSE(fs::exists(location_ / "evil.txt"));
+}
+
+TEST_F(ArchiveExtractorTest, RefusesWritingThroughSymbolicLink)
+{
+  // First a symbolic link to a directory outside the destination, then a file "via" the link
+  fs::create_directories(location_ / "outside");
+  fs::create_directories(location_ / "link_source");
+  fs::create_directory_symlink(location_ / "outside", location_ / "link_source" / "link");
+  fs::create_directories(location_ / "file_source" / "link");
+  std::ofstream(location_ / "file_source" / "link" / "evil.txt") << "evil";
+  fs::path archive = location_ / "symlink.tar";
+  ASSERT_EQ(ProcessLauncher::run({"tar", "-c", "-f", archive.string(), "-C", (location_ / "link_source").string(), "link", "-C",
+                                  (location_ / "file_source").string(), "link/evil.txt"})
+                .first,
+            0);
+  EXPECT_THROW(extract(archive, ArchiveExtractor::Compression::None), std::runtime_error);
+  EXPECT_FALSE(fs::exists(location_ / "outside" / "evil.txt"));
+}
@@ -0,0 +1,76 @@
+/**
+ * Throughput benchmark of the bottle cloner, single thread versus multiple copy threads.
+ *
+ * Usage: bottle_cloner_benchmark [source folder] [destination folder]
+ * Without a source folder, a bottle-like tree is generated (many small DLL-sized files & a few large files). Use a
+ * destination folder on another disk or file system to measure the copy without reflinks.
+ * Note: the source files are in the page cache after the first run, drop the caches between runs for cold-cache numbers.
+ */
+#include "bottle_cloner.h"
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+static constexpr int GeneratedDirs = 100;
+static constexpr int GeneratedFilesPerDir = 200;
+static constexpr std::size_t GeneratedFileSize = 64 * 1024;
+static constexpr int GeneratedLargeFiles = 4;
+static constexpr std::size_t GeneratedLargeFileSize = 256 * 1024 * 1024;
+
+static void generate_tree(const fs::path& source)
+{
+  std::string small_data(GeneratedFileSize, 'd');
+  for (int dir = 0; dir < GeneratedDirs; ++dir)
+  {
+    fs::path dir_path = source / "drive_c" / "windows" / std::to_string(dir);
+    fs::create_directories(dir_path);
+    for (int file = 0; file < GeneratedFilesPerDir; ++file)
+      std::ofstream(dir_path / (std::to_string(file) + ".dll"), std::ios::binary) << small_data;
+  }
+  std::string large_data(1024 * 1024, 'g');
+  for (int file = 0; file < GeneratedLargeFiles; ++file)
+  {
+    std::ofstream large_file(source / "drive_c" / ("game" + std::to_string(file) + ".pak"), std::ios::binary);
+    for (std::size_t written = 0; written < GeneratedLargeFileSize; written += large_data.size())
+      large_file << large_data;
+  }
+  fs::create_directories(source / "dosdevices");
+  fs::create_symlink("../drive_c", source / "dosdevices" / "c:");
+}
+
+static void run(const fs::path& source, const fs::path& destination, unsigned int thread_count)
+{
+  std::atomic<bool> cancel{false};
+  std::uint64_t bytes = 0;
+  auto start = std::chrono::steady_clock::now();
+  BottleCloner::clone(source, destination, [&bytes](std::uint64_t bytes_done, std::uint64_t) { bytes = bytes_done; }, cancel, thread_count);
+  std::chrono::duration<double> duration = std::chrono::steady_clock::now() - start;
+  std::cout << thread_count << " thread(s): " << bytes / (1024 * 1024) << " MiB in " << duration.count() << " s, "
+            << static_cast<double>(bytes) / (1024 * 1024) / duration.count() << " MiB/s" << std::endl;
+  fs::remove_all(destination);
+}
+
+int main(int argc, char* argv[])
+{
+  fs::path work_dir = fs::temp_directory_path() / ("winegui_bottle_cloner_benchmark_" + std::to_string(getpid()));
+  fs::path source = (argc > 1) ? fs::path(argv[1]) : work_dir / "source";
+  if (argc <= 1)
+  {
+    std::cout << "Generating the source tree in: " << source << std::endl;
+    generate_tree(source);
+  }
+  fs::path destination = (argc > 2) ? fs::path(argv[2]) : work_dir / "destination";
+  fs::create_directories(destination.parent_path());
+
+  std::vector<unsigned int> thread_counts{1, 2, 4, BottleCloner::get_default_thread_count()};
+  for (unsigned int thread_count : thread_counts)
+    run(source, destination, thread_count);
+  fs::remove_all(work_dir);
+  return 0;
+}
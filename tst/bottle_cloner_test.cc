@@ -0,0 +1,139 @@
+#include "bottle_cloner.h"
+#include <filesystem>
+#include <fstream>
+#include <gtest/gtest.h>
+#include <sstream>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+
+static std::string read_file(const fs::path& path)
+{
+  std::ifstream file(path, std::ios::binary);
+  std::stringstream buffer;
+  buffer << file.rdbuf();
+  return buffer.str();
+}
+
+class BottleClonerTest : public ::testing::Test
+{
+protected:
+  fs::path test_dir_;
+  fs::path source_;
+  fs::path destination_;
+
+  void SetUp() override
+  {
+    test_dir_ = fs::temp_directory_path() / ("winegui_bottle_cloner_test_" + std::to_string(getpid()));
+    source_ = test_dir_ / "source";
+    destination_ = test_dir_ / "destination";
+    fs::create_directories(source_ / "drive_c" / "windows" / "system32");
+    fs::create_directories(source_ / "dosdevices");
+    std::ofstream(source_ / "system.reg") << "WINE REGISTRY Version 2\n";
+    std::ofstream(source_ / "drive_c" / "windows" / "system32" / "large.dll", std::ios::binary) << std::string(3 * 1024 * 1024, 'x');
+    std::ofstream(source_ / "drive_c" / "empty.txt");
+    fs::create_symlink("../drive_c", source_ / "dosdevices" / "c:");
+    fs::create_symlink("/", source_ / "dosdevices" / "z:");
+    fs::permissions(source_ / "system.reg", fs::perms::owner_read);
+  }
+
+  void TearDown() override
+  {
+    fs::permissions(source_ / "system.reg", fs::perms::owner_all);
+    fs::remove_all(test_dir_);
+  }
+};
+
+TEST_F(BottleClonerTest, CloneTree)
+{
+  std::atomic<bool> cancel{false};
+  std::uint64_t last_done = 0;
+  std::uint64_t last_total = 0;
+  bool is_cloned = BottleCloner::clone(source_, destination_,
+                                       [&](std::uint64_t bytes_done, std::uint64_t bytes_total)
+                                       {
+                                         EXPECT_GE(bytes_done, last_done);
+                                         last_done = bytes_done;
+                                         last_total = bytes_total;
+                                       },
+                                       cancel);
+  ASSERT_TRUE(is_cloned);
+  std::uint64_t expected_size = 3 * 1024 * 1024 + std::string("WINE REGISTRY Version 2\n").size();
+  EXPECT_EQ(last_done, expected_size);
+  EXPECT_EQ(last_total, expected_size);
+  EXPECT_EQ(read_file(destination_ / "system.reg"), "WINE REGISTRY Version 2\n");
+  EXPECT_EQ(read_file(destination_ / "drive_c" / "windows" / "system32" / "large.dll"), std::string(3 * 1024 * 1024, 'x'));
+  EXPECT_TRUE(fs::is_regular_file(destination_ / "drive_c" / "empty.txt"));
+  EXPECT_EQ(fs::status(destination_ / "system.reg").permissions() & fs::perms::all, fs::perms::owner_read);
+  // Symbolic links are copied as-is, never followed
+  ASSERT_TRUE(fs::is_symlink(destination_ / "dosdevices" / "c:"));
+  EXPECT_EQ(fs::read_symlink(destination_ / "dosdevices" / "c:"), "../drive_c");
+  ASSERT_TRUE(fs::is_symlink(destination_ / "dosdevices" / "z:"));
+  EXPECT_EQ(fs::read_symlink(destination_ / "dosdevices" / "z:"), "/");
+}
+
+TEST_F(BottleClonerTest, CloneManyFilesInParallel)
+{
+  for (int dir = 0; dir < 10; ++dir)
+  {
+    fs::create_directories(source_ / "many" / std::to_string(dir));
+    for (int file = 0; file < 100; ++file)
+      std::ofstream(source_ / "many" / std::to_string(dir) / (std::to_string(file) + ".dll")) << dir << "-" << file;
+  }
+  std::atomic<bool> cancel{false};
+  std::uint64_t last_done = 0;
+  ASSERT_TRUE(BottleCloner::clone(source_, destination_,
+                                  [&last_done](std::uint64_t bytes_done, std::uint64_t)
+                                  {
+                                    // Progress is reported by one thread at a time, never backwards
+                                    EXPECT_GE(bytes_done, last_done);
+                                    last_done = bytes_done;
+                                  },
+                                  cancel, 8));
+  for (int dir = 0; dir < 10; ++dir)
+  {
+    for (int file = 0; file < 100; ++file)
+      EXPECT_EQ(read_file(destination_ / "many" / std::to_string(dir) / (std::to_string(file) + ".dll")),
+                std::to_string(dir) + "-" + std::to_string(file));
+  }
+}
+
+TEST_F(BottleClonerTest, CloneUnreadableFile)
+{
+  if (getuid() == 0)
+    GTEST_SKIP() << "Root can read every file";
+  fs::permissions(source_ / "system.reg", fs::perms::none);
+  std::atomic<bool> cancel{false};
+  EXPECT_THROW(BottleCloner::clone(source_, destination_, nullptr, cancel, 4), std::runtime_error);
+  EXPECT_FALSE(fs::exists(destination_));
+}
+
+TEST_F(BottleClonerTest, CloneCancelled)
+{
+  std::atomic<bool> cancel{true};
+  EXPECT_FALSE(BottleCloner::clone(source_, destination_, nullptr, cancel));
+  EXPECT_FALSE(fs::exists(destination_));
+}
+
+TEST_F(BottleClonerTest, CloneDestinationExists)
+{
+  std::atomic<bool> cancel{false};
+  fs::create_directories(destination_);
+  EXPECT_THROW(BottleCloner::clone(source_, destination_, nullptr, cancel), std::runtime_error);
+  EXPECT_THROW(BottleCloner::clone(test_dir_ / "missing", test_dir_ / "other", nullptr, cancel), std::runtime_error);
+}
+
+TEST_F(BottleClonerTest, CopyFile)
+{
+  std::atomic<bool> cancel{false};
+  std::uint64_t bytes_copied = 0;
+  BottleCloner::CopyMethod method = BottleCloner::copy_file((source_ / "drive_c" / "windows" / "system32" / "large.dll").string(),
+                                                            (test_dir_ / "copy.dll").string(),
+                                                            [&bytes_copied](std::uint64_t bytes) { bytes_copied += bytes; }, cancel);
+  EXPECT_EQ(bytes_copied, 3u * 1024 * 1024);
+  EXPECT_EQ(read_file(test_dir_ / "copy.dll"), std::string(3 * 1024 * 1024, 'x'));
+  // Reflinks are only supported on some file systems (like btrfs and XFS)
+  EXPECT_NE(method, BottleCloner::CopyMethod::ReadWrite);
+  // The destination may not exist yet
+  EXPECT_THROW(BottleCloner::copy_file((source_ / "system.reg").string(), (test_dir_ / "copy.dll").string(), nullptr, cancel), std::runtime_error);
+}
@@ -0,0 +1,137 @@
+#include "bottle_deduplicator.h"
+#include <fcntl.h>
+#include <filesystem>
+#include <fstream>
+#include <gtest/gtest.h>
+#include <linux/fs.h>
+#include <sys/ioctl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+
+class BottleDeduplicatorTest : public ::testing::Test
+{
+protected:
+  fs::path test_dir_;
+  std::vector<std::string> prefixes_;
+  std::atomic<bool> cancel_{false};
+
+  void SetUp() override
+  {
+    test_dir_ = fs::temp_directory_path() / ("winegui_bottle_deduplicator_test_" + std::to_string(getpid()));
+    for (const std::string& name : {"first", "second", "third"})
+    {
+      fs::path system32 = test_dir_ / name / "drive_c" / "windows" / "system32";
+      fs::create_directories(system32);
+      std::ofstream(system32 / "d3d9.dll") << std::string(64 * 1024, 'd');
+      std::ofstream(system32 / "small.dll") << "identical, but too small";
+      std::ofstream(system32 / "unique.dll") << std::string(64 * 1024, name[0]);
+      prefixes_.push_back((test_dir_ / name).string());
+    }
+  }
+
+  void TearDown() override
+  {
+    fs::remove_all(test_dir_);
+  }
+
+  static ino_t get_inode(const fs::path& path)
+  {
+    struct stat file_stat;
+    EXPECT_EQ(stat(path.c_str(), &file_stat), 0);
+    return file_stat.st_ino;
+  }
+};
+
+TEST_F(BottleDeduplicatorTest, DryRun)
+{
+  BottleDeduplicator deduplicator((test_dir_ / "index.ini").string());
+  BottleDeduplicator::Options options;
+  BottleDeduplicator::Report report = deduplicator.deduplicate(prefixes_, options, cancel_);
+  EXPECT_EQ(report.scanned_files, 6u);
+  EXPECT_EQ(report.hashed_files, 6u);
+  EXPECT_EQ(report.duplicate_files, 2u);
+  EXPECT_EQ(report.duplicate_bytes, 2u * 64 * 1024);
+  EXPECT_EQ(report.deduplicated_files, 0u);
+  EXPECT_NE(get_inode(test_dir_ / "first/drive_c/windows/system32/d3d9.dll"), get_inode(test_dir_ / "second/drive_c/windows/system32/d3d9.dll"));
+}
+
+TEST_F(BottleDeduplicatorTest, IncrementalIndex)
+{
+  BottleDeduplicator deduplicator((test_dir_ / "index.ini").string());
+  BottleDeduplicator::Options options;
+  deduplicator.deduplicate(prefixes_, options, cancel_);
+  BottleDeduplicator::Report report = deduplicator.deduplicate(prefixes_, options, cancel_);
+  EXPECT_EQ(report.hashed_files, 0u);
+  EXPECT_EQ(report.duplicate_files, 2u);
+
+  // A changed file is hashed again, and is no duplicate anymore
+  std::ofstream(test_dir_ / "third/drive_c/windows/system32/d3d9.dll") << std::string(64 * 1024, 'x');
+  report = deduplicator.deduplicate(prefixes_, options, cancel_);
+  EXPECT_EQ(report.hashed_files, 1u);
+  EXPECT_EQ(report.duplicate_files, 1u);
+}
+
+TEST_F(BottleDeduplicatorTest, HardLinksOnlyForReadOnlyFiles)
+{
+  fs::path first = test_dir_ / "first/drive_c/windows/system32/d3d9.dll";
+  fs::path second = test_dir_ / "second/drive_c/windows/system32/d3d9.dll";
+  fs::path third = test_dir_ / "third/drive_c/windows/system32/d3d9.dll";
+  for (const fs::path& path : {first, second})
+    fs::permissions(path, fs::perms::owner_read | fs::perms::group_read | fs::perms::others_read);
+  BottleDeduplicator deduplicator((test_dir_ / "index.ini").string());
+  BottleDeduplicator::Options options;
+  options.is_dry_run = false;
+  options.allow_hard_links = true;
+  BottleDeduplicator::Report report = deduplicator.deduplicate(prefixes_, options, cancel_);
+  EXPECT_EQ(report.duplicate_files, 2u);
+  // Either the file system shares the data (reflinks), or the read-only files are hard linked
+  EXPECT_GE(report.deduplicated_files, 1u);
+  EXPECT_TRUE(report.deduplicated_files == 2u || get_inode(first) == get_inode(second));
+  EXPECT_NE(get_inode(first), get_inode(third));
+  EXPECT_EQ(fs::file_size(third), 64u * 1024);
+}
+
+TEST_F(BottleDeduplicatorTest, NoHardLinksByDefault)
+{
+  fs::path first = test_dir_ / "first/drive_c/windows/system32/d3d9.dll";
+  fs::path second = test_dir_ / "second/drive_c/windows/system32/d3d9.dll";
+  for (const fs::path& path : {first, second})
+    fs::permissions(path, fs::perms::owner_read | fs::perms::group_read | fs::perms::others_read);
+  BottleDeduplicator deduplicator((test_dir_ / "index.ini").string());
+  BottleDeduplicator::Options options;
+  options.is_dry_run = false;
+  deduplicator.deduplicate(prefixes_, options, cancel_);
+  // The files might share their data (reflinks), but stay separate files
+  EXPECT_NE(get_inode(first), get_inode(second));
+}
+
+TEST_F(BottleDeduplicatorTest, CopiedFilesDontShareData)
+{
+  EXPECT_FALSE(BottleDeduplicator::is_sharing_file_data((test_dir_ / "first/drive_c/windows/system32/d3d9.dll").string(),
+                                                        (test_dir_ / "second/drive_c/windows/system32/d3d9.dll").string()));
+}
+
+TEST_F(BottleDeduplicatorTest, SharedFilesAreNotCountedAgain)
+{
+  // Reflink copies share their data already, like the files deduplicated by an earlier run
+  fs::path source = test_dir_ / "first/drive_c/windows/system32/d3d9.dll";
+  for (const std::string& name : {"second", "third"})
+  {
+    fs::path destination = test_dir_ / name / "drive_c/windows/system32/d3d9.dll";
+    int source_fd = open(source.c_str(), O_RDONLY | O_CLOEXEC);
+    int destination_fd = open(destination.c_str(), O_WRONLY | O_TRUNC | O_CLOEXEC);
+    bool is_cloned = source_fd >= 0 && destination_fd >= 0 && ioctl(destination_fd, FICLONE, source_fd) == 0;
+    close(destination_fd);
+    close(source_fd);
+    if (!is_cloned)
+      GTEST_SKIP() << "The file system doesn't support reflinks";
+  }
+  BottleDeduplicator deduplicator((test_dir_ / "index.ini").string());
+  BottleDeduplicator::Options options;
+  BottleDeduplicator::Report report = deduplicator.deduplicate(prefixes_, options, cancel_);
+  EXPECT_EQ(report.duplicate_files, 0u);
+  EXPECT_EQ(report.already_shared_files, 2u);
+  EXPECT_EQ(report.already_shared_bytes, 2u * 64 * 1024);
+}
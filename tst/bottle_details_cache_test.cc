@@ -0,0 +1,153 @@
+#include "bottle_details_cache.h"
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <giomm/init.h>
+#include <gtest/gtest.h>
+
+namespace fs = std::filesystem;
+
+class BottleDetailsCacheTest : public ::testing::Test
+{
+protected:
+  std::string test_dir;
+  std::string prefix_path;
+  std::string cache_file_path;
+
+  static void SetUpTestSuite()
+  {
+    // Initialize Gio to prevent GLib warnings
+    Gio::init();
+  }
+
+  void SetUp() override
+  {
+    test_dir = fs::temp_directory_path() / "winegui_bottle_details_cache_test";
+    prefix_path = test_dir + "/prefixes/bottle1";
+    cache_file_path = test_dir + "/bottles.ini";
+    fs::create_directories(prefix_path);
+    write_file(prefix_path + "/user.reg", "WINE REGISTRY Version 2\n#arch=win64\n");
+    write_file(prefix_path + "/system.reg", "WINE REGISTRY Version 2\n#arch=win64\n");
+    write_file(prefix_path + "/winegui.ini", "[General]\nName=Bottle 1\n");
+  }
+
+  void TearDown() override
+  {
+    if (fs::exists(test_dir))
+    {
+      fs::remove_all(test_dir);
+    }
+  }
+
+  static void write_file(const std::string& file_path, const std::string& contents)
+  {
+    std::ofstream file(file_path);
+    file << contents;
+    file.close();
+  }
+
+  BottleDetailsData create_details()
+  {
+    BottleDetailsData details;
+    details.prefix_path = prefix_path;
+    details.folder_name = "bottle1";
+    details.config.name = "Bottle 1";
+    details.config.description = "Games; and more";
+    details.config.env_vars = {{"DXVK_HUD", "fps"}, {"WINEDLLOVERRIDES", "d3d9=n;dxgi=n"}};
+    details.app_list = {{0, {"Notepad", "Text editor", "notepad.exe"}}};
+    details.status = true;
+    details.windows = BottleTypes::Windows::Windows7;
+    details.bit = BottleTypes::Bit::win64;
+    details.wine_version = "9.0";
+    details.c_drive_location = prefix_path + "/drive_c";
+    details.last_time_wine_updated = "2026-01-01 12:00:00";
+    details.audio_driver = BottleTypes::AudioDriver::alsa;
+    details.virtual_desktop = "1024x768";
+    return details;
+  }
+};
+
+TEST_F(BottleDetailsCacheTest, FileStampsOfMissingFilesAreEmpty)
+{
+  std::vector<std::string> file_stamps = BottleDetailsCache::get_file_stamps(prefix_path);
+  ASSERT_EQ(file_stamps.size(), 4u);
+  EXPECT_FALSE(file_stamps[0].empty()); // user.reg
+  EXPECT_FALSE(file_stamps[1].empty()); // system.reg
+  EXPECT_TRUE(file_stamps[2].empty());  // .update-timestamp
+  EXPECT_FALSE(file_stamps[3].empty()); // winegui.ini
+}
+
+TEST_F(BottleDetailsCacheTest, GetUnknownBottle)
+{
+  BottleDetailsCache cache(cache_file_path);
+  EXPECT_FALSE(cache.get(prefix_path, BottleDetailsCache::get_file_stamps(prefix_path)).has_value());
+}
+
+TEST_F(BottleDetailsCacheTest, PutAndGetFromDisk)
+{
+  std::vector<std::string> file_stamps = BottleDetailsCache::get_file_stamps(prefix_path);
+  {
+    BottleDetailsCache cache(cache_file_path);
+    cache.put(create_details(), file_stamps);
+    cache.save();
+  }
+  ASSERT_TRUE(fs::exists(cache_file_path));
+
+  BottleDetailsCache reloaded_cache(cache_file_path);
+  std::optional<BottleDetailsData> details = reloaded_cache.get(prefix_path, file_stamps);
+  ASSERT_TRUE(details.has_value());
+  EXPECT_TRUE(details->is_snapshot);
+  EXPECT_EQ(details->folder_name, "bottle1");
+  EXPECT_EQ(details->config.name, "Bottle 1");
+  EXPECT_EQ(details->config.description, "Games; and more");
+  ASSERT_EQ(details->config.env_vars.size(), 2u);
+  EXPECT_EQ(details->config.env_vars[1].first, "WINEDLLOVERRIDES");
+  EXPECT_EQ(details->config.env_vars[1].second, "d3d9=n;dxgi=n");
+  ASSERT_EQ(details->app_list.size(), 1u);
+  EXPECT_EQ(details->app_list.at(0).command, "notepad.exe");
+  EXPECT_TRUE(details->status);
+  EXPECT_EQ(details->windows, BottleTypes::Windows::Windows7);
+  EXPECT_EQ(details->bit, BottleTypes::Bit::win64);
+  EXPECT_EQ(details->wine_version, "9.0");
+  EXPECT_EQ(details->audio_driver, BottleTypes::AudioDriver::alsa);
+  EXPECT_EQ(details->virtual_desktop, "1024x768");
+}
+
+TEST_F(BottleDetailsCacheTest, ChangedRegistryInvalidatesSnapshot)
+{
+  BottleDetailsCache cache(cache_file_path);
+  cache.put(create_details(), BottleDetailsCache::get_file_stamps(prefix_path));
+
+  fs::last_write_time(prefix_path + "/user.reg", fs::last_write_time(prefix_path + "/user.reg") + std::chrono::seconds(1));
+  EXPECT_FALSE(cache.get(prefix_path, BottleDetailsCache::get_file_stamps(prefix_path)).has_value());
+}
+
+TEST_F(BottleDetailsCacheTest, DetailsWithErrorsAreNotStored)
+{
+  BottleDetailsCache cache(cache_file_path);
+  std::vector<std::string> file_stamps = BottleDetailsCache::get_file_stamps(prefix_path);
+  cache.put(create_details(), file_stamps);
+
+  BottleDetailsData details = create_details();
+  details.error_messages.emplace_back("Could not determine Wine version");
+  cache.put(details, file_stamps);
+  EXPECT_FALSE(cache.get(prefix_path, file_stamps).has_value());
+}
+
+TEST_F(BottleDetailsCacheTest, RetainRemovesDeletedBottles)
+{
+  BottleDetailsCache cache(cache_file_path);
+  std::vector<std::string> file_stamps = BottleDetailsCache::get_file_stamps(prefix_path);
+  cache.put(create_details(), file_stamps);
+
+  cache.retain({test_dir + "/prefixes/bottle2"});
+  EXPECT_FALSE(cache.get(prefix_path, file_stamps).has_value());
+}
+
+TEST_F(BottleDetailsCacheTest, IsSourceFile)
+{
+  EXPECT_TRUE(BottleDetailsCache::is_source_file("user.reg"));
+  EXPECT_TRUE(BottleDetailsCache::is_source_file("winegui.ini"));
+  EXPECT_FALSE(BottleDetailsCache::is_source_file("userdef.reg"));
+  EXPECT_FALSE(BottleDetailsCache::is_source_file("reg1a2b.tmp"));
+}
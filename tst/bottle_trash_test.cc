@@ -0,0 +1,88 @@
+#include "bottle_trash.h"
+#include <filesystem>
+#include <fstream>
+#include <gtest/gtest.h>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+
+class BottleTrashTest : public ::testing::Test
+{
+protected:
+  fs::path location_;
+
+  void SetUp() override
+  {
+    location_ = fs::temp_directory_path() / ("winegui_bottle_trash_test_" + std::to_string(getpid()));
+    fs::create_directories(location_);
+  }
+
+  void TearDown() override
+  {
+    fs::remove_all(location_);
+  }
+
+  fs::path create_bottle(const std::string& name)
+  {
+    fs::path prefix = location_ / name;
+    for (int dir = 0; dir < 5; ++dir)
+    {
+      fs::create_directories(prefix / "drive_c" / std::to_string(dir) / "sub");
+      for (int file = 0; file < 20; ++file)
+        std::ofstream(prefix / "drive_c" / std::to_string(dir) / (std::to_string(file) + ".dll")) << file;
+    }
+    fs::create_directories(prefix / "dosdevices");
+    fs::create_symlink("../drive_c", prefix / "dosdevices" / "c:");
+    // Symbolic link to a folder outside the bottle, which should never be followed
+    fs::create_directories(location_ / "outside");
+    std::ofstream(location_ / "outside" / "keep.txt") << "keep";
+    fs::create_directory_symlink(location_ / "outside", prefix / "dosdevices" / "d:");
+    return prefix;
+  }
+};
+
+TEST_F(BottleTrashTest, MoveToTrash)
+{
+  fs::path prefix = create_bottle("bottle");
+  std::string trash_path = BottleTrash::move_to_trash(prefix.string());
+  EXPECT_FALSE(fs::exists(prefix));
+  EXPECT_EQ(fs::path(trash_path).parent_path(), location_ / BottleTrash::TrashDirName);
+  EXPECT_TRUE(fs::exists(fs::path(trash_path) / "drive_c" / "0" / "0.dll"));
+  // The same name can be deleted again
+  create_bottle("bottle");
+  EXPECT_NE(BottleTrash::move_to_trash(prefix.string()), trash_path);
+  EXPECT_THROW(BottleTrash::move_to_trash((location_ / "missing").string()), std::runtime_error);
+}
+
+TEST_F(BottleTrashTest, RemoveTree)
+{
+  fs::path prefix = create_bottle("bottle");
+  fs::permissions(prefix / "drive_c" / "1", fs::perms::owner_read | fs::perms::owner_exec);
+  std::atomic<bool> cancel{false};
+  EXPECT_TRUE(BottleTrash::remove_tree(prefix.string(), 4, cancel));
+  EXPECT_FALSE(fs::exists(prefix));
+  EXPECT_EQ(fs::file_size(location_ / "outside" / "keep.txt"), 4u);
+  EXPECT_TRUE(BottleTrash::remove_tree((location_ / "missing").string(), 4, cancel));
+}
+
+TEST_F(BottleTrashTest, RemoveInBackground)
+{
+  fs::path prefix = create_bottle("bottle");
+  BottleTrash trash(2);
+  trash.remove(prefix.string());
+  EXPECT_FALSE(fs::exists(prefix));
+  trash.wait_until_idle();
+  EXPECT_TRUE(fs::is_empty(location_ / BottleTrash::TrashDirName));
+}
+
+TEST_F(BottleTrashTest, SweepLeftovers)
+{
+  BottleTrash::move_to_trash(create_bottle("first").string());
+  BottleTrash::move_to_trash(create_bottle("second").string());
+  BottleTrash trash(2);
+  trash.sweep(location_.string());
+  trash.sweep((location_ / "no-trash").string());
+  trash.wait_until_idle();
+  EXPECT_TRUE(fs::is_empty(location_ / BottleTrash::TrashDirName));
+  EXPECT_TRUE(fs::exists(location_ / "outside" / "keep.txt"));
+}
@@ -0,0 +1,104 @@
+#include "download_cache.h"
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <gtest/gtest.h>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+
+class DownloadCacheTest : public ::testing::Test
+{
+protected:
+  fs::path location_;
+
+  void SetUp() override
+  {
+    location_ = fs::temp_directory_path() / ("winegui_download_cache_test_" + std::to_string(getpid()));
+    fs::create_directories(location_);
+  }
+
+  void TearDown() override
+  {
+    fs::remove_all(location_);
+  }
+
+  // Downloaded file of the given size (in the cache directory, like a .part file)
+  std::string create_download(const std::string& name, std::size_t size)
+  {
+    fs::create_directories(location_ / "cache");
+    fs::path path = location_ / "cache" / (name + ".part");
+    std::ofstream(path, std::ios::binary) << std::string(size, 'x');
+    return path.string();
+  }
+
+  static std::string digest(char character)
+  {
+    return std::string(64, character);
+  }
+};
+
+TEST_F(DownloadCacheTest, IsDigest)
+{
+  EXPECT_TRUE(DownloadCache::is_digest(digest('a')));
+  EXPECT_TRUE(DownloadCache::is_digest(std::string(128, '0')));
+  EXPECT_FALSE(DownloadCache::is_digest(""));
+  EXPECT_FALSE(DownloadCache::is_digest(std::string(64, 'A')));
+  EXPECT_FALSE(DownloadCache::is_digest("../" + std::string(61, 'a')));
+}
+
+TEST_F(DownloadCacheTest, StoreAndFind)
+{
+  DownloadCache cache((location_ / "cache").string(), 1000);
+  EXPECT_EQ(cache.get_part_path("wine-11.13-amd64.tar.xz"), (location_ / "cache" / "wine-11.13-amd64.tar.xz.part").string());
+  EXPECT_FALSE(cache.find_digest("wine-11.13-amd64.tar.xz").has_value());
+  cache.store("wine-11.13-amd64.tar.xz", digest('a'), create_download("wine-11.13-amd64.tar.xz", 100));
+  EXPECT_FALSE(fs::exists(cache.get_part_path("wine-11.13-amd64.tar.xz")));
+  // Found again by another instance (eg. after a restart), without any network access
+  DownloadCache other_cache((location_ / "cache").string(), 1000);
+  EXPECT_EQ(other_cache.find_digest("wine-11.13-amd64.tar.xz"), digest('a'));
+  EXPECT_EQ(other_cache.get_file_path(digest('a')), (location_ / "cache" / digest('a')).string());
+  EXPECT_FALSE(other_cache.get_file_path(digest('b')).has_value());
+  EXPECT_EQ(other_cache.get_size(), 100u);
+  EXPECT_THROW(cache.store("evil.tar.xz", "../evil", create_download("evil.tar.xz", 1)), std::runtime_error);
+}
+
+TEST_F(DownloadCacheTest, Remove)
+{
+  DownloadCache cache((location_ / "cache").string(), 1000);
+  cache.store("wine-11.13-amd64.tar.xz", digest('a'), create_download("wine-11.13-amd64.tar.xz", 100));
+  cache.remove(digest('a'));
+  EXPECT_FALSE(cache.find_digest("wine-11.13-amd64.tar.xz").has_value());
+  EXPECT_FALSE(fs::exists(location_ / "cache" / digest('a')));
+}
+
+TEST_F(DownloadCacheTest, EvictLeastRecentlyUsed)
+{
+  DownloadCache cache((location_ / "cache").string(), 250);
+  cache.store("a.tar.xz", digest('a'), create_download("a.tar.xz", 100));
+  cache.store("b.tar.xz", digest('b'), create_download("b.tar.xz", 100));
+  auto now = fs::file_time_type::clock::now();
+  fs::last_write_time(location_ / "cache" / digest('a'), now - std::chrono::hours(2));
+  fs::last_write_time(location_ / "cache" / digest('b'), now - std::chrono::hours(1));
+  // Using an archive makes it the most recently used one
+  EXPECT_TRUE(cache.get_file_path(digest('a')).has_value());
+  cache.store("c.tar.xz", digest('c'), create_download("c.tar.xz", 100));
+  EXPECT_EQ(cache.find_digest("a.tar.xz"), digest('a'));
+  EXPECT_FALSE(cache.find_digest("b.tar.xz").has_value());
+  EXPECT_EQ(cache.find_digest("c.tar.xz"), digest('c'));
+  // A single archive larger than the maximum size is still kept
+  cache.store("d.tar.xz", digest('d'), create_download("d.tar.xz", 300));
+  EXPECT_EQ(cache.find_digest("d.tar.xz"), digest('d'));
+  EXPECT_EQ(cache.get_size(), 300u);
+}
+
+TEST_F(DownloadCacheTest, RemoveAbandonedDownloads)
+{
+  DownloadCache cache((location_ / "cache").string(), 1000);
+  std::string part_path = create_download("old.tar.xz", 10);
+  fs::last_write_time(part_path, fs::file_time_type::clock::now() - std::chrono::hours(24 * 30));
+  std::string recent_part_path = create_download("recent.tar.xz", 10);
+  cache.store("a.tar.xz", digest('a'), create_download("a.tar.xz", 100));
+  EXPECT_FALSE(fs::exists(part_path));
+  EXPECT_TRUE(fs::exists(recent_part_path));
+}
@@ -1,9 +1,11 @@
 #include <gtest/gtest.h>
 #include <filesystem>
 #include <fstream>
+#include <stdexcept>
 #include <glibmm/miscutils.h>
 #include <giomm/init.h>
 #include "helper.h"
+#include "wine_version_cache.h"
 
 namespace fs = std::filesystem;
 
@@ -431,6 +433,96 @@ TEST_F(HelperTest, GetCLetterDriveMissingDosdevices) {
   EXPECT_THROW(Helper::get_c_letter_drive(prefix), std::runtime_error);
 }
 
+// Test registry lookups (user.reg / system.reg)
+static void write_reg_file(const std::string& file_path, const std::string& contents) {
+  std::ofstream file(file_path);
+  file << "WINE REGISTRY Version 2\n"
+       << ";; All keys relative to \\\\User\\\\S-1-5-21-0-0-0-1000\n\n"
+       << "#arch=win64\n\n"
+       << contents;
+  file.close();
+}
+
+TEST_F(HelperTest, GetWindowsBitnessFromRegistryHeader) {
+  std::string prefix = test_dir + "/reg_bitness_prefix";
+  fs::create_directories(prefix);
+  write_reg_file(prefix + "/user.reg", "[Software\\\\Wine] 1700000000\n#time=1da0000\n\"Version\"=\"win10\"\n\n");
+  EXPECT_EQ(Helper::get_windows_bitness(prefix), BottleTypes::Bit::win64);
+}
+
+TEST_F(HelperTest, GetAudioDriverFromKey) {
+  std::string prefix = test_dir + "/reg_audio_prefix";
+  fs::create_directories(prefix);
+  write_reg_file(prefix + "/user.reg",
+                 "[Software\\\\Wine] 1700000000\n\"Version\"=\"win10\"\n\n"
+                 "[Software\\\\Wine\\\\Drivers] 1700000000\n#time=1da0000\n\"Audio\"=\"alsa\"\n\n");
+  EXPECT_EQ(Helper::get_audio_driver(prefix), BottleTypes::AudioDriver::alsa);
+}
+
+TEST_F(HelperTest, GetAudioDriverIgnoresValueOfOtherKey) {
+  std::string prefix = test_dir + "/reg_audio_other_key_prefix";
+  fs::create_directories(prefix);
+  // The Audio value belongs to another key, so the default (PulseAudio) should be returned
+  write_reg_file(prefix + "/user.reg",
+                 "[Software\\\\Wine\\\\Drivers] 1700000000\n\n"
+                 "[Software\\\\Wine\\\\Other] 1700000000\n\"Audio\"=\"alsa\"\n\n");
+  EXPECT_EQ(Helper::get_audio_driver(prefix), BottleTypes::AudioDriver::pulseaudio);
+}
+
+TEST_F(HelperTest, GetVirtualDesktopResolution) {
+  std::string prefix = test_dir + "/reg_desktop_prefix";
+  fs::create_directories(prefix);
+  write_reg_file(prefix + "/user.reg",
+                 "[Software\\\\Wine\\\\Explorer] 1700000000\n\"Desktop\"=\"Default\"\n\n"
+                 "[Software\\\\Wine\\\\Explorer\\\\Desktops] 1700000000\n\"Default\"=\"1024x768\"\n\n");
+  EXPECT_EQ(Helper::get_virtual_desktop(prefix), "1024x768");
+}
+
+TEST_F(HelperTest, GetVirtualDesktopDisabled) {
+  std::string prefix = test_dir + "/reg_desktop_disabled_prefix";
+  fs::create_directories(prefix);
+  write_reg_file(prefix + "/user.reg", "[Software\\\\Wine\\\\Explorer\\\\Desktops] 1700000000\n\"Default\"=\"1024x768\"\n\n");
+  EXPECT_EQ(Helper::get_virtual_desktop(prefix), "");
+}
+
+TEST_F(HelperTest, GetUninstallerByKeyPrefix) {
+  std::string prefix = test_dir + "/reg_uninstaller_prefix";
+  fs::create_directories(prefix);
+  write_reg_file(prefix + "/system.reg",
+                 "[Software\\\\Microsoft\\\\Windows\\\\CurrentVersion\\\\Uninstall\\\\{1D8E6291-B0D5-35EC-8441-6616F567A0F7}] 1700000000\n"
+                 "\"DisplayName\"=\"Microsoft Visual C++ 2010  x64 Redistributable - 10.0.40219\"\n\n");
+  EXPECT_EQ(Helper::get_uninstaller(prefix, "{1D8E6291-B0D5-35EC-8441-6616F567A0F7}"),
+            "Microsoft Visual C++ 2010  x64 Redistributable - 10.0.40219");
+  EXPECT_EQ(Helper::get_uninstaller(prefix, "{00000000-0000-0000-0000-000000000000}"), "");
+}
+
+TEST_F(HelperTest, HasUninstallerDisplayNamePrefix) {
+  std::string prefix = test_dir + "/reg_uninstaller_display_name_prefix";
+  fs::create_directories(prefix);
+  write_reg_file(prefix + "/system.reg",
+                 "[Software\\\\Microsoft\\\\Windows\\\\CurrentVersion\\\\Uninstall\\\\Wine Gecko] 1700000000\n"
+                 "\"DisplayName\"=\"Wine Gecko\"\n\n"
+                 "[Software\\\\Microsoft\\\\Windows\\\\CurrentVersion\\\\Uninstall\\\\{F0C3E5D1-1ADE-321E-8167-68EF0DE699A5}] 1700000000\n"
+                 "\"DisplayName\"=\"Microsoft Visual C++ 2010  x86 Redistributable - 10.0.40219\"\n\n");
+  EXPECT_TRUE(Helper::has_uninstaller_display_name_prefix(prefix, "Microsoft Visual C++ 2010"));
+  EXPECT_FALSE(Helper::has_uninstaller_display_name_prefix(prefix, "Microsoft Visual C++ 2015"));
+}
+
+TEST_F(HelperTest, RegistryLookupEmptyFile) {
+  std::string prefix = test_dir + "/reg_empty_prefix";
+  fs::create_directories(prefix);
+  std::ofstream file(prefix + "/user.reg");
+  file.close();
+  EXPECT_EQ(Helper::get_audio_driver(prefix), BottleTypes::AudioDriver::pulseaudio);
+  EXPECT_THROW(Helper::get_windows_bitness(prefix), std::runtime_error);
+}
+
+TEST_F(HelperTest, RegistryLookupMissingFileThrows) {
+  std::string prefix = test_dir + "/reg_missing_prefix";
+  fs::create_directories(prefix);
+  EXPECT_THROW(Helper::get_audio_driver(prefix), std::runtime_error);
+}
+
 // Test get_image_location function
 TEST_F(HelperTest, GetImageLocationNotFound) {
   // Test with a filename that doesn't exist
@@ -540,3 +632,66 @@ TEST_F(HelperTest, ToFilenamePartKeepsDashAndUnderscore) {
 TEST_F(HelperTest, ToFilenamePartEmptyFallback) {
   EXPECT_EQ(Helper::to_filename_part("***"), "shortcut");
 }
+
+// Test WineVersionCache class
+
+static std::string write_fake_wine_binary(const std::string& path, const std::string& contents) {
+  std::ofstream file(path);
+  file << contents;
+  file.close();
+  fs::permissions(path, fs::perms::owner_all);
+  return path;
+}
+
+TEST_F(HelperTest, WineVersionCacheProbesEachBinaryOnce) {
+  std::string wine = write_fake_wine_binary(test_dir + "/wine", "#!/bin/sh\necho wine-9.0\n");
+  WineVersionCache cache(test_dir + "/wine_versions.ini");
+  int probe_count = 0;
+  auto probe = [&probe_count](const std::string&) {
+    probe_count++;
+    return std::string("9.0");
+  };
+  EXPECT_EQ(cache.get_version(wine, probe), "9.0");
+  EXPECT_EQ(cache.get_version(wine, probe), "9.0");
+  EXPECT_EQ(probe_count, 1);
+}
+
+TEST_F(HelperTest, WineVersionCacheIsPersisted) {
+  std::string wine = write_fake_wine_binary(test_dir + "/wine", "#!/bin/sh\necho wine-9.0\n");
+  int probe_count = 0;
+  auto probe = [&probe_count](const std::string&) {
+    probe_count++;
+    return std::string("9.0");
+  };
+  {
+    WineVersionCache cache(test_dir + "/wine_versions.ini");
+    EXPECT_EQ(cache.get_version(wine, probe), "9.0");
+  }
+  WineVersionCache reloaded_cache(test_dir + "/wine_versions.ini");
+  EXPECT_EQ(reloaded_cache.get_version(wine, probe), "9.0");
+  EXPECT_EQ(probe_count, 1);
+}
+
+TEST_F(HelperTest, WineVersionCacheProbesAgainWhenBinaryChanged) {
+  std::string wine = write_fake_wine_binary(test_dir + "/wine", "#!/bin/sh\necho wine-9.0\n");
+  WineVersionCache cache(test_dir + "/wine_versions.ini");
+  EXPECT_EQ(cache.get_version(wine, [](const std::string&) { return std::string("9.0"); }), "9.0");
+  // Upgrade: the binary is replaced by a new file
+  fs::remove(wine);
+  write_fake_wine_binary(wine, "#!/bin/sh\necho wine-10.0-rc1\n");
+  EXPECT_EQ(cache.get_version(wine, [](const std::string&) { return std::string("10.0"); }), "10.0");
+}
+
+TEST_F(HelperTest, WineVersionCacheDoesNotCacheFailures) {
+  std::string wine = write_fake_wine_binary(test_dir + "/wine", "#!/bin/sh\nexit 1\n");
+  WineVersionCache cache(test_dir + "/wine_versions.ini");
+  EXPECT_THROW(cache.get_version(wine, [](const std::string&) -> std::string { throw std::runtime_error("No output"); }), std::runtime_error);
+  EXPECT_EQ(cache.get_version(wine, [](const std::string&) { return std::string("9.0"); }), "9.0");
+}
+
+TEST_F(HelperTest, WineVersionCacheResolvesSymlinks) {
+  std::string wine = write_fake_wine_binary(test_dir + "/wine-stable", "#!/bin/sh\necho wine-9.0\n");
+  fs::create_symlink(wine, test_dir + "/wine");
+  EXPECT_EQ(WineVersionCache::resolve_executable(test_dir + "/wine"), fs::canonical(wine).string());
+  EXPECT_EQ(WineVersionCache::resolve_executable(test_dir + "/missing-wine"), "");
+}
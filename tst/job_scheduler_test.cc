@@ -0,0 +1,190 @@
+#include "job_scheduler.h"
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <gtest/gtest.h>
+#include <latch>
+#include <stdexcept>
+#include <thread>
+
+using namespace std::chrono_literals;
+
+/**
+ * \brief Keeps track of the maximum number of jobs that run at the same time
+ */
+struct ConcurrencyCounter
+{
+  std::atomic<int> running = 0;
+  std::atomic<int> max_running = 0;
+
+  void run()
+  {
+    int count = ++running;
+    int max = max_running;
+    while (count > max && !max_running.compare_exchange_weak(max, count))
+    {
+    }
+    std::this_thread::sleep_for(10ms);
+    --running;
+  }
+};
+
+TEST(JobSchedulerTest, RunAllJobs)
+{
+  std::atomic<int> count = 0;
+  JobScheduler scheduler(4, nullptr);
+  for (int i = 0; i < 20; ++i)
+  {
+    scheduler.submit("Job", "/bottle" + std::to_string(i % 3), JobScheduler::Lock::Shared, [&count] { ++count; });
+  }
+  scheduler.wait_until_idle();
+  EXPECT_EQ(count, 20);
+  EXPECT_TRUE(scheduler.get_jobs().empty());
+}
+
+TEST(JobSchedulerTest, WorkerPoolIsBounded)
+{
+  ConcurrencyCounter counter;
+  JobScheduler scheduler(2, nullptr);
+  for (int i = 0; i < 8; ++i)
+  {
+    scheduler.submit("Install", "/bottle" + std::to_string(i), JobScheduler::Lock::Exclusive, [&counter] { counter.run(); });
+  }
+  scheduler.wait_until_idle();
+  EXPECT_LE(counter.max_running, 2);
+}
+
+TEST(JobSchedulerTest, ExclusiveJobsOfSameBottleAreSerialized)
+{
+  ConcurrencyCounter counter;
+  JobScheduler scheduler(4, nullptr);
+  for (int i = 0; i < 6; ++i)
+  {
+    scheduler.submit("Install", "/bottle", JobScheduler::Lock::Exclusive, [&counter] { counter.run(); });
+    scheduler.submit("Run", "/bottle", JobScheduler::Lock::Shared, [&counter] { counter.run(); });
+  }
+  scheduler.wait_until_idle();
+  EXPECT_EQ(counter.max_running, 1);
+}
+
+TEST(JobSchedulerTest, DifferentBottlesRunInParallel)
+{
+  // Both jobs need to run at the same time, in order to finish
+  std::latch both_running(2);
+  JobScheduler scheduler(2, nullptr);
+  scheduler.submit("Install", "/bottle1", JobScheduler::Lock::Exclusive, [&both_running] { both_running.arrive_and_wait(); });
+  scheduler.submit("Install", "/bottle2", JobScheduler::Lock::Exclusive, [&both_running] { both_running.arrive_and_wait(); });
+  scheduler.wait_until_idle();
+  SUCCEED();
+}
+
+TEST(JobSchedulerTest, UnlockedJobRunsNextToExclusiveJob)
+{
+  std::latch both_running(2);
+  JobScheduler scheduler(2, nullptr);
+  scheduler.submit("Install", "/bottle", JobScheduler::Lock::Exclusive, [&both_running] { both_running.arrive_and_wait(); });
+  scheduler.submit("Kill processes", "/bottle", JobScheduler::Lock::None, [&both_running] { both_running.arrive_and_wait(); });
+  scheduler.wait_until_idle();
+  SUCCEED();
+}
+
+TEST(JobSchedulerTest, JobsOfSameBottleKeepSubmitOrder)
+{
+  std::vector<int> order;
+  std::mutex order_mutex;
+  JobScheduler scheduler(4, nullptr);
+  for (int i = 0; i < 5; ++i)
+  {
+    scheduler.submit("Install", "/bottle", JobScheduler::Lock::Exclusive,
+                     [i, &order, &order_mutex]
+                     {
+                       std::lock_guard<std::mutex> lock(order_mutex);
+                       order.push_back(i);
+                     });
+  }
+  scheduler.wait_until_idle();
+  EXPECT_EQ(order, std::vector<int>({0, 1, 2, 3, 4}));
+}
+
+TEST(JobSchedulerTest, LaunchedJobDoesNotBlockTheBottle)
+{
+  auto release = std::make_shared<std::promise<void>>();
+  std::shared_future<void> released = release->get_future().share();
+  std::latch started(1);
+  bool is_install_run = false;
+  {
+    JobScheduler scheduler(1, nullptr);
+    scheduler.launch("Run program", "/bottle", [&started, released]
+                     {
+                       started.count_down();
+                       released.wait();
+                     });
+    started.wait();
+    // The only worker and the bottle are still available
+    scheduler.submit("Install", "/bottle", JobScheduler::Lock::Exclusive, [&is_install_run] { is_install_run = true; });
+    scheduler.wait_until_idle();
+    EXPECT_TRUE(scheduler.has_running_jobs("/bottle"));
+    EXPECT_FALSE(scheduler.has_running_jobs("/other_bottle"));
+    std::vector<JobScheduler::JobInfo> jobs = scheduler.get_jobs();
+    ASSERT_EQ(jobs.size(), 1u);
+    EXPECT_EQ(jobs[0].name, "Run program");
+    EXPECT_EQ(jobs[0].state, JobScheduler::State::Running);
+  }
+  // The scheduler is destroyed without waiting for the launched job
+  EXPECT_TRUE(is_install_run);
+  release->set_value();
+}
+
+TEST(JobSchedulerTest, CancelAndListJobs)
+{
+  std::promise<void> release;
+  std::shared_future<void> released = release.get_future().share();
+  std::latch started(1);
+  bool is_cancelled_job_run = false;
+  int cancelled_count = 0;
+  JobScheduler scheduler(1, nullptr);
+  std::size_t first = scheduler.submit(
+      "Install DXVK", "/bottle", JobScheduler::Lock::Exclusive,
+      [&started, released]
+      {
+        started.count_down();
+        released.wait();
+      },
+      [&cancelled_count] { ++cancelled_count; });
+  std::size_t second = scheduler.submit(
+      "Install VKD3D", "/bottle", JobScheduler::Lock::Exclusive, [&is_cancelled_job_run] { is_cancelled_job_run = true; },
+      [&cancelled_count] { ++cancelled_count; });
+  started.wait();
+
+  std::vector<JobScheduler::JobInfo> jobs = scheduler.get_jobs();
+  ASSERT_EQ(jobs.size(), 2u);
+  EXPECT_EQ(jobs[0].id, first);
+  EXPECT_EQ(jobs[0].state, JobScheduler::State::Running);
+  EXPECT_EQ(jobs[1].id, second);
+  EXPECT_EQ(jobs[1].name, "Install VKD3D");
+  EXPECT_EQ(jobs[1].state, JobScheduler::State::Queued);
+
+  EXPECT_FALSE(scheduler.cancel(first)); // Already running
+  EXPECT_TRUE(scheduler.cancel(second));
+  EXPECT_EQ(cancelled_count, 1);
+  release.set_value();
+  scheduler.wait_until_idle();
+  EXPECT_FALSE(is_cancelled_job_run);
+}
+
+TEST(JobSchedulerTest, JobsChangedCallback)
+{
+  std::atomic<int> changes = 0;
+  {
+    JobScheduler scheduler(1, [&changes] { ++changes; });
+    scheduler.submit("Reboot", "/bottle", JobScheduler::Lock::Exclusive, [] {});
+    scheduler.wait_until_idle();
+  }
+  // Queued, started & finished
+  EXPECT_GE(changes, 3);
+}
+
+TEST(JobSchedulerTest, ZeroWorkers)
+{
+  EXPECT_THROW(JobScheduler scheduler(0, nullptr), std::invalid_argument);
+}
@@ -0,0 +1,99 @@
+#include "log_writer.h"
+#include "output_ring_buffer.h"
+#include <filesystem>
+#include <fstream>
+#include <gtest/gtest.h>
+#include <sstream>
+
+namespace fs = std::filesystem;
+
+class LogWriterTest : public ::testing::Test
+{
+protected:
+  std::string prefix_path;
+
+  void SetUp() override
+  {
+    prefix_path = fs::temp_directory_path() / "winegui_log_writer_test";
+    fs::create_directories(prefix_path);
+  }
+
+  void TearDown() override
+  {
+    if (fs::exists(prefix_path))
+    {
+      fs::remove_all(prefix_path);
+    }
+  }
+
+  static std::string read_file(const std::string& file_path)
+  {
+    std::ifstream file(file_path);
+    std::stringstream contents;
+    contents << file.rdbuf();
+    return contents.str();
+  }
+};
+
+TEST_F(LogWriterTest, WriteOutputOfMultiplePrograms)
+{
+  {
+    LogWriter log_writer(1024, 1);
+    auto first = std::make_shared<OutputRingBuffer>(64);
+    auto second = std::make_shared<OutputRingBuffer>(64);
+    log_writer.add_output(prefix_path, first);
+    log_writer.add_output(prefix_path, second);
+    // Both programs exit at the same time
+    first->write("first program\n");
+    second->write("second program");
+    first->close();
+    second->close();
+    log_writer.notify();
+  }
+  // A new line is added to the output of the second program
+  EXPECT_EQ(read_file(prefix_path + "/winegui.log"), "first program\nsecond program\n");
+}
+
+TEST_F(LogWriterTest, AppendToExistingLogFile)
+{
+  std::ofstream(prefix_path + "/winegui.log") << "previous run\n";
+  {
+    LogWriter log_writer(1024, 1);
+    auto output = std::make_shared<OutputRingBuffer>(64);
+    log_writer.add_output(prefix_path, output);
+    output->write("next run\n");
+    output->close();
+    log_writer.notify();
+  }
+  EXPECT_EQ(read_file(prefix_path + "/winegui.log"), "previous run\nnext run\n");
+}
+
+TEST_F(LogWriterTest, RotateLogFile)
+{
+  std::ofstream(prefix_path + "/winegui.log") << "oldest\n";
+  std::ofstream(prefix_path + "/winegui.log.1") << "older\n";
+  {
+    LogWriter log_writer(10, 2);
+    auto output = std::make_shared<OutputRingBuffer>(64);
+    log_writer.add_output(prefix_path, output);
+    output->write("newest\n");
+    output->close();
+    log_writer.notify();
+  }
+  EXPECT_EQ(read_file(prefix_path + "/winegui.log"), "newest\n");
+  EXPECT_EQ(read_file(prefix_path + "/winegui.log.1"), "oldest\n");
+  EXPECT_EQ(read_file(prefix_path + "/winegui.log.2"), "older\n");
+}
+
+TEST_F(LogWriterTest, SkippedOutput)
+{
+  {
+    LogWriter log_writer(1024, 1);
+    auto output = std::make_shared<OutputRingBuffer>(4);
+    log_writer.add_output(prefix_path, output);
+    output->write("123456\n");
+    output->close();
+    log_writer.notify();
+  }
+  EXPECT_EQ(read_file(prefix_path + "/winegui.log"), "[WineGUI] 3 bytes of output skipped\n456\n");
+}
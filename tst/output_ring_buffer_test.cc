@@ -0,0 +1,68 @@
+#include "output_ring_buffer.h"
+#include <gtest/gtest.h>
+#include <stdexcept>
+
+TEST(OutputRingBufferTest, WriteAndRead)
+{
+  OutputRingBuffer buffer(16);
+  EXPECT_TRUE(buffer.write("hello "));
+  EXPECT_FALSE(buffer.write("world"));
+  std::string output;
+  EXPECT_EQ(buffer.read(output), 0u);
+  EXPECT_EQ(output, "hello world");
+  // Buffer is empty again after a read
+  output.clear();
+  EXPECT_EQ(buffer.read(output), 0u);
+  EXPECT_TRUE(output.empty());
+  EXPECT_TRUE(buffer.write("again"));
+}
+
+TEST(OutputRingBufferTest, WrapAround)
+{
+  OutputRingBuffer buffer(8);
+  buffer.write("123456");
+  std::string output;
+  buffer.read(output);
+  buffer.write("abcdef");
+  output.clear();
+  EXPECT_EQ(buffer.read(output), 0u);
+  EXPECT_EQ(output, "abcdef");
+}
+
+TEST(OutputRingBufferTest, OverflowDropsOldestOutput)
+{
+  OutputRingBuffer buffer(8);
+  buffer.write("123456");
+  buffer.write("abcde");
+  std::string output;
+  EXPECT_EQ(buffer.read(output), 3u);
+  EXPECT_EQ(output, "456abcde");
+}
+
+TEST(OutputRingBufferTest, WriteLargerThanCapacity)
+{
+  OutputRingBuffer buffer(4);
+  buffer.write("12");
+  buffer.write("abcdefgh");
+  std::string output;
+  EXPECT_EQ(buffer.read(output), 6u);
+  EXPECT_EQ(output, "efgh");
+}
+
+TEST(OutputRingBufferTest, Close)
+{
+  OutputRingBuffer buffer(8);
+  buffer.write("last");
+  EXPECT_FALSE(buffer.is_closed());
+  buffer.close();
+  EXPECT_TRUE(buffer.is_closed());
+  // Remaining output can still be read
+  std::string output;
+  buffer.read(output);
+  EXPECT_EQ(output, "last");
+}
+
+TEST(OutputRingBufferTest, ZeroCapacity)
+{
+  EXPECT_THROW(OutputRingBuffer buffer(0), std::invalid_argument);
+}
@@ -0,0 +1,134 @@
+#include "prefix_templates.h"
+#include <filesystem>
+#include <fstream>
+#include <gtest/gtest.h>
+#include <sstream>
+#include <thread>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+
+static std::string read_file(const fs::path& path)
+{
+  std::ifstream file(path);
+  std::stringstream buffer;
+  buffer << file.rdbuf();
+  return buffer.str();
+}
+
+class PrefixTemplatesTest : public ::testing::Test
+{
+protected:
+  fs::path test_dir_;
+  fs::path wine_bin_path_;
+
+  void SetUp() override
+  {
+    test_dir_ = fs::temp_directory_path() / ("winegui_prefix_templates_test_" + std::to_string(getpid()));
+    wine_bin_path_ = test_dir_ / "bin";
+    fs::create_directories(wine_bin_path_);
+    // Fake Wine, 'wineboot' writes a registry file with the prefix path & counts the number of runs
+    fs::path wine = wine_bin_path_ / "wine";
+    std::ofstream script(wine);
+    script << "#!/bin/sh\n"
+              "if [ \"$1\" = \"--version\" ]; then echo wine-9.0; exit 0; fi\n"
+              "mkdir -p \"$WINEPREFIX/dosdevices\"\n"
+              "ln -s ../drive_c \"$WINEPREFIX/dosdevices/c:\"\n"
+              "mkdir -p \"$WINEPREFIX/drive_c\"\n"
+              "printf '\"Path\"=\"%s\"\\n' \"$WINEPREFIX\" > \"$WINEPREFIX/system.reg\"\n"
+              "echo run >> \""
+           << (test_dir_ / "wineboot_runs").string() << "\"\n";
+    script.close();
+    fs::permissions(wine, fs::perms::owner_all);
+  }
+
+  void TearDown() override
+  {
+    fs::remove_all(test_dir_);
+  }
+};
+
+TEST_F(PrefixTemplatesTest, TemplateName)
+{
+  std::string name = PrefixTemplates::get_template_name("/usr/bin/wine", "9.0", BottleTypes::Bit::win64, false);
+  EXPECT_EQ(name, PrefixTemplates::get_template_name("/usr/bin/wine", "9.0", BottleTypes::Bit::win64, false));
+  EXPECT_NE(name, PrefixTemplates::get_template_name("/usr/bin/wine", "9.0", BottleTypes::Bit::win32, false));
+  EXPECT_NE(name, PrefixTemplates::get_template_name("/usr/bin/wine", "9.0", BottleTypes::Bit::win64, true));
+  EXPECT_NE(name, PrefixTemplates::get_template_name("/usr/bin/wine", "9.1", BottleTypes::Bit::win64, false));
+  EXPECT_NE(name, PrefixTemplates::get_template_name("/opt/wine/bin/wine", "9.0", BottleTypes::Bit::win64, false));
+}
+
+TEST_F(PrefixTemplatesTest, FixUserPaths)
+{
+  fs::path prefix = test_dir_ / "prefix";
+  fs::create_directories(prefix);
+  std::ofstream(prefix / "user.reg") << "\"A\"=\"/tmp/templates/t1/drive_c\"\n\"B\"=\"Z:\\\\tmp\\\\templates\\\\t1\\\\drive_c\"\n";
+  // Missing registry files are skipped
+  PrefixTemplates::fix_user_paths("/tmp/templates/t1", "/home/user/bottles/my");
+  PrefixTemplates::fix_user_paths("/tmp/templates/t1", prefix.string());
+  std::string expected_unix = prefix.string();
+  std::string expected_registry = "Z:" + prefix.string();
+  for (std::size_t pos = expected_registry.find('/'); pos != std::string::npos; pos = expected_registry.find('/', pos + 2))
+    expected_registry.replace(pos, 1, "\\\\");
+  EXPECT_EQ(read_file(prefix / "user.reg"), "\"A\"=\"" + expected_unix + "/drive_c\"\n\"B\"=\"" + expected_registry + "\\\\drive_c\"\n");
+}
+
+TEST_F(PrefixTemplatesTest, RegenerateMachineIds)
+{
+  fs::path prefix = test_dir_ / "prefix";
+  fs::create_directories(prefix);
+  std::string old_guid = "5b8f4bd6-2c3a-4e1f-9d7b-0a1b2c3d4e5f";
+  std::ofstream(prefix / "system.reg") << "WINE REGISTRY Version 2\n\n"
+                                          "[Software\\\\Microsoft\\\\Cryptography] 1700000000\n"
+                                          "#time=1da0000000000000\n"
+                                          "\"MachineGuid\"=\""
+                                       << old_guid << "\"\n";
+  PrefixTemplates::regenerate_machine_ids(prefix.string());
+
+  std::string contents = read_file(prefix / "system.reg");
+  std::size_t pos = contents.find("\"MachineGuid\"=\"");
+  ASSERT_NE(pos, std::string::npos);
+  std::string new_guid = contents.substr(pos + 15, old_guid.size());
+  EXPECT_NE(new_guid, old_guid);
+  EXPECT_EQ(contents.substr(pos + 15 + new_guid.size()), "\"\n");
+  EXPECT_EQ(new_guid[8], '-');
+  EXPECT_EQ(new_guid[14], '4'); // Version 4
+}
+
+TEST_F(PrefixTemplatesTest, CreateBottlesFromTemplate)
+{
+  PrefixTemplates templates((test_dir_ / "templates").string());
+  fs::path first = test_dir_ / "first";
+  fs::path second = test_dir_ / "second";
+  templates.create_bottle(first.string(), BottleTypes::Bit::win64, false, wine_bin_path_.string());
+  templates.create_bottle(second.string(), BottleTypes::Bit::win64, false, wine_bin_path_.string());
+
+  // Only the template is created via wineboot
+  EXPECT_EQ(read_file(test_dir_ / "wineboot_runs"), "run\n");
+  EXPECT_EQ(read_file(second / "system.reg"), "\"Path\"=\"" + second.string() + "\"\n");
+  EXPECT_TRUE(fs::is_symlink(second / "dosdevices" / "c:"));
+  EXPECT_EQ(fs::read_symlink(second / "dosdevices" / "c:"), "../drive_c");
+
+  // Other settings use their own template
+  templates.create_bottle((test_dir_ / "third").string(), BottleTypes::Bit::win32, false, wine_bin_path_.string());
+  EXPECT_EQ(read_file(test_dir_ / "wineboot_runs"), "run\nrun\n");
+}
+
+TEST_F(PrefixTemplatesTest, CreateBottlesAtTheSameTime)
+{
+  PrefixTemplates templates((test_dir_ / "templates").string());
+  std::vector<std::thread> threads;
+  for (const char* name : {"first", "second", "third"})
+  {
+    threads.emplace_back([this, &templates, name]
+                         { templates.create_bottle((test_dir_ / name).string(), BottleTypes::Bit::win64, false, wine_bin_path_.string()); });
+  }
+  for (std::thread& thread : threads)
+  {
+    thread.join();
+  }
+
+  // The bottles wait for the template that is being built, instead of building it as well
+  EXPECT_EQ(read_file(test_dir_ / "wineboot_runs"), "run\n");
+  EXPECT_EQ(read_file(test_dir_ / "third" / "system.reg"), "\"Path\"=\"" + (test_dir_ / "third").string() + "\"\n");
+}
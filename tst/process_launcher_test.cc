@@ -0,0 +1,105 @@
+#include "process_launcher.h"
+#include <filesystem>
+#include <gtest/gtest.h>
+
+namespace fs = std::filesystem;
+
+TEST(ProcessLauncherTest, RunCapturesOutput)
+{
+  const auto& [exit_code, output] = ProcessLauncher::run({"echo", "hello world"});
+  EXPECT_EQ(exit_code, 0);
+  EXPECT_EQ(output, "hello world\n");
+}
+
+TEST(ProcessLauncherTest, RunReturnsExitCode)
+{
+  const auto& [exit_code, output] = ProcessLauncher::run({"sh", "-c", "exit 3"});
+  EXPECT_EQ(exit_code, 3);
+  EXPECT_TRUE(output.empty());
+}
+
+TEST(ProcessLauncherTest, RunProgramNotFound)
+{
+  const auto& [exit_code, output] = ProcessLauncher::run({"winegui-program-that-does-not-exist"}, {}, "", true);
+  EXPECT_EQ(exit_code, 127);
+  EXPECT_FALSE(output.empty());
+}
+
+TEST(ProcessLauncherTest, RunWithEnvironmentVariables)
+{
+  // Values are passed as-is, without any quoting
+  const auto& [exit_code, output] = ProcessLauncher::run({"printenv", "WINEPREFIX"}, {{"WINEPREFIX", "/tmp/my \"bottle\" $HOME"}});
+  EXPECT_EQ(exit_code, 0);
+  EXPECT_EQ(output, "/tmp/my \"bottle\" $HOME\n");
+}
+
+TEST(ProcessLauncherTest, RunWithWorkingDirectory)
+{
+  std::string working_directory = fs::canonical(fs::temp_directory_path()).string();
+  const auto& [exit_code, output] = ProcessLauncher::run({"pwd"}, {}, working_directory);
+  EXPECT_EQ(exit_code, 0);
+  EXPECT_EQ(output, working_directory + "\n");
+}
+
+TEST(ProcessLauncherTest, RunStderrOutput)
+{
+  const auto& [exit_code, output] = ProcessLauncher::run({"sh", "-c", "echo error >&2"}, {}, "", true);
+  EXPECT_EQ(exit_code, 0);
+  EXPECT_EQ(output, "error\n");
+  const auto& [exit_code2, output2] = ProcessLauncher::run({"sh", "-c", "echo error >&2"}, {}, "", false);
+  EXPECT_EQ(exit_code2, 0);
+  EXPECT_TRUE(output2.empty());
+}
+
+TEST(ProcessLauncherTest, RunLargeOutput)
+{
+  const auto& [exit_code, output] = ProcessLauncher::run({"head", "-c", "1000000", "/dev/zero"});
+  EXPECT_EQ(exit_code, 0);
+  EXPECT_EQ(output.size(), 1000000u);
+}
+
+TEST(ProcessLauncherTest, RunStreamsOutput)
+{
+  std::size_t output_size = 0;
+  int exit_code = ProcessLauncher::run({"head", "-c", "1000000", "/dev/zero"}, {}, "", false,
+                                       [&output_size](std::string_view output) { output_size += output.size(); });
+  EXPECT_EQ(exit_code, 0);
+  EXPECT_EQ(output_size, 1000000u);
+}
+
+TEST(ProcessLauncherTest, ParseCommand)
+{
+  std::vector<std::pair<std::string, std::string>> env_vars;
+  std::vector<std::string> argv = ProcessLauncher::parse_command("WINEDLLOVERRIDES=\"mscoree=b\" \"/opt/my wine/bin/wine\" wineboot -u", env_vars);
+  ASSERT_EQ(argv.size(), 3u);
+  EXPECT_EQ(argv[0], "/opt/my wine/bin/wine");
+  EXPECT_EQ(argv[1], "wineboot");
+  EXPECT_EQ(argv[2], "-u");
+  ASSERT_EQ(env_vars.size(), 1u);
+  EXPECT_EQ(env_vars[0].first, "WINEDLLOVERRIDES");
+  EXPECT_EQ(env_vars[0].second, "mscoree=b");
+}
+
+TEST(ProcessLauncherTest, ParseCommandRequiresShell)
+{
+  std::vector<std::pair<std::string, std::string>> env_vars;
+  EXPECT_TRUE(ProcessLauncher::parse_command("wine uninstaller --remove '{1234}'; winetricks dotnet48", env_vars).empty());
+  EXPECT_TRUE(ProcessLauncher::parse_command("wine --version | cut -d - -f2", env_vars).empty());
+  EXPECT_TRUE(ProcessLauncher::parse_command("echo $HOME", env_vars).empty());
+  EXPECT_FALSE(ProcessLauncher::parse_command("start /unix \"/home/user/My App (x86)/setup.exe\"", env_vars).empty());
+  EXPECT_TRUE(env_vars.empty());
+}
+
+TEST(ProcessLauncherTest, RunCommandFallsBackToShell)
+{
+  const auto& [exit_code, output] = ProcessLauncher::run_command("echo one; echo two | tr a-z A-Z");
+  EXPECT_EQ(exit_code, 0);
+  EXPECT_EQ(output, "one\nTWO\n");
+}
+
+TEST(ProcessLauncherTest, DecodeExitStatus)
+{
+  EXPECT_EQ(ProcessLauncher::decode_exit_status(0), 0);
+  EXPECT_EQ(ProcessLauncher::decode_exit_status(124 << 8), 124);
+  EXPECT_EQ(ProcessLauncher::decode_exit_status(9), 128 + 9); // Killed by SIGKILL
+}
@@ -0,0 +1,132 @@
+#include "release_list_cache.h"
+#include <filesystem>
+#include <fstream>
+#include <giomm/init.h>
+#include <gtest/gtest.h>
+
+namespace fs = std::filesystem;
+
+class ReleaseListCacheTest : public ::testing::Test
+{
+protected:
+  std::string test_dir;
+  std::string cache_file_path;
+
+  static void SetUpTestSuite()
+  {
+    // Initialize Gio to prevent GLib warnings
+    Gio::init();
+  }
+
+  void SetUp() override
+  {
+    test_dir = fs::temp_directory_path() / "winegui_release_list_cache_test";
+    // The directory of the cache file is created on the first write
+    cache_file_path = test_dir + "/winegui/runner_releases.ini";
+  }
+
+  void TearDown() override
+  {
+    if (fs::exists(test_dir))
+    {
+      fs::remove_all(test_dir);
+    }
+  }
+
+  static ReleaseListCache::Entry create_entry()
+  {
+    WineRunner::Release release;
+    release.source = WineRunner::SourceId::GEProton;
+    release.tag_name = "GE-Proton11-1";
+    release.version = "11-1";
+    release.variant = "GE-Proton";
+    release.wow64 = true;
+    release.asset_name = "GE-Proton11-1.tar.gz";
+    release.download_url = "https://github.com/GloriousEggroll/proton-ge-custom/releases/download/GE-Proton11-1/GE-Proton11-1.tar.gz";
+    release.size_bytes = 5'000'000'000;
+    release.published_at = "2026-10-01T12:00:00Z";
+    release.checksum_type = WineRunner::ChecksumType::Sha512;
+    release.checksum_url = release.download_url + ".sha512sum";
+    ReleaseListCache::Entry entry;
+    entry.releases = {release};
+    entry.etag = "W/\"abc123\"";
+    entry.last_modified = "Thu, 01 Oct 2026 12:00:00 GMT";
+    return entry;
+  }
+};
+
+TEST_F(ReleaseListCacheTest, MissingFile)
+{
+  ReleaseListCache cache(cache_file_path);
+  EXPECT_FALSE(cache.get(WineRunner::SourceId::GEProton).has_value());
+}
+
+TEST_F(ReleaseListCacheTest, PersistedAcrossInstances)
+{
+  {
+    ReleaseListCache cache(cache_file_path);
+    cache.put(WineRunner::SourceId::GEProton, create_entry());
+  }
+  ASSERT_TRUE(fs::exists(cache_file_path));
+
+  ReleaseListCache cache(cache_file_path);
+  EXPECT_FALSE(cache.get(WineRunner::SourceId::Kron4ekWineBuilds).has_value());
+  auto entry = cache.get(WineRunner::SourceId::GEProton);
+  ASSERT_TRUE(entry.has_value());
+  EXPECT_EQ(entry->etag, "W/\"abc123\"");
+  EXPECT_EQ(entry->last_modified, "Thu, 01 Oct 2026 12:00:00 GMT");
+  ASSERT_EQ(entry->releases.size(), 1u);
+  const WineRunner::Release expected = create_entry().releases.at(0);
+  const WineRunner::Release& release = entry->releases.at(0);
+  EXPECT_EQ(release.source, expected.source);
+  EXPECT_EQ(release.tag_name, expected.tag_name);
+  EXPECT_EQ(release.version, expected.version);
+  EXPECT_EQ(release.variant, expected.variant);
+  EXPECT_EQ(release.wow64, expected.wow64);
+  EXPECT_EQ(release.asset_name, expected.asset_name);
+  EXPECT_EQ(release.download_url, expected.download_url);
+  EXPECT_EQ(release.size_bytes, expected.size_bytes);
+  EXPECT_EQ(release.published_at, expected.published_at);
+  EXPECT_EQ(release.checksum_type, expected.checksum_type);
+  EXPECT_EQ(release.checksum_url, expected.checksum_url);
+}
+
+TEST_F(ReleaseListCacheTest, PutReplacesOnlyThatSource)
+{
+  ReleaseListCache cache(cache_file_path);
+  cache.put(WineRunner::SourceId::GEProton, create_entry());
+  ReleaseListCache::Entry empty_entry;
+  empty_entry.etag = "\"empty\"";
+  cache.put(WineRunner::SourceId::Kron4ekWineBuilds, empty_entry);
+  cache.put(WineRunner::SourceId::Kron4ekWineBuilds, empty_entry);
+
+  ReleaseListCache reloaded(cache_file_path);
+  auto entry = reloaded.get(WineRunner::SourceId::Kron4ekWineBuilds);
+  ASSERT_TRUE(entry.has_value());
+  EXPECT_TRUE(entry->releases.empty());
+  EXPECT_EQ(entry->etag, "\"empty\"");
+  ASSERT_TRUE(reloaded.get(WineRunner::SourceId::GEProton).has_value());
+  EXPECT_EQ(reloaded.get(WineRunner::SourceId::GEProton)->releases.size(), 1u);
+}
+
+TEST_F(ReleaseListCacheTest, OtherVersionIsIgnored)
+{
+  fs::create_directories(fs::path(cache_file_path).parent_path());
+  std::ofstream file(cache_file_path);
+  file << "[General]\nVersion=0\n\n[Source1]\nId=1\nETag=\"old\"\nLastModified=\nReleases=0\n";
+  file.close();
+
+  ReleaseListCache cache(cache_file_path);
+  EXPECT_FALSE(cache.get(WineRunner::SourceId::GEProton).has_value());
+}
+
+TEST_F(ReleaseListCacheTest, CorruptFileIsIgnored)
+{
+  fs::create_directories(fs::path(cache_file_path).parent_path());
+  std::ofstream file(cache_file_path);
+  file << "[General]\nVersion=1\n\n[Source1]\nId=1\nReleases=1\n";
+  file.close();
+
+  ReleaseListCache cache(cache_file_path);
+  EXPECT_FALSE(cache.get(WineRunner::SourceId::GEProton).has_value());
+}
@@ -0,0 +1,319 @@
+#include "resumable_download.h"
+#include <algorithm>
+#include <arpa/inet.h>
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+#include <gtest/gtest.h>
+#include <mutex>
+#include <netinet/in.h>
+#include <poll.h>
+#include <string>
+#include <string_view>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+/**
+ * Minimal HTTP/1.1 server on localhost, as a stand-in for the download server (GitHub)
+ */
+class LocalHttpServer
+{
+public:
+  LocalHttpServer(std::string content, bool is_range_supported) : content_(std::move(content)), is_range_supported_(is_range_supported)
+  {
+    listen_fd_ = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    struct sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t address_size = sizeof(address);
+    bind(listen_fd_, reinterpret_cast<struct sockaddr*>(&address), address_size);
+    listen(listen_fd_, 16);
+    getsockname(listen_fd_, reinterpret_cast<struct sockaddr*>(&address), &address_size);
+    port_ = ntohs(address.sin_port);
+    accept_thread_ = std::thread(&LocalHttpServer::serve, this);
+  }
+
+  ~LocalHttpServer()
+  {
+    is_stopping_ = true;
+    accept_thread_.join();
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (std::thread& thread : connection_threads_)
+      thread.join();
+    close(listen_fd_);
+  }
+
+  std::string get_url(const std::string& path) const
+  {
+    return "http://127.0.0.1:" + std::to_string(port_) + path;
+  }
+
+  // The connection of the next response is closed after the given number of body bytes
+  void drop_next_response_after(std::size_t bytes)
+  {
+    drop_after_ = bytes;
+  }
+
+  std::vector<std::size_t> get_range_starts()
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return range_starts_;
+  }
+
+private:
+  std::string content_;
+  bool is_range_supported_;
+  int listen_fd_ = -1;
+  int port_ = 0;
+  std::atomic<bool> is_stopping_ = false;
+  std::atomic<std::size_t> drop_after_ = 0;
+  std::thread accept_thread_;
+  std::mutex mutex_;
+  std::vector<std::thread> connection_threads_;
+  std::vector<std::size_t> range_starts_;
+
+  void serve()
+  {
+    while (!is_stopping_)
+    {
+      struct pollfd poll_fd = {listen_fd_, POLLIN, 0};
+      if (poll(&poll_fd, 1, 50) <= 0)
+        continue;
+      int fd = accept4(listen_fd_, nullptr, nullptr, SOCK_CLOEXEC);
+      if (fd < 0)
+        continue;
+      std::lock_guard<std::mutex> lock(mutex_);
+      connection_threads_.emplace_back(&LocalHttpServer::handle, this, fd);
+    }
+  }
+
+  void handle(int fd)
+  {
+    std::string request;
+    char buffer[4096];
+    while (request.find("\r\n\r\n") == std::string::npos)
+    {
+      ssize_t count = recv(fd, buffer, sizeof(buffer), 0);
+      if (count <= 0)
+      {
+        close(fd);
+        return;
+      }
+      request.append(buffer, static_cast<std::size_t>(count));
+    }
+    std::string path = request.substr(4, request.find(' ', 4) - 4);
+    std::size_t start = 0;
+    if (auto range = request.find("Range: bytes="); range != std::string::npos)
+      start = std::stoul(request.substr(range + 13));
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      range_starts_.push_back(start);
+    }
+    std::string header;
+    std::string_view body(content_);
+    if (path != "/runner.tar.xz")
+    {
+      header = "HTTP/1.1 404 Not Found\r\nContent-Length: 0\r\n";
+      body = {};
+    }
+    else if (is_range_supported_ && start > 0)
+    {
+      header = "HTTP/1.1 206 Partial Content\r\nContent-Range: bytes " + std::to_string(start) + "-" + std::to_string(content_.size() - 1) + "/" +
+               std::to_string(content_.size()) + "\r\nContent-Length: " + std::to_string(content_.size() - start) + "\r\n";
+      body = body.substr(start);
+    }
+    else
+    {
+      header = "HTTP/1.1 200 OK\r\nContent-Length: " + std::to_string(content_.size()) + "\r\n";
+    }
+    header += "Connection: close\r\n\r\n";
+    if (std::size_t drop_after = drop_after_.exchange(0); drop_after > 0)
+      body = body.substr(0, drop_after);
+    send(fd, header.data(), header.size(), MSG_NOSIGNAL);
+    while (!body.empty())
+    {
+      ssize_t count = send(fd, body.data(), body.size(), MSG_NOSIGNAL);
+      if (count <= 0)
+        break;
+      body.remove_prefix(static_cast<std::size_t>(count));
+    }
+    close(fd);
+  }
+};
+
+class ResumableDownloadTest : public ::testing::Test
+{
+protected:
+  fs::path location_;
+  std::string content_;
+  std::string received_;
+  std::atomic<bool> cancel_ = false;
+
+  void SetUp() override
+  {
+    location_ = fs::temp_directory_path() / ("winegui_resumable_download_test_" + std::to_string(getpid()));
+    fs::create_directories(location_);
+    // 40 MiB of data, which is not repeating at a segment boundary
+    content_.reserve(40 * 1024 * 1024);
+    for (unsigned int value = 0; content_.size() < 40 * 1024 * 1024; value = value * 1103515245 + 12345)
+      content_.push_back(static_cast<char>(value >> 16));
+  }
+
+  void TearDown() override
+  {
+    fs::remove_all(location_);
+  }
+
+  std::string get_part_path() const
+  {
+    return (location_ / "runner.tar.xz.part").string();
+  }
+
+  bool run(ResumableDownload& download, std::size_t cancel_after = 0)
+  {
+    received_.clear();
+    return download.run(
+        [this, cancel_after](const char* data, std::size_t size)
+        {
+          received_.append(data, size);
+          if (cancel_after > 0 && received_.size() >= cancel_after)
+            cancel_ = true;
+        },
+        {}, cancel_);
+  }
+
+  std::string read_part_file() const
+  {
+    std::ifstream file(get_part_path(), std::ios::binary);
+    std::string data(fs::file_size(get_part_path()), '\0');
+    file.read(data.data(), static_cast<std::streamsize>(data.size()));
+    return data;
+  }
+};
+
+TEST_F(ResumableDownloadTest, Download)
+{
+  LocalHttpServer server(content_, true);
+  ResumableDownload download(server.get_url("/runner.tar.xz"), get_part_path(), content_.size());
+  EXPECT_EQ(download.get_segment_count(), 1u);
+  EXPECT_EQ(download.get_resumed_bytes(), 0u);
+  ASSERT_TRUE(run(download));
+  EXPECT_TRUE(received_ == content_);
+  EXPECT_TRUE(read_part_file() == content_);
+}
+
+TEST_F(ResumableDownloadTest, DownloadWithUnknownSize)
+{
+  LocalHttpServer server(content_, true);
+  ResumableDownload download(server.get_url("/runner.tar.xz"), get_part_path(), 0, 4);
+  EXPECT_EQ(download.get_segment_count(), 1u);
+  ASSERT_TRUE(run(download));
+  EXPECT_TRUE(received_ == content_);
+}
+
+TEST_F(ResumableDownloadTest, DownloadInParallelSegments)
+{
+  LocalHttpServer server(content_, true);
+  ResumableDownload download(server.get_url("/runner.tar.xz"), get_part_path(), content_.size(), 2);
+  EXPECT_EQ(download.get_segment_count(), 2u);
+  ASSERT_TRUE(run(download));
+  // The data is still passed in order
+  EXPECT_TRUE(received_ == content_);
+  EXPECT_TRUE(read_part_file() == content_);
+  std::vector<std::size_t> range_starts = server.get_range_starts();
+  EXPECT_NE(std::find(range_starts.begin(), range_starts.end(), content_.size() / 2), range_starts.end());
+}
+
+TEST_F(ResumableDownloadTest, ProgressFollowsTheData)
+{
+  LocalHttpServer server(content_, true);
+  ResumableDownload download(server.get_url("/runner.tar.xz"), get_part_path(), content_.size(), 2);
+  std::vector<std::uint64_t> progress;
+  ASSERT_TRUE(download.run([](const char*, std::size_t) {},
+                           [this, &progress](std::uint64_t bytes_done, std::uint64_t bytes_total)
+                           {
+                             EXPECT_EQ(bytes_total, content_.size());
+                             progress.push_back(bytes_done);
+                           },
+                           cancel_));
+  // Pushed while the data arrives (not once per time interval), and complete at the end
+  EXPECT_GT(progress.size(), 10u);
+  EXPECT_TRUE(std::is_sorted(progress.begin(), progress.end()));
+  ASSERT_FALSE(progress.empty());
+  EXPECT_EQ(progress.back(), content_.size());
+}
+
+TEST_F(ResumableDownloadTest, ResumeAfterBrokenConnection)
+{
+  LocalHttpServer server(content_, true);
+  server.drop_next_response_after(5 * 1024 * 1024);
+  ResumableDownload download(server.get_url("/runner.tar.xz"), get_part_path(), content_.size());
+  ASSERT_TRUE(run(download));
+  EXPECT_TRUE(received_ == content_);
+  std::vector<std::size_t> range_starts = server.get_range_starts();
+  ASSERT_EQ(range_starts.size(), 2u);
+  EXPECT_EQ(range_starts[1], 5u * 1024 * 1024);
+}
+
+TEST_F(ResumableDownloadTest, ResumeAfterCancel)
+{
+  LocalHttpServer server(content_, true);
+  {
+    ResumableDownload download(server.get_url("/runner.tar.xz"), get_part_path(), content_.size(), 2);
+    EXPECT_FALSE(run(download, 3 * 1024 * 1024));
+  }
+  EXPECT_TRUE(fs::exists(get_part_path()));
+  cancel_ = false;
+  // A later run continues both segments, the data of the first run is passed first
+  ResumableDownload download(server.get_url("/runner.tar.xz"), get_part_path(), content_.size(), 2);
+  EXPECT_EQ(download.get_segment_count(), 2u);
+  EXPECT_GE(download.get_resumed_bytes(), 3u * 1024 * 1024);
+  ASSERT_TRUE(run(download));
+  EXPECT_TRUE(received_ == content_);
+  EXPECT_TRUE(read_part_file() == content_);
+  std::vector<std::size_t> range_starts = server.get_range_starts();
+  EXPECT_GT(*std::max_element(range_starts.begin() + 2, range_starts.end()), content_.size() / 2);
+  EXPECT_GE(*std::min_element(range_starts.begin() + 2, range_starts.end()), 3u * 1024 * 1024);
+}
+
+TEST_F(ResumableDownloadTest, RestartForOtherFile)
+{
+  LocalHttpServer server(content_, true);
+  {
+    ResumableDownload download(server.get_url("/runner.tar.xz"), get_part_path(), content_.size());
+    EXPECT_FALSE(run(download, 1024 * 1024));
+  }
+  cancel_ = false;
+  // Another size, so the .part file belongs to another file
+  content_.resize(content_.size() - 1);
+  LocalHttpServer other_server(content_, true);
+  ResumableDownload download(other_server.get_url("/runner.tar.xz"), get_part_path(), content_.size());
+  EXPECT_EQ(download.get_resumed_bytes(), 0u);
+  ASSERT_TRUE(run(download));
+  EXPECT_TRUE(read_part_file() == content_);
+}
+
+TEST_F(ResumableDownloadTest, ServerWithoutRangeSupport)
+{
+  LocalHttpServer server(content_, false);
+  server.drop_next_response_after(5 * 1024 * 1024);
+  ResumableDownload download(server.get_url("/runner.tar.xz"), get_part_path(), content_.size());
+  ASSERT_TRUE(run(download));
+  EXPECT_TRUE(received_ == content_);
+}
+
+TEST_F(ResumableDownloadTest, Discard)
+{
+  LocalHttpServer server(content_, true);
+  {
+    ResumableDownload download(server.get_url("/runner.tar.xz"), get_part_path(), content_.size());
+    EXPECT_FALSE(run(download, 1024 * 1024));
+  }
+  ResumableDownload::discard(get_part_path());
+  EXPECT_FALSE(fs::exists(get_part_path()));
+  EXPECT_FALSE(fs::exists(get_part_path() + ".ini"));
+}
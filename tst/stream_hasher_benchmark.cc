@@ -0,0 +1,81 @@
+/**
+ * Throughput benchmark of the checksum calculation of the Wine runner downloads, Glib::Checksum versus the StreamHasher.
+ *
+ * Usage: stream_hasher_benchmark [size in GiB] [file]
+ * Without a file, generated data (4 GiB by default) is passed from memory in 1 MiB chunks, like a download. With a file,
+ * the file is read in 1 MiB chunks instead. The caller does no other work, so this only shows the hashing speed: in the
+ * installer the StreamHasher also runs next to the extraction (on another thread).
+ * Note: the file is in the page cache after the first run, drop the caches between runs for cold-cache numbers.
+ */
+#include "stream_hasher.h"
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <glibmm/checksum.h>
+#include <iostream>
+#include <string>
+#include <tuple>
+#include <vector>
+
+static constexpr std::size_t ChunkSize = 1024 * 1024;
+
+/// Pass the data in chunks to the callback, from the file or generated
+static void feed(const std::string& file_path, std::uint64_t size, const std::function<void(const char*, std::size_t)>& data_cb)
+{
+  std::vector<char> chunk(ChunkSize);
+  if (file_path.empty())
+  {
+    for (std::size_t i = 0; i < chunk.size(); ++i)
+      chunk[i] = static_cast<char>((i * 2654435761u) >> 13);
+    for (std::uint64_t done = 0; done < size; done += chunk.size())
+      data_cb(chunk.data(), chunk.size());
+    return;
+  }
+  std::ifstream file(file_path, std::ios::binary);
+  while (file.read(chunk.data(), static_cast<std::streamsize>(chunk.size())) || file.gcount() > 0)
+    data_cb(chunk.data(), static_cast<std::size_t>(file.gcount()));
+}
+
+static void run(const std::string& name, std::uint64_t size, const std::function<std::string()>& hash)
+{
+  auto start = std::chrono::steady_clock::now();
+  std::string digest = hash();
+  std::chrono::duration<double> duration = std::chrono::steady_clock::now() - start;
+  std::cout << name << ": " << duration.count() << " s, " << static_cast<double>(size) / (1024 * 1024) / duration.count() << " MiB/s ("
+            << digest.substr(0, 16) << "...)" << std::endl;
+}
+
+int main(int argc, char* argv[])
+{
+  std::uint64_t size = static_cast<std::uint64_t>((argc > 1) ? std::atof(argv[1]) * 1024 : 4 * 1024) * 1024 * 1024;
+  std::string file_path = (argc > 2) ? argv[2] : "";
+  if (!file_path.empty())
+  {
+    std::ifstream file(file_path, std::ios::binary | std::ios::ate);
+    size = static_cast<std::uint64_t>(file.tellg());
+  }
+  std::cout << "Hashing " << size / (1024 * 1024) << " MiB" << (file_path.empty() ? " of generated data" : " of " + file_path) << std::endl;
+
+  for (auto [name, glib_type, algorithm] : {std::tuple{"SHA-256", Glib::Checksum::Type::SHA256, StreamHasher::Algorithm::Sha256},
+                                            std::tuple{"SHA-512", Glib::Checksum::Type::SHA512, StreamHasher::Algorithm::Sha512}})
+  {
+    run(std::string(name) + " Glib::Checksum", size,
+        [&]()
+        {
+          Glib::Checksum checksum(glib_type);
+          feed(file_path, size,
+               [&checksum](const char* data, std::size_t count)
+               { checksum.update(reinterpret_cast<const guchar*>(data), static_cast<gssize>(count)); });
+          return checksum.get_string();
+        });
+    run(std::string(name) + " StreamHasher  ", size,
+        [&]()
+        {
+          StreamHasher hasher(algorithm);
+          feed(file_path, size, [&hasher](const char* data, std::size_t count) { hasher.update(data, count); });
+          return hasher.finish();
+        });
+  }
+  return 0;
+}
@@ -0,0 +1,59 @@
+#include "stream_hasher.h"
+#include <algorithm>
+#include <glibmm/checksum.h>
+#include <gtest/gtest.h>
+#include <string>
+
+TEST(StreamHasherTest, EmptyData)
+{
+  StreamHasher hasher(StreamHasher::Algorithm::Sha256);
+  EXPECT_EQ(hasher.finish(), "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855");
+}
+
+TEST(StreamHasherTest, Sha256)
+{
+  StreamHasher hasher(StreamHasher::Algorithm::Sha256);
+  hasher.update("ab", 2);
+  hasher.update("c", 1);
+  EXPECT_EQ(hasher.finish(), "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad");
+}
+
+TEST(StreamHasherTest, Sha512)
+{
+  StreamHasher hasher(StreamHasher::Algorithm::Sha512);
+  hasher.update("abc", 3);
+  EXPECT_EQ(hasher.finish(), "ddaf35a193617abacc417349ae20413112e6fa4e89a97ea20a9eeee64b55d39a"
+                             "2192992a274fc1a836ba3c23a3feebbd454d4423643ce80e2a9ac94fa54ca49f");
+}
+
+TEST(StreamHasherTest, SameDigestAsGlib)
+{
+  // Multiple blocks, passed in odd sized chunks (like a download)
+  std::string data;
+  for (unsigned int value = 0; data.size() < 20 * 1024 * 1024 + 123; value = value * 1103515245 + 12345)
+    data.push_back(static_cast<char>(value >> 16));
+  StreamHasher sha256(StreamHasher::Algorithm::Sha256);
+  StreamHasher sha512(StreamHasher::Algorithm::Sha512);
+  for (std::size_t offset = 0; offset < data.size(); offset += 65'537)
+  {
+    std::size_t size = std::min<std::size_t>(65'537, data.size() - offset);
+    sha256.update(data.data() + offset, size);
+    sha512.update(data.data() + offset, size);
+  }
+  auto glib_digest = [&data](Glib::Checksum::Type type)
+  {
+    Glib::Checksum checksum(type);
+    checksum.update(reinterpret_cast<const guchar*>(data.data()), static_cast<gssize>(data.size()));
+    return checksum.get_string();
+  };
+  EXPECT_EQ(sha256.finish(), glib_digest(Glib::Checksum::Type::SHA256));
+  EXPECT_EQ(sha512.finish(), glib_digest(Glib::Checksum::Type::SHA512));
+}
+
+TEST(StreamHasherTest, DestroyWithoutFinish)
+{
+  std::string data(5 * 1024 * 1024, 'x');
+  StreamHasher hasher(StreamHasher::Algorithm::Sha256);
+  hasher.update(data.data(), data.size());
+  // The destructor stops the hash thread (eg. a cancelled download)
+}
@@ -234,6 +234,33 @@ TEST_F(WineRunnerTest, ParseChecksumFileMissingAsset)
 
 // Test find_wine_bin_dir function
 
+TEST_F(WineRunnerTest, ParseServerResponseValidators)
+{
+  // wget --server-response output, after a redirect
+  std::string response = "  HTTP/1.1 302 Found\n"
+                         "  Location: https://example.com/releases\n"
+                         "  ETag: \"redirect\"\n"
+                         "  HTTP/1.1 200 OK\n"
+                         "  Content-Type: application/json\n"
+                         "  etag: W/\"abc123\"\n"
+                         "  Last-Modified: Thu, 15 Oct 2026 10:00:00 GMT\n";
+  std::string etag;
+  std::string last_modified;
+  EXPECT_EQ(WineRunnerManager::parse_server_response(response, etag, last_modified), 200);
+  EXPECT_EQ(etag, "W/\"abc123\"");
+  EXPECT_EQ(last_modified, "Thu, 15 Oct 2026 10:00:00 GMT");
+}
+
+TEST_F(WineRunnerTest, ParseServerResponseNotModified)
+{
+  std::string etag;
+  std::string last_modified;
+  EXPECT_EQ(WineRunnerManager::parse_server_response("  HTTP/1.0 304 Not Modified\n", etag, last_modified), 304);
+  EXPECT_TRUE(etag.empty());
+  EXPECT_TRUE(last_modified.empty());
+  EXPECT_EQ(WineRunnerManager::parse_server_response("", etag, last_modified), 0);
+}
+
 TEST_F(WineRunnerTest, FindWineBinDirRegularLayout)
 {
   std::string runner_dir = test_dir + "/wine-11.13-amd64";
@@ -0,0 +1,122 @@
+#include "wineserver_monitor.h"
+#include <atomic>
+#include <chrono>
+#include <fcntl.h>
+#include <filesystem>
+#include <gtest/gtest.h>
+#include <latch>
+#include <sstream>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <thread>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+using namespace std::chrono_literals;
+
+class WineserverMonitorTest : public ::testing::Test
+{
+protected:
+  std::string prefix_path;
+  std::string server_directory;
+  pid_t fake_wineserver_pid = 0;
+
+  void SetUp() override
+  {
+    prefix_path = fs::temp_directory_path() / "winegui_wineserver_monitor_test";
+    fs::create_directories(prefix_path);
+    server_directory = WineserverMonitor::get_server_directory(prefix_path);
+    fs::create_directories(server_directory);
+  }
+
+  void TearDown() override
+  {
+    if (fake_wineserver_pid > 0)
+    {
+      kill(fake_wineserver_pid, SIGKILL);
+      waitpid(fake_wineserver_pid, nullptr, 0);
+    }
+    fs::remove_all(server_directory);
+    fs::remove_all(prefix_path);
+  }
+
+  /**
+   * \brief Start a process that holds the lock of the server directory (like wineserver does) for a while
+   */
+  void start_fake_wineserver(std::chrono::milliseconds duration)
+  {
+    std::string lock_path = server_directory + "/lock";
+    int ready_pipe[2];
+    ASSERT_EQ(pipe(ready_pipe), 0);
+    fake_wineserver_pid = fork();
+    ASSERT_GE(fake_wineserver_pid, 0);
+    if (fake_wineserver_pid == 0)
+    {
+      int fd = open(lock_path.c_str(), O_CREAT | O_TRUNC | O_WRONLY, 0600);
+      struct flock lock_info{};
+      lock_info.l_type = F_WRLCK;
+      lock_info.l_whence = SEEK_SET;
+      lock_info.l_len = 1;
+      fcntl(fd, F_SETLK, &lock_info);
+      char ready = 1;
+      (void)!write(ready_pipe[1], &ready, 1);
+      usleep(static_cast<useconds_t>(duration.count() * 1000));
+      _exit(0);
+    }
+    close(ready_pipe[1]);
+    char ready = 0;
+    ASSERT_EQ(read(ready_pipe[0], &ready, 1), 1);
+    close(ready_pipe[0]);
+  }
+};
+
+TEST_F(WineserverMonitorTest, GetServerDirectory)
+{
+  struct stat prefix_stat;
+  ASSERT_EQ(stat(prefix_path.c_str(), &prefix_stat), 0);
+  std::string expected = "/tmp/.wine-" + std::to_string(getuid()) + "/server-";
+  EXPECT_TRUE(server_directory.starts_with(expected));
+  EXPECT_TRUE(server_directory.ends_with("-" + (std::stringstream() << std::hex << prefix_stat.st_ino).str()));
+  EXPECT_TRUE(WineserverMonitor::get_server_directory(prefix_path + "/does_not_exist").empty());
+}
+
+TEST_F(WineserverMonitorTest, NotRunning)
+{
+  EXPECT_EQ(WineserverMonitor::find_wineserver_pid(prefix_path), 0);
+  EXPECT_TRUE(WineserverMonitor::get_instance().wait(prefix_path, 10ms));
+}
+
+TEST_F(WineserverMonitorTest, WaitUntilTerminated)
+{
+  start_fake_wineserver(200ms);
+  EXPECT_EQ(WineserverMonitor::find_wineserver_pid(prefix_path), fake_wineserver_pid);
+  auto start = std::chrono::steady_clock::now();
+  EXPECT_TRUE(WineserverMonitor::get_instance().wait(prefix_path, 5s));
+  EXPECT_LT(std::chrono::steady_clock::now() - start, 4s);
+}
+
+TEST_F(WineserverMonitorTest, WaitTimeout)
+{
+  start_fake_wineserver(5s);
+  EXPECT_FALSE(WineserverMonitor::get_instance().wait(prefix_path, 50ms));
+}
+
+TEST_F(WineserverMonitorTest, SeveralWaitsShareMonitor)
+{
+  start_fake_wineserver(200ms);
+  std::atomic<int> terminated_count = 0;
+  std::latch finished(3);
+  WineserverMonitor monitor;
+  for (int i = 0; i < 3; ++i)
+  {
+    monitor.wait_async(prefix_path, 5s,
+                       [&terminated_count, &finished](bool is_terminated)
+                       {
+                         if (is_terminated)
+                           ++terminated_count;
+                         finished.count_down();
+                       });
+  }
+  finished.wait();
+  EXPECT_EQ(terminated_count, 3);
+}